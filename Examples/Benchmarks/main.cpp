@@ -0,0 +1,628 @@
+#include <iostream>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <2DTools/Misc/Helper.hpp>
+#include <2DTools/Math/Matrix2D.hpp>
+#include <2DTools/Math/Transforms2D.hpp>
+#include <2DTools/Primitives/ConvexPolygon2D.hpp>
+#include <2DTools/Distances/Distances2D.hpp>
+#include <2DTools/Distances/BatchDistances2D.hpp>
+#include <2DTools/Intersections/GJK2D.hpp>
+#include <2DTools/Algorithms/RotatingCalipers2D.hpp>
+#include <2DTools/Algorithms/ConvexHull2D.hpp>
+#include <2DTools/Algorithms/Triangulation2D.hpp>
+#include <2DTools/Algorithms/PolygonBoolean2D.hpp>
+#include <2DTools/Algorithms/Clipping2D.hpp>
+#include <2DTools/Algorithms/Simplification2D.hpp>
+#include <2DTools/Spatial/SegmentBVH2D.hpp>
+#include <2DTools/Spatial/KdTree2D.hpp>
+#include <2DTools/Spatial/RTree2D.hpp>
+#include <2DTools/Spatial/LooseQuadtree2D.hpp>
+#include <2DTools/Spatial/SpatialHashGrid2D.hpp>
+#include <2DTools/Spatial/SweepAndPrune2D.hpp>
+#include <2DTools/Spatial/PointLocator2D.hpp>
+#include <2DTools/Spatial/PreparedPolygon2D.hpp>
+using namespace std;
+using namespace Tools2D;
+
+/**
+* Simple Benchmarks of the batch kernels against the per-object code paths
+**/
+
+// Run func "repeats" times and return the average time in milliseconds
+template<class Func>
+double Time(Func func, int repeats)
+{
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for(int r=0;r<repeats;r++)
+        func();
+    chrono::duration<double, milli> elapsed = chrono::high_resolution_clock::now()-start;
+    return elapsed.count()/repeats;
+}
+
+template<class T>
+void BenchmarkTransformPoints(const char* name, size_t n, int repeats)
+{
+    Matrix2D<T> mat = Matrix2D<T>();
+    mat.Rotate(T(0.3));
+    mat.Translate(T(1), T(2));
+    vector<Vector2D<T> > in(n), out(n);
+    vector<T> x(n), y(n), outX(n), outY(n);
+    for(size_t i=0;i<n;i++)
+    {
+        in[i] = Vector2D<T>(T(rand())/RAND_MAX, T(rand())/RAND_MAX);
+        x[i] = in[i].X();
+        y[i] = in[i].Y();
+    }
+    double perPoint = Time([&]() {
+        for(size_t i=0;i<n;i++)
+        {
+            out[i] = in[i];
+            out[i] *= mat;
+        }
+    }, repeats);
+    double aos = Time([&]() { TransformPoints(mat, in.data(), out.data(), n); }, repeats);
+    double soa = Time([&]() { TransformPoints(mat, x.data(), y.data(), outX.data(), outY.data(), n); }, repeats);
+    cout<<"TransformPoints<"<<name<<"> ("<<n<<" points): per-point operator*= "<<perPoint<<" ms, AoS kernel "<<aos<<" ms, SoA kernel "<<soa<<" ms\n";
+}
+
+void BenchmarkPolylineDistance(size_t n, int repeats)
+{
+    Polyline2d line = Polyline2d();
+    for(size_t i=0;i<n;i++)
+        line.AddPoint(Vector2d(double(i), (i%2) ? 1.0 : -1.0));
+    Vector2d p = Vector2d(n/2.0, 3.0);
+    double d = 0.0;
+    double t = Time([&]() { d += Distance(p, line); }, repeats);
+    cout<<"Distance(point, Polyline2D) ("<<n<<" vertices): "<<t<<" ms ("<<t*1e6/n<<" ns/vertex, checksum "<<d<<")\n";
+}
+
+void BenchmarkPreparedSegments(size_t n, int repeats)
+{
+    // every segment is queried with a point next to its middle (the common map-matching case)
+    vector<Segment2d> segs;
+    vector<PreparedSegment2d> prepared;
+    vector<Vector2d> queries;
+    for(size_t i=0;i<n;i++)
+    {
+        Vector2d a = Vector2d(double(rand())/RAND_MAX, double(rand())/RAND_MAX);
+        Vector2d dir = Vector2d(0.01, 0.02);
+        segs.push_back(Segment2d(a, a+dir));
+        prepared.push_back(PreparedSegment2d(segs.back()));
+        queries.push_back(a+dir*0.5+dir.Perp()*0.1);
+    }
+    double d = 0.0;
+    double plain = Time([&]() { for(size_t i=0;i<n;i++) d += Distance(queries[i], segs[i]); }, repeats);
+    double fast = Time([&]() { for(size_t i=0;i<n;i++) d += Distance(queries[i], prepared[i]); }, repeats);
+    cout<<"Distance(point, Segment) ("<<n<<" segments): Segment "<<plain<<" ms, PreparedSegment "<<fast<<" ms (checksum "<<d<<")\n";
+}
+
+template<class T>
+void BenchmarkClosestSegment(const char* name, size_t n, int repeats)
+{
+    vector<Segment<T> > segs;
+    SegmentArray2D<T> array;
+    for(size_t i=0;i<n;i++)
+    {
+        Vector2D<T> a = Vector2D<T>(T(rand())/RAND_MAX, T(rand())/RAND_MAX);
+        segs.push_back(Segment<T>(a, a+Vector2D<T>(T(0.01), T(-0.02))));
+        array.AddSegment(segs.back());
+    }
+    Vector2D<T> p = Vector2D<T>(T(0.5), T(0.5));
+    double d = 0.0;
+    double plain = Time([&]() {
+        double best = DistanceSq(p, segs[0]);
+        size_t index = 0;
+        for(size_t i=1;i<n;i++)
+        {
+            double dist = DistanceSq(p, segs[i]);
+            if(dist<best)
+            {
+                best = dist;
+                index = i;
+            }
+        }
+        d += best+index;
+    }, repeats);
+    double batch = Time([&]() {
+        ClosestSegment2D<T> closest = FindClosestSegment(p, array);
+        d += closest.distanceSq+closest.index;
+    }, repeats);
+    cout<<"Closest segment<"<<name<<"> ("<<n<<" segments): DistanceSq loop "<<plain<<" ms, FindClosestSegment "<<batch<<" ms (checksum "<<d<<")\n";
+}
+
+void BenchmarkSegmentBVH(size_t n, size_t queries)
+{
+    // smooth random curve with unit steps (similar to a long road polyline)
+    Polyline2d line = Polyline2d();
+    Vector2d p = Vector2d();
+    double heading = 0.0;
+    for(size_t i=0;i<n;i++)
+    {
+        heading += 0.2*(double(rand())/RAND_MAX-0.5);
+        p += Vector2d(cos(heading), sin(heading));
+        line.AddPoint(p);
+    }
+    SegmentBVH2d bvh;
+    double build = Time([&]() { bvh.Build(line.View()); }, 1);
+    // queries close to the line (map-matching)
+    vector<Vector2d> points;
+    for(size_t i=0;i<queries;i++)
+        points.push_back(line.Vertices()[rand()%n]+Vector2d(double(rand())/RAND_MAX-0.5, double(rand())/RAND_MAX-0.5));
+    double d = 0.0;
+    double linear = Time([&]() { d += DistanceSq(points[0], line); }, 10);
+    double query = Time([&]() { for(size_t i=0;i<queries;i++) d += bvh.Closest(points[i]).distanceSq; }, 1);
+    cout<<"SegmentBVH2D ("<<n<<" vertices): build "<<build<<" ms, nearest query "<<query*1e6/queries<<" ns, linear scan "<<linear*1e6<<" ns (checksum "<<d<<")\n";
+}
+
+void BenchmarkKdTree(size_t n, size_t queries)
+{
+    vector<Vector2d> points(n), targets(queries);
+    for(size_t i=0;i<n;i++)
+        points[i] = Vector2d(double(rand())/RAND_MAX, double(rand())/RAND_MAX);
+    for(size_t i=0;i<queries;i++)
+        targets[i] = Vector2d(double(rand())/RAND_MAX, double(rand())/RAND_MAX);
+    KdTree2d tree;
+    double build = Time([&]() { tree.Build(points); }, 1);
+    double parallelBuild = Time([&]() { tree.Build(points, 0); }, 1);
+    double d = 0.0;
+    double brute = Time([&]() {
+        double best = targets[0].DistanceSq(points[0]);
+        for(size_t i=1;i<n;i++)
+            best = min(best, targets[0].DistanceSq(points[i]));
+        d += best;
+    }, 10);
+    double nearest = Time([&]() { for(size_t i=0;i<queries;i++) d += tree.Nearest(targets[i]).distanceSq; }, 1);
+    vector<Neighbor2D<double> > knn;
+    double k8 = Time([&]() {
+        for(size_t i=0;i<queries;i++)
+        {
+            knn.clear();
+            tree.Nearest(targets[i], 8, knn);
+            d += knn.back().distanceSq;
+        }
+    }, 1);
+    cout<<"KdTree2D ("<<n<<" points): build "<<build<<" ms ("<<parallelBuild<<" ms on "<<HardwareThreads()<<" threads), nearest "<<nearest*1e6/queries
+        <<" ns, 8 nearest "<<k8*1e6/queries<<" ns, brute force "<<brute*1e6<<" ns (checksum "<<d<<")\n";
+}
+
+void BenchmarkRTree(size_t n, size_t queries)
+{
+    vector<Polygon2d> shapes(n);
+    for(size_t i=0;i<n;i++)
+    {
+        Vector2d c = Vector2d(1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX);
+        for(int k=0;k<6;k++)
+            shapes[i].AddPoint(c+Vector2d(cos(k*1.04), sin(k*1.04)));
+    }
+    RTree2d tree;
+    double build = Time([&]() { tree.BuildFromShapes(Span<const Polygon2d>(shapes)); }, 1);
+    vector<Vector2d> points(queries);
+    for(size_t i=0;i<queries;i++)
+        points[i] = Vector2d(1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX);
+    vector<size_t> found;
+    double d = 0.0;
+    double brute = Time([&]() {
+        AABB2d window = AABB2d(points[0], points[0]+Vector2d(5.0, 5.0));
+        for(size_t i=0;i<n;i++)
+            d += BoundingBox(shapes[i]).Overlaps(window);
+    }, 3);
+    double window = Time([&]() {
+        for(size_t i=0;i<queries;i++)
+        {
+            found.clear();
+            d += tree.Query(AABB2d(points[i], points[i]+Vector2d(5.0, 5.0)), found);
+        }
+    }, 1);
+    double nearest = Time([&]() { for(size_t i=0;i<queries;i++) d += tree.Nearest(points[i], Span<const Polygon2d>(shapes)).distanceSq; }, 1);
+    cout<<"RTree2D ("<<n<<" polygons): build "<<build<<" ms, window query "<<window*1e6/queries<<" ns (vertex scan "<<brute*1e6<<" ns), nearest shape "
+        <<nearest*1e6/queries<<" ns (checksum "<<d<<")\n";
+}
+
+void BenchmarkLooseQuadtree(size_t n, int ticks)
+{
+    LooseQuadtree2d tree = LooseQuadtree2d(AABB2d(Vector2d(0.0, 0.0), Vector2d(1000.0, 1000.0)));
+    vector<LooseQuadtree2d::Handle> handles(n);
+    vector<Vector2d> positions(n), velocities(n);
+    for(size_t i=0;i<n;i++)
+    {
+        positions[i] = Vector2d(1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX);
+        velocities[i] = Vector2d(0.1*rand()/RAND_MAX-0.05, 0.1*rand()/RAND_MAX-0.05);
+        handles[i] = tree.Insert(AABB2d(positions[i]-Vector2d(0.5, 0.5), positions[i]+Vector2d(0.5, 0.5)));
+    }
+    double move = Time([&]() {
+        for(size_t i=0;i<n;i++)
+        {
+            positions[i] += velocities[i];
+            tree.Move(handles[i], AABB2d(positions[i]-Vector2d(0.5, 0.5), positions[i]+Vector2d(0.5, 0.5)));
+        }
+    }, ticks);
+    vector<LooseQuadtree2d::Handle> found;
+    double d = 0.0;
+    double query = Time([&]() {
+        for(size_t i=0;i<n;i+=10)
+        {
+            found.clear();
+            d += tree.Query(positions[i], 3.0, found);
+        }
+    }, 1);
+    cout<<"LooseQuadtree2D ("<<n<<" agents): move all "<<move<<" ms/tick, radius query "<<query*1e6/(n/10)<<" ns (checksum "<<d<<")\n";
+}
+
+void BenchmarkSpatialHashGrid(size_t n, int frames)
+{
+    vector<Vector2d> points(n);
+    for(size_t i=0;i<n;i++)
+        points[i] = Vector2d(500.0*rand()/RAND_MAX, 500.0*rand()/RAND_MAX);
+    SpatialHashGrid2d grid;
+    vector<SpatialHashGrid2d::Pair> pairs;
+    double build = Time([&]() { grid.Build(points, 1.0); }, frames);
+    double serial = Time([&]() { grid.FindPairs(pairs); }, frames);
+    double parallel = Time([&]() { grid.FindPairs(pairs, 0); }, frames);
+    cout<<"SpatialHashGrid2D ("<<n<<" points, r=1): build "<<build<<" ms/frame, pairs "<<serial<<" ms ("<<parallel<<" ms on "<<HardwareThreads()
+        <<" threads), "<<pairs.size()<<" pairs\n";
+}
+
+void BenchmarkSweepAndPrune(size_t n, int frames)
+{
+    vector<AABB2d> boxes(n);
+    vector<Vector2d> velocities(n);
+    for(size_t i=0;i<n;i++)
+    {
+        Vector2d p(1000.0*rand()/RAND_MAX, 1000.0*rand()/RAND_MAX);
+        boxes[i] = AABB2d(p, p+Vector2d(2.0, 2.0));
+        velocities[i] = Vector2d(0.1*rand()/RAND_MAX-0.05, 0.1*rand()/RAND_MAX-0.05);
+    }
+    SweepAndPrune2d sap;
+    double build = Time([&]() { sap.Build(boxes); }, 1);
+    vector<SweepAndPrune2d::Pair> added, removed;
+    size_t swaps = 0, events = 0;
+    double update = Time([&]() {
+        for(size_t i=0;i<n;i++)
+        {
+            boxes[i] = AABB2d(boxes[i].Min()+velocities[i], boxes[i].Max()+velocities[i]);
+            sap.Move(SweepAndPrune2d::Handle(i), boxes[i]);
+        }
+        swaps += sap.Update(added, removed);
+        events += added.size()+removed.size();
+    }, frames);
+    cout<<"SweepAndPrune2D ("<<n<<" bodies): build "<<build<<" ms, move+update "<<update<<" ms/frame, "<<swaps/frames<<" swaps and "
+        <<events/frames<<" pair events per frame, "<<sap.PairCount()<<" pairs\n";
+}
+
+void BenchmarkGJK(int vertices, int pairs)
+{
+    // two regular polygons approaching each other, one query per frame and pair
+    Polygon2d a, b;
+    for(int i=0;i<vertices;i++)
+    {
+        double angle = 6.283185307179586*i/vertices;
+        a.AddPoint(Vector2d(cos(angle), sin(angle)));
+        b.AddPoint(Vector2d(3.0+cos(angle+0.1), 0.5+sin(angle+0.1)));
+    }
+    vector<Vector2d> moved(b.Vertices());
+    double d = 0.0;
+    double naive = Time([&]() {
+        for(int p=0;p<pairs;p++)
+        {
+            double m = Distance(a.Vertices()[0], b);
+            for(size_t i=0;i<a.Vertices().size();i++)
+                m = min(m, Distance(a.Vertices()[i], b));
+            for(size_t i=0;i<b.Vertices().size();i++)
+                m = min(m, Distance(b.Vertices()[i], a));
+            d += m;
+        }
+    }, 1);
+    double cold = Time([&]() {
+        for(int p=0;p<pairs;p++)
+            d += GJKDistance(a, b).distance;
+    }, 1);
+    SimplexCache2D cache;
+    double warm = Time([&]() {
+        for(int p=0;p<pairs;p++)
+        {
+            for(size_t i=0;i<moved.size();i++)
+                moved[i] -= Vector2d(1e-6, 0.0);
+            d += GJKDistance(Span<const Vector2d>(a.Vertices()), Span<const Vector2d>(moved), &cache).distance;
+        }
+    }, 1);
+    cout<<"GJK2D ("<<vertices<<"-gons): vertex/edge scan "<<naive*1e6/pairs<<" ns, GJK "<<cold*1e6/pairs<<" ns, warm started "<<warm*1e6/pairs
+        <<" ns (checksum "<<d<<")\n";
+}
+
+void BenchmarkRotatingCalipers(size_t polygons, int vertices)
+{
+    vector<Polygon2d> shapes(polygons);
+    for(size_t i=0;i<polygons;i++)
+        for(int k=0;k<vertices;k++)
+        {
+            double angle = 6.283185307179586*k/vertices;
+            shapes[i].AddPoint(Vector2d((1.0+i%7)*cos(angle), sin(angle)));
+        }
+    vector<double> out(polygons);
+    double d = 0.0;
+    double quadratic = Time([&]() {
+        for(size_t i=0;i<polygons;i++)
+        {
+            const vector<Vector2d>& v = shapes[i].Vertices();
+            double m = 0.0;
+            for(size_t a=0;a<v.size();a++)
+                for(size_t b=a+1;b<v.size();b++)
+                    m = max(m, v[a].DistanceSq(v[b]));
+            d += sqrt(m);
+        }
+    }, 1);
+    double calipers = Time([&]() { ConvexDiameters(Span<const Polygon2d>(shapes), out.data(), 1); }, 1);
+    double parallel = Time([&]() { ConvexDiameters(Span<const Polygon2d>(shapes), out.data(), 0); }, 1);
+    vector<Rectangle2d> rects;
+    double rectangles = Time([&]() { MinAreaRectangles(Span<const Polygon2d>(shapes), rects, 0); }, 1);
+    cout<<"RotatingCalipers2D ("<<polygons<<" "<<vertices<<"-gons): diameters all pairs "<<quadratic<<" ms, calipers "<<calipers<<" ms ("<<parallel
+        <<" ms on "<<HardwareThreads()<<" threads), min area rectangles "<<rectangles<<" ms (checksum "<<d+out[0]<<")\n";
+}
+
+void BenchmarkConvexPolygon(int vertices, size_t queries)
+{
+    Polygon2d polygon;
+    for(int k=0;k<vertices;k++)
+    {
+        double angle = 6.283185307179586*k/vertices;
+        polygon.AddPoint(Vector2d(3.0*cos(angle), sin(angle)));
+    }
+    vector<Vector2d> points(queries);
+    for(size_t i=0;i<queries;i++)
+        points[i] = Vector2d(8.0*rand()/RAND_MAX-4, 4.0*rand()/RAND_MAX-2);
+    double d = 0.0;
+    double linear = Time([&]() {
+        for(size_t i=0;i<queries;i++)
+            d += Distance(points[i], polygon);
+    }, 1);
+    ConvexPolygon2d convex;
+    double build = Time([&]() { convex = ConvexPolygon2d(polygon); }, 1);
+    double fast = Time([&]() {
+        for(size_t i=0;i<queries;i++)
+            d += convex.Distance(points[i]);
+    }, 1);
+    size_t inside = 0;
+    double contains = Time([&]() {
+        for(size_t i=0;i<queries;i++)
+            inside += convex.Contains(points[i]);
+    }, 1);
+    cout<<"ConvexPolygon2D ("<<vertices<<" vertices, "<<queries<<" points): linear distance "<<linear<<" ms, build "<<build<<" ms, distance "<<fast
+        <<" ms, contains "<<contains<<" ms (checksum "<<d+inside<<")\n";
+}
+void BenchmarkPointLocator(int size, size_t queries, double edgesPerCell)
+{
+    // jittered lattice tiling of size*size quads
+    vector<Vector2d> lattice;
+    for(int j=0;j<=size;j++)
+        for(int i=0;i<=size;i++)
+            lattice.push_back(Vector2d(i+0.6*rand()/RAND_MAX-0.3, j+0.6*rand()/RAND_MAX-0.3));
+    vector<Polygon2d> polygons(size_t(size)*size);
+    for(int j=0;j<size;j++)
+        for(int i=0;i<size;i++)
+        {
+            Polygon2d& polygon = polygons[size_t(j)*size+i];
+            polygon.AddPoint(lattice[j*(size+1)+i]);
+            polygon.AddPoint(lattice[j*(size+1)+i+1]);
+            polygon.AddPoint(lattice[(j+1)*(size+1)+i+1]);
+            polygon.AddPoint(lattice[(j+1)*(size+1)+i]);
+        }
+    PointCloud2D<double> points;
+    points.Reserve(queries);
+    for(size_t i=0;i<queries;i++)
+        points.AddPoint(double(size)*rand()/RAND_MAX, double(size)*rand()/RAND_MAX);
+    PointLocator2d locator;
+    double build = Time([&]() { locator.Build(Span<const Polygon2d>(polygons), edgesPerCell, 0); }, 1);
+    vector<uint32_t> out(queries);
+    double serial = Time([&]() { locator.Locate(points.View(), out.data(), 1); }, 1);
+    double parallel = Time([&]() { locator.Locate(points.View(), out.data(), 0); }, 1);
+    size_t located = 0;
+    for(size_t i=0;i<queries;i++)
+        located += out[i]!=PointLocator2d::None;
+    cout<<"PointLocator2D ("<<polygons.size()<<" polygons, "<<edgesPerCell<<" edges/cell, "<<locator.Columns()<<"x"<<locator.Rows()<<" cells): build "<<build
+        <<" ms, "<<locator.MemoryUsage()/(1024.0*1024.0)<<" MB, "<<queries<<" points "<<serial<<" ms ("<<parallel<<" ms on "<<HardwareThreads()
+        <<" threads, "<<located<<" located)\n";
+}
+void BenchmarkPreparedPolygon(int vertices, size_t queries)
+{
+    Polygon2d coast;
+    for(int i=0;i<vertices;i++)
+    {
+        double angle = 6.283185307179586*i/vertices;
+        double radius = 10.0+sin(37*angle)+0.5*sin(301*angle)+0.002*rand()/RAND_MAX;
+        coast.AddPoint(Vector2d(radius*cos(angle), radius*sin(angle)));
+    }
+    PointCloud2D<double> points;
+    points.Reserve(queries);
+    for(size_t i=0;i<queries;i++)
+        points.AddPoint(24.0*rand()/RAND_MAX-12, 24.0*rand()/RAND_MAX-12);
+    size_t inside = 0, sampled = 100;
+    double crossing = Time([&]() {
+        for(size_t i=0;i<sampled;i++)
+            inside += coast.Contains(points.View()[i]);
+    }, 1)*double(queries)/sampled;
+    PreparedPolygon2d prepared;
+    double build = Time([&]() { prepared = PreparedPolygon2d(coast, 2.0, 0); }, 1);
+    vector<char> out(queries);
+    bool* flags = reinterpret_cast<bool*>(out.data());
+    double serial = Time([&]() { prepared.Contains(points.View(), flags, 1); }, 1);
+    double parallel = Time([&]() { prepared.Contains(points.View(), flags, 0); }, 1);
+    for(size_t i=0;i<queries;i++)
+        inside += flags[i];
+    cout<<"PreparedPolygon2D ("<<vertices<<" vertices, "<<queries<<" points): crossing test "<<crossing<<" ms (estimated), build "<<build<<" ms, "
+        <<prepared.MemoryUsage()/(1024.0*1024.0)<<" MB, "<<100.0*prepared.BoundaryCells()/(prepared.Columns()*prepared.Rows())<<"% boundary cells, contains "
+        <<serial<<" ms ("<<parallel<<" ms on "<<HardwareThreads()<<" threads, "<<inside<<" inside)\n";
+}
+void BenchmarkConvexHull(size_t n)
+{
+    // points in a disk: the filter drops nearly all of them
+    vector<Vector2d> points(n);
+    for(size_t i=0;i<n;i++)
+    {
+        double angle = 6.283185307179586*rand()/RAND_MAX, radius = sqrt(double(rand())/RAND_MAX);
+        points[i] = Vector2d(radius*cos(angle), radius*sin(angle));
+    }
+    vector<Vector2d> copy, hull;
+    double unfiltered = Time([&]() { copy = points; detail::MonotoneChain(copy, hull); }, 1);
+    Polygon2d polygon;
+    double serial = Time([&]() { polygon = ConvexHull(Span<const Vector2d>(points), 1); }, 1);
+    double parallel = Time([&]() { polygon = ConvexHull(Span<const Vector2d>(points), 0); }, 1);
+    IncrementalHull2d incremental;
+    double streamed = Time([&]() { incremental.Insert(Span<const Vector2d>(points)); }, 1);
+    cout<<"ConvexHull2D ("<<n<<" points, "<<polygon.Vertices().size()<<" hull vertices): monotone chain "<<unfiltered<<" ms, filtered "<<serial
+        <<" ms ("<<parallel<<" ms on "<<HardwareThreads()<<" threads), incremental "<<streamed<<" ms ("<<hull.size()<<")\n";
+}
+void BenchmarkTriangulation(int vertices, size_t polygons)
+{
+    // footprint: star shaped outline (many split and merge vertices) with a star shaped hole
+    vector<Polygon2d> rings(2);
+    for(int k=0;k<vertices;k++)
+    {
+        double angle = 6.283185307179586*k/vertices;
+        double outer = 10.0+2.0*rand()/RAND_MAX, inner = 1.0+2.0*rand()/RAND_MAX;
+        rings[0].AddPoint(Vector2d(outer*cos(angle), outer*sin(angle)));
+        rings[1].AddPoint(Vector2d(inner*cos(angle), inner*sin(angle)));
+    }
+    vector<uint32_t> triangles;
+    double single = Time([&]() { Triangulate(Span<const Polygon2d>(rings), triangles); }, 1);
+    vector<Polygon2d> shapes(polygons);
+    for(size_t p=0;p<polygons;p++)
+        for(int k=0;k<24;k++)
+        {
+            double angle = 6.283185307179586*k/24, radius = 1.0+double(rand())/RAND_MAX;
+            shapes[p].AddPoint(Vector2d(radius*cos(angle), radius*sin(angle)));
+        }
+    vector<uint32_t> all;
+    vector<size_t> offsets;
+    double serial = Time([&]() { TriangulatePolygons(Span<const Polygon2d>(shapes), all, offsets, 1); }, 1);
+    double parallel = Time([&]() { TriangulatePolygons(Span<const Polygon2d>(shapes), all, offsets, 0); }, 1);
+    cout<<"Triangulation2D ("<<2*vertices<<" vertices with a hole): "<<single<<" ms, "<<triangles.size()/3<<" triangles; "<<polygons<<" 24-gons "
+        <<serial<<" ms ("<<parallel<<" ms on "<<HardwareThreads()<<" threads, "<<all.size()/3<<" triangles)\n";
+}
+void BenchmarkPolygonBoolean(size_t polygons)
+{
+    // obstacle footprints: overlapping hexagons of random size
+    double side = sqrt(double(polygons));
+    vector<Polygon2d> footprints(polygons);
+    for(size_t i=0;i<polygons;i++)
+    {
+        Vector2d center(side*rand()/RAND_MAX, side*rand()/RAND_MAX);
+        double radius = 0.2+0.4*rand()/RAND_MAX;
+        for(int k=0;k<6;k++)
+            footprints[i].AddPoint(center+Vector2d(radius*cos(1.0471975511965976*k), radius*sin(1.0471975511965976*k)));
+    }
+    RingBuffer2d merged, parallel, single;
+    BooleanStats2D serial = CascadedUnion(Span<const Polygon2d>(footprints), merged, 1);
+    BooleanStats2D threaded = CascadedUnion(Span<const Polygon2d>(footprints), parallel, 0);
+    PolygonBoolean2d engine;
+    engine.Compute(RingBuffer2d(Span<const Polygon2d>(footprints)), RingBuffer2d(), BooleanUnion, single);
+    const BooleanStats2D& flat = engine.Stats();
+    // free space: the union removed from the bounds
+    RingBuffer2d bounds, free;
+    bounds.AddRing(Span<const Vector2d>(Rectangle2d(Vector2d(side/2, side/2), side, side).Vertices()));
+    BooleanStats2D difference = BooleanOp(bounds, merged, BooleanDifference, free);
+    cout<<"PolygonBoolean2D ("<<polygons<<" hexagons): cascaded union "<<serial.totalMilliseconds<<" ms ("<<threaded.totalMilliseconds<<" ms on "
+        <<HardwareThreads()<<" threads), one sweep "<<flat.totalMilliseconds<<" ms (intersections "<<flat.intersectMilliseconds<<" ms, sweep "
+        <<flat.sweepMilliseconds<<" ms, link "<<flat.linkMilliseconds<<" ms, "<<flat.intersections<<" intersections, "<<flat.memoryUsage/(1024.0*1024.0)
+        <<" MB), "<<merged.RingCount()<<" rings, free space "<<difference.totalMilliseconds<<" ms (area "<<free.Area()<<")\n";
+}
+void BenchmarkClipping(size_t shapes, int frames)
+{
+    // scene of small polygons and segments, the view window covers about a quarter of it
+    RingBuffer2d polygons;
+    SegmentArray2d segments;
+    vector<Polygon2d> separate(shapes);
+    for(size_t i=0;i<shapes;i++)
+    {
+        Vector2d center(100.0*rand()/RAND_MAX, 100.0*rand()/RAND_MAX);
+        for(int k=0;k<8;k++)
+            separate[i].AddPoint(center+Vector2d(cos(0.7853981633974483*k), sin(0.7853981633974483*k)));
+        polygons.AddRing(Span<const Vector2d>(separate[i].Vertices()));
+        segments.AddSegment(center, center+Vector2d(10.0*rand()/RAND_MAX-5.0, 10.0*rand()/RAND_MAX-5.0));
+    }
+    RectangleClipper2d clipper(Rectangle2d(Vector2d(50.0, 50.0), 50.0, 50.0));
+    RingBuffer2d clippedPolygons;
+    SegmentArray2d clippedSegments;
+    vector<uint32_t> sources;
+    size_t count = 0;
+    double rings = Time([&]() { count += clipper.ClipRings(polygons, clippedPolygons, sources); }, frames);
+    size_t accepted = clipper.Accepted(), clipped = clipper.Clipped();
+    double lines = Time([&]() { count += clipper.ClipSegments(segments, clippedSegments, sources); }, frames);
+    // one allocation per shape: every polygon clipped into its own vector
+    double perShape = Time([&]() {
+        vector<vector<Vector2d> > out;
+        for(size_t i=0;i<shapes;i++)
+        {
+            vector<Vector2d> ring;
+            if(clipper.Clip(Span<const Vector2d>(separate[i].Vertices()), ring))
+                out.push_back(ring);
+        }
+        count += out.size();
+    }, frames);
+    cout<<"RectangleClipper2D ("<<shapes<<" octagons and segments): rings "<<rings<<" ms ("<<accepted<<" inside, "<<clipped<<" clipped; "
+        <<perShape<<" ms with a vector per polygon), segments "<<lines<<" ms ("<<count<<")\n";
+}
+void BenchmarkSimplification(size_t points, size_t lines)
+{
+    // GPS like trajectory: a random walk with a slowly turning heading and noise
+    Polyline2d trajectory;
+    Vector2d position(0.0, 0.0);
+    double heading = 0.0;
+    for(size_t i=0;i<points;i++)
+    {
+        heading += 0.1*rand()/RAND_MAX-0.05;
+        position += Vector2d(cos(heading), sin(heading))+Vector2d(0.2*rand()/RAND_MAX-0.1, 0.2*rand()/RAND_MAX-0.1);
+        trajectory.AddPoint(position);
+    }
+    vector<uint32_t> douglas, visvalingam;
+    double dp = Time([&]() { DouglasPeucker(trajectory, 0.5, douglas); }, 1);
+    double vw = Time([&]() { Visvalingam(trajectory, 0.5, visvalingam); }, 1);
+    StreamingPolyline2d stream(0.5);
+    double streaming = Time([&]() {
+        for(size_t i=0;i<points;i++)
+            stream.AddPoint(trajectory.Vertices()[i]);
+        stream.Flush();
+    }, 1);
+    // many shorter trajectories
+    vector<Polyline2d> pieces(lines);
+    for(size_t i=0;i<points;i++)
+        pieces[i*lines/points].AddPoint(trajectory.Vertices()[i]);
+    vector<uint32_t> all;
+    vector<size_t> offsets;
+    double serial = Time([&]() { SimplifyPolylines(Span<const Polyline2d>(pieces), 0.5, SimplifyDouglasPeucker, all, offsets, 1); }, 1);
+    double parallel = Time([&]() { SimplifyPolylines(Span<const Polyline2d>(pieces), 0.5, SimplifyDouglasPeucker, all, offsets, 0); }, 1);
+    cout<<"Simplification2D ("<<points<<" points): Douglas-Peucker "<<dp<<" ms ("<<douglas.size()<<" kept), Visvalingam "<<vw<<" ms ("
+        <<visvalingam.size()<<" kept), streaming "<<streaming<<" ms ("<<stream.Indices().size()<<" kept); "<<lines<<" polylines "<<serial
+        <<" ms ("<<parallel<<" ms on "<<HardwareThreads()<<" threads)\n";
+}
+int main()
+{
+    BenchmarkTransformPoints<float>("float", 1000000, 20);
+    BenchmarkTransformPoints<double>("double", 1000000, 20);
+    BenchmarkPolylineDistance(1000, 1000);
+    BenchmarkPolylineDistance(10000, 100);
+    BenchmarkPolylineDistance(100000, 10);
+    BenchmarkPreparedSegments(1000, 2000);
+    BenchmarkClosestSegment<float>("float", 100000, 100);
+    BenchmarkClosestSegment<double>("double", 100000, 100);
+    BenchmarkSegmentBVH(1000000, 100000);
+    BenchmarkKdTree(1000000, 1000000);
+    BenchmarkRTree(200000, 100000);
+    BenchmarkLooseQuadtree(200000, 20);
+    BenchmarkSpatialHashGrid(200000, 20);
+    BenchmarkSweepAndPrune(50000, 50);
+    BenchmarkGJK(32, 100000);
+    BenchmarkRotatingCalipers(10000, 256);
+    BenchmarkConvexPolygon(16, 1000000);
+    BenchmarkConvexPolygon(256, 1000000);
+    BenchmarkPointLocator(316, 4000000, 2.0);
+    BenchmarkPreparedPolygon(1000000, 4000000);
+    BenchmarkConvexHull(10000000);
+    BenchmarkTriangulation(25000, 100000);
+    BenchmarkPolygonBoolean(100000);
+    BenchmarkClipping(50000, 20);
+    BenchmarkSimplification(4000000, 400);
+	return(0);
+}
@@ -20,8 +20,7 @@ int main()
     Matrix2 mat = Matrix2();
 	mat.Identity();
 	mat.Translate(2,3);
-	float** data;
-	data = mat.getData(); //get the matrix data
+	const Matrix2::DataType& data = mat.getData(); //get the matrix data (no copy)
 	cout<<"Matrix -- Column Major (so far...maybe row major in next push)\n";
 	for(int i=0;i<3;i++)
 	{
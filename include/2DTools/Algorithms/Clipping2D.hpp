@@ -0,0 +1,299 @@
+#ifndef CLIPPING_2D_HPP
+#define CLIPPING_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/LinearShapes.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+#include <2DTools/Primitives/SegmentArray2D.hpp>
+#include <2DTools/Primitives/RingBuffer2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* One Sutherland-Hodgman stage: keep the part of a ring on the inside of the line x=bound (Axis 0) or y=bound (Axis 1)
+* The inside is below the bound if Upper, above it otherwise; the points on the line get exactly the bound
+**/
+template<class T, int Axis, bool Upper>
+void ClipRingStage(const Vector2D<T>* in, std::size_t n, T bound, std::vector<Vector2D<T> >& out)
+{
+    out.clear();
+    if(n==0)
+        return;
+    const Vector2D<T>* prev = &in[n-1];
+    T pc = Axis==0 ? prev->X() : prev->Y();
+    bool prevIn = Upper ? pc<=bound : pc>=bound;
+    for(std::size_t i=0;i<n;i++)
+    {
+        const Vector2D<T>& cur = in[i];
+        T cc = Axis==0 ? cur.X() : cur.Y();
+        bool curIn = Upper ? cc<=bound : cc>=bound;
+        // a vertex on the line is inside: it is the crossing point already
+        if(curIn!=prevIn && cc!=bound && pc!=bound)
+        {
+            T t = (bound-pc)/(cc-pc);
+            if(Axis==0)
+                out.push_back(Vector2D<T>(bound, prev->Y()+t*(cur.Y()-prev->Y())));
+            else
+                out.push_back(Vector2D<T>(prev->X()+t*(cur.X()-prev->X()), bound));
+        }
+        if(curIn)
+            out.push_back(cur);
+        prev = &cur;
+        pc = cc;
+        prevIn = curIn;
+    }
+}
+
+}
+
+/**
+* RectangleClipper2D Class
+* Clipping of polygons (Sutherland-Hodgman) and segments (Liang-Barsky) to an axis aligned view window
+* The batch kernels read flat buffers (SegmentArray2D, RingBuffer2D) and append to output buffers that are cleared but
+* keep their memory, so clipping the same scene every frame does not allocate once the buffers have grown
+* Every shape first goes through a bounding box test: shapes inside the window are copied as they are, shapes outside
+* are skipped, and a polygon crossing the window is only clipped against the sides its box crosses
+**/
+template<class T>
+class RectangleClipper2D
+{
+protected:
+    AABB2D<T> window;
+    // scratch rings of the Sutherland-Hodgman stages
+    std::vector<Vector2D<T> > front;
+    std::vector<Vector2D<T> > back;
+    // counters of the last batch
+    std::size_t accepted;
+    std::size_t rejected;
+    std::size_t clipped;
+
+    /**
+    * Clip a ring against the sides of the window crossed by its bounding box
+    * @return const std::vector - the clipped ring (front or back)
+    **/
+    const std::vector<Vector2D<T> >& ClipRing(Span<const Vector2D<T> > ring, const AABB2D<T>& box)
+    {
+        const Vector2D<T>* in = ring.data();
+        std::size_t n = ring.size();
+        std::vector<Vector2D<T> >* out = &front;
+        std::vector<Vector2D<T> >* spare = &back;
+        bool copied = false;
+        // each stage reads the output of the previous one
+        auto stage = [&](bool crossed, void (*clip)(const Vector2D<T>*, std::size_t, T, std::vector<Vector2D<T> >&), T bound) {
+            if(!crossed)
+                return;
+            clip(in, n, bound, *out);
+            in = out->data();
+            n = out->size();
+            std::swap(out, spare);
+            copied = true;
+        };
+        stage(box.Min().X()<window.Min().X(), &detail::ClipRingStage<T, 0, false>, window.Min().X());
+        stage(box.Max().X()>window.Max().X(), &detail::ClipRingStage<T, 0, true>, window.Max().X());
+        stage(box.Min().Y()<window.Min().Y(), &detail::ClipRingStage<T, 1, false>, window.Min().Y());
+        stage(box.Max().Y()>window.Max().Y(), &detail::ClipRingStage<T, 1, true>, window.Max().Y());
+        if(!copied)
+            spare->assign(ring.begin(), ring.end());
+        return *spare;
+    }
+
+    static AABB2D<T> RingBox(Span<const Vector2D<T> > ring)
+    {
+        AABB2D<T> box;
+        for(std::size_t i=0;i<ring.size();i++)
+            box.Extend(ring[i]);
+        return box;
+    }
+public:
+    /**
+    * Constructor
+    * @param view - the window (axis aligned)
+    **/
+    explicit RectangleClipper2D(const AABB2D<T>& view):window(view),accepted(0),rejected(0),clipped(0){}
+
+    /**
+    * Constructor
+    * @param view - the window (an axis aligned rectangle, a rotated one is replaced by its bounding box)
+    **/
+    explicit RectangleClipper2D(const Rectangle2D<T>& view):window(BoundingBox(view)),accepted(0),rejected(0),clipped(0){}
+
+    const AABB2D<T>& Window()const {return window;}
+    void SetWindow(const AABB2D<T>& view) {window = view;}
+
+    /**
+    * Get the counters of the last batch
+    * @return std::size_t - shapes copied as they are (inside), skipped (outside) and clipped
+    **/
+    std::size_t Accepted()const {return accepted;}
+    std::size_t Rejected()const {return rejected;}
+    std::size_t Clipped()const {return clipped;}
+
+    /**
+    * Clip a segment (Liang-Barsky)
+    * @param segment - the segment
+    * @param out - the part of the segment in the window
+    * @return bool - false if the segment misses the window (out is not changed)
+    **/
+    bool Clip(const Segment<T>& segment, Segment<T>& out)const
+    {
+        Vector2D<T> p0 = segment.P0(), p1 = segment.P1();
+        Vector2D<T> d = p1-p0;
+        T t0 = 0, t1 = 1;
+        // p*t<=q for the four sides
+        const T p[4] = {-d.X(), d.X(), -d.Y(), d.Y()};
+        const T q[4] = {p0.X()-window.Min().X(), window.Max().X()-p0.X(), p0.Y()-window.Min().Y(), window.Max().Y()-p0.Y()};
+        for(int k=0;k<4;k++)
+        {
+            if(p[k]==0)
+            {
+                if(q[k]<0)
+                    return false;
+            }
+            else if(p[k]<0)
+                t0 = std::max(t0, q[k]/p[k]);
+            else
+                t1 = std::min(t1, q[k]/p[k]);
+        }
+        if(t0>t1)
+            return false;
+        // the endpoints are clamped so rounding cannot move them out of the window
+        Vector2D<T> a = t0>0 ? p0+d*t0 : p0, b = t1<1 ? p0+d*t1 : p1;
+        a = Vector2D<T>(std::min(std::max(a.X(), window.Min().X()), window.Max().X()), std::min(std::max(a.Y(), window.Min().Y()), window.Max().Y()));
+        b = Vector2D<T>(std::min(std::max(b.X(), window.Min().X()), window.Max().X()), std::min(std::max(b.Y(), window.Min().Y()), window.Max().Y()));
+        out = Segment<T>(a, b);
+        return true;
+    }
+
+    /**
+    * Clip a polygon ring (Sutherland-Hodgman)
+    * A concave ring cut in several pieces by the window stays one ring, joined by edges along the window sides
+    * @param ring - the vertices
+    * @param out - the clipped ring (cleared first)
+    * @return bool - false if nothing is left (fewer than 3 vertices)
+    **/
+    bool Clip(Span<const Vector2D<T> > ring, std::vector<Vector2D<T> >& out)
+    {
+        out.clear();
+        AABB2D<T> box = RingBox(ring);
+        if(ring.size()<3 || !window.Overlaps(box))
+            return false;
+        if(window.Contains(box))
+            out.assign(ring.begin(), ring.end());
+        else
+        {
+            const std::vector<Vector2D<T> >& result = ClipRing(ring, box);
+            out.assign(result.begin(), result.end());
+        }
+        return out.size()>=3;
+    }
+
+    /**
+    * Clip a batch of segments
+    * @param segments - the segments
+    * @param out - the clipped segments (cleared first)
+    * @param sources - index in segments of every clipped segment (cleared first)
+    * @return std::size_t - number of segments in the window
+    **/
+    std::size_t ClipSegments(const SegmentArray2D<T>& segments, SegmentArray2D<T>& out, std::vector<std::uint32_t>& sources)
+    {
+        out.Clear();
+        sources.clear();
+        accepted = rejected = clipped = 0;
+        const T* x0s = segments.X0();
+        const T* y0s = segments.Y0();
+        const T* dxs = segments.DX();
+        const T* dys = segments.DY();
+        T minX = window.Min().X(), minY = window.Min().Y(), maxX = window.Max().X(), maxY = window.Max().Y();
+        for(std::size_t i=0;i<segments.Size();i++)
+        {
+            T x0 = x0s[i], y0 = y0s[i], x1 = x0+dxs[i], y1 = y0+dys[i];
+            T loX = std::min(x0, x1), hiX = std::max(x0, x1), loY = std::min(y0, y1), hiY = std::max(y0, y1);
+            if(hiX<minX || loX>maxX || hiY<minY || loY>maxY)
+            {
+                rejected++;
+                continue;
+            }
+            Vector2D<T> p0(x0, y0), p1(x1, y1);
+            if(loX>=minX && hiX<=maxX && loY>=minY && hiY<=maxY)
+            {
+                accepted++;
+                out.AddSegment(p0, p1);
+                sources.push_back(std::uint32_t(i));
+                continue;
+            }
+            Segment<T> part;
+            if(!Clip(Segment<T>(p0, p1), part))
+            {
+                rejected++;
+                continue;
+            }
+            clipped++;
+            out.AddSegment(part);
+            sources.push_back(std::uint32_t(i));
+        }
+        return sources.size();
+    }
+
+    /**
+    * Clip a batch of polygon rings
+    * @param rings - the rings
+    * @param out - the clipped rings (cleared first, kept in the orientation of the input)
+    * @param sources - index in rings of every clipped ring (cleared first)
+    * @return std::size_t - number of rings in the window
+    **/
+    std::size_t ClipRings(const RingBuffer2D<T>& rings, RingBuffer2D<T>& out, std::vector<std::uint32_t>& sources)
+    {
+        out.Clear();
+        sources.clear();
+        accepted = rejected = clipped = 0;
+        for(std::size_t r=0;r<rings.RingCount();r++)
+        {
+            Span<const Vector2D<T> > ring = rings.Ring(r);
+            AABB2D<T> box = RingBox(ring);
+            if(ring.size()<3 || !window.Overlaps(box))
+            {
+                rejected++;
+                continue;
+            }
+            if(window.Contains(box))
+            {
+                accepted++;
+                for(std::size_t i=0;i<ring.size();i++)
+                    out.AddPoint(ring[i]);
+            }
+            else
+            {
+                const std::vector<Vector2D<T> >& result = ClipRing(ring, box);
+                if(result.size()<3)
+                {
+                    rejected++;
+                    continue;
+                }
+                clipped++;
+                for(std::size_t i=0;i<result.size();i++)
+                    out.AddPoint(result[i]);
+            }
+            out.CloseRing();
+            sources.push_back(std::uint32_t(r));
+        }
+        return sources.size();
+    }
+};
+
+typedef RectangleClipper2D<double> RectangleClipper2d;
+typedef RectangleClipper2D<float> RectangleClipper2;
+
+}
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef CONVEX_HULL_2D_HPP
+#define CONVEX_HULL_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Predicates2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/PointCloud2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+// Points per chunk below which the hull is not split between threads
+static const std::size_t HullParallelGrain = 1<<16;
+
+/**
+* Orientation of the triangle (o, a, b): positive if counter clockwise
+* The sign is exact, so the chains and the octagon filter keep or drop near collinear points the same way everywhere
+**/
+template<class T>
+inline T Orient(const Vector2D<T>& o, const Vector2D<T>& a, const Vector2D<T>& b)
+{
+    return Orient2D(o, a, b);
+}
+
+template<class T>
+inline bool LexicographicLess(const Vector2D<T>& a, const Vector2D<T>& b)
+{
+    return a.X()<b.X() || (a.X()==b.X() && a.Y()<b.Y());
+}
+
+/**
+* Andrew's monotone chain: counter clockwise hull without collinear vertices (points are sorted in place)
+**/
+template<class T>
+void MonotoneChain(std::vector<Vector2D<T> >& points, std::vector<Vector2D<T> >& hull)
+{
+    std::sort(points.begin(), points.end(), LexicographicLess<T>);
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+    std::size_t n = points.size();
+    hull.clear();
+    if(n<3)
+    {
+        hull.assign(points.begin(), points.end());
+        return;
+    }
+    hull.resize(2*n);
+    std::size_t k = 0;
+    for(std::size_t i=0;i<n;i++)
+    {
+        while(k>=2 && Orient(hull[k-2], hull[k-1], points[i])<=0)
+            k--;
+        hull[k++] = points[i];
+    }
+    for(std::size_t i=n-1, lower=k+1;i>0;i--)
+    {
+        while(k>=lower && Orient(hull[k-2], hull[k-1], points[i-1])<=0)
+            k--;
+        hull[k++] = points[i-1];
+    }
+    hull.resize(k-1);
+}
+
+/**
+* Akl-Toussaint filter: the extreme points in 8 directions (x, y and the diagonals) span an octagon inside the hull;
+* the points strictly inside it cannot be hull vertices
+**/
+template<class T>
+class HullOctagon
+{
+protected:
+    Vector2D<T> corners[8];
+    std::size_t count;
+public:
+    HullOctagon():count(0){}
+
+    /**
+    * Extreme points of a range, in counter clockwise order of their directions (starting at the lowest point)
+    **/
+    template<class Points>
+    static void Extremes(const Points& points, std::size_t begin, std::size_t end, Vector2D<T>* extremes)
+    {
+        for(int k=0;k<8;k++)
+            extremes[k] = points[begin];
+        for(std::size_t i=begin+1;i<end;i++)
+            Merge(points[i], extremes);
+    }
+
+    static void Merge(const Vector2D<T>& p, Vector2D<T>* extremes)
+    {
+        T x = p.X(), y = p.Y();
+        if(y<extremes[0].Y()) extremes[0] = p;
+        if(x-y>extremes[1].X()-extremes[1].Y()) extremes[1] = p;
+        if(x>extremes[2].X()) extremes[2] = p;
+        if(x+y>extremes[3].X()+extremes[3].Y()) extremes[3] = p;
+        if(y>extremes[4].Y()) extremes[4] = p;
+        if(x-y<extremes[5].X()-extremes[5].Y()) extremes[5] = p;
+        if(x<extremes[6].X()) extremes[6] = p;
+        if(x+y<extremes[7].X()+extremes[7].Y()) extremes[7] = p;
+    }
+
+    /**
+    * Set the octagon from the extreme points (repeated corners are dropped)
+    **/
+    void Set(const Vector2D<T>* extremes)
+    {
+        count = 0;
+        for(int k=0;k<8;k++)
+            if(count==0 || extremes[k]!=corners[count-1])
+                corners[count++] = extremes[k];
+        while(count>1 && corners[count-1]==corners[0])
+            count--;
+    }
+
+    /**
+    * Check if a point is strictly inside (strictly left of every edge; always false for less than 3 corners)
+    **/
+    bool Inside(const Vector2D<T>& p)const
+    {
+        if(count<3)
+            return false;
+        for(std::size_t k=0;k<count;k++)
+            if(Orient(corners[k], corners[k+1==count ? 0 : k+1], p)<=0)
+                return false;
+        return true;
+    }
+};
+
+/**
+* Hull of points given by an indexable container (points[i] is a Vector2D)
+* Each chunk is filtered and hulled by its own thread, then the hull of the chunk hulls is the result
+**/
+template<class T, class Points>
+void ConvexHull(const Points& points, std::size_t n, std::vector<Vector2D<T> >& hull, unsigned int threads)
+{
+    hull.clear();
+    if(n==0)
+        return;
+    std::size_t chunks = std::min<std::size_t>(ResolveThreads(threads), std::max<std::size_t>(1, n/HullParallelGrain));
+    std::size_t chunk = (n+chunks-1)/chunks;
+    std::vector<Vector2D<T> > extremes(8*chunks);
+    ParallelFor(0, chunks, [&](std::size_t c) {
+        HullOctagon<T>::Extremes(points, c*chunk, std::min(n, (c+1)*chunk), &extremes[8*c]);
+    }, threads, 1);
+    for(std::size_t c=1;c<chunks;c++)
+        for(int k=0;k<8;k++)
+            HullOctagon<T>::Merge(extremes[8*c+k], &extremes[0]);
+    HullOctagon<T> octagon;
+    octagon.Set(&extremes[0]);
+    std::vector<std::vector<Vector2D<T> > > hulls(chunks);
+    ParallelFor(0, chunks, [&](std::size_t c) {
+        std::vector<Vector2D<T> > kept;
+        for(std::size_t i=c*chunk;i<std::min(n, (c+1)*chunk);i++)
+            if(!octagon.Inside(points[i]))
+                kept.push_back(points[i]);
+        MonotoneChain(kept, hulls[c]);
+    }, threads, 1);
+    if(chunks==1)
+    {
+        hull.swap(hulls[0]);
+        return;
+    }
+    std::vector<Vector2D<T> > merged;
+    for(std::size_t c=0;c<chunks;c++)
+        merged.insert(merged.end(), hulls[c].begin(), hulls[c].end());
+    MonotoneChain(merged, hull);
+}
+
+template<class T>
+Polygon2D<T> MakePolygon(const std::vector<Vector2D<T> >& vertices)
+{
+    Polygon2D<T> polygon;
+    for(std::size_t i=0;i<vertices.size();i++)
+        polygon.AddPoint(vertices[i]);
+    return polygon;
+}
+
+}
+
+/**
+* Convex hull of a set of points (Andrew's monotone chain with the Akl-Toussaint filter)
+* Large sets are split between threads: every thread hulls a chunk and the chunk hulls are merged
+* @param points - the points
+* @param threads - number of threads (0 means all hardware threads)
+* @return Polygon2D - the hull, counter clockwise from the leftmost (then lowest) point, without collinear vertices
+* (fewer than 3 vertices if the points are all equal or collinear)
+**/
+template<class T>
+Polygon2D<T> ConvexHull(Span<const Vector2D<T> > points, unsigned int threads = 1)
+{
+    std::vector<Vector2D<T> > hull;
+    detail::ConvexHull(points, points.size(), hull, threads);
+    return detail::MakePolygon(hull);
+}
+
+/**
+* Convex hull of the vertices of a polyline/polygon
+* @param shape - the shape
+* @param threads - number of threads (0 means all hardware threads)
+* @return Polygon2D - the hull (see above)
+**/
+template<class T>
+Polygon2D<T> ConvexHull(const Polyline2D<T>& shape, unsigned int threads = 1)
+{
+    return ConvexHull(Span<const Vector2D<T> >(shape.Vertices()), threads);
+}
+
+/**
+* Convex hull of a point cloud (SoA)
+* @param points - the points
+* @param threads - number of threads (0 means all hardware threads)
+* @return Polygon2D - the hull (see above)
+**/
+template<class T>
+Polygon2D<T> ConvexHull(const PointCloudView2D<T>& points, unsigned int threads = 1)
+{
+    std::vector<Vector2D<T> > hull;
+    detail::ConvexHull(points, points.Size(), hull, threads);
+    return detail::MakePolygon(hull);
+}
+
+/**
+* IncrementalHull2D Class
+* Convex hull of a stream of points, kept up to date after every insertion in amortized O(log h)
+* The upper and lower chains are kept in ordered maps from x to the extreme y; an inserted point is dropped in
+* O(log h) when it is under the upper chain and above the lower one, otherwise the vertices it hides are erased
+* (every vertex is erased at most once)
+**/
+template<class T>
+class IncrementalHull2D
+{
+protected:
+    typedef std::map<T, T> Chain;
+    // upper chain (x -> y) and lower chain stored upside down (x -> -y), so both are handled as upper chains
+    Chain upper;
+    Chain lower;
+
+    static T Orient(T ox, T oy, T ax, T ay, T bx, T by) {return Orient2D(ox, oy, ax, ay, bx, by);}
+
+    /**
+    * Insert a point in an upper chain
+    * @return bool - true if the point is a vertex of the chain
+    **/
+    static bool Insert(Chain& chain, T x, T y)
+    {
+        typename Chain::iterator next = chain.lower_bound(x);
+        if(next!=chain.end() && next->first==x)
+        {
+            if(next->second>=y)
+                return false;
+        }
+        else if(next!=chain.end() && next!=chain.begin())
+        {
+            typename Chain::iterator prev = std::prev(next);
+            if(Orient(prev->first, prev->second, next->first, next->second, x, y)<=0)
+                return false;
+        }
+        typename Chain::iterator it = chain.insert(next, std::make_pair(x, y));
+        it->second = y;
+        // vertices on or under the segments to the point
+        while(it!=chain.begin())
+        {
+            typename Chain::iterator prev = std::prev(it);
+            if(prev==chain.begin() || Orient(std::prev(prev)->first, std::prev(prev)->second, prev->first, prev->second, x, y)<0)
+                break;
+            chain.erase(prev);
+        }
+        while(true)
+        {
+            typename Chain::iterator succ = std::next(it);
+            if(succ==chain.end() || std::next(succ)==chain.end() ||
+                Orient(x, y, succ->first, succ->second, std::next(succ)->first, std::next(succ)->second)<0)
+                break;
+            chain.erase(succ);
+        }
+        return true;
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty hull
+    **/
+    IncrementalHull2D(){}
+
+    /**
+    * Add a point
+    * @param point - the point
+    * @return bool - true if the hull changed
+    **/
+    bool Insert(const Vector2D<T>& point)
+    {
+        bool changed = Insert(upper, point.X(), point.Y());
+        return Insert(lower, point.X(), -point.Y()) || changed;
+    }
+
+    /**
+    * Add points
+    * @param points - the points
+    * @return std::size_t - number of points that changed the hull
+    **/
+    std::size_t Insert(Span<const Vector2D<T> > points)
+    {
+        std::size_t changed = 0;
+        for(std::size_t i=0;i<points.size();i++)
+            changed += Insert(points[i]);
+        return changed;
+    }
+
+    void Clear()
+    {
+        upper.clear();
+        lower.clear();
+    }
+
+    bool Empty()const {return upper.empty();}
+
+    /**
+    * Get the hull vertices
+    * @param out - the vertices, counter clockwise from the leftmost (then lowest) point, without collinear vertices (cleared first)
+    **/
+    void Vertices(std::vector<Vector2D<T> >& out)const
+    {
+        out.clear();
+        for(typename Chain::const_iterator it=lower.begin();it!=lower.end();++it)
+            out.push_back(Vector2D<T>(it->first, -it->second));
+        for(typename Chain::const_reverse_iterator it=upper.rbegin();it!=upper.rend();++it)
+        {
+            Vector2D<T> p(it->first, it->second);
+            if(p!=out.back() && p!=out.front())
+                out.push_back(p);
+        }
+    }
+
+    /**
+    * Get the hull
+    * @return Polygon2D - the hull (see Vertices)
+    **/
+    Polygon2D<T> Hull()const
+    {
+        std::vector<Vector2D<T> > vertices;
+        Vertices(vertices);
+        return detail::MakePolygon(vertices);
+    }
+};
+
+typedef IncrementalHull2D<double> IncrementalHull2d;
+typedef IncrementalHull2D<float> IncrementalHull2;
+
+}
+
+#endif
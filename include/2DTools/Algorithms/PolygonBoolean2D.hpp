@@ -0,0 +1,870 @@
+#ifndef POLYGON_BOOLEAN_2D_HPP
+#define POLYGON_BOOLEAN_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <set>
+#include <utility>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Predicates2D.hpp>
+#include <2DTools/Primitives/RingBuffer2D.hpp>
+
+namespace Tools2D {
+
+/**
+* Boolean operations on polygon sets
+**/
+enum BooleanOperation
+{
+    BooleanUnion,
+    BooleanIntersection,
+    BooleanDifference,
+    BooleanXor
+};
+
+/**
+* Counters of a boolean operation (summed over the sub-operations of a cascaded union)
+* inputEdges - edges of the input rings
+* intersections - crossing and touching points found between the edges
+* sweepEdges - edges after splitting at the intersections (the edges of the sweep)
+* outputRings, outputPoints - size of the result
+* memoryUsage - bytes allocated by the scratch buffers (largest sub-operation)
+* intersectMilliseconds, sweepMilliseconds, linkMilliseconds - time of the three passes
+* totalMilliseconds - wall clock time of the operation
+* closed - false if rounding left edges that could not be closed into rings (in any sub-operation)
+**/
+struct BooleanStats2D
+{
+    std::size_t inputEdges;
+    std::size_t intersections;
+    std::size_t sweepEdges;
+    std::size_t outputRings;
+    std::size_t outputPoints;
+    std::size_t memoryUsage;
+    double intersectMilliseconds;
+    double sweepMilliseconds;
+    double linkMilliseconds;
+    double totalMilliseconds;
+    bool closed;
+
+    BooleanStats2D():inputEdges(0),intersections(0),sweepEdges(0),outputRings(0),outputPoints(0),memoryUsage(0),
+        intersectMilliseconds(0),sweepMilliseconds(0),linkMilliseconds(0),totalMilliseconds(0),closed(true){}
+
+    void Add(const BooleanStats2D& other)
+    {
+        inputEdges += other.inputEdges;
+        intersections += other.intersections;
+        sweepEdges += other.sweepEdges;
+        memoryUsage = std::max(memoryUsage, other.memoryUsage);
+        intersectMilliseconds += other.intersectMilliseconds;
+        sweepMilliseconds += other.sweepMilliseconds;
+        linkMilliseconds += other.linkMilliseconds;
+        closed = closed && other.closed;
+    }
+};
+
+namespace detail {
+
+inline double ElapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+// true if p projects strictly between a and b
+template<class T>
+bool ProjectsInside(const Vector2D<T>& a, const Vector2D<T>& b, const Vector2D<T>& p)
+{
+    Vector2D<T> d = b-a;
+    T t = (p.X()-a.X())*d.X()+(p.Y()-a.Y())*d.Y();
+    return t>0 && t<d.LengthSq();
+}
+
+template<class T>
+void RingBounds(Span<const Vector2D<T> > ring, T* box)
+{
+    for(std::size_t i=0;i<ring.size();i++)
+    {
+        box[0] = std::min(box[0], ring[i].X());
+        box[1] = std::min(box[1], ring[i].Y());
+        box[2] = std::max(box[2], ring[i].X());
+        box[3] = std::max(box[3], ring[i].Y());
+    }
+}
+
+template<class T>
+void BufferBounds(const RingBuffer2D<T>& rings, T* box)
+{
+    box[0] = box[1] = std::numeric_limits<T>::max();
+    box[2] = box[3] = -std::numeric_limits<T>::max();
+    RingBounds(Span<const Vector2D<T> >(rings.Points()), box);
+}
+
+}
+
+/**
+* PolygonBoolean2D Class
+* Union, intersection, difference and xor of two sets of rings (polygons with holes, nonzero rule) with a sweep line
+* 1. The edges are split at their intersections (candidate pairs from a uniform grid over the edges); the pieces are
+*    tested again until nothing crosses, the endpoints within a few ulps of an edge being snapped to it
+* 2. A sweep from left to right keeps the edges crossing the sweep line in order; every edge gets the winding
+*    numbers of both sets just below it from the edge under it, so both of its sides are classified in O(log n)
+*    (overlapping edges are merged and their windings added)
+* 3. The edges between a side in the result and a side out of it are linked into rings, the result on their left
+* The result is written to a flat RingBuffer2D: counter clockwise outer boundaries and clockwise holes, without
+* collinear vertices, touching rings split at the touching vertices
+* The scratch buffers are kept, so one instance can be reused for many operations
+**/
+template<class T>
+class PolygonBoolean2D
+{
+protected:
+    static const std::uint32_t None = 0xffffffffu;
+    // Sweep edge states
+    enum {Swept, Merged, Kept};
+    // Passes of SplitEdges at most (the pieces of split edges are tested again, rounding rarely needs more than three)
+    static const int MaxSplitPasses = 64;
+
+    // edge from the lexicographically smaller endpoint l to r; the windings are added when crossing it upwards
+    struct Edge
+    {
+        Vector2D<T> l, r;
+        int windA, windB;
+    };
+
+    // Order of the edges crossing the sweep line (the edges only meet at their endpoints)
+    struct SweepOrder
+    {
+        const std::vector<Edge>* edges;
+
+        bool operator()(std::uint32_t a, std::uint32_t b)const
+        {
+            if(a==b)
+                return false;
+            const Edge& s = (*edges)[a];
+            const Edge& t = (*edges)[b];
+            T o;
+            if(s.l==t.l)
+                o = Orient(s.l, s.r, t.r);
+            else if(Less(s.l, t.l))
+            {
+                o = Orient(s.l, s.r, t.l);
+                if(o==0)
+                    o = Orient(s.l, s.r, t.r);
+            }
+            else
+            {
+                o = -Orient(t.l, t.r, s.l);
+                if(o==0)
+                    o = -Orient(t.l, t.r, s.r);
+            }
+            return o!=0 ? o>0 : a<b;
+        }
+    };
+    typedef std::set<std::uint32_t, SweepOrder> Status;
+
+    std::vector<Edge> edges;
+    // edges not tested against each other yet (new pieces of split edges)
+    std::vector<std::uint8_t> dirty;
+    std::vector<std::pair<std::uint32_t, Vector2D<T> > > splits;
+    std::vector<Edge> pieces;
+    std::vector<std::uint8_t> dirtyPieces;
+    std::vector<std::uint32_t> cellStarts;
+    std::vector<std::uint32_t> cellEdges;
+    // edges away from the other set (MergeUnion), kept as they are
+    std::vector<Edge> kept;
+    std::vector<Edge> sweepEdges;
+    // part of the sweep edges inside the swept slab (the sweep edges themselves without a slab)
+    std::vector<Edge> clipped;
+    std::vector<std::uint32_t> events;
+    std::vector<int> belowA;
+    std::vector<int> belowB;
+    std::vector<std::uint8_t> states;
+    std::vector<typename Status::iterator> positions;
+    // result edges (vertex indices) and vertices
+    std::vector<Vector2D<T> > vertices;
+    std::vector<std::uint32_t> from;
+    std::vector<std::uint32_t> to;
+    std::vector<std::uint32_t> outStarts;
+    std::vector<std::uint32_t> outEdges;
+    std::vector<std::uint8_t> used;
+    std::vector<Vector2D<T> > ring;
+    BooleanStats2D stats;
+
+    // exact sign: the sweep order and the split tests must agree on every side test
+    static T Orient(const Vector2D<T>& o, const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        return Orient2D(o, a, b);
+    }
+
+    static bool Less(const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        return a.X()<b.X() || (a.X()==b.X() && a.Y()<b.Y());
+    }
+
+    static bool InResult(BooleanOperation op, int a, int b)
+    {
+        switch(op)
+        {
+        case BooleanUnion: return a!=0 || b!=0;
+        case BooleanIntersection: return a!=0 && b!=0;
+        case BooleanDifference: return a!=0 && b==0;
+        default: return (a!=0)!=(b!=0);
+        }
+    }
+
+    /**
+    * Add the edges of a set of rings; the edges outside [lo, hi] in x are kept as they are
+    **/
+    void AddEdges(const RingBuffer2D<T>& rings, bool first, T lo, T hi)
+    {
+        for(std::size_t k=0;k<rings.RingCount();k++)
+        {
+            Span<const Vector2D<T> > v = rings.Ring(k);
+            for(std::size_t i=0;i<v.size();i++)
+            {
+                const Vector2D<T>& p = v[i];
+                const Vector2D<T>& q = v[i+1==v.size() ? 0 : i+1];
+                if(p==q)
+                    continue;
+                // walking a ring counter clockwise, its inside is on the left: above the edge when going right
+                int wind = Less(p, q) ? 1 : -1;
+                Edge e = {wind>0 ? p : q, wind>0 ? q : p, first ? wind : 0, first ? 0 : wind};
+                if(e.r.X()<lo || e.l.X()>hi)
+                    kept.push_back(e);
+                else
+                    edges.push_back(e);
+            }
+        }
+    }
+
+    /**
+    * Add a rounded crossing point to an edge (unless it is one of the endpoints)
+    **/
+    void AddSplit(std::uint32_t e, const Vector2D<T>& p)
+    {
+        if(p!=edges[e].l && p!=edges[e].r)
+            splits.push_back(std::make_pair(e, p));
+    }
+
+    /**
+    * Split an edge at an endpoint of another edge on it or within a few ulps of it
+    * @param o - orientation of the point to the edge (exactly on it if 0)
+    * @param near - largest o*o of a point snapped to the edge
+    * @return bool - true if the point is strictly between the endpoints (lexicographically on the edge, by its
+    * projection beside it) and was added
+    **/
+    bool Snap(std::uint32_t e, const Vector2D<T>& p, T o, T near)
+    {
+        const Edge& edge = edges[e];
+        if(o*o>near || p==edge.l || p==edge.r)
+            return false;
+        if(o==0 ? !Less(edge.l, p) || !Less(p, edge.r) : !detail::ProjectsInside(edge.l, edge.r, p))
+            return false;
+        splits.push_back(std::make_pair(e, p));
+        return true;
+    }
+
+    /**
+    * Find the points where two edges cross or touch
+    **/
+    void Intersect(std::uint32_t i, std::uint32_t j)
+    {
+        if(!dirty[i] && !dirty[j])
+            return;
+        const Edge& a = edges[i];
+        const Edge& b = edges[j];
+        if(a.r.X()<b.l.X() || b.r.X()<a.l.X() ||
+            std::max(a.l.Y(), a.r.Y())<std::min(b.l.Y(), b.r.Y()) || std::max(b.l.Y(), b.r.Y())<std::min(a.l.Y(), a.r.Y()))
+            return;
+        T o1 = Orient(a.l, a.r, b.l), o2 = Orient(a.l, a.r, b.r);
+        T o3 = Orient(b.l, b.r, a.l), o4 = Orient(b.l, b.r, a.r);
+        std::size_t count = splits.size();
+        // an endpoint within a few ulps of the other edge is snapped to it: split points rounded off an edge would
+        // otherwise make new crossings with its neighbours pass after pass
+        T size = std::max(std::max(std::max(std::fabs(a.l.X()), std::fabs(a.l.Y())), std::max(std::fabs(a.r.X()), std::fabs(a.r.Y()))),
+            std::max(std::max(std::fabs(b.l.X()), std::fabs(b.l.Y())), std::max(std::fabs(b.r.X()), std::fabs(b.r.Y()))));
+        T tolerance = 4*std::numeric_limits<T>::epsilon()*size;
+        T square = tolerance*tolerance, lengthA = (a.r-a.l).LengthSq(), lengthB = (b.r-b.l).LengthSq();
+        T nearA = lengthA>256*square ? lengthA*square : 0, nearB = lengthB>256*square ? lengthB*square : 0;
+        bool snapped = Snap(i, b.l, o1, nearA);
+        snapped = Snap(i, b.r, o2, nearA) || snapped;
+        snapped = Snap(j, a.l, o3, nearB) || snapped;
+        snapped = Snap(j, a.r, o4, nearB) || snapped;
+        if(!snapped && ((o1>0 && o2<0) || (o1<0 && o2>0)) && ((o3>0 && o4<0) || (o3<0 && o4>0)))
+        {
+            T t = o3/(o3-o4);
+            // kept in the boxes of both edges: rounding must not put the point beside an axis aligned edge
+            T x = a.l.X()+t*(a.r.X()-a.l.X()), y = a.l.Y()+t*(a.r.Y()-a.l.Y());
+            x = std::min(std::max(x, std::max(a.l.X(), b.l.X())), std::min(a.r.X(), b.r.X()));
+            y = std::min(std::max(y, std::max(std::min(a.l.Y(), a.r.Y()), std::min(b.l.Y(), b.r.Y()))),
+                std::min(std::max(a.l.Y(), a.r.Y()), std::max(b.l.Y(), b.r.Y())));
+            Vector2D<T> p(x, y);
+            AddSplit(i, p);
+            AddSplit(j, p);
+        }
+        stats.intersections += splits.size()>count;
+    }
+
+    /**
+    * Find the split points of the edges (pairs with at least one dirty edge)
+    * The candidate pairs share a cell of a uniform grid over the edge boxes; a pair is tested in the first cell
+    * shared by the cell ranges of both boxes only
+    **/
+    void FindSplits()
+    {
+        std::size_t n = edges.size();
+        splits.clear();
+        if(n<64)
+        {
+            for(std::uint32_t i=0;i<n;i++)
+                for(std::uint32_t j=i+1;j<n;j++)
+                    Intersect(i, j);
+        }
+        else
+        {
+            T minX = edges[0].l.X(), maxX = minX, minY = edges[0].l.Y(), maxY = minY;
+            for(std::size_t i=0;i<n;i++)
+            {
+                minX = std::min(minX, edges[i].l.X());
+                maxX = std::max(maxX, edges[i].r.X());
+                minY = std::min(minY, std::min(edges[i].l.Y(), edges[i].r.Y()));
+                maxY = std::max(maxY, std::max(edges[i].l.Y(), edges[i].r.Y()));
+            }
+            T width = std::max(maxX-minX, T(1e-30)), height = std::max(maxY-minY, T(1e-30));
+            std::size_t columns = std::max<std::size_t>(1, std::min<std::size_t>(4096, std::size_t(std::sqrt(double(n)*width/height))));
+            std::size_t rows = std::max<std::size_t>(1, std::min<std::size_t>(4096, n/columns));
+            T sx = T(columns)/width, sy = T(rows)/height;
+            auto range = [&](const Edge& e, std::size_t* r) {
+                r[0] = std::min(columns-1, std::size_t((e.l.X()-minX)*sx));
+                r[1] = std::min(columns-1, std::size_t((e.r.X()-minX)*sx));
+                r[2] = std::min(rows-1, std::size_t((std::min(e.l.Y(), e.r.Y())-minY)*sy));
+                r[3] = std::min(rows-1, std::size_t((std::max(e.l.Y(), e.r.Y())-minY)*sy));
+            };
+            cellStarts.assign(columns*rows+1, 0);
+            std::size_t r[4], s[4];
+            for(std::size_t i=0;i<n;i++)
+            {
+                range(edges[i], r);
+                for(std::size_t y=r[2];y<=r[3];y++)
+                    for(std::size_t x=r[0];x<=r[1];x++)
+                        cellStarts[y*columns+x+1]++;
+            }
+            for(std::size_t c=0;c<columns*rows;c++)
+                cellStarts[c+1] += cellStarts[c];
+            cellEdges.resize(cellStarts.back());
+            std::vector<std::uint32_t> fill(cellStarts.begin(), cellStarts.end()-1);
+            for(std::size_t i=0;i<n;i++)
+            {
+                range(edges[i], r);
+                for(std::size_t y=r[2];y<=r[3];y++)
+                    for(std::size_t x=r[0];x<=r[1];x++)
+                        cellEdges[fill[y*columns+x]++] = std::uint32_t(i);
+            }
+            for(std::size_t c=0;c<columns*rows;c++)
+                for(std::uint32_t a=cellStarts[c];a<cellStarts[c+1];a++)
+                    for(std::uint32_t b=a+1;b<cellStarts[c+1];b++)
+                    {
+                        range(edges[cellEdges[a]], r);
+                        range(edges[cellEdges[b]], s);
+                        if(std::max(r[2], s[2])*columns+std::max(r[0], s[0])==c)
+                            Intersect(cellEdges[a], cellEdges[b]);
+                    }
+        }
+    }
+
+    void AddPiece(const Edge& edge, const Vector2D<T>& p, const Vector2D<T>& q, bool split)
+    {
+        if(p==q)
+            return;
+        Edge piece = edge;
+        // a rounded split point can be behind the previous one in x: the piece is reversed
+        if(Less(q, p))
+        {
+            piece.l = q;
+            piece.r = p;
+            piece.windA = -edge.windA;
+            piece.windB = -edge.windB;
+        }
+        else
+        {
+            piece.l = p;
+            piece.r = q;
+        }
+        pieces.push_back(piece);
+        dirtyPieces.push_back(split);
+    }
+
+    /**
+    * Cut the edges at their split points, in order along the edges; the pieces of the split edges are dirty
+    **/
+    void CutEdges()
+    {
+        const std::vector<Edge>& e = edges;
+        std::sort(splits.begin(), splits.end(), [&e](const std::pair<std::uint32_t, Vector2D<T> >& a, const std::pair<std::uint32_t, Vector2D<T> >& b) {
+            if(a.first!=b.first)
+                return a.first<b.first;
+            const Edge& edge = e[a.first];
+            T dx = edge.r.X()-edge.l.X(), dy = edge.r.Y()-edge.l.Y();
+            T ta = (a.second.X()-edge.l.X())*dx+(a.second.Y()-edge.l.Y())*dy, tb = (b.second.X()-edge.l.X())*dx+(b.second.Y()-edge.l.Y())*dy;
+            // the points projected at the same place are kept together, so their duplicates are removed
+            return ta<tb || (ta==tb && Less(a.second, b.second));
+        });
+        splits.erase(std::unique(splits.begin(), splits.end()), splits.end());
+        pieces.clear();
+        dirtyPieces.clear();
+        std::size_t k = 0;
+        for(std::uint32_t i=0;i<edges.size();i++)
+        {
+            Vector2D<T> start = edges[i].l;
+            bool split = k<splits.size() && splits[k].first==i;
+            for(;k<splits.size() && splits[k].first==i;k++)
+            {
+                AddPiece(edges[i], start, splits[k].second, true);
+                start = splits[k].second;
+            }
+            AddPiece(edges[i], start, edges[i].r, split);
+        }
+        edges.swap(pieces);
+        dirty.swap(dirtyPieces);
+    }
+
+    /**
+    * Split the edges at their intersections
+    * A crossing point is rounded, so the pieces of a split edge may cross other edges still: they are tested again
+    * until nothing is split
+    **/
+    void SplitEdges()
+    {
+        dirty.assign(edges.size(), 1);
+        for(int pass=0;pass<MaxSplitPasses;pass++)
+        {
+            FindSplits();
+            if(splits.empty())
+                break;
+            CutEdges();
+        }
+        sweepEdges = edges;
+    }
+
+    /**
+    * Clip the sweep edges to the slab [lo, hi] in x; the edges only touching it are kept as they are
+    **/
+    void Clip(T lo, T hi)
+    {
+        std::size_t m = sweepEdges.size();
+        clipped = sweepEdges;
+        states.assign(m, Swept);
+        for(std::size_t i=0;i<m;i++)
+        {
+            Edge& c = clipped[i];
+            const Edge& e = sweepEdges[i];
+            if(e.l.X()<lo)
+                c.l = Vector2D<T>(lo, e.l.Y()+(lo-e.l.X())*(e.r.Y()-e.l.Y())/(e.r.X()-e.l.X()));
+            if(e.r.X()>hi)
+                c.r = Vector2D<T>(hi, e.l.Y()+(hi-e.l.X())*(e.r.Y()-e.l.Y())/(e.r.X()-e.l.X()));
+            if(!Less(c.l, c.r))
+                states[i] = Kept;
+        }
+    }
+
+    /**
+    * Sweep the edges from left to right and compute the windings below every edge
+    **/
+    void Sweep()
+    {
+        std::size_t m = sweepEdges.size();
+        events.clear();
+        for(std::size_t i=0;i<m;i++)
+            if(states[i]==Swept)
+            {
+                events.push_back(std::uint32_t(2*i));
+                events.push_back(std::uint32_t(2*i+1));
+            }
+        // at the same point: the edges ending there first, then the edges starting there from bottom to top
+        std::vector<Edge>& e = clipped;
+        std::sort(events.begin(), events.end(), [&e](std::uint32_t a, std::uint32_t b) {
+            const Vector2D<T>& pa = (a&1) ? e[a>>1].r : e[a>>1].l;
+            const Vector2D<T>& pb = (b&1) ? e[b>>1].r : e[b>>1].l;
+            if(pa!=pb)
+                return Less(pa, pb);
+            if((a&1)!=(b&1))
+                return (a&1)!=0;
+            if(!(a&1))
+            {
+                T o = Orient(pa, e[a>>1].r, e[b>>1].r);
+                if(o!=0)
+                    return o>0;
+            }
+            return a<b;
+        });
+        SweepOrder order = {&clipped};
+        Status status(order);
+        belowA.assign(m, 0);
+        belowB.assign(m, 0);
+        positions.resize(m);
+        for(std::size_t k=0;k<events.size();k++)
+        {
+            std::uint32_t id = events[k]>>1;
+            if(events[k]&1)
+            {
+                if(states[id]==Swept)
+                    status.erase(positions[id]);
+                continue;
+            }
+            typename Status::iterator it = status.insert(id).first;
+            if(it!=status.begin())
+            {
+                std::uint32_t below = *std::prev(it);
+                Edge& b = e[below];
+                if(sweepEdges[below].l==sweepEdges[id].l && sweepEdges[below].r==sweepEdges[id].r)
+                {
+                    // overlapping edges: one edge with both windings
+                    b.windA += e[id].windA;
+                    b.windB += e[id].windB;
+                    states[id] = Merged;
+                    status.erase(it);
+                    continue;
+                }
+                belowA[id] = belowA[below]+b.windA;
+                belowB[id] = belowB[below]+b.windB;
+            }
+            positions[id] = it;
+        }
+    }
+
+    /**
+    * Link the edges of the result into rings
+    * @return bool - false if some edges could not be closed into rings
+    **/
+    bool Link(BooleanOperation op, RingBuffer2D<T>& out)
+    {
+        std::size_t m = sweepEdges.size();
+        vertices.clear();
+        for(std::size_t i=0;i<m;i++)
+        {
+            if(states[i]==Merged)
+                continue;
+            const Edge& e = sweepEdges[i];
+            const Edge& c = clipped[i];
+            bool below = InResult(op, belowA[i], belowB[i]);
+            bool above = InResult(op, belowA[i]+c.windA, belowB[i]+c.windB);
+            if(states[i]==Kept)
+            {
+                // edge of a union away from the other union: its set is on its left
+                below = c.windA+c.windB<0;
+                above = !below;
+            }
+            if(below==above)
+                continue;
+            // the result is left of the ring edges: going right when the result is above the edge
+            vertices.push_back(above ? e.l : e.r);
+            vertices.push_back(above ? e.r : e.l);
+        }
+        std::size_t count = vertices.size()/2;
+        // endpoints of the edges in order, then the vertices sorted without duplicates
+        ring.assign(vertices.begin(), vertices.end());
+        std::sort(vertices.begin(), vertices.end(), Less);
+        vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+        from.resize(count);
+        to.resize(count);
+        for(std::size_t k=0;k<count;k++)
+        {
+            from[k] = std::uint32_t(std::lower_bound(vertices.begin(), vertices.end(), ring[2*k], Less)-vertices.begin());
+            to[k] = std::uint32_t(std::lower_bound(vertices.begin(), vertices.end(), ring[2*k+1], Less)-vertices.begin());
+        }
+        outStarts.assign(vertices.size()+1, 0);
+        for(std::size_t k=0;k<count;k++)
+            outStarts[from[k]+1]++;
+        for(std::size_t v=0;v<vertices.size();v++)
+            outStarts[v+1] += outStarts[v];
+        outEdges.resize(count);
+        std::vector<std::uint32_t> fill(outStarts.begin(), outStarts.end()-1);
+        for(std::size_t k=0;k<count;k++)
+            outEdges[fill[from[k]]++] = std::uint32_t(k);
+        used.assign(count, 0);
+        bool closed = true;
+        for(std::uint32_t start=0;start<count;start++)
+        {
+            if(used[start])
+                continue;
+            ring.clear();
+            std::uint32_t e = start;
+            while(true)
+            {
+                used[e] = 1;
+                ring.push_back(vertices[from[e]]);
+                std::uint32_t next = NextEdge(e);
+                if(next==None || used[next])
+                {
+                    closed = closed && next==start;
+                    break;
+                }
+                e = next;
+            }
+            RemoveCollinear();
+            if(ring.size()>=3)
+            {
+                for(std::size_t i=0;i<ring.size();i++)
+                    out.AddPoint(ring[i]);
+                out.CloseRing();
+            }
+        }
+        return closed;
+    }
+
+    /**
+    * Next edge of a ring: at the end of edge e, the first edge clockwise from e reversed (rings split at the
+    * vertices where they touch)
+    **/
+    std::uint32_t NextEdge(std::uint32_t e)const
+    {
+        std::uint32_t v = to[e];
+        std::uint32_t best = None;
+        if(outStarts[v+1]-outStarts[v]==1)
+            return outEdges[outStarts[v]];
+        const Vector2D<T>& p = vertices[v];
+        const Vector2D<T>& back = vertices[from[e]];
+        Vector2D<T> d = back-p;
+        int bestClass = 4;
+        std::uint32_t bestTo = None;
+        for(std::uint32_t k=outStarts[v];k<outStarts[v+1];k++)
+        {
+            std::uint32_t c = outEdges[k];
+            const Vector2D<T>& q = vertices[to[c]];
+            T cross = Orient(p, back, q);
+            Vector2D<T> direction = q-p;
+            T dot = d.X()*direction.X()+d.Y()*direction.Y();
+            int cls = cross<0 ? 0 : cross>0 ? 2 : dot<0 ? 1 : 3;
+            if(cls<bestClass || (cls==bestClass && (cls==0 || cls==2) && Orient(p, vertices[bestTo], q)>0))
+            {
+                best = c;
+                bestClass = cls;
+                bestTo = to[c];
+            }
+        }
+        return best;
+    }
+
+    /**
+    * Remove the collinear vertices of the current ring (left by the splits of overlapping edges)
+    **/
+    void RemoveCollinear()
+    {
+        std::size_t m = 0;
+        for(std::size_t i=0;i<ring.size();i++)
+        {
+            Vector2D<T> p = ring[i];
+            while(m>=2 && Orient(ring[m-2], ring[m-1], p)==0)
+                m--;
+            ring[m++] = p;
+        }
+        while(m>=3 && Orient(ring[m-2], ring[m-1], ring[0])==0)
+            m--;
+        std::size_t s = 0;
+        while(m-s>=3 && Orient(ring[m-1], ring[s], ring[s+1])==0)
+            s++;
+        ring.erase(ring.begin()+m, ring.end());
+        ring.erase(ring.begin(), ring.begin()+s);
+    }
+    bool Run(const RingBuffer2D<T>& a, const RingBuffer2D<T>& b, BooleanOperation op, RingBuffer2D<T>& out, bool slab)
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        stats = BooleanStats2D();
+        out.Clear();
+        edges.clear();
+        kept.clear();
+        T lo = -std::numeric_limits<T>::max(), hi = std::numeric_limits<T>::max();
+        if(slab && !a.Empty() && !b.Empty())
+        {
+            // shared range of x, widened so that the edges left out do not touch the other set
+            T boxA[4], boxB[4];
+            detail::BufferBounds(a, boxA);
+            detail::BufferBounds(b, boxB);
+            T margin = (std::max(boxA[2], boxB[2])-std::min(boxA[0], boxB[0]))/1024;
+            lo = std::max(boxA[0], boxB[0])-margin;
+            hi = std::min(boxA[2], boxB[2])+margin;
+        }
+        AddEdges(a, true, lo, hi);
+        AddEdges(b, false, lo, hi);
+        stats.inputEdges = edges.size()+kept.size();
+        SplitEdges();
+        Clip(lo, hi);
+        sweepEdges.insert(sweepEdges.end(), kept.begin(), kept.end());
+        clipped.insert(clipped.end(), kept.begin(), kept.end());
+        states.resize(sweepEdges.size(), Kept);
+        stats.sweepEdges = sweepEdges.size()-kept.size();
+        stats.intersectMilliseconds = detail::ElapsedMilliseconds(start);
+        std::chrono::steady_clock::time_point sweep = std::chrono::steady_clock::now();
+        Sweep();
+        stats.sweepMilliseconds = detail::ElapsedMilliseconds(sweep);
+        std::chrono::steady_clock::time_point link = std::chrono::steady_clock::now();
+        stats.closed = Link(op, out);
+        stats.linkMilliseconds = detail::ElapsedMilliseconds(link);
+        stats.outputRings = out.RingCount();
+        stats.outputPoints = out.PointCount();
+        // the status tree holds at most one node per sweep edge (about 4 pointers and the key each)
+        stats.memoryUsage = MemoryUsage()+stats.sweepEdges*(4*sizeof(void*)+sizeof(std::uint32_t));
+        stats.totalMilliseconds = detail::ElapsedMilliseconds(start);
+        return stats.closed;
+    }
+public:
+    /**
+    * Default Constructor
+    **/
+    PolygonBoolean2D(){}
+
+    /**
+    * Compute a boolean operation
+    * @param a - first set of rings (counter clockwise outer boundaries, clockwise holes, may overlap: nonzero rule)
+    * @param b - second set of rings
+    * @param op - the operation (a-b for BooleanDifference)
+    * @param out - the result (cleared first)
+    * @return bool - false if rounding left edges that could not be closed into rings (the closed rings are kept)
+    **/
+    bool Compute(const RingBuffer2D<T>& a, const RingBuffer2D<T>& b, BooleanOperation op, RingBuffer2D<T>& out)
+    {
+        return Run(a, b, op, out, false);
+    }
+
+    /**
+    * Union of two results of Compute or MergeUnion (non overlapping rings in each set)
+    * Only the edges in the range of x shared by both sets are swept, the others are kept as they are: merging two
+    * unions side by side only costs the edges near their common range
+    * @param a - first union
+    * @param b - second union
+    * @param out - the union (cleared first)
+    * @return bool - false if rounding left edges that could not be closed into rings (the closed rings are kept)
+    **/
+    bool MergeUnion(const RingBuffer2D<T>& a, const RingBuffer2D<T>& b, RingBuffer2D<T>& out)
+    {
+        return Run(a, b, BooleanUnion, out, true);
+    }
+    /**
+    * Get the counters of the last operation
+    * @return BooleanStats2D - the counters
+    **/
+    const BooleanStats2D& Stats()const {return stats;}
+
+    /**
+    * Get the memory used by the scratch buffers
+    * @return std::size_t - bytes allocated (capacity of the arrays)
+    **/
+    std::size_t MemoryUsage()const
+    {
+        return sizeof(*this)+(edges.capacity()+kept.capacity()+sweepEdges.capacity()+clipped.capacity())*sizeof(Edge)+
+            splits.capacity()*sizeof(std::pair<std::uint32_t, Vector2D<T> >)+
+            (cellStarts.capacity()+cellEdges.capacity()+events.capacity()+from.capacity()+to.capacity()+outStarts.capacity()+
+            outEdges.capacity())*sizeof(std::uint32_t)+(belowA.capacity()+belowB.capacity())*sizeof(int)+states.capacity()+
+            used.capacity()+positions.capacity()*sizeof(typename Status::iterator)+(vertices.capacity()+ring.capacity())*sizeof(Vector2D<T>);
+    }
+};
+
+template<class T>
+const std::uint32_t PolygonBoolean2D<T>::None;
+
+/**
+* Compute a boolean operation
+* @param a - first set of rings (counter clockwise outer boundaries, clockwise holes)
+* @param b - second set of rings
+* @param op - the operation (a-b for BooleanDifference)
+* @param out - the result (cleared first)
+* @return BooleanStats2D - the counters of the operation (closed tells if the result is complete)
+**/
+template<class T>
+BooleanStats2D BooleanOp(const RingBuffer2D<T>& a, const RingBuffer2D<T>& b, BooleanOperation op, RingBuffer2D<T>& out)
+{
+    PolygonBoolean2D<T> engine;
+    engine.Compute(a, b, op, out);
+    return engine.Stats();
+}
+
+namespace detail {
+
+template<class Shape, class T>
+void CascadedUnion(Span<const Shape> polygons, const std::uint32_t* order, std::size_t count, std::size_t leaf, RingBuffer2D<T>& out,
+    unsigned int threads, BooleanStats2D& stats)
+{
+    // strips of polygons are merged in one sweep each, then the strips are merged two by two (side by side in x)
+    if(count<=leaf)
+    {
+        RingBuffer2D<T> group;
+        for(std::size_t i=0;i<count;i++)
+            group.AddRing(Span<const Vector2D<T> >(polygons[order[i]].Vertices()));
+        PolygonBoolean2D<T> engine;
+        engine.Compute(group, RingBuffer2D<T>(), BooleanUnion, out);
+        stats.Add(engine.Stats());
+        return;
+    }
+    std::size_t half = count/2;
+    RingBuffer2D<T> left, right;
+    BooleanStats2D leftStats, rightStats;
+    ParallelInvoke(threads>1, [&]() {
+        CascadedUnion(polygons, order, half, leaf, left, std::max(1u, threads/2), leftStats);
+    }, [&]() {
+        CascadedUnion(polygons, order+half, count-half, leaf, right, threads-threads/2, rightStats);
+    });
+    PolygonBoolean2D<T> engine;
+    engine.MergeUnion(left, right, out);
+    stats.Add(leftStats);
+    stats.Add(rightStats);
+    stats.Add(engine.Stats());
+}
+
+}
+
+/**
+* Union of many polygons (cascaded: the polygons are sorted in x and cut into one strip per thread, the strips are
+* merged in parallel with one sweep each, then the partial unions two by two, each merge only sweeping the edges where
+* the two unions meet, see MergeUnion; with one thread this is a single sweep over all the polygons)
+* @param polygons - the polygons (any class with Vertices(), either orientation, may overlap)
+* @param out - the union (cleared first)
+* @param threads - number of threads (0 means all hardware threads)
+* @param minStrip - polygons per strip at least (below a few thousand the merges cost more than the parallel sweeps save)
+* @return BooleanStats2D - the counters summed over all the merges (wall clock total time, closed if every merge is)
+**/
+template<class Shape, class T>
+BooleanStats2D CascadedUnion(Span<const Shape> polygons, RingBuffer2D<T>& out, unsigned int threads = 0, std::size_t minStrip = 4096)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    BooleanStats2D stats;
+    out.Clear();
+    // polygons sorted by the center of their bounds in x: the two halves of every merge are side by side
+    std::size_t n = polygons.size();
+    std::vector<std::pair<T, std::uint32_t> > centers(n);
+    for(std::size_t i=0;i<n;i++)
+    {
+        T box[4] = {std::numeric_limits<T>::max(), std::numeric_limits<T>::max(), -std::numeric_limits<T>::max(), -std::numeric_limits<T>::max()};
+        detail::RingBounds(Span<const Vector2D<T> >(polygons[i].Vertices()), box);
+        centers[i] = std::make_pair(box[0]+box[2], std::uint32_t(i));
+    }
+    std::sort(centers.begin(), centers.end());
+    std::vector<std::uint32_t> order(n);
+    for(std::size_t i=0;i<n;i++)
+        order[i] = centers[i].second;
+    unsigned int count = ResolveThreads(threads);
+    std::size_t leaf = std::max<std::size_t>(std::max<std::size_t>(1, minStrip), (n+count-1)/count);
+    if(n>0)
+        detail::CascadedUnion(polygons, order.data(), n, leaf, out, count, stats);
+    stats.outputRings = out.RingCount();
+    stats.outputPoints = out.PointCount();
+    stats.totalMilliseconds = detail::ElapsedMilliseconds(start);
+    return stats;
+}
+
+typedef PolygonBoolean2D<double> PolygonBoolean2d;
+typedef PolygonBoolean2D<float> PolygonBoolean2;
+
+}
+
+#endif
@@ -0,0 +1,364 @@
+#ifndef ROTATING_CALIPERS_2D_HPP
+#define ROTATING_CALIPERS_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Predicates2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* Result of the rotating calipers measures
+* distance - the measured length (diameter, width or distance)
+* first, second - the two points realizing it
+**/
+template<class T>
+struct CaliperPair2D
+{
+    T distance;
+    Vector2D<T> first;
+    Vector2D<T> second;
+};
+
+namespace detail {
+
+/**
+* Counter clockwise view of the vertices of a convex polygon
+* Clockwise input is walked backwards and a repeated closing vertex is dropped
+**/
+template<class T>
+class ConvexRing
+{
+protected:
+    Span<const Vector2D<T> > v;
+    std::size_t n;
+    bool reversed;
+public:
+    explicit ConvexRing(Span<const Vector2D<T> > vertices):v(vertices),n(vertices.size()),reversed(false)
+    {
+        if(n>1 && v[0]==v[n-1])
+            n--;
+        T area = 0;
+        for(std::size_t i=0;i<n;i++)
+            area += Cross(v[i], v[i+1==n ? 0 : i+1]);
+        reversed = area<0;
+    }
+
+    std::size_t Size()const {return n;}
+    std::size_t Next(std::size_t i)const {return i+1==n ? 0 : i+1;}
+    const Vector2D<T>& operator[](std::size_t i)const {return reversed ? v[n-1-i] : v[i];}
+
+    static T Cross(const Vector2D<T>& a, const Vector2D<T>& b) {return a.X()*b.Y()-a.Y()*b.X();}
+};
+
+/**
+* Check if p is in the bounding box of the segment (a, b)
+**/
+template<class T>
+inline bool InSegmentBox(const Vector2D<T>& a, const Vector2D<T>& b, const Vector2D<T>& p)
+{
+    return std::min(a.X(), b.X())<=p.X() && p.X()<=std::max(a.X(), b.X()) &&
+        std::min(a.Y(), b.Y())<=p.Y() && p.Y()<=std::max(a.Y(), b.Y());
+}
+
+/**
+* Exact test of the segments (a0, a1) and (b0, b1) touching (either may be a point)
+**/
+template<class T>
+inline bool SegmentsTouch(const Vector2D<T>& a0, const Vector2D<T>& a1, const Vector2D<T>& b0, const Vector2D<T>& b1)
+{
+    T o1 = Orient2D(a0, a1, b0), o2 = Orient2D(a0, a1, b1);
+    T o3 = Orient2D(b0, b1, a0), o4 = Orient2D(b0, b1, a1);
+    if(((o1>0 && o2<0) || (o1<0 && o2>0)) && ((o3>0 && o4<0) || (o3<0 && o4>0)))
+        return true;
+    return (o1==0 && InSegmentBox(a0, a1, b0)) || (o2==0 && InSegmentBox(a0, a1, b1)) ||
+        (o3==0 && InSegmentBox(b0, b1, a0)) || (o4==0 && InSegmentBox(b0, b1, a1));
+}
+
+}
+
+/**
+* Diameter of a convex polygon (farthest pair of vertices) with rotating calipers, O(n)
+* @param polygon - vertices of the convex polygon (either orientation, not empty)
+* @return CaliperPair2D - the diameter and its two vertices
+**/
+template<class T>
+CaliperPair2D<T> ConvexDiameter(Span<const Vector2D<T> > polygon)
+{
+    detail::ConvexRing<T> p(polygon);
+    std::size_t n = p.Size();
+    CaliperPair2D<T> best = {0, p[0], p[0]};
+    T bestSq = 0;
+    std::size_t j = 1%n;
+    for(std::size_t i=0;i<n;i++)
+    {
+        std::size_t ni = p.Next(i);
+        Vector2D<T> e = p[ni]-p[i];
+        // advance the antipodal vertex while it gets further from the edge
+        while(detail::ConvexRing<T>::Cross(e, p[p.Next(j)]-p[j])>0)
+            j = p.Next(j);
+        // parallel edges: both ends of the opposite edge are antipodal
+        std::size_t candidates[2] = {j, detail::ConvexRing<T>::Cross(e, p[p.Next(j)]-p[j])==0 ? p.Next(j) : j};
+        for(int k=0;k<2;k++)
+        {
+            const Vector2D<T>& q = p[candidates[k]];
+            T di = p[i].DistanceSq(q), dni = p[ni].DistanceSq(q);
+            if(di>bestSq)
+            {
+                bestSq = di;
+                best.first = p[i];
+                best.second = q;
+            }
+            if(dni>bestSq)
+            {
+                bestSq = dni;
+                best.first = p[ni];
+                best.second = q;
+            }
+        }
+    }
+    best.distance = std::sqrt(bestSq);
+    return best;
+}
+
+template<class T>
+CaliperPair2D<T> ConvexDiameter(const Polygon2D<T>& polygon)
+{
+    return ConvexDiameter(Span<const Vector2D<T> >(polygon.Vertices()));
+}
+
+/**
+* Width of a convex polygon (smallest distance between two parallel supporting lines) with rotating calipers, O(n)
+* @param polygon - vertices of the convex polygon (either orientation, not empty)
+* @return CaliperPair2D - the width, the foot of the perpendicular on the supporting edge and the opposite vertex
+**/
+template<class T>
+CaliperPair2D<T> ConvexWidth(Span<const Vector2D<T> > polygon)
+{
+    detail::ConvexRing<T> p(polygon);
+    std::size_t n = p.Size();
+    CaliperPair2D<T> best = {0, p[0], p[0]};
+    bool found = false;
+    std::size_t j = 1%n;
+    for(std::size_t i=0;i<n;i++)
+    {
+        Vector2D<T> e = p[p.Next(i)]-p[i];
+        T lengthSq = e.LengthSq();
+        if(!(lengthSq>0))
+            continue;
+        while(detail::ConvexRing<T>::Cross(e, p[p.Next(j)]-p[j])>0)
+            j = p.Next(j);
+        T height = detail::ConvexRing<T>::Cross(e, p[j]-p[i])/std::sqrt(lengthSq);
+        if(!found || height<best.distance)
+        {
+            found = true;
+            best.distance = height;
+            best.second = p[j];
+            best.first = p[j]-height/std::sqrt(lengthSq)*e.Perp();
+        }
+    }
+    return best;
+}
+
+template<class T>
+CaliperPair2D<T> ConvexWidth(const Polygon2D<T>& polygon)
+{
+    return ConvexWidth(Span<const Vector2D<T> >(polygon.Vertices()));
+}
+
+/**
+* Minimum area bounding rectangle of a convex polygon with rotating calipers, O(n)
+* One side of the optimal rectangle lies on an edge of the polygon (Freeman-Shapira), so every edge is tried
+* with the three other calipers (furthest along the edge, furthest from it, furthest against it) following it
+* @param polygon - vertices of the convex polygon (either orientation, not empty)
+* @return Rectangle2D - the rectangle (counter clockwise, lower-left corner on the supporting line of the edge)
+**/
+template<class T>
+Rectangle2D<T> MinAreaRectangle(Span<const Vector2D<T> > polygon)
+{
+    typedef detail::ConvexRing<T> Ring;
+    Ring p(polygon);
+    std::size_t n = p.Size();
+    T bestArea = std::numeric_limits<T>::max();
+    Vector2D<T> corner = p[0], side0, side1;
+    std::size_t right = 0, top = 0, left = 0;
+    bool first = true;
+    for(std::size_t i=0;i<n;i++)
+    {
+        Vector2D<T> u = p[p.Next(i)]-p[i];
+        T length = u.Length();
+        if(!(length>0))
+            continue;
+        u *= 1/length;
+        if(first)
+            right = i;
+        while(u*(p[p.Next(right)]-p[right])>0)
+            right = p.Next(right);
+        if(first)
+            top = right;
+        while(Ring::Cross(u, p[p.Next(top)]-p[top])>0)
+            top = p.Next(top);
+        if(first)
+            left = top;
+        while(u*(p[p.Next(left)]-p[left])<0)
+            left = p.Next(left);
+        first = false;
+        T sMin = u*(p[left]-p[i]), sMax = u*(p[right]-p[i]);
+        T height = Ring::Cross(u, p[top]-p[i]);
+        T area = (sMax-sMin)*height;
+        if(area<bestArea)
+        {
+            bestArea = area;
+            corner = p[i]+sMin*u;
+            side0 = (sMax-sMin)*u;
+            side1 = height*u.Perp();
+        }
+    }
+    return Rectangle2D<T>(corner, side0, side1);
+}
+
+template<class T>
+Rectangle2D<T> MinAreaRectangle(const Polygon2D<T>& polygon)
+{
+    return MinAreaRectangle(Span<const Vector2D<T> >(polygon.Vertices()));
+}
+
+/**
+* Distance between two convex polygons, O(n+m)
+* The edges of A and -B are merged by angle (the calipers rotate around both polygons at once), which walks the
+* boundary of the Minkowski difference A-B; the distance is the distance from the origin to that boundary
+* @param a - vertices of the first convex polygon (either orientation, not empty)
+* @param b - vertices of the second convex polygon (either orientation, not empty)
+* @return CaliperPair2D - the distance and the closest points on a and b (distance 0 if they intersect,
+*         the points are then only points of the two boundaries; use EPAPenetration for the overlap)
+* Inputs of one or two vertices are points and segments: when both are, the overlap is an exact segment test
+**/
+template<class T>
+CaliperPair2D<T> ConvexDistance(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b)
+{
+    typedef detail::ConvexRing<T> Ring;
+    Ring p(a), q(b);
+    std::size_t n = p.Size(), m = q.Size();
+    // lowest vertex of a and highest vertex of b (lowest of -b): start of the merge
+    std::size_t i = 0, j = 0;
+    for(std::size_t k=1;k<n;k++)
+        if(p[k].Y()<p[i].Y() || (p[k].Y()==p[i].Y() && p[k].X()<p[i].X()))
+            i = k;
+    for(std::size_t k=1;k<m;k++)
+        if(q[k].Y()>q[j].Y() || (q[k].Y()==q[j].Y() && q[k].X()>q[j].X()))
+            j = k;
+    CaliperPair2D<T> best = {0, p[i], q[j]};
+    T bestSq = p[i].DistanceSq(q[j]);
+    bool inside = n>2 || m>2;
+    std::size_t stepsA = 0, stepsB = 0;
+    while(stepsA<n || stepsB<m)
+    {
+        Vector2D<T> eA = p[p.Next(i)]-p[i];
+        Vector2D<T> eB = q[j]-q[q.Next(j)];
+        T turn = Ring::Cross(eA, eB);
+        bool stepA = stepsB==m || (stepsA<n && turn>=0);
+        Vector2D<T> start = p[i]-q[j];
+        Vector2D<T> edge = stepA ? eA : eB;
+        // the origin must be on the left of every edge of the counter clockwise difference to be inside
+        if(Ring::Cross(edge, start.Reverse())<0)
+            inside = false;
+        T lengthSq = edge.LengthSq();
+        T t = lengthSq>0 ? -(start*edge)/lengthSq : T(0);
+        t = t<0 ? T(0) : (t>1 ? T(1) : t);
+        T dSq = (start+t*edge).LengthSq();
+        if(dSq<bestSq)
+        {
+            bestSq = dSq;
+            best.first = stepA ? p[i]+t*eA : p[i];
+            best.second = stepA ? q[j] : q[j]-t*eB;
+        }
+        if(stepA)
+        {
+            i = p.Next(i);
+            stepsA++;
+        }
+        else
+        {
+            j = q.Next(j);
+            stepsB++;
+        }
+    }
+    // points and segments have no interior to enclose the origin: they overlap if they touch
+    if(n<=2 && m<=2)
+        inside = detail::SegmentsTouch(p[0], p[n-1], q[0], q[m-1]);
+    best.distance = inside ? T(0) : std::sqrt(bestSq);
+    return best;
+}
+
+template<class T>
+CaliperPair2D<T> ConvexDistance(const Polygon2D<T>& a, const Polygon2D<T>& b)
+{
+    return ConvexDistance(Span<const Vector2D<T> >(a.Vertices()), Span<const Vector2D<T> >(b.Vertices()));
+}
+
+/**
+* Diameters of many convex polygons in parallel
+* @param polygons - the polygons (Polygon2D or subclasses)
+* @param out - output array (one value per polygon)
+* @param threads - number of threads (0 means all hardware threads)
+**/
+template<class Shape, class T>
+void ConvexDiameters(Span<const Shape> polygons, T* out, unsigned int threads = 0)
+{
+    ParallelFor(0, polygons.size(), [&](std::size_t i) { out[i] = ConvexDiameter(polygons[i]).distance; }, threads, 64);
+}
+
+/**
+* Widths of many convex polygons in parallel
+* @param polygons - the polygons (Polygon2D or subclasses)
+* @param out - output array (one value per polygon)
+* @param threads - number of threads (0 means all hardware threads)
+**/
+template<class Shape, class T>
+void ConvexWidths(Span<const Shape> polygons, T* out, unsigned int threads = 0)
+{
+    ParallelFor(0, polygons.size(), [&](std::size_t i) { out[i] = ConvexWidth(polygons[i]).distance; }, threads, 64);
+}
+
+/**
+* Minimum area bounding rectangles of many convex polygons in parallel
+* @param polygons - the polygons (Polygon2D or subclasses)
+* @param out - the rectangles (resized to the number of polygons)
+* @param threads - number of threads (0 means all hardware threads)
+**/
+template<class Shape, class T>
+void MinAreaRectangles(Span<const Shape> polygons, std::vector<Rectangle2D<T> >& out, unsigned int threads = 0)
+{
+    out.assign(polygons.size(), Rectangle2D<T>(Vector2D<T>(), T(0), T(0)));
+    ParallelFor(0, polygons.size(), [&](std::size_t i) { out[i] = MinAreaRectangle(polygons[i]); }, threads, 64);
+}
+
+/**
+* Distances between many pairs of convex polygons in parallel
+* @param a - first polygon of every pair
+* @param b - second polygon of every pair (same size as a)
+* @param out - output array (one value per pair)
+* @param threads - number of threads (0 means all hardware threads)
+**/
+template<class Shape, class T>
+void ConvexDistances(Span<const Shape> a, Span<const Shape> b, T* out, unsigned int threads = 0)
+{
+    ParallelFor(0, a.size(), [&](std::size_t i) { out[i] = ConvexDistance(a[i], b[i]).distance; }, threads, 64);
+}
+
+typedef CaliperPair2D<double> CaliperPair2d;
+typedef CaliperPair2D<float> CaliperPair2;
+
+}
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef SIMPLIFICATION_2D_HPP
+#define SIMPLIFICATION_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+enum SimplifyMethod {SimplifyDouglasPeucker, SimplifyVisvalingam};
+
+/**
+* PolylineSimplifier2D Class
+* Polyline simplification into the indices of the vertices to keep (the first and last vertices are always kept)
+* - Douglas-Peucker: keeps the farthest vertex from the segment between two kept ones while it is farther than the
+*   tolerance; the ranges to split are on an explicit stack, so long polylines cannot overflow the call stack
+* - Visvalingam-Whyatt: removes the vertex of smallest triangle area with its neighbours, from an indexed 4-ary heap,
+*   while that area is below the threshold (effective areas: a vertex never gets a smaller area than the one removed
+*   before)
+* The scratch buffers are kept between calls, so one simplifier can be reused for many polylines
+**/
+template<class T>
+class PolylineSimplifier2D
+{
+protected:
+    // ranges of Douglas-Peucker still to split
+    std::vector<std::pair<std::uint32_t, std::uint32_t> > ranges;
+    std::vector<std::uint8_t> keep;
+    // Visvalingam-Whyatt: 4-ary min heap of (area, vertex), the heap position of every vertex so an area can be
+    // updated in place, and linked list of the remaining vertices
+    struct HeapEntry
+    {
+        T area;
+        std::uint32_t vertex;
+        bool operator<(const HeapEntry& other)const {return area<other.area || (area==other.area && vertex<other.vertex);}
+    };
+    std::vector<HeapEntry> heap;
+    std::vector<std::uint32_t> positions;
+    std::vector<std::uint32_t> prev;
+    std::vector<std::uint32_t> next;
+
+    static T TriangleArea(const Vector2D<T>& a, const Vector2D<T>& b, const Vector2D<T>& c)
+    {
+        T area = ((b.X()-a.X())*(c.Y()-a.Y())-(b.Y()-a.Y())*(c.X()-a.X()))/2;
+        return area<0 ? -area : area;
+    }
+
+    void SiftUp(std::size_t k)
+    {
+        HeapEntry e = heap[k];
+        while(k>0 && e<heap[(k-1)/4])
+        {
+            heap[k] = heap[(k-1)/4];
+            positions[heap[k].vertex] = std::uint32_t(k);
+            k = (k-1)/4;
+        }
+        heap[k] = e;
+        positions[e.vertex] = std::uint32_t(k);
+    }
+
+    void SiftDown(std::size_t k)
+    {
+        HeapEntry e = heap[k];
+        std::size_t n = heap.size();
+        for(;;)
+        {
+            std::size_t first = 4*k+1;
+            if(first>=n)
+                break;
+            std::size_t child = first;
+            for(std::size_t c=first+1;c<std::min(n, first+4);c++)
+                if(heap[c]<heap[child])
+                    child = c;
+            if(!(heap[child]<e))
+                break;
+            heap[k] = heap[child];
+            positions[heap[k].vertex] = std::uint32_t(k);
+            k = child;
+        }
+        heap[k] = e;
+        positions[e.vertex] = std::uint32_t(k);
+    }
+
+    void UpdateArea(std::uint32_t v, T area)
+    {
+        std::size_t k = positions[v];
+        T old = heap[k].area;
+        heap[k].area = area;
+        if(area<old)
+            SiftUp(k);
+        else
+            SiftDown(k);
+    }
+public:
+    /**
+    * Douglas-Peucker simplification
+    * @param points - the vertices (an open path)
+    * @param tolerance - largest distance from a removed vertex to the simplified polyline
+    * @param indices - the indices of the kept vertices are appended, in order
+    **/
+    void DouglasPeucker(Span<const Vector2D<T> > points, T tolerance, std::vector<std::uint32_t>& indices)
+    {
+        std::size_t n = points.size();
+        if(n<=2)
+        {
+            for(std::size_t i=0;i<n;i++)
+                indices.push_back(std::uint32_t(i));
+            return;
+        }
+        T toleranceSq = tolerance*tolerance;
+        keep.assign(n, 0);
+        keep[0] = keep[n-1] = 1;
+        ranges.clear();
+        ranges.push_back(std::make_pair(std::uint32_t(0), std::uint32_t(n-1)));
+        while(!ranges.empty())
+        {
+            std::uint32_t first = ranges.back().first, last = ranges.back().second;
+            ranges.pop_back();
+            const Vector2D<T>& a = points[first];
+            T dx = points[last].X()-a.X(), dy = points[last].Y()-a.Y();
+            T lengthSq = dx*dx+dy*dy;
+            T inverse = lengthSq>0 ? 1/lengthSq : T(0);
+            T farthest = toleranceSq;
+            std::uint32_t split = first;
+            for(std::uint32_t i=first+1;i<last;i++)
+            {
+                // distance to the segment (not the line), so a path going back past an end still counts
+                T px = points[i].X()-a.X(), py = points[i].Y()-a.Y();
+                T t = std::min(std::max((px*dx+py*dy)*inverse, T(0)), T(1));
+                T ex = px-t*dx, ey = py-t*dy;
+                T distanceSq = ex*ex+ey*ey;
+                if(distanceSq>farthest)
+                {
+                    farthest = distanceSq;
+                    split = i;
+                }
+            }
+            if(split==first)
+                continue;
+            keep[split] = 1;
+            if(split-first>1)
+                ranges.push_back(std::make_pair(first, split));
+            if(last-split>1)
+                ranges.push_back(std::make_pair(split, last));
+        }
+        for(std::size_t i=0;i<n;i++)
+            if(keep[i])
+                indices.push_back(std::uint32_t(i));
+    }
+
+    /**
+    * Visvalingam-Whyatt simplification
+    * @param points - the vertices (an open path)
+    * @param area - vertices are removed while the smallest effective triangle area is below it
+    * @param indices - the indices of the kept vertices are appended, in order
+    **/
+    void Visvalingam(Span<const Vector2D<T> > points, T area, std::vector<std::uint32_t>& indices)
+    {
+        std::size_t n = points.size();
+        if(n<=2)
+        {
+            for(std::size_t i=0;i<n;i++)
+                indices.push_back(std::uint32_t(i));
+            return;
+        }
+        positions.resize(n);
+        prev.resize(n);
+        next.resize(n);
+        keep.assign(n, 1);
+        heap.clear();
+        for(std::uint32_t i=0;i<n;i++)
+        {
+            prev[i] = i-1;
+            next[i] = i+1;
+        }
+        for(std::uint32_t i=1;i+1<n;i++)
+        {
+            HeapEntry e = {TriangleArea(points[i-1], points[i], points[i+1]), i};
+            positions[i] = std::uint32_t(heap.size());
+            heap.push_back(e);
+        }
+        for(std::size_t k=(heap.size()+2)/4;k-->0;)
+            SiftDown(k);
+        while(!heap.empty() && heap[0].area<area)
+        {
+            std::uint32_t i = heap[0].vertex;
+            T smallest = heap[0].area;
+            heap[0] = heap.back();
+            heap.pop_back();
+            if(!heap.empty())
+                SiftDown(0);
+            keep[i] = 0;
+            std::uint32_t p = prev[i], q = next[i];
+            next[p] = q;
+            prev[q] = p;
+            if(p>0)
+                UpdateArea(p, std::max(smallest, TriangleArea(points[prev[p]], points[p], points[q])));
+            if(q+1<n)
+                UpdateArea(q, std::max(smallest, TriangleArea(points[p], points[q], points[next[q]])));
+        }
+        for(std::size_t i=0;i<n;i++)
+            if(keep[i])
+                indices.push_back(std::uint32_t(i));
+    }
+
+    /**
+    * Simplify with either method
+    * @param points - the vertices (an open path)
+    * @param tolerance - distance for Douglas-Peucker, triangle area for Visvalingam-Whyatt
+    * @param method - the method
+    * @param indices - the indices of the kept vertices are appended, in order
+    **/
+    void Simplify(Span<const Vector2D<T> > points, T tolerance, SimplifyMethod method, std::vector<std::uint32_t>& indices)
+    {
+        if(method==SimplifyVisvalingam)
+            Visvalingam(points, tolerance, indices);
+        else
+            DouglasPeucker(points, tolerance, indices);
+    }
+};
+
+/**
+* StreamingPolyline2D Class
+* Polyline simplified while it grows: every AddPoint appends the point, and once the points after the last key point
+* fill the window they are simplified with Douglas-Peucker; the kept points but the last one become key points
+* (the segments between them are final), so the work per point is bounded by the window whatever the length
+* Indices() are the key points found so far; Flush() adds the rest when the polyline is complete
+* Every removed point is within the tolerance of the segment between the key points around it
+**/
+template<class T>
+class StreamingPolyline2D: public Polyline2D<T>
+{
+protected:
+    T tolerance;
+    std::size_t window;
+    // key points (indices of vertices) and the first point of the pending window
+    std::vector<std::uint32_t> indices;
+    std::size_t anchor;
+    PolylineSimplifier2D<T> simplifier;
+    std::vector<std::uint32_t> kept;
+
+    /**
+    * Simplify the pending window
+    * @param last - true to make all the kept points key points (end of the polyline)
+    **/
+    void Process(bool last)
+    {
+        const std::vector<Vector2D<T> >& v = this->vertices;
+        kept.clear();
+        simplifier.DouglasPeucker(Span<const Vector2D<T> >(v.data()+anchor, v.size()-anchor), tolerance, kept);
+        // kept.front() is the anchor, a key point already
+        std::size_t count = last || kept.size()==2 ? kept.size() : kept.size()-1;
+        for(std::size_t k=1;k<count;k++)
+            indices.push_back(std::uint32_t(anchor+kept[k]));
+        anchor = indices.back();
+    }
+public:
+    /**
+    * Constructor
+    * @param tol - largest distance from a removed point to the simplified polyline
+    * @param windowSize - number of pending points that triggers a simplification (at least 3)
+    **/
+    explicit StreamingPolyline2D(T tol, std::size_t windowSize = 1024):tolerance(tol),window(std::max<std::size_t>(3, windowSize)),anchor(0){}
+
+    /**
+    * Add new point to the polyline and simplify the pending points if the window is full
+    * @param point - point to be added
+    **/
+    void AddPoint(const Vector2D<T>& point)
+    {
+        this->vertices.push_back(point);
+        if(this->vertices.size()==1)
+            indices.push_back(0);
+        else if(this->vertices.size()-anchor>=window)
+            Process(false);
+    }
+
+    /**
+    * Simplify the pending points (the last point becomes a key point); more points can be added afterwards
+    **/
+    void Flush()
+    {
+        if(this->vertices.size()>anchor+1)
+            Process(true);
+    }
+
+    /**
+    * Get the key points
+    * @return std::vector - indices of the kept vertices, in order
+    **/
+    const std::vector<std::uint32_t>& Indices()const {return indices;}
+
+    T Tolerance()const {return tolerance;}
+};
+
+/**
+* Douglas-Peucker simplification of a polyline
+* @param line - the polyline (its vertices as an open path)
+* @param tolerance - largest distance from a removed vertex to the simplified polyline
+* @param indices - the indices of the kept vertices, in order (cleared first)
+**/
+template<class T>
+void DouglasPeucker(const Polyline2D<T>& line, T tolerance, std::vector<std::uint32_t>& indices)
+{
+    PolylineSimplifier2D<T> simplifier;
+    indices.clear();
+    simplifier.DouglasPeucker(Span<const Vector2D<T> >(line.Vertices()), tolerance, indices);
+}
+
+/**
+* Visvalingam-Whyatt simplification of a polyline
+* @param line - the polyline (its vertices as an open path)
+* @param area - vertices are removed while the smallest effective triangle area is below it
+* @param indices - the indices of the kept vertices, in order (cleared first)
+**/
+template<class T>
+void Visvalingam(const Polyline2D<T>& line, T area, std::vector<std::uint32_t>& indices)
+{
+    PolylineSimplifier2D<T> simplifier;
+    indices.clear();
+    simplifier.Visvalingam(Span<const Vector2D<T> >(line.Vertices()), area, indices);
+}
+
+/**
+* Simplify many polylines in parallel
+* The polylines are cut in one run per thread with about the same number of vertices each
+* @param lines - the polylines (any class with Vertices())
+* @param tolerance - distance for Douglas-Peucker, triangle area for Visvalingam-Whyatt
+* @param method - the method
+* @param indices - kept vertices of all the polylines, each into the vertices of its polyline (cleared first)
+* @param offsets - the kept vertices of line l are indices[offsets[l], offsets[l+1]) (lines.size()+1 elements)
+* @param threads - number of threads (0 means all hardware threads)
+**/
+template<class Shape>
+void SimplifyPolylines(Span<const Shape> lines, typename detail::ShapeScalar<Shape>::type tolerance, SimplifyMethod method,
+    std::vector<std::uint32_t>& indices, std::vector<std::size_t>& offsets, unsigned int threads = 0)
+{
+    typedef typename detail::ShapeScalar<Shape>::type T;
+    std::size_t n = lines.size();
+    offsets.assign(n+1, 0);
+    // offsets holds the vertex counts first, to balance the runs
+    for(std::size_t l=0;l<n;l++)
+        offsets[l+1] = offsets[l]+lines[l].Vertices().size();
+    std::size_t total = offsets[n];
+    std::size_t chunks = std::min<std::size_t>(ResolveThreads(threads), std::max<std::size_t>(1, std::min(n, total/65536)));
+    std::vector<std::size_t> starts(chunks+1, n);
+    for(std::size_t c=0;c<chunks;c++)
+        starts[c] = std::size_t(std::lower_bound(offsets.begin(), offsets.end()-1, total/chunks*c)-offsets.begin());
+    std::vector<std::vector<std::uint32_t> > parts(chunks);
+    ParallelFor(0, chunks, [&](std::size_t c) {
+        PolylineSimplifier2D<T> simplifier;
+        for(std::size_t l=starts[c];l<starts[c+1];l++)
+        {
+            simplifier.Simplify(Span<const Vector2D<T> >(lines[l].Vertices()), tolerance, method, parts[c]);
+            offsets[l+1] = parts[c].size();
+        }
+    }, threads, 1);
+    indices.clear();
+    for(std::size_t c=0;c<chunks;c++)
+    {
+        std::size_t base = indices.size();
+        for(std::size_t l=starts[c];l<starts[c+1];l++)
+            offsets[l+1] += base;
+        indices.insert(indices.end(), parts[c].begin(), parts[c].end());
+    }
+}
+
+typedef PolylineSimplifier2D<double> PolylineSimplifier2d;
+typedef PolylineSimplifier2D<float> PolylineSimplifier2;
+typedef StreamingPolyline2D<double> StreamingPolyline2d;
+typedef StreamingPolyline2D<float> StreamingPolyline2;
+
+}
+
+#endif
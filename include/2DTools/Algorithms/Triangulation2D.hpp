@@ -0,0 +1,573 @@
+#ifndef TRIANGULATION_2D_HPP
+#define TRIANGULATION_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Predicates2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* Triangulator2D Class
+* Triangulation of polygons with holes in O(n log n): a sweep line splits the polygon into y-monotone pieces
+* (diagonals at the split and merge vertices), then every piece is triangulated in linear time with a stack
+* Triangles are index triples (counter clockwise) into the vertices of the rings, in the order they were added
+* The scratch buffers are kept between calls, so one triangulator can be reused for many polygons
+* The rings must be simple and must not touch each other; a repeated closing vertex and repeated consecutive
+* vertices are allowed
+**/
+template<class T>
+class Triangulator2D
+{
+protected:
+    // Vertex types of the sweep
+    enum {Start, End, Split, Merge, Regular};
+
+    static const std::uint32_t None = 0xffffffffu;
+
+    // Order of the edges crossing the sweep line (edge i goes from vertex i to next[i], downwards)
+    struct SweepOrder
+    {
+        typedef void is_transparent;
+        const Triangulator2D* owner;
+
+        bool operator()(std::uint32_t a, std::uint32_t b)const
+        {
+            T xa = owner->SweepX(a), xb = owner->SweepX(b);
+            return xa<xb || (xa==xb && a<b);
+        }
+        bool operator()(std::uint32_t a, const T& x)const {return owner->SweepX(a)<x;}
+        bool operator()(const T& x, std::uint32_t b)const {return x<owner->SweepX(b);}
+    };
+    typedef std::set<std::uint32_t, SweepOrder> Status;
+
+    // vertices of the rings (repeated vertices dropped), with their index in the input and their ring neighbours
+    std::vector<Vector2D<T> > points;
+    std::vector<std::uint32_t> ids;
+    std::vector<std::uint32_t> next;
+    std::vector<std::uint32_t> prev;
+    std::uint32_t inputCount;
+    std::size_t rings;
+    // the outer boundary was degenerate (no area), and holes were added to it (the input is rejected)
+    bool outerDropped;
+    bool orphanHoles;
+    // sweep
+    std::vector<std::uint32_t> order;
+    std::vector<std::uint8_t> types;
+    std::vector<std::uint32_t> helpers;
+    std::vector<typename Status::iterator> positions;
+    std::vector<std::uint32_t> diagonals;
+    Vector2D<T> sweep;
+    // planar graph of the edges and diagonals (CSR, neighbours counter clockwise) and monotone pieces
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint32_t> neighbours;
+    std::vector<std::uint8_t> visited;
+    std::vector<std::uint32_t> face;
+    std::vector<std::uint32_t> sorted;
+    std::vector<std::uint8_t> sides;
+    std::vector<std::uint32_t> stack;
+
+    // exact sign: the vertex types, the reflex tests and the angular order must agree on near collinear vertices
+    static T Orient(const Vector2D<T>& o, const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        return Orient2D(o, a, b);
+    }
+
+    // Sweep order of the vertices: top to bottom, left to right on the same height
+    static bool Above(const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        return a.Y()>b.Y() || (a.Y()==b.Y() && a.X()<b.X());
+    }
+
+    /**
+    * Abscissa of an edge on the sweep line (horizontal edges are seen through the sweep point)
+    **/
+    T SweepX(std::uint32_t e)const
+    {
+        const Vector2D<T>& a = points[e];
+        const Vector2D<T>& b = points[next[e]];
+        if(a.Y()==b.Y())
+            return std::min(std::max(sweep.X(), a.X()), b.X());
+        if(sweep.Y()>=a.Y())
+            return a.X();
+        if(sweep.Y()<=b.Y())
+            return b.X();
+        return a.X()+(sweep.Y()-a.Y())*(b.X()-a.X())/(b.Y()-a.Y());
+    }
+
+    void AddDiagonal(std::uint32_t a, std::uint32_t b)
+    {
+        if(a!=b && next[a]!=b && prev[a]!=b)
+        {
+            diagonals.push_back(a);
+            diagonals.push_back(b);
+        }
+    }
+
+    void FixHelper(std::uint32_t e, std::uint32_t v)
+    {
+        if(types[helpers[e]]==Merge)
+            AddDiagonal(v, helpers[e]);
+    }
+
+    void Insert(Status& status, std::uint32_t e, std::uint32_t v)
+    {
+        positions[e] = status.insert(e).first;
+        helpers[e] = v;
+    }
+
+    void Erase(Status& status, std::uint32_t e)
+    {
+        status.erase(positions[e]);
+        helpers[e] = None;
+    }
+
+    /**
+    * Edge directly left of the sweep point
+    **/
+    std::uint32_t LeftEdge(const Status& status)const
+    {
+        typename Status::const_iterator it = status.lower_bound(sweep.X());
+        return it==status.begin() ? None : *std::prev(it);
+    }
+
+    /**
+    * Split the polygon in y-monotone pieces (diagonals added at the split and merge vertices)
+    * @return bool - false if the rings are not a valid polygon
+    **/
+    bool Partition()
+    {
+        std::size_t n = points.size();
+        order.resize(n);
+        for(std::size_t i=0;i<n;i++)
+            order[i] = std::uint32_t(i);
+        std::sort(order.begin(), order.end(), [this](std::uint32_t a, std::uint32_t b) {return Above(points[a], points[b]);});
+        types.resize(n);
+        for(std::size_t i=0;i<n;i++)
+        {
+            const Vector2D<T>& p = points[prev[i]];
+            const Vector2D<T>& v = points[i];
+            const Vector2D<T>& q = points[next[i]];
+            bool pBelow = Above(v, p), qBelow = Above(v, q);
+            if(pBelow && qBelow)
+                types[i] = Orient(p, v, q)>0 ? Start : Split;
+            else if(!pBelow && !qBelow)
+                types[i] = Orient(p, v, q)>0 ? End : Merge;
+            else
+                types[i] = Regular;
+        }
+        SweepOrder compare = {this};
+        Status status(compare);
+        helpers.assign(n, None);
+        positions.resize(n);
+        diagonals.clear();
+        for(std::size_t k=0;k<n;k++)
+        {
+            std::uint32_t v = order[k];
+            sweep = points[v];
+            std::uint32_t e = None;
+            switch(types[v])
+            {
+            case Start:
+                Insert(status, v, v);
+                break;
+            case End:
+                if(helpers[prev[v]]==None)
+                    return false;
+                FixHelper(prev[v], v);
+                Erase(status, prev[v]);
+                break;
+            case Split:
+                if((e = LeftEdge(status))==None)
+                    return false;
+                AddDiagonal(v, helpers[e]);
+                helpers[e] = v;
+                Insert(status, v, v);
+                break;
+            case Merge:
+                if(helpers[prev[v]]==None)
+                    return false;
+                FixHelper(prev[v], v);
+                Erase(status, prev[v]);
+                if((e = LeftEdge(status))==None)
+                    return false;
+                FixHelper(e, v);
+                helpers[e] = v;
+                break;
+            default:
+                if(Above(points[prev[v]], sweep))
+                {
+                    // the interior is right of the vertex: the edge above is replaced by the edge below
+                    if(helpers[prev[v]]==None)
+                        return false;
+                    FixHelper(prev[v], v);
+                    Erase(status, prev[v]);
+                    Insert(status, v, v);
+                }
+                else
+                {
+                    if((e = LeftEdge(status))==None)
+                        return false;
+                    FixHelper(e, v);
+                    helpers[e] = v;
+                }
+            }
+        }
+        return true;
+    }
+
+    /**
+    * Build the graph of the edges and diagonals, with the neighbours of every vertex in counter clockwise order
+    **/
+    void BuildGraph()
+    {
+        std::size_t n = points.size();
+        starts.assign(n+1, 2);
+        starts[n] = 0;
+        for(std::size_t d=0;d<diagonals.size();d++)
+            starts[diagonals[d]]++;
+        std::uint32_t sum = 0;
+        for(std::size_t i=0;i<=n;i++)
+        {
+            std::uint32_t count = starts[i];
+            starts[i] = sum;
+            sum += count;
+        }
+        neighbours.resize(sum);
+        for(std::size_t i=0;i<n;i++)
+        {
+            neighbours[starts[i]] = next[i];
+            neighbours[starts[i]+1] = prev[i];
+        }
+        std::vector<std::uint32_t>& fill = stack;
+        fill.assign(n, 2);
+        for(std::size_t d=0;d<diagonals.size();d+=2)
+        {
+            std::uint32_t a = diagonals[d], b = diagonals[d+1];
+            neighbours[starts[a]+fill[a]++] = b;
+            neighbours[starts[b]+fill[b]++] = a;
+        }
+        for(std::size_t d=0;d<diagonals.size();d++)
+        {
+            // only the vertices with diagonals have more than two neighbours to sort (once: fill is reset)
+            std::uint32_t v = diagonals[d];
+            if(fill[v]==0)
+                continue;
+            fill[v] = 0;
+            const Vector2D<T>& o = points[v];
+            std::sort(neighbours.begin()+starts[v], neighbours.begin()+starts[v+1], [&](std::uint32_t a, std::uint32_t b) {
+                const Vector2D<T>& pa = points[a];
+                const Vector2D<T>& pb = points[b];
+                // the half planes only need the signs of the differences, which are exact
+                bool ha = pa.Y()<o.Y() || (pa.Y()==o.Y() && pa.X()<o.X()), hb = pb.Y()<o.Y() || (pb.Y()==o.Y() && pb.X()<o.X());
+                if(ha!=hb)
+                    return hb;
+                return Orient(o, pa, pb)>0;
+            });
+        }
+        // the outside of the rings is not traced: the half edges to the previous vertices are marked as visited
+        visited.assign(sum, 0);
+        for(std::size_t i=0;i<n;i++)
+            for(std::uint32_t s=starts[i];s<starts[i+1];s++)
+                if(neighbours[s]==prev[i])
+                    visited[s] = 1;
+    }
+
+    /**
+    * Triangulate a y-monotone piece (face, counter clockwise)
+    **/
+    void TriangulateMonotone(std::vector<std::uint32_t>& out)
+    {
+        std::size_t k = face.size();
+        std::size_t top = 0, bottom = 0;
+        for(std::size_t i=1;i<k;i++)
+        {
+            if(Above(points[face[i]], points[face[top]]))
+                top = i;
+            if(Above(points[face[bottom]], points[face[i]]))
+                bottom = i;
+        }
+        // merge the left chain (forward from the top) and the right chain (backward from the top)
+        sorted.clear();
+        sides.clear();
+        sorted.push_back(face[top]);
+        sides.push_back(0);
+        std::size_t l = top+1==k ? 0 : top+1, r = top==0 ? k-1 : top-1;
+        while(l!=bottom || r!=bottom)
+        {
+            bool left = r==bottom || (l!=bottom && Above(points[face[l]], points[face[r]]));
+            sorted.push_back(face[left ? l : r]);
+            sides.push_back(left ? 0 : 1);
+            if(left)
+                l = l+1==k ? 0 : l+1;
+            else
+                r = r==0 ? k-1 : r-1;
+        }
+        sorted.push_back(face[bottom]);
+        sides.push_back(0);
+        stack.clear();
+        stack.push_back(0);
+        stack.push_back(1);
+        for(std::size_t j=2;j+1<k;j++)
+        {
+            if(sides[j]!=sides[stack.back()])
+            {
+                for(std::size_t s=0;s+1<stack.size();s++)
+                    Emit(sorted[j], sorted[stack[s]], sorted[stack[s+1]], out);
+                stack.clear();
+                stack.push_back(std::uint32_t(j-1));
+                stack.push_back(std::uint32_t(j));
+            }
+            else
+            {
+                std::uint32_t last = stack.back();
+                stack.pop_back();
+                while(!stack.empty())
+                {
+                    const Vector2D<T>& a = points[sorted[stack.back()]];
+                    const Vector2D<T>& b = points[sorted[last]];
+                    const Vector2D<T>& c = points[sorted[j]];
+                    if((sides[j]==0 ? Orient(a, b, c) : Orient(c, b, a))<=0)
+                        break;
+                    Emit(sorted[stack.back()], sorted[last], sorted[j], out);
+                    last = stack.back();
+                    stack.pop_back();
+                }
+                stack.push_back(last);
+                stack.push_back(std::uint32_t(j));
+            }
+        }
+        for(std::size_t s=0;s+1<stack.size();s++)
+            Emit(sorted[k-1], sorted[stack[s]], sorted[stack[s+1]], out);
+    }
+
+    void Emit(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::vector<std::uint32_t>& out)const
+    {
+        if(Orient(points[a], points[b], points[c])<0)
+            std::swap(b, c);
+        out.push_back(ids[a]);
+        out.push_back(ids[b]);
+        out.push_back(ids[c]);
+    }
+
+    /**
+    * Trace the monotone pieces and triangulate them
+    * @return bool - false if the pieces are not closed
+    **/
+    bool TriangulatePieces(std::vector<std::uint32_t>& out)
+    {
+        std::size_t n = points.size();
+        for(std::uint32_t v=0;v<n;v++)
+            for(std::uint32_t h=starts[v];h<starts[v+1];h++)
+            {
+                if(visited[h])
+                    continue;
+                face.clear();
+                std::uint32_t from = v, slot = h;
+                while(!visited[slot])
+                {
+                    visited[slot] = 1;
+                    face.push_back(from);
+                    if(face.size()>n)
+                        return false;
+                    // next half edge of the face: the neighbour clockwise from the one we came from
+                    std::uint32_t to = neighbours[slot];
+                    std::uint32_t s = starts[to];
+                    while(s<starts[to+1] && neighbours[s]!=from)
+                        s++;
+                    if(s==starts[to+1])
+                        return false;
+                    slot = s==starts[to] ? starts[to+1]-1 : s-1;
+                    from = to;
+                }
+                if(slot!=h || face.size()<3)
+                    return false;
+                TriangulateMonotone(out);
+            }
+        return true;
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty triangulator
+    **/
+    Triangulator2D():inputCount(0),rings(0),outerDropped(false),orphanHoles(false){}
+
+    /**
+    * Remove the rings (the buffers are kept)
+    **/
+    void Clear()
+    {
+        points.clear();
+        ids.clear();
+        next.clear();
+        prev.clear();
+        inputCount = 0;
+        rings = 0;
+        outerDropped = false;
+        orphanHoles = false;
+    }
+
+    /**
+    * Add a ring: the first one is the outer boundary, the next ones are holes
+    * Degenerate rings (less than 3 distinct vertices or no area) are dropped; holes in a degenerate outer boundary
+    * make the input invalid
+    * @param ring - the vertices (either orientation); their indices follow the vertices of the previous rings
+    **/
+    void AddRing(Span<const Vector2D<T> > ring)
+    {
+        std::uint32_t base = std::uint32_t(points.size()), offset = inputCount;
+        inputCount += std::uint32_t(ring.size());
+        bool outer = rings++==0;
+        std::size_t count = ring.size();
+        while(count>1 && ring[count-1]==ring[0])
+            count--;
+        for(std::size_t i=0;i<count;i++)
+            if(i==0 || ring[i]!=ring[i-1])
+            {
+                points.push_back(ring[i]);
+                ids.push_back(offset+std::uint32_t(i));
+            }
+        std::size_t m = points.size()-base;
+        T area = 0;
+        for(std::size_t i=0;i<m;i++)
+            area += Orient(points[base], points[base+i], points[base+(i+1)%m]);
+        if(m<3 || area==0 || outerDropped)
+        {
+            if(outer)
+                outerDropped = true;
+            else if(m>=3 && area!=0)
+                orphanHoles = true;
+            points.resize(base);
+            ids.resize(base);
+            return;
+        }
+        // the interior is left of the edges: counter clockwise outer boundary, clockwise holes
+        bool forward = (area>0)==outer;
+        next.resize(points.size());
+        prev.resize(points.size());
+        for(std::uint32_t i=0;i<m;i++)
+        {
+            std::uint32_t a = base+i, b = base+(i+1==m ? 0 : i+1);
+            next[forward ? a : b] = forward ? b : a;
+            prev[forward ? b : a] = forward ? a : b;
+        }
+    }
+
+    /**
+    * Triangulate the rings
+    * @param triangles - counter clockwise index triples of the triangles, appended (n-2+2h triangles for n vertices and h holes)
+    * @return bool - false if the rings are not a valid polygon (nothing appended)
+    **/
+    bool Triangulate(std::vector<std::uint32_t>& triangles)
+    {
+        if(orphanHoles)
+            return false;
+        if(points.empty())
+            return true;
+        std::size_t size = triangles.size();
+        if(Partition())
+        {
+            BuildGraph();
+            if(TriangulatePieces(triangles))
+                return true;
+        }
+        triangles.resize(size);
+        return false;
+    }
+};
+
+template<class T>
+const std::uint32_t Triangulator2D<T>::None;
+
+/**
+* Triangulate a polygon (sweep line monotone decomposition, O(n log n))
+* @param polygon - the polygon (either orientation)
+* @param triangles - counter clockwise index triples into polygon.Vertices() (cleared first)
+* @return bool - false if the polygon is not simple
+**/
+template<class T>
+bool Triangulate(const Polygon2D<T>& polygon, std::vector<std::uint32_t>& triangles)
+{
+    Triangulator2D<T> triangulator;
+    triangulator.AddRing(Span<const Vector2D<T> >(polygon.Vertices()));
+    triangles.clear();
+    return triangulator.Triangulate(triangles);
+}
+
+/**
+* Triangulate a polygon with holes
+* @param rings - the outer boundary then the holes (any class with Vertices(), either orientation)
+* @param triangles - counter clockwise index triples into the vertices of the rings, numbered one ring after the other (cleared first)
+* @return bool - false if the rings are not a valid polygon
+**/
+template<class Shape>
+bool Triangulate(Span<const Shape> rings, std::vector<std::uint32_t>& triangles)
+{
+    typedef typename detail::ShapeScalar<Shape>::type T;
+    Triangulator2D<T> triangulator;
+    for(std::size_t r=0;r<rings.size();r++)
+        triangulator.AddRing(Span<const Vector2D<T> >(rings[r].Vertices()));
+    triangles.clear();
+    return triangulator.Triangulate(triangles);
+}
+
+/**
+* Triangulate many polygons in parallel
+* @param polygons - the polygons (any class with Vertices(), either orientation)
+* @param triangles - index triples of all the polygons, each into the vertices of its polygon (cleared first)
+* @param offsets - the triangles of polygon p are triangles[offsets[p], offsets[p+1]) (polygons.size()+1 elements)
+* @param threads - number of threads (0 means all hardware threads)
+* @return std::size_t - number of polygons that could not be triangulated (no triangles)
+**/
+template<class Shape>
+std::size_t TriangulatePolygons(Span<const Shape> polygons, std::vector<std::uint32_t>& triangles, std::vector<std::size_t>& offsets,
+    unsigned int threads = 0)
+{
+    typedef typename detail::ShapeScalar<Shape>::type T;
+    std::size_t n = polygons.size();
+    std::size_t chunks = std::min<std::size_t>(ResolveThreads(threads), std::max<std::size_t>(1, n/64));
+    std::size_t chunk = n==0 ? 0 : (n+chunks-1)/chunks;
+    std::vector<std::vector<std::uint32_t> > parts(chunks);
+    std::vector<std::size_t> failures(chunks, 0);
+    offsets.assign(n+1, 0);
+    ParallelFor(0, chunks, [&](std::size_t c) {
+        Triangulator2D<T> triangulator;
+        for(std::size_t p=c*chunk;p<std::min(n, (c+1)*chunk);p++)
+        {
+            triangulator.Clear();
+            triangulator.AddRing(Span<const Vector2D<T> >(polygons[p].Vertices()));
+            failures[c] += !triangulator.Triangulate(parts[c]);
+            offsets[p+1] = parts[c].size();
+        }
+    }, threads, 1);
+    triangles.clear();
+    std::size_t failed = 0;
+    for(std::size_t c=0;c<chunks;c++)
+    {
+        std::size_t base = triangles.size();
+        for(std::size_t p=c*chunk;p<std::min(n, (c+1)*chunk);p++)
+            offsets[p+1] += base;
+        triangles.insert(triangles.end(), parts[c].begin(), parts[c].end());
+        failed += failures[c];
+    }
+    return failed;
+}
+
+typedef Triangulator2D<double> Triangulator2d;
+typedef Triangulator2D<float> Triangulator2;
+
+}
+
+#endif
@@ -0,0 +1,259 @@
+#ifndef BATCH_DISTANCES_2D_HPP
+#define BATCH_DISTANCES_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <2DTools/Misc/Simd.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/LinearShapes.hpp>
+#include <2DTools/Primitives/PointCloud2D.hpp>
+#include <2DTools/Primitives/SegmentArray2D.hpp>
+
+namespace Tools2D {
+
+/**
+* Result of a closest segment query
+* distanceSq - squared distance to the closest segment
+* index - index of the closest segment (the lowest one on ties)
+* t - parameter of the closest point on the segment (P0+t*(P1-P0), t in [0,1])
+**/
+template<class T>
+struct ClosestSegment2D
+{
+    T distanceSq;
+    std::size_t index;
+    T t;
+};
+
+namespace detail {
+
+/**
+* Point to segment distance squared with the segment given as P0, P1-P0 and 1/|P1-P0|^2
+* Branch-free form shared by all the batch kernels (clamped projection)
+**/
+template<class T>
+inline T ClampedSegmentT(T qx, T qy, T dx, T dy, T invLengthSq)
+{
+    T t = (qx*dx+qy*dy)*invLengthSq;
+    t = t<0 ? 0 : t;
+    return t>1 ? 1 : t;
+}
+
+template<class T>
+inline T SegmentDistanceSq(T px, T py, T x0, T y0, T dx, T dy, T invLengthSq)
+{
+    T qx = px-x0, qy = py-y0;
+    T t = ClampedSegmentT(qx, qy, dx, dy, invLengthSq);
+    T ex = qx-t*dx, ey = qy-t*dy;
+    return ex*ex+ey*ey;
+}
+
+template<class P>
+inline typename P::Type SegmentDistanceSq(typename P::Type px, typename P::Type py, typename P::Type x0, typename P::Type y0,
+                                          typename P::Type dx, typename P::Type dy, typename P::Type invLengthSq)
+{
+    typename P::Type qx = P::Sub(px, x0), qy = P::Sub(py, y0);
+    typename P::Type t = P::Mul(P::Add(P::Mul(qx, dx), P::Mul(qy, dy)), invLengthSq);
+    t = P::Min(P::Max(t, P::Set1(0)), P::Set1(1));
+    typename P::Type ex = P::Sub(qx, P::Mul(t, dx)), ey = P::Sub(qy, P::Mul(t, dy));
+    return P::Add(P::Mul(ex, ex), P::Mul(ey, ey));
+}
+
+/**
+* Many points against one segment: out[i] = d^2(point i, segment)
+**/
+template<class T>
+void PointsSegmentDistanceSq(const T* x, const T* y, std::size_t start, std::size_t n, T x0, T y0, T dx, T dy, T invLengthSq, T* out)
+{
+    for(std::size_t i=start;i<n;i++)
+        out[i] = SegmentDistanceSq(x[i], y[i], x0, y0, dx, dy, invLengthSq);
+}
+
+template<class T>
+void PointsSegmentDistanceSq(const T* x, const T* y, std::size_t n, T x0, T y0, T dx, T dy, T invLengthSq, T* out, std::false_type)
+{
+    PointsSegmentDistanceSq(x, y, 0, n, x0, y0, dx, dy, invLengthSq, out);
+}
+
+template<class T>
+void PointsSegmentDistanceSq(const T* x, const T* y, std::size_t n, T x0, T y0, T dx, T dy, T invLengthSq, T* out, std::true_type)
+{
+    typedef Pack<T> P;
+    typename P::Type vx0 = P::Set1(x0), vy0 = P::Set1(y0), vdx = P::Set1(dx), vdy = P::Set1(dy), vinv = P::Set1(invLengthSq);
+    std::size_t i = 0;
+    for(;i+P::Width<=n;i+=P::Width)
+        P::Store(out+i, SegmentDistanceSq<P>(P::Load(x+i), P::Load(y+i), vx0, vy0, vdx, vdy, vinv));
+    PointsSegmentDistanceSq(x, y, i, n, x0, y0, dx, dy, invLengthSq, out);
+}
+
+/**
+* One point against many segments: out[j] = d^2(point, segment j)
+**/
+template<class T>
+void PointSegmentsDistanceSq(T px, T py, const SegmentArray2D<T>& segments, std::size_t start, T* out)
+{
+    const T *x0 = segments.X0(), *y0 = segments.Y0(), *dx = segments.DX(), *dy = segments.DY(), *inv = segments.InvLengthSq();
+    for(std::size_t j=start;j<segments.Size();j++)
+        out[j] = SegmentDistanceSq(px, py, x0[j], y0[j], dx[j], dy[j], inv[j]);
+}
+
+template<class T>
+void PointSegmentsDistanceSq(T px, T py, const SegmentArray2D<T>& segments, T* out, std::false_type)
+{
+    PointSegmentsDistanceSq(px, py, segments, 0, out);
+}
+
+template<class T>
+void PointSegmentsDistanceSq(T px, T py, const SegmentArray2D<T>& segments, T* out, std::true_type)
+{
+    typedef Pack<T> P;
+    const T *x0 = segments.X0(), *y0 = segments.Y0(), *dx = segments.DX(), *dy = segments.DY(), *inv = segments.InvLengthSq();
+    std::size_t n = segments.Size();
+    typename P::Type vpx = P::Set1(px), vpy = P::Set1(py);
+    std::size_t j = 0;
+    for(;j+P::Width<=n;j+=P::Width)
+        P::Store(out+j, SegmentDistanceSq<P>(vpx, vpy, P::Load(x0+j), P::Load(y0+j), P::Load(dx+j), P::Load(dy+j), P::Load(inv+j)));
+    PointSegmentsDistanceSq(px, py, segments, j, out);
+}
+
+/**
+* One point against many segments, keeping only the minimum over [start, end)
+* best/bestIndex are updated in place (strictly smaller distances only, so the lowest index wins on ties)
+**/
+template<class T>
+void ClosestSegmentScalar(T px, T py, const SegmentArray2D<T>& segments, std::size_t start, std::size_t end, T& best, std::size_t& bestIndex)
+{
+    const T *x0 = segments.X0(), *y0 = segments.Y0(), *dx = segments.DX(), *dy = segments.DY(), *inv = segments.InvLengthSq();
+    for(std::size_t j=start;j<end;j++)
+    {
+        T d = SegmentDistanceSq(px, py, x0[j], y0[j], dx[j], dy[j], inv[j]);
+        if(d<best)
+        {
+            best = d;
+            bestIndex = j;
+        }
+    }
+}
+
+template<class T>
+void ClosestSegment(T px, T py, const SegmentArray2D<T>& segments, T& best, std::size_t& bestIndex, std::false_type)
+{
+    ClosestSegmentScalar(px, py, segments, 0, segments.Size(), best, bestIndex);
+}
+
+// Lane indices are kept as T, so blocks are small enough to be exact in float
+static const std::size_t ArgMinBlock = 1<<16;
+
+template<class T>
+void ClosestSegment(T px, T py, const SegmentArray2D<T>& segments, T& best, std::size_t& bestIndex, std::true_type)
+{
+    typedef Pack<T> P;
+    const T *x0 = segments.X0(), *y0 = segments.Y0(), *dx = segments.DX(), *dy = segments.DY(), *inv = segments.InvLengthSq();
+    std::size_t n = segments.Size();
+    typename P::Type vpx = P::Set1(px), vpy = P::Set1(py), step = P::Set1(T(P::Width));
+    for(std::size_t start=0;start<n;start+=ArgMinBlock)
+    {
+        std::size_t end = n-start<ArgMinBlock ? n : start+ArgMinBlock;
+        std::size_t j = start;
+        if(end-start>=P::Width)
+        {
+            typename P::Type vbest = P::Set1(best), vindex = P::Set1(0), lane = P::Iota();
+            for(;j+P::Width<=end;j+=P::Width)
+            {
+                typename P::Type d = SegmentDistanceSq<P>(vpx, vpy, P::Load(x0+j), P::Load(y0+j), P::Load(dx+j), P::Load(dy+j), P::Load(inv+j));
+                typename P::Type mask = P::Less(d, vbest);
+                vbest = P::Select(mask, d, vbest);
+                vindex = P::Select(mask, lane, vindex);
+                lane = P::Add(lane, step);
+            }
+            T lanes[2][P::Width];
+            P::Store(lanes[0], vbest);
+            P::Store(lanes[1], vindex);
+            for(std::size_t k=0;k<P::Width;k++)
+            {
+                std::size_t index = start+std::size_t(lanes[1][k]);
+                if(lanes[0][k]<best || (lanes[0][k]==best && lanes[0][k]<std::numeric_limits<T>::infinity() && index<bestIndex))
+                {
+                    best = lanes[0][k];
+                    bestIndex = index;
+                }
+            }
+        }
+        ClosestSegmentScalar(px, py, segments, j, end, best, bestIndex);
+    }
+}
+
+}
+
+/**
+* Computes the squared distances from many points to one segment
+* @param points - the points (SoA)
+* @param segment - the segment
+* @param out - output, out[i] is the squared distance of point i (at least points.Size() elements)
+**/
+template<class T>
+void BatchDistanceSq(const PointCloudView2D<T>& points, const Segment<T>& segment, T* out)
+{
+    T dx = segment.D().X(), dy = segment.D().Y();
+    T lengthSq = dx*dx+dy*dy;
+    detail::PointsSegmentDistanceSq(points.X(), points.Y(), points.Size(), segment.P0().X(), segment.P0().Y(), dx, dy,
+                                    lengthSq>0 ? 1/lengthSq : T(0), out, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+}
+
+/**
+* Computes the squared distances from one point to many segments
+* @param point - the point
+* @param segments - the segments (SoA)
+* @param out - output, out[j] is the squared distance to segment j (at least segments.Size() elements)
+**/
+template<class T>
+void BatchDistanceSq(const Vector2D<T>& point, const SegmentArray2D<T>& segments, T* out)
+{
+    detail::PointSegmentsDistanceSq(point.X(), point.Y(), segments, out, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+}
+
+/**
+* Computes the matrix of squared distances between many points and many segments
+* Every row is computed with the one point / many segments kernel
+* @param points - the points (SoA)
+* @param segments - the segments (SoA)
+* @param out - output, out[i*segments.Size()+j] is the squared distance of point i to segment j
+**/
+template<class T>
+void DistanceSqMatrix(const PointCloudView2D<T>& points, const SegmentArray2D<T>& segments, T* out)
+{
+    std::size_t m = segments.Size();
+    for(std::size_t i=0;i<points.Size();i++)
+        detail::PointSegmentsDistanceSq(points.X()[i], points.Y()[i], segments, out+i*m, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+}
+
+/**
+* Finds the segment closest to a point
+* @param point - the point
+* @param segments - the segments (SoA)
+* @return ClosestSegment2D - squared distance, index and parameter of the closest point
+*         (distanceSq is infinity and index is segments.Size() when there are no segments)
+**/
+template<class T>
+ClosestSegment2D<T> FindClosestSegment(const Vector2D<T>& point, const SegmentArray2D<T>& segments)
+{
+    ClosestSegment2D<T> result;
+    result.distanceSq = std::numeric_limits<T>::infinity();
+    result.index = segments.Size();
+    result.t = 0;
+    detail::ClosestSegment(point.X(), point.Y(), segments, result.distanceSq, result.index, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+    if(result.index<segments.Size())
+    {
+        std::size_t j = result.index;
+        result.t = detail::ClampedSegmentT(point.X()-segments.X0()[j], point.Y()-segments.Y0()[j], segments.DX()[j], segments.DY()[j], segments.InvLengthSq()[j]);
+    }
+    return result;
+}
+
+}
+
+#endif
@@ -4,6 +4,9 @@
 /**
 * Includes
 **/
+#include <cmath>
+#include <cstddef>
+#include <limits>
 #include <2DTools/Misc/Helper.hpp>
 #include <2DTools/Primitives/Polygons.hpp>
 
@@ -16,7 +19,7 @@ namespace Tools2D {
 * @param line
 **/
 template<class T>
-double DistanceSq(Vector2D<T> point, Line<T> line)
+double DistanceSq(const Vector2D<T>& point, const Line<T>& line)
 {
     Vector2D<T> n = line.n();
     double distance = std::abs(n*point+line.c())/n.Length();
@@ -24,7 +27,7 @@ double DistanceSq(Vector2D<T> point, Line<T> line)
 }
 
 template<class T>
-double DistanceSq(Line<T> line, Vector2D<T> point)
+double DistanceSq(const Line<T>& line, const Vector2D<T>& point)
 {
     return DistanceSq(point,line);
 }
@@ -35,14 +38,14 @@ double DistanceSq(Line<T> line, Vector2D<T> point)
 * @param line
 **/
 template<class T>
-double Distance(Vector2D<T> point, Line<T> line)
+double Distance(const Vector2D<T>& point, const Line<T>& line)
 {
     Vector2D<T> n = line.n();
     return (std::abs(n*point+line.c())/n.Length());
 }
 
 template<class T>
-double Distance(Line<T> line, Vector2D<T> point)
+double Distance(const Line<T>& line, const Vector2D<T>& point)
 {
     return Distance(point,line);
 }
@@ -53,7 +56,7 @@ double Distance(Line<T> line, Vector2D<T> point)
 * @param ray
 **/
 template<class T>
-double DistanceSq(Vector2D<T> point, Ray<T> ray)
+double DistanceSq(const Vector2D<T>& point, const Ray<T>& ray)
 {
     Vector2D<T> toP = point-ray.P();
     if((ray.D()*toP)>0)
@@ -62,7 +65,7 @@ double DistanceSq(Vector2D<T> point, Ray<T> ray)
 }
 
 template<class T>
-double DistanceSq(Ray<T> ray, Vector2D<T> point)
+double DistanceSq(const Ray<T>& ray, const Vector2D<T>& point)
 {
     return DistanceSq(point,ray);
 }
@@ -73,7 +76,7 @@ double DistanceSq(Ray<T> ray, Vector2D<T> point)
 * @param ray
 **/
 template<class T>
-double Distance(Vector2D<T> point, Ray<T> ray)
+double Distance(const Vector2D<T>& point, const Ray<T>& ray)
 {
     Vector2D<T> toP = point-ray.P();
     if((ray.D()*toP)>0)
@@ -82,7 +85,7 @@ double Distance(Vector2D<T> point, Ray<T> ray)
 }
 
 template<class T>
-double Distance(Ray<T> ray, Vector2D<T> point)
+double Distance(const Ray<T>& ray, const Vector2D<T>& point)
 {
     return Distance(point,ray);
 }
@@ -94,7 +97,7 @@ double Distance(Ray<T> ray, Vector2D<T> point)
 * @param seg
 **/
 template<class T>
-double DistanceSq(Vector2D<T> point, Segment<T> seg)
+double DistanceSq(const Vector2D<T>& point, const Segment<T>& seg)
 {
     Vector2D<T> D = seg.D();
     Vector2D<T> toP = point-seg.P();
@@ -113,7 +116,7 @@ double DistanceSq(Vector2D<T> point, Segment<T> seg)
 }
 
 template<class T>
-double DistanceSq(Segment<T> seg, Vector2D<T> point)
+double DistanceSq(const Segment<T>& seg, const Vector2D<T>& point)
 {
     return DistanceSq(point,seg);
 }
@@ -124,7 +127,7 @@ double DistanceSq(Segment<T> seg, Vector2D<T> point)
 * @param seg
 **/
 template<class T>
-double Distance(Vector2D<T> point, Segment<T> seg)
+double Distance(const Vector2D<T>& point, const Segment<T>& seg)
 {
     Vector2D<T> D = seg.D();
     Vector2D<T> toP = point-seg.P();
@@ -143,73 +146,219 @@ double Distance(Vector2D<T> point, Segment<T> seg)
 }
 
 template<class T>
-double Distance(Segment<T> seg, Vector2D<T> point)
+double Distance(const Segment<T>& seg, const Vector2D<T>& point)
 {
     return Distance(point,seg);
 }
 
 
+/**
+* Computes Point to Prepared Line/Ray/Segment Distance (Squared)
+* Uses the cached unit normal/direction: no sqrt or division, except the sqrt of Distance
+* when the closest point of a ray/segment is one of its end points
+* A degenerate ray/segment (zero direction) is the distance to its point, as for the unprepared overloads
+* @param point
+* @param line/ray/seg - the prepared shape
+**/
+template<class T>
+double DistanceSq(const Vector2D<T>& point, const PreparedLine<T>& line)
+{
+    T d = line.SignedDistance(point);
+    return d*d;
+}
+
+template<class T>
+double DistanceSq(const PreparedLine<T>& line, const Vector2D<T>& point)
+{
+    return DistanceSq(point,line);
+}
+
+template<class T>
+double Distance(const Vector2D<T>& point, const PreparedLine<T>& line)
+{
+    return std::abs(line.SignedDistance(point));
+}
+
+template<class T>
+double Distance(const PreparedLine<T>& line, const Vector2D<T>& point)
+{
+    return Distance(point,line);
+}
+
+template<class T>
+double DistanceSq(const Vector2D<T>& point, const PreparedRay<T>& ray)
+{
+    if(ray.Degenerate())
+        return point.DistanceSq(ray.P());
+    T t = ray.Project(point);
+    T d = ray.SignedDistance(point);
+    T over = (t<0) ? t : T(0);
+    return d*d+over*over;
+}
+
+template<class T>
+double DistanceSq(const PreparedRay<T>& ray, const Vector2D<T>& point)
+{
+    return DistanceSq(point,ray);
+}
+
+template<class T>
+double Distance(const Vector2D<T>& point, const PreparedRay<T>& ray)
+{
+    if(!ray.Degenerate() && ray.Project(point)>0)
+        return std::abs(ray.SignedDistance(point));
+    return point.Distance(ray.P());
+}
+
+template<class T>
+double Distance(const PreparedRay<T>& ray, const Vector2D<T>& point)
+{
+    return Distance(point,ray);
+}
+
+template<class T>
+double DistanceSq(const Vector2D<T>& point, const PreparedSegment<T>& seg)
+{
+    if(seg.Degenerate())
+        return point.DistanceSq(seg.P0());
+    // squared distance = squared distance to the line + squared overshoot along the direction
+    T t = seg.Project(point);
+    T d = seg.SignedDistance(point);
+    T over = (t<0) ? t : ((t>seg.Length()) ? t-seg.Length() : T(0));
+    return d*d+over*over;
+}
+
+template<class T>
+double DistanceSq(const PreparedSegment<T>& seg, const Vector2D<T>& point)
+{
+    return DistanceSq(point,seg);
+}
+
+template<class T>
+double Distance(const Vector2D<T>& point, const PreparedSegment<T>& seg)
+{
+    if(seg.Degenerate())
+        return point.Distance(seg.P0());
+    T t = seg.Project(point);
+    if(t<=0 || t>=seg.Length())
+        return sqrt(DistanceSq(point,seg));
+    return std::abs(seg.SignedDistance(point));
+}
+
+template<class T>
+double Distance(const PreparedSegment<T>& seg, const Vector2D<T>& point)
+{
+    return Distance(point,seg);
+}
+
+namespace detail {
+
+/**
+* Point to Segment (a->b) Distance Squared on raw coordinates (no temporaries)
+**/
+template<class T>
+inline T PointSegmentDistanceSq(T px, T py, T ax, T ay, T bx, T by)
+{
+    T dx = bx-ax, dy = by-ay;
+    T qx = px-ax, qy = py-ay;
+    T t = dx*qx+dy*qy;
+    if(t<=0)
+        return qx*qx+qy*qy;
+    T dd = dx*dx+dy*dy;
+    if(t>=dd)
+    {
+        T rx = px-bx, ry = py-by;
+        return rx*rx+ry*ry;
+    }
+    T cross = dx*qy-dy*qx;
+    return cross*cross/dd;
+}
+
+}
+
 /**
 * Computes Point to Polyline Distance Squared
+* Linear scan over the segments of the view (no copies, no allocations)
 * @param point
-* @param line
+* @param line - view of the polyline (closed views include the last->first edge)
+* @return double - the distance squared (infinity for an empty polyline)
 **/
 template<class T>
-double DistanceSq(Vector2D<T> point, Polyline2D<T> line)
+double DistanceSq(const Vector2D<T>& point, const PolylineView2D<T>& line)
 {
-    double m = DistanceSq(point, Segment<T>(line.Vertices()[0], line.Vertices()[1]));
-    Vector2D<T> prev = line.Vertices()[1];
-    double prevX = abs(prev.X()-point.X());
-    double prevY = abs(prev.Y()-point.Y());
-    double currX, currY;
-    for(int i=1;i<line.Vertices().size()-1;i++)
+    Span<const Vector2D<T> > v = line.Vertices();
+    if(v.empty())
+        return std::numeric_limits<double>::infinity();
+    T px = point.X(), py = point.Y();
+    if(v.size()==1)
+        return point.DistanceSq(v[0]);
+    T m = std::numeric_limits<T>::max();
+    for(std::size_t i=0;i+1<v.size();i++)
     {
-        currX = abs(line.Vertices()[i].X()-point.X());
-        currY = abs(line.Vertices()[i].Y()-point.Y());
-        if((prevX <= m && currX <= m && (prevX*currX)>0) && (prevY <= m && currY <= m && (prevY*currY)>0))
-        {
-            m = DistanceSq(point, Segment<T>(line.Vertices()[i], line.Vertices()[i+1]));
-        }
-        prevX = currX;
-        prevY = currY;
+        T d = detail::PointSegmentDistanceSq(px, py, v[i].X(), v[i].Y(), v[i+1].X(), v[i+1].Y());
+        m = d<m ? d : m;
+    }
+    if(line.Closed())
+    {
+        T d = detail::PointSegmentDistanceSq(px, py, v.back().X(), v.back().Y(), v[0].X(), v[0].Y());
+        m = d<m ? d : m;
     }
     return m;
 }
 
 template<class T>
-double DistanceSq(Polyline2D<T> line, Vector2D<T> point)
+double DistanceSq(const PolylineView2D<T>& line, const Vector2D<T>& point)
 {
     return DistanceSq(point,line);
 }
+
 /**
 * Computes Point to Polyline Distance
 * @param point
+* @param line - view of the polyline
+**/
+template<class T>
+double Distance(const Vector2D<T>& point, const PolylineView2D<T>& line)
+{
+    return sqrt(DistanceSq(point,line));
+}
+
+template<class T>
+double Distance(const PolylineView2D<T>& line, const Vector2D<T>& point)
+{
+    return Distance(point,line);
+}
+
+/**
+* Computes Point to Polyline Distance Squared
+* Polygons (and their subclasses) include their closing edge
+* @param point
 * @param line
 **/
 template<class T>
-double Distance(Vector2D<T> point, Polyline2D<T> line)
+double DistanceSq(const Vector2D<T>& point, const Polyline2D<T>& line)
 {
-    double m = Distance(point, Segment<T>(line.Vertices()[0], line.Vertices()[1]));
-    Vector2D<T> prev = line.Vertices()[1];
-    double prevX = std::abs(prev.X()-point.X());
-    double prevY = std::abs(prev.Y()-point.Y());
-    double currX, currY;
-    for(int i=1;i<line.Vertices().size()-1;i++)
-    {
-        currX = std::abs(line.Vertices()[i].X()-point.X());
-        currY = std::abs(line.Vertices()[i].Y()-point.Y());
-        if((prevX <= m && currX <= m && (prevX*currX)>0) && (prevY <= m && currY <= m && (prevY*currY)>0))
-        {
-            m = Distance(point, Segment<T>(line.Vertices()[i], line.Vertices()[i+1]));
-        }
-        prevX = currX;
-        prevY = currY;
-    }
-    return m;
+    return DistanceSq(point,line.View());
+}
+
+template<class T>
+double DistanceSq(const Polyline2D<T>& line, const Vector2D<T>& point)
+{
+    return DistanceSq(point,line);
+}
+/**
+* Computes Point to Polyline Distance
+* @param point
+* @param line
+**/
+template<class T>
+double Distance(const Vector2D<T>& point, const Polyline2D<T>& line)
+{
+    return Distance(point,line.View());
 }
 
 template<class T>
-double Distance(Polyline2D<T> line, Vector2D<T> point)
+double Distance(const Polyline2D<T>& line, const Vector2D<T>& point)
 {
     return Distance(point,line);
 }
@@ -220,7 +369,7 @@ double Distance(Polyline2D<T> line, Vector2D<T> point)
 * @param line2
 **/
 template<class T>
-double DistanceSq(Line<T> line1, Line<T> line2)
+double DistanceSq(const Line<T>& line1, const Line<T>& line2)
 {
     Vector2D<T> d2P = line2.D().Perp2();
     if(line1.D()*d2P!=0)
@@ -236,7 +385,7 @@ double DistanceSq(Line<T> line1, Line<T> line2)
 * @param line2
 **/
 template<class T>
-double Distance(Line<T> line1, Line<T> line2)
+double Distance(const Line<T>& line1, const Line<T>& line2)
 {
     Vector2D<T> d2P = line2.D().Perp2();
     if(line1.D()*d2P!=0)
@@ -254,7 +403,7 @@ double Distance(Line<T> line1, Line<T> line2)
 * @param ray
 **/
 template<class T>
-double DistanceSq(Line<T> line, Ray<T> ray)
+double DistanceSq(const Line<T>& line, const Ray<T>& ray)
 {
     Vector2D<T> n0 = line.n();
     double c0 = -line.c();
@@ -265,7 +414,7 @@ double DistanceSq(Line<T> line, Ray<T> ray)
 }
 
 template<class T>
-double DistanceSq(Ray<T> ray, Line<T> line)
+double DistanceSq(const Ray<T>& ray, const Line<T>& line)
 {
     return DistanceSq(line,ray);
 }
@@ -277,7 +426,7 @@ double DistanceSq(Ray<T> ray, Line<T> line)
 * @param ray
 **/
 template<class T>
-double Distance(Line<T> line, Ray<T> ray)
+double Distance(const Line<T>& line, const Ray<T>& ray)
 {
     Vector2D<T> n0 = line.n();
     double c0 = -line.c();
@@ -287,7 +436,7 @@ double Distance(Line<T> line, Ray<T> ray)
 }
 
 template<class T>
-double Distance(Ray<T> ray, Line<T> line)
+double Distance(const Ray<T>& ray, const Line<T>& line)
 {
     return Distance(line,ray);
 }
@@ -299,7 +448,7 @@ double Distance(Ray<T> ray, Line<T> line)
 * @param seg
 **/
 template<class T>
-double DistanceSq(Line<T> line, Segment<T> seg)
+double DistanceSq(const Line<T>& line, const Segment<T>& seg)
 {
     Vector2D<T> Q0 = seg.P();
     Vector2D<T> Q1 = seg.P1();
@@ -317,7 +466,7 @@ double DistanceSq(Line<T> line, Segment<T> seg)
 }
 
 template<class T>
-double DistanceSq(Segment<T> seg, Line<T> line)
+double DistanceSq(const Segment<T>& seg, const Line<T>& line)
 {
     return DistanceSq(line,seg);
 }
@@ -329,7 +478,7 @@ double DistanceSq(Segment<T> seg, Line<T> line)
 * @param seg
 **/
 template<class T>
-double Distance(Line<T> line, Segment<T> seg)
+double Distance(const Line<T>& line, const Segment<T>& seg)
 {
     Vector2D<T> Q0 = seg.P();
     Vector2D<T> Q1 = seg.P1();
@@ -345,7 +494,7 @@ double Distance(Line<T> line, Segment<T> seg)
 }
 
 template<class T>
-double Distance(Segment<T> seg, Line<T> line)
+double Distance(const Segment<T>& seg, const Line<T>& line)
 {
     return Distance(line,seg);
 }
@@ -0,0 +1,528 @@
+#ifndef GJK_2D_HPP
+#define GJK_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* Warm start data of GJK: vertex indices of the last simplex
+* Keep one per pair of shapes and pass it to every query of that pair; when the shapes move a little between
+* two queries the old simplex is already (almost) the final one and GJK finishes in one or two iterations
+**/
+struct SimplexCache2D
+{
+    std::uint32_t count;
+    std::uint32_t indexA[3];
+    std::uint32_t indexB[3];
+
+    SimplexCache2D():count(0){}
+};
+
+/**
+* Result of GJKDistance
+* distance - distance between the shapes (0 if they intersect)
+* pointA, pointB - closest points on the shapes (the same point when they intersect)
+* iterations - number of GJK iterations
+**/
+template<class T>
+struct GJKResult2D
+{
+    T distance;
+    Vector2D<T> pointA;
+    Vector2D<T> pointB;
+    unsigned int iterations;
+
+    bool Intersecting()const {return distance==0;}
+};
+
+/**
+* Result of EPAPenetration
+* intersecting - true if the shapes intersect (touching counts as intersection)
+* depth - penetration depth (0 if they do not intersect)
+* normal - unit direction in which B moves out of A by depth (from A to B when they do not intersect)
+**/
+template<class T>
+struct Penetration2D
+{
+    bool intersecting;
+    T depth;
+    Vector2D<T> normal;
+};
+
+namespace detail {
+
+// Maximum number of GJK iterations (every iteration adds a new vertex, so polygons finish well before)
+const unsigned int GJKMaxIterations = 64;
+// Maximum number of vertices of the EPA polytope (no allocations)
+const std::size_t EPAMaxVertices = 64;
+
+template<class T>
+inline T Cross(const Vector2D<T>& a, const Vector2D<T>& b) {return a.X()*b.Y()-a.Y()*b.X();}
+
+/**
+* Index of the vertex furthest along a direction (linear scan over the contiguous vertices)
+**/
+template<class T>
+inline std::uint32_t Support(Span<const Vector2D<T> > v, const Vector2D<T>& d)
+{
+    T dx = d.X(), dy = d.Y();
+    std::uint32_t best = 0;
+    T bestDot = v[0].X()*dx+v[0].Y()*dy;
+    for(std::size_t i=1;i<v.size();i++)
+    {
+        T dot = v[i].X()*dx+v[i].Y()*dy;
+        if(dot>bestDot)
+        {
+            bestDot = dot;
+            best = std::uint32_t(i);
+        }
+    }
+    return best;
+}
+
+/**
+* Vertex of the Minkowski difference A-B: w = wA-wB with barycentric weight a
+**/
+template<class T>
+struct SimplexVertex2D
+{
+    Vector2D<T> wA, wB, w;
+    T a;
+    std::uint32_t indexA, indexB;
+};
+
+/**
+* GJK simplex (point, segment or triangle of the Minkowski difference) and its closest point to the origin
+**/
+template<class T>
+struct Simplex2D
+{
+    SimplexVertex2D<T> v[3];
+    unsigned int count;
+
+    void Set(unsigned int k, Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, std::uint32_t ia, std::uint32_t ib)
+    {
+        v[k].indexA = ia;
+        v[k].indexB = ib;
+        v[k].wA = a[ia];
+        v[k].wB = b[ib];
+        v[k].w = v[k].wA-v[k].wB;
+        v[k].a = 1;
+    }
+
+    /**
+    * Reduce a segment to the part closest to the origin (Voronoi regions of the end points and the edge)
+    **/
+    void Solve2()
+    {
+        Vector2D<T> w1 = v[0].w, w2 = v[1].w, e12 = w2-w1;
+        T d12_2 = -(w1*e12);
+        if(d12_2<=0)
+        {
+            v[0].a = 1;
+            count = 1;
+            return;
+        }
+        T d12_1 = w2*e12;
+        if(d12_1<=0)
+        {
+            v[1].a = 1;
+            v[0] = v[1];
+            count = 1;
+            return;
+        }
+        T inv = 1/(d12_1+d12_2);
+        v[0].a = d12_1*inv;
+        v[1].a = d12_2*inv;
+        count = 2;
+    }
+
+    /**
+    * Reduce a triangle to the feature closest to the origin (vertices, edges or the inside)
+    **/
+    void Solve3()
+    {
+        Vector2D<T> w1 = v[0].w, w2 = v[1].w, w3 = v[2].w;
+        Vector2D<T> e12 = w2-w1, e13 = w3-w1, e23 = w3-w2;
+        T d12_1 = w2*e12, d12_2 = -(w1*e12);
+        T d13_1 = w3*e13, d13_2 = -(w1*e13);
+        T d23_1 = w3*e23, d23_2 = -(w2*e23);
+        T n123 = Cross(e12, e13);
+        T d123_1 = n123*Cross(w2, w3), d123_2 = n123*Cross(w3, w1), d123_3 = n123*Cross(w1, w2);
+        if(d12_2<=0 && d13_2<=0)
+        {
+            v[0].a = 1;
+            count = 1;
+        }
+        else if(d12_1>0 && d12_2>0 && d123_3<=0)
+        {
+            T inv = 1/(d12_1+d12_2);
+            v[0].a = d12_1*inv;
+            v[1].a = d12_2*inv;
+            count = 2;
+        }
+        else if(d13_1>0 && d13_2>0 && d123_2<=0)
+        {
+            T inv = 1/(d13_1+d13_2);
+            v[0].a = d13_1*inv;
+            v[2].a = d13_2*inv;
+            v[1] = v[2];
+            count = 2;
+        }
+        else if(d12_1<=0 && d23_2<=0)
+        {
+            v[1].a = 1;
+            v[0] = v[1];
+            count = 1;
+        }
+        else if(d13_1<=0 && d23_1<=0)
+        {
+            v[2].a = 1;
+            v[0] = v[2];
+            count = 1;
+        }
+        else if(d23_1>0 && d23_2>0 && d123_1<=0)
+        {
+            T inv = 1/(d23_1+d23_2);
+            v[1].a = d23_1*inv;
+            v[2].a = d23_2*inv;
+            v[0] = v[2];
+            count = 2;
+        }
+        else
+        {
+            // the origin is inside the triangle
+            T inv = 1/(d123_1+d123_2+d123_3);
+            v[0].a = d123_1*inv;
+            v[1].a = d123_2*inv;
+            v[2].a = d123_3*inv;
+            count = 3;
+        }
+    }
+
+    /**
+    * Direction from the simplex towards the origin (not normalized)
+    **/
+    Vector2D<T> SearchDirection()const
+    {
+        if(count==1)
+            return v[0].w.Reverse();
+        Vector2D<T> e12 = v[1].w-v[0].w;
+        return Cross(e12, v[0].w.Reverse())>0 ? e12.Perp() : e12.Perp2();
+    }
+
+    Vector2D<T> ClosestPoint()const
+    {
+        if(count==1)
+            return v[0].w;
+        return v[0].a*v[0].w+v[1].a*v[1].w;
+    }
+
+    void WitnessPoints(Vector2D<T>& pA, Vector2D<T>& pB)const
+    {
+        pA = v[0].a*v[0].wA;
+        pB = v[0].a*v[0].wB;
+        for(unsigned int k=1;k<count;k++)
+        {
+            pA += v[k].a*v[k].wA;
+            pB += v[k].a*v[k].wB;
+        }
+        if(count==3)
+            pB = pA;
+    }
+};
+
+/**
+* Run GJK on two convex vertex arrays
+* @return bool - true if the origin is in the Minkowski difference (the shapes intersect)
+**/
+template<class T>
+bool GJK(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, SimplexCache2D* cache, Simplex2D<T>& simplex, unsigned int& iterations)
+{
+    simplex.count = 0;
+    if(cache)
+    {
+        // start from the cached simplex (the indices are checked in case the shapes changed)
+        for(std::uint32_t k=0;k<cache->count && k<3;k++)
+        {
+            bool valid = cache->indexA[k]<a.size() && cache->indexB[k]<b.size();
+            for(unsigned int j=0;j<simplex.count;j++)
+                valid = valid && (simplex.v[j].indexA!=cache->indexA[k] || simplex.v[j].indexB!=cache->indexB[k]);
+            if(valid)
+                simplex.Set(simplex.count++, a, b, cache->indexA[k], cache->indexB[k]);
+        }
+    }
+    if(simplex.count==0)
+    {
+        simplex.Set(0, a, b, 0, 0);
+        simplex.count = 1;
+    }
+    // tolerance on the squared search direction, relative to the size of the simplex
+    T eps = 16*std::numeric_limits<T>::epsilon();
+    bool overlap = false;
+    iterations = 0;
+    while(iterations<GJKMaxIterations)
+    {
+        std::uint32_t savedA[3], savedB[3];
+        unsigned int saved = simplex.count;
+        T scaleSq = 0;
+        for(unsigned int k=0;k<saved;k++)
+        {
+            savedA[k] = simplex.v[k].indexA;
+            savedB[k] = simplex.v[k].indexB;
+            T lengthSq = simplex.v[k].w.LengthSq();
+            scaleSq = lengthSq>scaleSq ? lengthSq : scaleSq;
+        }
+        if(simplex.count==2)
+            simplex.Solve2();
+        else if(simplex.count==3)
+            simplex.Solve3();
+        if(simplex.count==3)
+        {
+            overlap = true;
+            break;
+        }
+        // the origin is on the simplex (touching shapes)
+        if(simplex.ClosestPoint().LengthSq()<=eps*eps*scaleSq)
+        {
+            overlap = true;
+            break;
+        }
+        Vector2D<T> d = simplex.SearchDirection();
+        std::uint32_t ia = Support(a, d), ib = Support(b, d.Reverse());
+        iterations++;
+        // no progress: the new vertex is already in the simplex
+        bool duplicate = false;
+        for(unsigned int k=0;k<saved;k++)
+            duplicate = duplicate || (savedA[k]==ia && savedB[k]==ib);
+        if(duplicate)
+            break;
+        simplex.Set(simplex.count++, a, b, ia, ib);
+    }
+    if(cache)
+    {
+        cache->count = simplex.count;
+        for(unsigned int k=0;k<simplex.count;k++)
+        {
+            cache->indexA[k] = simplex.v[k].indexA;
+            cache->indexB[k] = simplex.v[k].indexB;
+        }
+    }
+    return overlap;
+}
+
+/**
+* Support point of the Minkowski difference A-B along a direction
+**/
+template<class T>
+inline Vector2D<T> MinkowskiSupport(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, const Vector2D<T>& d)
+{
+    return a[Support(a, d)]-b[Support(b, d.Reverse())];
+}
+
+}
+
+/**
+* Distance between two convex shapes with GJK
+* The shapes are given by their vertices (any order, the convex hull of the vertices is used)
+* @param a - vertices of the first shape (not empty)
+* @param b - vertices of the second shape (not empty)
+* @param cache - optional warm start simplex (updated with the final simplex)
+* @return GJKResult2D - distance and closest points
+**/
+template<class T>
+GJKResult2D<T> GJKDistance(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, SimplexCache2D* cache = 0)
+{
+    detail::Simplex2D<T> simplex;
+    GJKResult2D<T> result;
+    bool overlap = detail::GJK(a, b, cache, simplex, result.iterations);
+    simplex.WitnessPoints(result.pointA, result.pointB);
+    if(overlap)
+    {
+        result.pointB = result.pointA;
+        result.distance = 0;
+    }
+    else
+        result.distance = result.pointA.Distance(result.pointB);
+    return result;
+}
+
+template<class T>
+GJKResult2D<T> GJKDistance(const Polygon2D<T>& a, const Polygon2D<T>& b, SimplexCache2D* cache = 0)
+{
+    return GJKDistance(Span<const Vector2D<T> >(a.Vertices()), Span<const Vector2D<T> >(b.Vertices()), cache);
+}
+
+/**
+* Check if two convex shapes intersect with GJK (touching counts as intersection)
+* @param a - vertices of the first shape (not empty)
+* @param b - vertices of the second shape (not empty)
+* @param cache - optional warm start simplex (updated with the final simplex)
+* @return bool - true if they intersect
+**/
+template<class T>
+bool GJKIntersect(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, SimplexCache2D* cache = 0)
+{
+    detail::Simplex2D<T> simplex;
+    unsigned int iterations;
+    return detail::GJK(a, b, cache, simplex, iterations);
+}
+
+template<class T>
+bool GJKIntersect(const Polygon2D<T>& a, const Polygon2D<T>& b, SimplexCache2D* cache = 0)
+{
+    return GJKIntersect(Span<const Vector2D<T> >(a.Vertices()), Span<const Vector2D<T> >(b.Vertices()), cache);
+}
+
+/**
+* Penetration depth and normal of two convex shapes (GJK, then EPA when they intersect)
+* EPA grows the final GJK triangle towards the boundary of the Minkowski difference A-B until the edge closest
+* to the origin is on the boundary; that edge gives the minimum translation (depth along normal)
+* @param a - vertices of the first shape (not empty)
+* @param b - vertices of the second shape (not empty)
+* @param cache - optional warm start simplex of GJK
+* @return Penetration2D - penetration depth and normal
+**/
+template<class T>
+Penetration2D<T> EPAPenetration(Span<const Vector2D<T> > a, Span<const Vector2D<T> > b, SimplexCache2D* cache = 0)
+{
+    detail::Simplex2D<T> simplex;
+    unsigned int iterations;
+    Penetration2D<T> result;
+    result.intersecting = detail::GJK(a, b, cache, simplex, iterations);
+    result.depth = 0;
+    if(!result.intersecting)
+    {
+        Vector2D<T> pA, pB;
+        simplex.WitnessPoints(pA, pB);
+        result.normal = pB-pA;
+        result.normal.Normalize();
+        return result;
+    }
+    // the polytope is a counter clockwise polygon around the origin
+    Vector2D<T> p[detail::EPAMaxVertices];
+    std::size_t n = simplex.count;
+    for(std::size_t k=0;k<n;k++)
+        p[k] = simplex.v[k].w;
+    T eps = 16*std::numeric_limits<T>::epsilon();
+    // GJK stopped on a point or a segment through the origin (touching shapes): grow it into a triangle
+    if(n==1)
+    {
+        const Vector2D<T> axes[4] = {Vector2D<T>(1, 0), Vector2D<T>(-1, 0), Vector2D<T>(0, 1), Vector2D<T>(0, -1)};
+        for(int k=0;k<4 && n==1;k++)
+        {
+            Vector2D<T> s = detail::MinkowskiSupport(a, b, axes[k]);
+            if(s!=p[0])
+                p[n++] = s;
+        }
+    }
+    if(n==2)
+    {
+        Vector2D<T> e = p[1]-p[0];
+        Vector2D<T> s = detail::MinkowskiSupport(a, b, e.Perp());
+        if(std::abs(detail::Cross(e, s-p[0]))<=eps*e.LengthSq())
+            s = detail::MinkowskiSupport(a, b, e.Perp2());
+        if(std::abs(detail::Cross(e, s-p[0]))>eps*e.LengthSq())
+            p[n++] = s;
+        else
+        {
+            // the Minkowski difference is flat (degenerate shapes)
+            result.normal = e.Perp2();
+            result.normal.Normalize();
+            return result;
+        }
+    }
+    if(n<3)
+    {
+        result.normal = Vector2D<T>(1, 0);
+        return result;
+    }
+    if(detail::Cross(p[1]-p[0], p[2]-p[0])<0)
+        std::swap(p[1], p[2]);
+    while(true)
+    {
+        // edge closest to the origin (outward normal of a counter clockwise edge is Perp2)
+        std::size_t best = 0;
+        T bestDistance = std::numeric_limits<T>::max();
+        Vector2D<T> bestNormal;
+        for(std::size_t i=0;i<n;i++)
+        {
+            Vector2D<T> normal = (p[i+1==n ? 0 : i+1]-p[i]).Perp2();
+            T length = normal.Length();
+            if(!(length>0))
+                continue;
+            normal *= 1/length;
+            T distance = normal*p[i];
+            if(distance<bestDistance)
+            {
+                bestDistance = distance;
+                best = i;
+                bestNormal = normal;
+            }
+        }
+        Vector2D<T> s = detail::MinkowskiSupport(a, b, bestNormal);
+        T reach = bestNormal*s;
+        T scale = std::abs(reach)>T(1) ? std::abs(reach) : T(1);
+        if(reach-bestDistance<=eps*scale || n==detail::EPAMaxVertices)
+        {
+            result.depth = bestDistance>0 ? bestDistance : T(0);
+            result.normal = bestNormal;
+            return result;
+        }
+        // replace the chain of edges seen from the support point by the point (keeps the polytope convex,
+        // the vertices of the GJK triangle are not always on the boundary of the Minkowski difference)
+        std::size_t first = best, last = best+1==n ? 0 : best+1;
+        for(std::size_t k=0;k+2<n;k++)
+        {
+            std::size_t prev = first==0 ? n-1 : first-1;
+            if(detail::Cross(p[first]-p[prev], s-p[prev])>=0)
+                break;
+            first = prev;
+        }
+        for(std::size_t k=0;k+2<n;k++)
+        {
+            std::size_t next = last+1==n ? 0 : last+1;
+            if(first==next || detail::Cross(p[next]-p[last], s-p[last])>=0)
+                break;
+            last = next;
+        }
+        Vector2D<T> q[detail::EPAMaxVertices];
+        std::size_t m = 0;
+        for(std::size_t k=last;;k=(k+1==n ? 0 : k+1))
+        {
+            q[m++] = p[k];
+            if(k==first)
+                break;
+        }
+        q[m++] = s;
+        for(std::size_t k=0;k<m;k++)
+            p[k] = q[k];
+        n = m;
+    }
+}
+
+template<class T>
+Penetration2D<T> EPAPenetration(const Polygon2D<T>& a, const Polygon2D<T>& b, SimplexCache2D* cache = 0)
+{
+    return EPAPenetration(Span<const Vector2D<T> >(a.Vertices()), Span<const Vector2D<T> >(b.Vertices()), cache);
+}
+
+typedef GJKResult2D<double> GJKResult2d;
+typedef GJKResult2D<float> GJKResult2;
+typedef Penetration2D<double> Penetration2d;
+typedef Penetration2D<float> Penetration2;
+
+}
+
+#endif
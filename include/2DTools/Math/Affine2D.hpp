@@ -0,0 +1,302 @@
+#ifndef AFFINE_2D_HPP
+#define AFFINE_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <2DTools/Misc/Helper.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Matrix2D.hpp>
+
+namespace Tools2D {
+
+/**
+* Affine 2D Transform Class (3x2 Matrix)
+* Same convention as Matrix2D (points are row vectors: p' = p*M) without the constant (0,0,1) column
+* Rows 0 and 1 hold the linear part, row 2 holds the translation
+* Translate/Scale/Rotate compose in closed form (no generic matrix multiplication)
+**/
+template<class T>
+class Affine2D
+{
+public:
+    typedef T DataType[3][2]; //Type of the Transform Data
+protected:
+    DataType data; //Transform Data (contiguous, row by row)
+public:
+    /**
+    * Default Constructor
+    * Initializes transform to Identity
+    **/
+    constexpr Affine2D():data{{1,0},{0,1},{0,0}}{}
+
+    /**
+    * Constructor
+    * @param m00, m01 - first row of the linear part
+    * @param m10, m11 - second row of the linear part
+    * @param tx, ty - translation
+    **/
+    constexpr Affine2D(const T& m00, const T& m01, const T& m10, const T& m11, const T& tx, const T& ty):data{{m00,m01},{m10,m11},{tx,ty}}{}
+
+    /**
+    * Constructor - from a Matrix2D (the constant column is dropped)
+    * @param mat - affine Matrix2D to copy from
+    **/
+    constexpr explicit Affine2D(const Matrix2D<T>& mat):data{{mat(0,0),mat(0,1)},{mat(1,0),mat(1,1)},{mat(2,0),mat(2,1)}}{}
+
+    /**
+    * Convert to Matrix2D
+    * @return Matrix2D - the equivalent 3x3 matrix
+    **/
+    constexpr Matrix2D<T> ToMatrix2D()const
+    {
+        Matrix2D<T> temp = Matrix2D<T>();
+        for(int i=0;i<3;i++)
+            for(int j=0;j<2;j++)
+                temp(i,j) = data[i][j];
+        return temp;
+    }
+
+    /**
+    * Make transform Identity
+    **/
+    constexpr void Identity()
+    {
+        data[0][0] = data[1][1] = 1;
+        data[0][1] = data[1][0] = 0;
+        data[2][0] = data[2][1] = 0;
+    }
+
+    /**
+    * Get Transform Data
+    * @return DataType - the 3x2 data (access as d[i][j])
+    **/
+    constexpr const DataType& getData()const
+    {
+        return data;
+    }
+
+    /**
+    * Get Translation part
+    * @return Vector2D - the translation
+    **/
+    constexpr Vector2D<T> Translation()const {return Vector2D<T>(data[2][0],data[2][1]);}
+
+    /**
+    * Translate this Transform (same as Matrix2D::Translate)
+    * @param dx - translation offset in x-axis
+    * @param dy - translation offset in y-axis
+    **/
+    constexpr void Translate(const T& dx, const T& dy)
+    {
+        data[2][0] += dx;
+        data[2][1] += dy;
+    }
+
+    /**
+    * Scale this Transform (same as Matrix2D::Scale)
+    * @param dx - scale offset in x-axis
+    * @param dy - scale offset in y-axis
+    **/
+    constexpr void Scale(const T& dx, const T& dy)
+    {
+        for(int i=0;i<3;i++)
+        {
+            data[i][0] *= dx;
+            data[i][1] *= dy;
+        }
+    }
+
+    /**
+    * Rotate this Transform (same as Matrix2D::Rotate)
+    * @param angle - angle in radians
+    **/
+    void Rotate(const T& angle)
+    {
+        T c = cos(angle);
+        T s = sin(angle);
+        RotateCS(c, s);
+    }
+
+    /**
+    * Rotate this Transform (same as Matrix2D::RotateDegrees)
+    * @param angle - angle in degrees
+    **/
+    void RotateDegrees(const T& angle)
+    {
+        T a = DegreesToRadians(angle);
+        Rotate(a);
+    }
+
+    /**
+    * Rotate this Transform with precomputed cosine/sine of the angle (avoids the trigonometric calls)
+    * @param c - cosine of the angle
+    * @param s - sine of the angle
+    **/
+    constexpr void RotateCS(const T& c, const T& s)
+    {
+        for(int i=0;i<3;i++)
+        {
+            T a = data[i][0];
+            T b = data[i][1];
+            data[i][0] = a*c-b*s;
+            data[i][1] = a*s+b*c;
+        }
+    }
+
+    /**
+    * Rotate this Transform to align with object that has fwd Forward vector and side Side vector
+    * @param fwd - the Forward Vector
+    * @param side - the Side Vector
+    **/
+    constexpr void Rotate(const Vector2D<T>& fwd, const Vector2D<T>& side)
+    {
+        for(int i=0;i<3;i++)
+        {
+            T a = data[i][0];
+            T b = data[i][1];
+            data[i][0] = a*fwd.X()+b*side.X();
+            data[i][1] = a*fwd.Y()+b*side.Y();
+        }
+    }
+
+    /**
+    * Get the Determinant of the Transform (of its linear part)
+    * @return T - the value of the Determinant
+    **/
+    constexpr T Det()const
+    {
+        return (data[0][0]*data[1][1]-data[0][1]*data[1][0]);
+    }
+
+    /**
+    * Get Inverse of the Transform
+    * @return Affine2D - the inversed transform (Identity if not invertible)
+    **/
+    constexpr Affine2D Inverse()const
+    {
+        T det = Det();
+        Affine2D temp = Affine2D();
+        if(det > std::numeric_limits<T>::epsilon() || det < -std::numeric_limits<T>::epsilon())
+        {
+            T inv = 1/det;
+            temp.data[0][0] = data[1][1]*inv;
+            temp.data[0][1] = -data[0][1]*inv;
+            temp.data[1][0] = -data[1][0]*inv;
+            temp.data[1][1] = data[0][0]*inv;
+            temp.data[2][0] = -(data[2][0]*temp.data[0][0]+data[2][1]*temp.data[1][0]);
+            temp.data[2][1] = -(data[2][0]*temp.data[0][1]+data[2][1]*temp.data[1][1]);
+        }
+        return temp;
+    }
+
+    /**
+    * Get Inverse of a Rigid Transform (rotation + translation only)
+    * Uses the transpose of the rotation - no determinant, no division
+    * @return Affine2D - the inversed transform
+    **/
+    constexpr Affine2D RigidInverse()const
+    {
+        Affine2D temp = Affine2D();
+        temp.data[0][0] = data[0][0];
+        temp.data[0][1] = data[1][0];
+        temp.data[1][0] = data[0][1];
+        temp.data[1][1] = data[1][1];
+        temp.data[2][0] = -(data[2][0]*data[0][0]+data[2][1]*data[0][1]);
+        temp.data[2][1] = -(data[2][0]*data[1][0]+data[2][1]*data[1][1]);
+        return temp;
+    }
+
+    /**
+    * Transform a point
+    * @param point - the point to transform
+    * @return Vector2D - the transformed point (point*this)
+    **/
+    constexpr Vector2D<T> Apply(const Vector2D<T>& point)const
+    {
+        return Vector2D<T>(point.X()*data[0][0]+point.Y()*data[1][0]+data[2][0],
+                           point.X()*data[0][1]+point.Y()*data[1][1]+data[2][1]);
+    }
+
+    /**
+    * Overload basic operators
+    * composition (*) - same order as Matrix2D multiplication (this transform first, then other)
+    **/
+    constexpr const Affine2D& operator*=(const Affine2D& other)
+    {
+        for(int i=0;i<3;i++)
+        {
+            T a = data[i][0];
+            T b = data[i][1];
+            data[i][0] = a*other.data[0][0]+b*other.data[1][0];
+            data[i][1] = a*other.data[0][1]+b*other.data[1][1];
+        }
+        data[2][0] += other.data[2][0];
+        data[2][1] += other.data[2][1];
+        return *this;
+    }
+
+    constexpr bool operator==(const Affine2D& other)const
+    {
+        for(int i=0;i<3;i++)
+            for(int j=0;j<2;j++)
+                if(data[i][j]!=other.data[i][j])
+                    return false;
+        return true;
+    }
+    constexpr bool operator!=(const Affine2D& other)const
+    {
+        return !((*this)==other);
+    }
+
+    /**
+    * Overloading () operator
+    * Access Transform Matlab-like
+    * @params i - row index to return (0-2)
+    * @params j - column index to return (0-1)
+    * @return T - value of i,j-th element
+    **/
+    constexpr T& operator()(unsigned int i, unsigned int j)
+    {
+        return data[i][j];
+    }
+
+    constexpr const T& operator()(unsigned int i, unsigned int j)const
+    {
+        return data[i][j];
+    }
+};
+
+/**
+* Functions Overloading basic operators
+* composition
+* transforming points
+**/
+
+template<class T>
+constexpr Affine2D<T> operator*(const Affine2D<T>& a1, const Affine2D<T>& a2)
+{
+    Affine2D<T> temp = a1;
+    temp *= a2;
+    return temp;
+}
+
+template<class T>
+constexpr Vector2D<T> operator*(const Vector2D<T>& vec, const Affine2D<T>& a)
+{
+    return a.Apply(vec);
+}
+
+template<class T>
+constexpr Vector2D<T> operator*(const Affine2D<T>& a, const Vector2D<T>& vec)
+{
+    return a.Apply(vec);
+}
+
+typedef Affine2D<double> Affine2d;
+typedef Affine2D<float> Affine2;
+
+}
+
+#endif
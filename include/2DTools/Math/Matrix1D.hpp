@@ -4,43 +4,102 @@
 /**
 * Includes
 **/
-#include <cstring>
 #include <cmath>
+#include <cstddef>
+#include <array>
+#include <2DTools/Misc/Helper.hpp>
 #include <2DTools/Math/Vector2D.hpp>
 
 namespace Tools2D {
 
+/**
+* Eigen decomposition of a 2x2 Matrix (returned by value, no allocation)
+* values are sorted in ascending order, vectors[i] corresponds to values[i]
+**/
+template<class T>
+struct Eigen2D
+{
+    std::array<T,2> values; // eigenvalues (values[0] <= values[1])
+    std::array<Vector2D<T>,2> vectors; // unit eigenvectors
+};
+
+/**
+* Closed form eigen decomposition of the symmetric 2x2 matrix [xx xy; xy yy]
+* Branch-free (the stable eigenvector row is picked with copysign), so it can be inlined in vectorized loops
+* @param xx, xy, yy - the matrix entries
+* @param l0 - smallest eigenvalue (output)
+* @param l1 - largest eigenvalue (output)
+* @param v1x, v1y - unit eigenvector of l1 (output); the eigenvector of l0 is (-v1y, v1x)
+**/
+template<class T>
+inline void EigenSymmetric2x2(T xx, T xy, T yy, T& l0, T& l1, T& v1x, T& v1y)
+{
+    T mean = (xx+yy)/2;
+    T diff = (xx-yy)/2;
+    T r = std::sqrt(diff*diff+xy*xy);
+    l0 = mean-r;
+    l1 = mean+r;
+    // p=1: use row (diff+r, xy), p=0: use row (xy, r-diff) - both are eigenvectors of l1
+    // (diff+0 turns -0 into +0, the tiny offset keeps the isotropic case at (1,0))
+    T p = (1+std::copysign(T(1), diff+T(0)))/2;
+    T x = p*(diff+r+std::sqrt(std::numeric_limits<T>::min()))+(1-p)*xy;
+    T y = p*xy+(1-p)*(r-diff);
+    T inv = 1/std::sqrt(x*x+y*y);
+    v1x = x*inv;
+    v1y = y*inv;
+}
+
+/**
+* Batch eigen decomposition of symmetric 2x2 matrices (e.g. covariances) stored in SoA layout
+* Matrix k is [xx[k] xy[k]; xy[k] yy[k]]. The loop is branch-free and auto-vectorizes (GCC needs -O3 -fno-math-errno for the sqrt).
+* Output arrays must not alias the input arrays.
+* @param xx, xy, yy - input arrays (n elements each)
+* @param n - number of matrices
+* @param l0, l1 - output eigenvalues (l0 <= l1)
+* @param v1x, v1y - output unit eigenvectors of l1 (the ones of l0 are (-v1y, v1x))
+**/
+template<class T>
+void EigenSymmetricBatch(const T* TOOLS2D_RESTRICT xx, const T* TOOLS2D_RESTRICT xy, const T* TOOLS2D_RESTRICT yy, std::size_t n,
+                         T* TOOLS2D_RESTRICT l0, T* TOOLS2D_RESTRICT l1, T* TOOLS2D_RESTRICT v1x, T* TOOLS2D_RESTRICT v1y)
+{
+    for(std::size_t k=0;k<n;k++)
+        EigenSymmetric2x2(xx[k], xy[k], yy[k], l0[k], l1[k], v1x[k], v1y[k]);
+}
+
 /**
 * Simple 1D Matrix Class (2x2 Matrix)
 **/
 template<class T>
 class Matrix1D
 {
+public:
+    typedef T DataType[2][2]; //Type of the Matrix Data
 protected:
-    T data[2][2]; //Matrix Data
+    DataType data; //Matrix Data (contiguous, row by row)
 public:
     /**
     * Default Constructor
     * Initializes matrix to Identity
     **/
-    Matrix1D(){ Identity();}
+    constexpr Matrix1D():data{{1,0},{0,1}}{}
 
     /**
-    * Copy Constructor
-    * @param other - Matrix2D to copy from
+    * Constructor
+    * @param m00, m01 - first row
+    * @param m10, m11 - second row
+    **/
+    constexpr Matrix1D(const T& m00, const T& m01, const T& m10, const T& m11):data{{m00,m01},{m10,m11}}{}
+
+    /**
+    * Copy/Move Constructors and Assignments are the implicit ones
+    * Data is stored inline (no heap), so Matrix1D is trivially copyable
     **/
-    Matrix1D(const Matrix1D& other)
-    {
-        for(int i=0;i<2;i++)
-            for(int j=0;j<2;j++)
-                data[i][j] = other.data[i][j];
-    }
 
     /**
     * Constructor
     * @param table - 2-dimensional table to copy data from
     **/
-    Matrix1D(T** table)
+    Matrix1D(T** table):data()
     {
         for(int i=0;i<2;i++)
             for(int j=0;j<2;j++)
@@ -50,25 +109,19 @@ public:
     /**
     * Make matrix Identity
     **/
-    void Identity()
+    constexpr void Identity()
     {
-        memset(data, 0, 4*sizeof(T));
+        data[0][1] = data[1][0] = 0;
         data[0][0] = data[1][1] = 1;
     }
 
     /**
     * Get Matrix Data
-    * @return T - the data
+    * Returns a reference to the inline storage (no copy, no allocation)
+    * @return DataType - the 2x2 data (access as d[i][j])
     **/
-    T** getData()
+    constexpr const DataType& getData()const
     {
-        T** data;
-        data = new T*[2];
-        for(int i=0;i<2;i++)
-        {
-            data[i] = new T[2];
-            memcpy(data[i],this->data[i],2*sizeof(T));
-        }
         return data;
     }
 
@@ -76,7 +129,7 @@ public:
     * Get Transpose of the Matrix
     * @return Matrix1D - the transposed matrix
     **/
-    Matrix1D Transpose()
+    constexpr Matrix1D Transpose()const
     {
         Matrix1D temp = Matrix1D();
         for(int i=0;i<2;i++)
@@ -91,7 +144,7 @@ public:
     * Get the Determinant of the Matrix
     * @return T - the value of the Determinant
     **/
-    T Det()const
+    constexpr T Det()const
     {
         return (data[0][0]*data[1][1]-data[0][1]*data[1][0]);
     }
@@ -100,18 +153,18 @@ public:
     * Get the Trace of the Matrix
     * @return T - the value of the Trace
     **/
-    T Trace()const
+    constexpr T Trace()const
     {
         return (data[0][0]+data[1][1]);
     }
 
     /**
     * Get the eigenvalues of the Matrix
-    * @return T[2] - array with the eigenvalues
+    * @return array<T,2> - array with the eigenvalues
     **/
-    T* Eigenvalues()const
+    std::array<T,2> Eigenvalues()const
     {
-        T* eigen = new T[2];
+        std::array<T,2> eigen;
         T t = Trace();
         T d = Det();
         eigen[0] = t/2+sqrt(t*t/4-d);
@@ -121,12 +174,12 @@ public:
 
     /**
     * Get the eigen vectors of the Matrix
-    * @return Vector2D[2] - array with the eigen vectors
+    * @return array<Vector2D,2> - array with the eigen vectors
     **/
-    Vector2D<T>* Eigenvectors()const
+    std::array<Vector2D<T>,2> Eigenvectors()const
     {
-        Vector2D<T>* eigenV = new Vector2D<T>[2];
-        T* eigen = Eigenvalues();
+        std::array<Vector2D<T>,2> eigenV;
+        std::array<T,2> eigen = Eigenvalues();
 
         if(std::abs(data[1][0]) > std::numeric_limits<T>::epsilon())
         {
@@ -151,8 +204,8 @@ public:
     **/
     void EigenDiagonalize(Matrix1D<T>& D, Matrix1D<T>& Q)const
     {
-        T* eigen = Eigenvalues();
-        Vector2D<T>* eigenV = Eigenvectors();
+        std::array<T,2> eigen = Eigenvalues();
+        std::array<Vector2D<T>,2> eigenV = Eigenvectors();
         if(eigen[0] > eigen[1])
         {
             T tmp = eigen[0];
@@ -172,15 +225,30 @@ public:
         Q(1,1) = eigenV[1].Y();
     }
 
+    /**
+    * Get the eigen decomposition of a symmetric Matrix (closed form, no allocation)
+    * Only the upper triangle is used (data[1][0] is assumed equal to data[0][1])
+    * @return Eigen2D - eigenvalues in ascending order and orthonormal eigenvectors
+    **/
+    Eigen2D<T> EigenSymmetric()const
+    {
+        Eigen2D<T> res;
+        T v1x, v1y;
+        EigenSymmetric2x2(data[0][0], data[0][1], data[1][1], res.values[0], res.values[1], v1x, v1y);
+        res.vectors[0] = Vector2D<T>(-v1y, v1x);
+        res.vectors[1] = Vector2D<T>(v1x, v1y);
+        return res;
+    }
+
     /**
     * Get Inverse of the Matrix
     * @return Matrix1D - the inversed matrix
     **/
-    Matrix1D Inverse()
+    constexpr Matrix1D Inverse()const
     {
         T det = Det();
         Matrix1D temp = Matrix1D();
-        if(std::abs(det) > std::numeric_limits<T>::epsilon())
+        if(det > std::numeric_limits<T>::epsilon() || det < -std::numeric_limits<T>::epsilon())
         {
             temp.data[0][0] = data[1][1];
             temp.data[0][1] = -data[0][1];
@@ -195,7 +263,7 @@ public:
     * Overload basic operators
     * mathematic operators (*,/)
     **/
-    const Matrix1D& operator*=(const T& other)
+    constexpr const Matrix1D& operator*=(const T& other)
     {
         for(int i=0;i<2;i++)
         {
@@ -205,10 +273,10 @@ public:
         return *this;
     }
 
-    const Matrix1D& operator/=(const T& other)
+    constexpr const Matrix1D& operator/=(const T& other)
     {
         // Divide only if other is not zero
-        if(std::abs(other) > std::numeric_limits<T>::epsilon())
+        if(other > std::numeric_limits<T>::epsilon() || other < -std::numeric_limits<T>::epsilon())
         {
             for(int i=0;i<2;i++)
             {
@@ -219,7 +287,7 @@ public:
         return *this;
     }
 
-    const Matrix1D& operator*=(const Matrix1D& other)
+    constexpr const Matrix1D& operator*=(const Matrix1D& other)
     {
         Matrix1D temp = Matrix1D();
         temp.data[0][0] = data[0][0]*other.data[0][0]+data[0][1]*other.data[1][0];
@@ -231,7 +299,7 @@ public:
         return *this;
     }
 
-    const Matrix1D& operator-=(const Matrix1D& other)
+    constexpr const Matrix1D& operator-=(const Matrix1D& other)
     {
         Matrix1D temp = Matrix1D();
         temp.data[0][0] = data[0][0]-other.data[0][0];
@@ -242,7 +310,7 @@ public:
         return *this;
     }
 
-    const Matrix1D& operator+=(const Matrix1D& other)
+    constexpr const Matrix1D& operator+=(const Matrix1D& other)
     {
         Matrix1D temp = Matrix1D();
         temp.data[0][0] = data[0][0]+other.data[0][0];
@@ -260,14 +328,15 @@ public:
     * @params j - column index to return
     * @return T - value of i,j-th element
     **/
-    T& operator()(unsigned int i, unsigned int j)
+    constexpr T& operator()(unsigned int i, unsigned int j)
     {
         return data[i][j];
     }
 
-    template<class U>
-    friend Vector2D<U> operator*(Vector2D<U>& vec, const Matrix1D<U>& mat);
-    friend const Vector2D<T>& Vector2D<T>::operator *=(const Matrix1D& other);
+    constexpr const T& operator()(unsigned int i, unsigned int j)const
+    {
+        return data[i][j];
+    }
 };
 
 /**
@@ -278,7 +347,7 @@ public:
 **/
 
 template<class T>
-Matrix1D<T> operator*(const Matrix1D<T>& mat1, T val)
+constexpr Matrix1D<T> operator*(const Matrix1D<T>& mat1, T val)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp *= val;
@@ -286,7 +355,7 @@ Matrix1D<T> operator*(const Matrix1D<T>& mat1, T val)
 }
 
 template<class T>
-Matrix1D<T> operator*(T val, const Matrix1D<T>& mat1)
+constexpr Matrix1D<T> operator*(T val, const Matrix1D<T>& mat1)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp *= val;
@@ -294,7 +363,7 @@ Matrix1D<T> operator*(T val, const Matrix1D<T>& mat1)
 }
 
 template<class T>
-Matrix1D<T> operator/(const Matrix1D<T>& mat1, const T& val)
+constexpr Matrix1D<T> operator/(const Matrix1D<T>& mat1, const T& val)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp /= val;
@@ -302,21 +371,15 @@ Matrix1D<T> operator/(const Matrix1D<T>& mat1, const T& val)
 }
 
 template<class T>
-Matrix1D<T> operator/(const T& val, const Matrix1D<T>& mat1)
+constexpr Matrix1D<T> operator/(const T& val, const Matrix1D<T>& mat1)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
-    if(std::abs(val) > std::numeric_limits<T>::epsilon())
-    {
-        temp.data[0][0] /= val;
-        temp.data[0][1] /= val;
-        temp.data[1][0] /= val;
-        temp.data[1][1] /= val;
-    }
+    temp /= val;
     return temp;
 }
 
 template<class T>
-Matrix1D<T> operator*(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
+constexpr Matrix1D<T> operator*(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp *= mat2;
@@ -324,16 +387,15 @@ Matrix1D<T> operator*(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 }
 
 template<class T>
-Matrix1D<T> operator-(const Matrix1D<T>& mat)
+constexpr Matrix1D<T> operator-(const Matrix1D<T>& mat)
 {
-    Matrix1D<T> temp;
-    temp.data[0][0] = temp.data[1][1] = 0.0;
+    Matrix1D<T> temp = Matrix1D<T>(0, 0, 0, 0);
     temp -= mat;
     return temp;
 }
 
 template<class T>
-Matrix1D<T> operator-(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
+constexpr Matrix1D<T> operator-(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp -= mat2;
@@ -341,7 +403,7 @@ Matrix1D<T> operator-(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 }
 
 template<class T>
-Matrix1D<T> operator+(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
+constexpr Matrix1D<T> operator+(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 {
     Matrix1D<T> temp = Matrix1D<T>(mat1);
     temp += mat2;
@@ -349,16 +411,16 @@ Matrix1D<T> operator+(const Matrix1D<T>& mat1, const Matrix1D<T>& mat2)
 }
 
 template<class T>
-Vector2D<T> operator*(Vector2D<T>& vec, const Matrix1D<T>& mat)
+constexpr Vector2D<T> operator*(const Vector2D<T>& vec, const Matrix1D<T>& mat)
 {
     Vector2D<T> temp = Vector2D<T>();
-    temp.SetX(vec.X()*mat.data[0][0]+vec.Y()*mat.data[1][0]);
-    temp.SetY(vec.X()*mat.data[0][1]+vec.Y()*mat.data[1][1]);
+    temp.SetX(vec.X()*mat(0,0)+vec.Y()*mat(1,0));
+    temp.SetY(vec.X()*mat(0,1)+vec.Y()*mat(1,1));
     return temp;
 }
 
 template<class T>
-Vector2D<T> operator*(const Matrix1D<T>& m, Vector2D<T>& vec)
+constexpr Vector2D<T> operator*(const Matrix1D<T>& m, const Vector2D<T>& vec)
 {
     Vector2D<T> temp = Vector2D<T>(vec);
     temp = temp*m;
@@ -366,11 +428,11 @@ Vector2D<T> operator*(const Matrix1D<T>& m, Vector2D<T>& vec)
 }
 
 template<class T>
-const Vector2D<T>& Vector2D<T>::operator *=(const Matrix1D<T>& other)
+constexpr const Vector2D<T>& Vector2D<T>::operator *=(const Matrix1D<T>& other)
 {
     Vector2D<T> temp;
-    temp.x = x*other.data[0][0]+y*other.data[1][0];
-    temp.y = x*other.data[0][1]+y*other.data[1][1];
+    temp.x = x*other(0,0)+y*other(1,0);
+    temp.y = x*other(0,1)+y*other(1,1);
     (*this) = temp;
     return *this;
 }
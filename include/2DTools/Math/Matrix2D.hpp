@@ -4,7 +4,8 @@
 /**
 * Includes
 **/
-#include <cstring>
+#include <cmath>
+#include <2DTools/Misc/Helper.hpp>
 #include <2DTools/Math/Vector2D.hpp>
 
 namespace Tools2D {
@@ -15,31 +16,37 @@ namespace Tools2D {
 template<class T>
 class Matrix2D
 {
+public:
+    typedef T DataType[3][3]; //Type of the Matrix Data
 protected:
-    T data[3][3]; //Matrix Data
+    DataType data; //Matrix Data (contiguous, row by row)
 public:
     /**
     * Default Constructor
     * Initializes matrix to Identity
     **/
-    Matrix2D(){ Identity();}
+    constexpr Matrix2D():data{{1,0,0},{0,1,0},{0,0,1}}{}
 
     /**
-    * Copy Constructor
-    * @param other - Matrix2D to copy from
+    * Constructor
+    * @param m00, m01, m02 - first row
+    * @param m10, m11, m12 - second row
+    * @param m20, m21, m22 - third row
+    **/
+    constexpr Matrix2D(const T& m00, const T& m01, const T& m02,
+                       const T& m10, const T& m11, const T& m12,
+                       const T& m20, const T& m21, const T& m22):data{{m00,m01,m02},{m10,m11,m12},{m20,m21,m22}}{}
+
+    /**
+    * Copy/Move Constructors and Assignments are the implicit ones
+    * Data is stored inline (no heap), so Matrix2D is trivially copyable
     **/
-    Matrix2D(const Matrix2D& other)
-    {
-        for(int i=0;i<3;i++)
-            for(int j=0;j<3;j++)
-                data[i][j] = other.data[i][j];
-    }
 
     /**
     * Constructor
     * @param table - 2-dimensional table to copy data from
     **/
-    Matrix2D(T** table)
+    Matrix2D(T** table):data()
     {
         for(int i=0;i<3;i++)
             for(int j=0;j<3;j++)
@@ -49,25 +56,20 @@ public:
     /**
     * Make matrix Identity
     **/
-    void Identity()
+    constexpr void Identity()
     {
-        memset(data, 0, 9*sizeof(T));
-        data[0][0] = data[1][1] = data[2][2] = 1;
+        for(int i=0;i<3;i++)
+            for(int j=0;j<3;j++)
+                data[i][j] = (i==j) ? 1 : 0;
     }
 
     /**
     * Get Matrix Data
-    * @return T - the data
+    * Returns a reference to the inline storage (no copy, no allocation)
+    * @return DataType - the 3x3 data (access as d[i][j])
     **/
-    T** getData()
+    constexpr const DataType& getData()const
     {
-        T** data;
-        data = new T*[3];
-        for(int i=0;i<3;i++)
-        {
-            data[i] = new T[3];
-            memcpy(data[i],this->data[i],3*sizeof(T));
-        }
         return data;
     }
 
@@ -76,7 +78,7 @@ public:
     * @param dx - translation offset in x-axis
     * @param dy - translation offset in y-axis
     **/
-    void Translate(const T& dx, const T& dy)
+    constexpr void Translate(const T& dx, const T& dy)
     {
         Matrix2D temp = Matrix2D();
         temp.data[2][0] = dx;
@@ -89,7 +91,7 @@ public:
     * @param dx - scale offset in x-axis
     * @param dy - scale offset in y-axis
     **/
-    void Scale(const T& dx, const T& dy)
+    constexpr void Scale(const T& dx, const T& dy)
     {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = dx;
@@ -103,8 +105,16 @@ public:
     **/
     void Rotate(const T& angle)
     {
-        double c = cos(angle);
-        double s = sin(angle);
+        RotateCS(cos(angle), sin(angle));
+    }
+
+    /**
+    * Rotate this Matrix with precomputed cosine/sine of the angle (usable in constant expressions)
+    * @param c - cosine of the angle
+    * @param s - sine of the angle
+    **/
+    constexpr void RotateCS(const T& c, const T& s)
+    {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = c;
         temp.data[0][1] = s;
@@ -128,7 +138,7 @@ public:
     * @param fwd - the Forward Vector
     * @param side - the Side Vector
     **/
-    void Rotate(const Vector2D<T>& fwd, const Vector2D<T>& side)
+    constexpr void Rotate(const Vector2D<T>& fwd, const Vector2D<T>& side)
     {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = fwd.X();
@@ -142,7 +152,7 @@ public:
     * Get Transpose of the Matrix
     * @return Matrix2D - the transposed matrix
     **/
-    Matrix2D Transpose()
+    constexpr Matrix2D Transpose()const
     {
         Matrix2D temp = Matrix2D();
         for(int i=0;i<3;i++)
@@ -157,16 +167,16 @@ public:
     * Get the Determinant of the Matrix
     * @return T - the value of the Determinant
     **/
-    T Det()const
+    constexpr T Det()const
     {
-        return (data[0][0]*data[1][1]*data[2][2]-data[0][0]*data[1][2]*data[2][1]-data[0][1]*data[1][0]*data[2][2]+data[0][1]*data[1][2]*data[0][2]+data[0][2]*data[1][0]*data[2][1]-data[0][2]*data[1][1]*data[2][0]);
+        return (data[0][0]*data[1][1]*data[2][2]-data[0][0]*data[1][2]*data[2][1]-data[0][1]*data[1][0]*data[2][2]+data[0][1]*data[1][2]*data[2][0]+data[0][2]*data[1][0]*data[2][1]-data[0][2]*data[1][1]*data[2][0]);
     }
 
     /**
     * Get the Trace of the Matrix
     * @return T - the value of the Trace
     **/
-    T Trace()const
+    constexpr T Trace()const
     {
         return (data[0][0]+data[1][1]+data[2][2]);
     }
@@ -175,15 +185,15 @@ public:
     * Get Inverse of the Matrix
     * @return Matrix2D - the inversed matrix
     **/
-    Matrix2D Inverse()
+    constexpr Matrix2D Inverse()const
     {
         T det = Det();
         Matrix2D temp = Matrix2D();
-        if(det > std::numeric_limits<T>::epsilon())
+        if(det > std::numeric_limits<T>::epsilon() || det < -std::numeric_limits<T>::epsilon())
         {
             temp.data[0][0] = data[2][2]*data[1][1]-data[2][1]*data[1][2];
-            temp.data[0][1] = -(data[2][2]*data[0][2]-data[2][1]*data[0][2]);
-            temp.data[0][2] = data[1][2]*data[0][2]-data[1][1]*data[0][2];
+            temp.data[0][1] = -(data[2][2]*data[0][1]-data[2][1]*data[0][2]);
+            temp.data[0][2] = data[1][2]*data[0][1]-data[1][1]*data[0][2];
             temp.data[1][0] = -(data[2][2]*data[1][0]-data[2][0]*data[1][2]);
             temp.data[1][1] = data[2][2]*data[0][0]-data[2][0]*data[0][2];
             temp.data[1][2] = -(data[1][2]*data[0][0]-data[1][0]*data[0][2]);
@@ -199,7 +209,7 @@ public:
     * Overload basic operators
     * mathematic operators (*,/)
     **/
-    const Matrix2D& operator*=(const T& other)
+    constexpr const Matrix2D& operator*=(const T& other)
     {
         for(int i=0;i<3;i++)
         {
@@ -209,10 +219,10 @@ public:
         return *this;
     }
 
-    const Matrix2D& operator/=(const T& other)
+    constexpr const Matrix2D& operator/=(const T& other)
     {
         // Divide only if other is not zero
-        if(std::abs(other) > std::numeric_limits<T>::epsilon())
+        if(other > std::numeric_limits<T>::epsilon() || other < -std::numeric_limits<T>::epsilon())
         {
             for(int i=0;i<3;i++)
             {
@@ -223,7 +233,7 @@ public:
         return *this;
     }
 
-    const Matrix2D& operator*=(const Matrix2D& other)
+    constexpr const Matrix2D& operator*=(const Matrix2D& other)
     {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = data[0][0]*other.data[0][0]+data[0][1]*other.data[1][0]+data[0][2]*other.data[2][0];
@@ -241,7 +251,7 @@ public:
         return *this;
     }
 
-    const Matrix2D& operator-=(const Matrix2D& other)
+    constexpr const Matrix2D& operator-=(const Matrix2D& other)
     {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = data[0][0]-other.data[0][0];
@@ -257,7 +267,7 @@ public:
         return *this;
     }
 
-    const Matrix2D& operator+=(const Matrix2D& other)
+    constexpr const Matrix2D& operator+=(const Matrix2D& other)
     {
         Matrix2D temp = Matrix2D();
         temp.data[0][0] = data[0][0]+other.data[0][0];
@@ -280,14 +290,15 @@ public:
     * @params j - column index to return
     * @return T - value of i,j-th element
     **/
-    T& operator()(unsigned int i, unsigned int j)
+    constexpr T& operator()(unsigned int i, unsigned int j)
     {
         return data[i][j];
     }
 
-    template<class U>
-    friend Vector2D<U> operator*(Vector2D<U>& vec, const Matrix2D<U>& mat);
-    friend const Vector2D<T>& Vector2D<T>::operator *=(const Matrix2D& other);
+    constexpr const T& operator()(unsigned int i, unsigned int j)const
+    {
+        return data[i][j];
+    }
 };
 
 /**
@@ -298,7 +309,7 @@ public:
 **/
 
 template<class T>
-Matrix2D<T> operator*(const Matrix2D<T>& mat1, T val)
+constexpr Matrix2D<T> operator*(const Matrix2D<T>& mat1, T val)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp *= val;
@@ -306,7 +317,7 @@ Matrix2D<T> operator*(const Matrix2D<T>& mat1, T val)
 }
 
 template<class T>
-Matrix2D<T> operator*(T val, const Matrix2D<T>& mat1)
+constexpr Matrix2D<T> operator*(T val, const Matrix2D<T>& mat1)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp *= val;
@@ -314,7 +325,7 @@ Matrix2D<T> operator*(T val, const Matrix2D<T>& mat1)
 }
 
 template<class T>
-Matrix2D<T> operator/(const Matrix2D<T>& mat1, const T& val)
+constexpr Matrix2D<T> operator/(const Matrix2D<T>& mat1, const T& val)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp /= val;
@@ -322,26 +333,15 @@ Matrix2D<T> operator/(const Matrix2D<T>& mat1, const T& val)
 }
 
 template<class T>
-Matrix2D<T> operator/(const T& val, const Matrix2D<T>& mat1)
+constexpr Matrix2D<T> operator/(const T& val, const Matrix2D<T>& mat1)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
-    if(std::abs(val) > std::numeric_limits<T>::epsilon())
-    {
-        temp.data[0][0] /= val;
-        temp.data[0][1] /= val;
-        temp.data[0][2] /= val;
-        temp.data[1][0] /= val;
-        temp.data[1][1] /= val;
-        temp.data[1][2] /= val;
-        temp.data[2][0] /= val;
-        temp.data[2][1] /= val;
-        temp.data[2][2] /= val;
-    }
+    temp /= val;
     return temp;
 }
 
 template<class T>
-Matrix2D<T> operator*(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
+constexpr Matrix2D<T> operator*(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp *= mat2;
@@ -349,16 +349,15 @@ Matrix2D<T> operator*(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 }
 
 template<class T>
-Matrix2D<T> operator-(const Matrix2D<T>& mat)
+constexpr Matrix2D<T> operator-(const Matrix2D<T>& mat)
 {
-    Matrix2D<T> temp;
-    temp.data[0][0] = temp.data[1][1] = temp.data[2][2] = 0.0;
+    Matrix2D<T> temp = Matrix2D<T>(0, 0, 0, 0, 0, 0, 0, 0, 0);
     temp -= mat;
     return temp;
 }
 
 template<class T>
-Matrix2D<T> operator-(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
+constexpr Matrix2D<T> operator-(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp -= mat2;
@@ -366,7 +365,7 @@ Matrix2D<T> operator-(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 }
 
 template<class T>
-Matrix2D<T> operator+(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
+constexpr Matrix2D<T> operator+(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 {
     Matrix2D<T> temp = Matrix2D<T>(mat1);
     temp += mat2;
@@ -374,16 +373,16 @@ Matrix2D<T> operator+(const Matrix2D<T>& mat1, const Matrix2D<T>& mat2)
 }
 
 template<class T>
-Vector2D<T> operator*(Vector2D<T>& vec, const Matrix2D<T>& mat)
+constexpr Vector2D<T> operator*(const Vector2D<T>& vec, const Matrix2D<T>& mat)
 {
     Vector2D<T> temp = Vector2D<T>();
-    temp.SetX(vec.X()*mat.data[0][0]+vec.Y()*mat.data[1][0]+mat.data[2][0]);
-    temp.SetY(vec.X()*mat.data[0][1]+vec.Y()*mat.data[1][1]+mat.data[2][1]);
+    temp.SetX(vec.X()*mat(0,0)+vec.Y()*mat(1,0)+mat(2,0));
+    temp.SetY(vec.X()*mat(0,1)+vec.Y()*mat(1,1)+mat(2,1));
     return temp;
 }
 
 template<class T>
-Vector2D<T> operator*(const Matrix2D<T>& m, Vector2D<T>& vec)
+constexpr Vector2D<T> operator*(const Matrix2D<T>& m, const Vector2D<T>& vec)
 {
     Vector2D<T> temp = Vector2D<T>(vec);
     temp = temp*m;
@@ -391,11 +390,11 @@ Vector2D<T> operator*(const Matrix2D<T>& m, Vector2D<T>& vec)
 }
 
 template<class T>
-const Vector2D<T>& Vector2D<T>::operator *=(const Matrix2D<T>& other)
+constexpr const Vector2D<T>& Vector2D<T>::operator *=(const Matrix2D<T>& other)
 {
     Vector2D<T> temp;
-    temp.x = x*other.data[0][0]+y*other.data[1][0]+other.data[2][0];
-    temp.y = x*other.data[0][1]+y*other.data[1][1]+other.data[2][1];
+    temp.x = x*other(0,0)+y*other(1,0)+other(2,0);
+    temp.y = x*other(0,1)+y*other(1,1)+other(2,1);
     (*this) = temp;
     return *this;
 }
@@ -0,0 +1,123 @@
+#ifndef PREDICATES_2D_HPP
+#define PREDICATES_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <limits>
+#include <2DTools/Math/Vector2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* Error free transformations: x+y is exactly a+b (a-b, a*b), x being the rounded result
+**/
+inline void TwoSum(double a, double b, double& x, double& y)
+{
+    x = a+b;
+    double bv = x-a, av = x-bv;
+    y = (a-av)+(b-bv);
+}
+
+inline void TwoDiff(double a, double b, double& x, double& y)
+{
+    x = a-b;
+    double bv = a-x, av = x+bv;
+    y = (a-av)+(bv-b);
+}
+
+inline void TwoProduct(double a, double b, double& x, double& y)
+{
+    x = a*b;
+    y = std::fma(a, b, -x);
+}
+
+/**
+* Add a double to an expansion (components of increasing magnitude that do not overlap, zeros allowed)
+* @return int - the new number of components (one more)
+**/
+inline int GrowExpansion(double* e, int n, double b)
+{
+    double q = b;
+    for(int i=0;i<n;i++)
+        TwoSum(q, e[i], q, e[i]);
+    e[n] = q;
+    return n+1;
+}
+
+/**
+* Exact orientation of three points: (a-c)x(b-c) as an expansion, its sign is the sign of the largest component
+**/
+inline double OrientExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double acx[2], acy[2], bcx[2], bcy[2];
+    TwoDiff(ax, cx, acx[1], acx[0]);
+    TwoDiff(ay, cy, acy[1], acy[0]);
+    TwoDiff(bx, cx, bcx[1], bcx[0]);
+    TwoDiff(by, cy, bcy[1], bcy[0]);
+    double e[17];
+    int n = 0;
+    for(int i=0;i<2;i++)
+        for(int j=0;j<2;j++)
+        {
+            double x, y;
+            TwoProduct(acx[i], bcy[j], x, y);
+            n = GrowExpansion(e, n, y);
+            n = GrowExpansion(e, n, x);
+            TwoProduct(-acy[i], bcx[j], x, y);
+            n = GrowExpansion(e, n, y);
+            n = GrowExpansion(e, n, x);
+        }
+    for(int i=n-1;i>=0;i--)
+        if(e[i]!=0)
+            return e[i];
+    return 0;
+}
+
+}
+
+/**
+* Orientation of the triangle (a, b, c)
+* The sign is exact (no rounding, whatever the compiler contracts into fused multiply-adds): the determinant is
+* computed in floating point first and only recomputed exactly when it is smaller than its error bound
+* @param a, b, c - the points
+* @return double - positive if counter clockwise, negative if clockwise, zero if collinear (about twice the area)
+**/
+inline double Orient2D(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    double left = (ax-cx)*(by-cy), right = (ay-cy)*(bx-cx);
+    double det = left-right;
+    // Shewchuk's bound for this expression
+    const double epsilon = std::numeric_limits<double>::epsilon()/2;
+    double bound = (3+16*epsilon)*epsilon*(std::fabs(left)+std::fabs(right));
+    if(det>bound || -det>bound)
+        return det;
+    return detail::OrientExact(ax, ay, bx, by, cx, cy);
+}
+
+/**
+* Orientation of the triangle (a, b, c) in float: floats are exact in double but their differences are not (1e20f
+* against 1e-20f), so the double filter and its exact fallback decide the sign
+**/
+inline float Orient2D(float ax, float ay, float bx, float by, float cx, float cy)
+{
+    double det = Orient2D(double(ax), double(ay), double(bx), double(by), double(cx), double(cy));
+    float result = float(det);
+    // keep the sign of a determinant too small for a float
+    if(result==0 && det!=0)
+        result = det>0 ? std::numeric_limits<float>::denorm_min() : -std::numeric_limits<float>::denorm_min();
+    return result;
+}
+
+template<class T>
+inline T Orient2D(const Vector2D<T>& a, const Vector2D<T>& b, const Vector2D<T>& c)
+{
+    return Orient2D(a.X(), a.Y(), b.X(), b.Y(), c.X(), c.Y());
+}
+
+}
+
+#endif
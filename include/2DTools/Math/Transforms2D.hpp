@@ -0,0 +1,298 @@
+#ifndef TRANSFORMS_2D_HPP
+#define TRANSFORMS_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <2DTools/Misc/Simd.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Matrix2D.hpp>
+#include <2DTools/Math/Affine2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* The six coefficients used to transform a point (same convention as Matrix2D)
+* x' = x*a+y*c+e
+* y' = x*b+y*d+f
+**/
+template<class T>
+struct AffineCoeffs
+{
+    T a, b, c, d, e, f;
+};
+
+template<class T>
+AffineCoeffs<T> Coeffs(const Matrix2D<T>& m)
+{
+    AffineCoeffs<T> res = {m(0,0), m(0,1), m(1,0), m(1,1), m(2,0), m(2,1)};
+    return res;
+}
+
+template<class T>
+AffineCoeffs<T> Coeffs(const Affine2D<T>& m)
+{
+    AffineCoeffs<T> res = {m(0,0), m(0,1), m(1,0), m(1,1), m(2,0), m(2,1)};
+    return res;
+}
+
+/**
+* Scalar kernels (also used for the remainder of the SIMD kernels)
+* Interleaved layout: in/out hold x0,y0,x1,y1,... (points [start, n) are processed)
+* Inputs are read before outputs are written, so in==out is allowed
+**/
+template<class T>
+inline void TransformInterleavedScalar(const AffineCoeffs<T>& m, const T* in, T* out, std::size_t start, std::size_t n)
+{
+    for(std::size_t i=start;i<n;i++)
+    {
+        T x = in[2*i];
+        T y = in[2*i+1];
+        out[2*i] = x*m.a+y*m.c+m.e;
+        out[2*i+1] = x*m.b+y*m.d+m.f;
+    }
+}
+
+template<class T>
+inline void TransformSoAScalar(const AffineCoeffs<T>& m, const T* inX, const T* inY, T* outX, T* outY, std::size_t start, std::size_t n)
+{
+    for(std::size_t i=start;i<n;i++)
+    {
+        T x = inX[i];
+        T y = inY[i];
+        outX[i] = x*m.a+y*m.c+m.e;
+        outY[i] = x*m.b+y*m.d+m.f;
+    }
+}
+
+template<class T>
+inline void TransformInterleaved(const AffineCoeffs<T>& m, const T* in, T* out, std::size_t n)
+{
+    TransformInterleavedScalar(m, in, out, 0, n);
+}
+
+template<class T>
+inline void TransformSoA(const AffineCoeffs<T>& m, const T* inX, const T* inY, T* outX, T* outY, std::size_t n)
+{
+    TransformSoAScalar(m, inX, inY, outX, outY, 0, n);
+}
+
+/**
+* SIMD kernels for float and double
+* Interleaved: each register holds whole points, x and y lanes are duplicated with shuffles
+* SoA: straight broadcast multiply-adds
+**/
+#if defined(TOOLS2D_SSE2)
+inline void TransformInterleaved(const AffineCoeffs<float>& m, const float* in, float* out, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(TOOLS2D_AVX2)
+    {
+        __m256 ab = _mm256_setr_ps(m.a, m.b, m.a, m.b, m.a, m.b, m.a, m.b);
+        __m256 cd = _mm256_setr_ps(m.c, m.d, m.c, m.d, m.c, m.d, m.c, m.d);
+        __m256 ef = _mm256_setr_ps(m.e, m.f, m.e, m.f, m.e, m.f, m.e, m.f);
+        for(;i+4<=n;i+=4)
+        {
+            __m256 v = _mm256_loadu_ps(in+2*i);
+            __m256 xx = _mm256_moveldup_ps(v);
+            __m256 yy = _mm256_movehdup_ps(v);
+            _mm256_storeu_ps(out+2*i, MulAdd(xx, ab, MulAdd(yy, cd, ef)));
+        }
+    }
+#endif
+    __m128 ab = _mm_setr_ps(m.a, m.b, m.a, m.b);
+    __m128 cd = _mm_setr_ps(m.c, m.d, m.c, m.d);
+    __m128 ef = _mm_setr_ps(m.e, m.f, m.e, m.f);
+    for(;i+2<=n;i+=2)
+    {
+        __m128 v = _mm_loadu_ps(in+2*i);
+        __m128 xx = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2,2,0,0));
+        __m128 yy = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3,3,1,1));
+        _mm_storeu_ps(out+2*i, MulAdd(xx, ab, MulAdd(yy, cd, ef)));
+    }
+    TransformInterleavedScalar(m, in, out, i, n);
+}
+
+inline void TransformInterleaved(const AffineCoeffs<double>& m, const double* in, double* out, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(TOOLS2D_AVX2)
+    {
+        __m256d ab = _mm256_setr_pd(m.a, m.b, m.a, m.b);
+        __m256d cd = _mm256_setr_pd(m.c, m.d, m.c, m.d);
+        __m256d ef = _mm256_setr_pd(m.e, m.f, m.e, m.f);
+        for(;i+2<=n;i+=2)
+        {
+            __m256d v = _mm256_loadu_pd(in+2*i);
+            __m256d xx = _mm256_movedup_pd(v);
+            __m256d yy = _mm256_permute_pd(v, 0xF);
+            _mm256_storeu_pd(out+2*i, MulAdd(xx, ab, MulAdd(yy, cd, ef)));
+        }
+    }
+#endif
+    __m128d ab = _mm_setr_pd(m.a, m.b);
+    __m128d cd = _mm_setr_pd(m.c, m.d);
+    __m128d ef = _mm_setr_pd(m.e, m.f);
+    for(;i<n;i++)
+    {
+        __m128d v = _mm_loadu_pd(in+2*i);
+        __m128d xx = _mm_unpacklo_pd(v, v);
+        __m128d yy = _mm_unpackhi_pd(v, v);
+        _mm_storeu_pd(out+2*i, MulAdd(xx, ab, MulAdd(yy, cd, ef)));
+    }
+}
+
+inline void TransformSoA(const AffineCoeffs<float>& m, const float* inX, const float* inY, float* outX, float* outY, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(TOOLS2D_AVX2)
+    {
+        __m256 a = _mm256_set1_ps(m.a), b = _mm256_set1_ps(m.b), c = _mm256_set1_ps(m.c);
+        __m256 d = _mm256_set1_ps(m.d), e = _mm256_set1_ps(m.e), f = _mm256_set1_ps(m.f);
+        for(;i+8<=n;i+=8)
+        {
+            __m256 x = _mm256_loadu_ps(inX+i);
+            __m256 y = _mm256_loadu_ps(inY+i);
+            _mm256_storeu_ps(outX+i, MulAdd(x, a, MulAdd(y, c, e)));
+            _mm256_storeu_ps(outY+i, MulAdd(x, b, MulAdd(y, d, f)));
+        }
+    }
+#endif
+    __m128 a = _mm_set1_ps(m.a), b = _mm_set1_ps(m.b), c = _mm_set1_ps(m.c);
+    __m128 d = _mm_set1_ps(m.d), e = _mm_set1_ps(m.e), f = _mm_set1_ps(m.f);
+    for(;i+4<=n;i+=4)
+    {
+        __m128 x = _mm_loadu_ps(inX+i);
+        __m128 y = _mm_loadu_ps(inY+i);
+        _mm_storeu_ps(outX+i, MulAdd(x, a, MulAdd(y, c, e)));
+        _mm_storeu_ps(outY+i, MulAdd(x, b, MulAdd(y, d, f)));
+    }
+    TransformSoAScalar(m, inX, inY, outX, outY, i, n);
+}
+
+inline void TransformSoA(const AffineCoeffs<double>& m, const double* inX, const double* inY, double* outX, double* outY, std::size_t n)
+{
+    std::size_t i = 0;
+#if defined(TOOLS2D_AVX2)
+    {
+        __m256d a = _mm256_set1_pd(m.a), b = _mm256_set1_pd(m.b), c = _mm256_set1_pd(m.c);
+        __m256d d = _mm256_set1_pd(m.d), e = _mm256_set1_pd(m.e), f = _mm256_set1_pd(m.f);
+        for(;i+4<=n;i+=4)
+        {
+            __m256d x = _mm256_loadu_pd(inX+i);
+            __m256d y = _mm256_loadu_pd(inY+i);
+            _mm256_storeu_pd(outX+i, MulAdd(x, a, MulAdd(y, c, e)));
+            _mm256_storeu_pd(outY+i, MulAdd(x, b, MulAdd(y, d, f)));
+        }
+    }
+#endif
+    __m128d a = _mm_set1_pd(m.a), b = _mm_set1_pd(m.b), c = _mm_set1_pd(m.c);
+    __m128d d = _mm_set1_pd(m.d), e = _mm_set1_pd(m.e), f = _mm_set1_pd(m.f);
+    for(;i+2<=n;i+=2)
+    {
+        __m128d x = _mm_loadu_pd(inX+i);
+        __m128d y = _mm_loadu_pd(inY+i);
+        _mm_storeu_pd(outX+i, MulAdd(x, a, MulAdd(y, c, e)));
+        _mm_storeu_pd(outY+i, MulAdd(x, b, MulAdd(y, d, f)));
+    }
+    TransformSoAScalar(m, inX, inY, outX, outY, i, n);
+}
+#endif
+
+template<class T>
+inline const T* Components(const Vector2D<T>* v)
+{
+    static_assert(sizeof(Vector2D<T>)==2*sizeof(T), "Vector2D must be two packed components");
+    return reinterpret_cast<const T*>(v);
+}
+
+template<class T>
+inline T* Components(Vector2D<T>* v)
+{
+    static_assert(sizeof(Vector2D<T>)==2*sizeof(T), "Vector2D must be two packed components");
+    return reinterpret_cast<T*>(v);
+}
+
+}
+
+/**
+* Transform an array of points (same result as p*mat for every point)
+* SSE2/AVX2 kernels are used for float and double, a scalar loop otherwise
+* @param mat - the transform (Matrix2D or Affine2D)
+* @param in - input points (n elements)
+* @param out - output points (n elements, may be the same array as in)
+* @param n - number of points
+**/
+template<class T>
+void TransformPoints(const Matrix2D<T>& mat, const Vector2D<T>* in, Vector2D<T>* out, std::size_t n)
+{
+    detail::TransformInterleaved(detail::Coeffs(mat), detail::Components(in), detail::Components(out), n);
+}
+
+template<class T>
+void TransformPoints(const Affine2D<T>& mat, const Vector2D<T>* in, Vector2D<T>* out, std::size_t n)
+{
+    detail::TransformInterleaved(detail::Coeffs(mat), detail::Components(in), detail::Components(out), n);
+}
+
+/**
+* Transform an array of points in place
+* @param mat - the transform (Matrix2D or Affine2D)
+* @param points - points to transform (n elements)
+* @param n - number of points
+**/
+template<class T>
+void TransformPoints(const Matrix2D<T>& mat, Vector2D<T>* points, std::size_t n)
+{
+    TransformPoints(mat, points, points, n);
+}
+
+template<class T>
+void TransformPoints(const Affine2D<T>& mat, Vector2D<T>* points, std::size_t n)
+{
+    TransformPoints(mat, points, points, n);
+}
+
+/**
+* Transform points stored as separate x/y arrays (SoA)
+* @param mat - the transform (Matrix2D or Affine2D)
+* @param inX, inY - input coordinates (n elements each)
+* @param outX, outY - output coordinates (n elements each, may be the same arrays as inX, inY)
+* @param n - number of points
+**/
+template<class T>
+void TransformPoints(const Matrix2D<T>& mat, const T* inX, const T* inY, T* outX, T* outY, std::size_t n)
+{
+    detail::TransformSoA(detail::Coeffs(mat), inX, inY, outX, outY, n);
+}
+
+template<class T>
+void TransformPoints(const Affine2D<T>& mat, const T* inX, const T* inY, T* outX, T* outY, std::size_t n)
+{
+    detail::TransformSoA(detail::Coeffs(mat), inX, inY, outX, outY, n);
+}
+
+/**
+* Transform points stored as separate x/y arrays (SoA) in place
+* @param mat - the transform (Matrix2D or Affine2D)
+* @param x, y - coordinates to transform (n elements each)
+* @param n - number of points
+**/
+template<class T>
+void TransformPoints(const Matrix2D<T>& mat, T* x, T* y, std::size_t n)
+{
+    TransformPoints(mat, x, y, x, y, n);
+}
+
+template<class T>
+void TransformPoints(const Affine2D<T>& mat, T* x, T* y, std::size_t n)
+{
+    TransformPoints(mat, x, y, x, y, n);
+}
+
+}
+
+#endif
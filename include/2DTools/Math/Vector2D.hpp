@@ -30,59 +30,53 @@ public:
     * Default Constructor
     * Initializes both x and y to zero
     **/
-    Vector2D():x(0.0),y(0.0){}
+    constexpr Vector2D():x(0.0),y(0.0){}
 
     /**
     * Constructor
     * @param a - value to be assigned to x
     * @param b - value to be assigned to y
     **/
-    Vector2D(const T& a, const T& b):x(a),y(b){}
+    constexpr Vector2D(const T& a, const T& b):x(a),y(b){}
 
     /**
-    * Copy Constructor
-    * @param other - Vector2D to copy from
+    * Copy/Move Constructors and Assignments are the implicit ones (Vector2D is a literal, trivially copyable type)
     **/
-    Vector2D(const Vector2D& other)
-    {
-        this->x = other.x;
-        this->y = other.y;
-    }
 
     /**
     * Get X component
     * @return T - the X value
     **/
-    T X() {return x;}
+    constexpr T X()const {return x;}
 
     /**
     * Get Y component
     * @return T - the Y value
     **/
-    T Y() {return y;}
+    constexpr T Y()const {return y;}
 
     /**
     * Set X component
     * @param a - value to set
     **/
-    void SetX(T a) {x=a;}
+    constexpr void SetX(T a) {x=a;}
 
     /**
     * Set Y component
     * @param b - value to set
     **/
-    void SetY(T b) {y=b;}
+    constexpr void SetY(T b) {y=b;}
 
     /**
     * Make vector zero (x=y=0)
     **/
-    void Zero() {x=0.0;y=0.0;}
+    constexpr void Zero() {x=0.0;y=0.0;}
 
     /**
     * Test if vector is zero?
     * @return bool - true if vector is zero
     **/
-    bool IsZero()const {return (x*x+y*y)<std::numeric_limits<T>::epsilon();}
+    constexpr bool IsZero()const {return (x*x+y*y)<std::numeric_limits<T>::epsilon();}
 
     /**
     * Normalize vector
@@ -103,20 +97,20 @@ public:
     * @return Vector2D - the perpendicular vector (-y,x)
     * @see Perp2()
     **/
-    Vector2D Perp() {return Vector2D(-y,x);}
+    constexpr Vector2D Perp()const {return Vector2D(-y,x);}
 
     /**
     * Get Perpendicular Vector (y,-x)
     * @return Vector2D - the perpendicular vector (y,-x)
     *  @see Perp()
     **/
-    Vector2D Perp2() {return Vector2D(y,-x);}
+    constexpr Vector2D Perp2()const {return Vector2D(y,-x);}
 
     /**
     * Get Reverse Vector (-x,-y)
     * @return Vector2D - the reversed vector
     **/
-    Vector2D Reverse(){return Vector2D(-x,-y);}
+    constexpr Vector2D Reverse()const {return Vector2D(-x,-y);}
 
     /**
     * Get Length of Vector
@@ -130,14 +124,14 @@ public:
     * @return T - length squared of the vector
     *  @see Length()
     **/
-    T LengthSq()const {return (x*x+y*y);}
+    constexpr T LengthSq()const {return (x*x+y*y);}
 
     /**
     * Dot product with other vector
     * @param other - vector to compute dot with
     * @return - the dot product
     **/
-    T Dot(const Vector2D& other)const
+    constexpr T Dot(const Vector2D& other)const
     {
         return (x*other.x+y*other.y);
     }
@@ -161,7 +155,7 @@ public:
     * @return T - distance squared to other vector
     * @see Distance()
     **/
-    T DistanceSq(const Vector2D& other)const
+    constexpr T DistanceSq(const Vector2D& other)const
     {
         T xSep = other.x-x;
         T ySep = other.y-y;
@@ -185,19 +179,19 @@ public:
     * mathematic operators (*,/,+,-)
     * equality operators (==,!=)
     **/
-    const Vector2D& operator-=(const Vector2D& other)
+    constexpr const Vector2D& operator-=(const Vector2D& other)
     {
         x -= other.x;
         y -= other.y;
         return *this;
     }
-    const Vector2D& operator+=(const Vector2D& other)
+    constexpr const Vector2D& operator+=(const Vector2D& other)
     {
         x += other.x;
         y += other.y;
         return *this;
     }
-    const Vector2D& operator*=(const T& other)
+    constexpr const Vector2D& operator*=(const T& other)
     {
         x *= other;
         y *= other;
@@ -205,10 +199,10 @@ public:
     }
 
     // Used for Matrix-Vector multiplications
-    inline const Vector2D& operator*=(const Matrix2D<T>& other);
-    inline const Vector2D& operator*=(const Matrix1D<T>& other);
+    constexpr const Vector2D& operator*=(const Matrix2D<T>& other);
+    constexpr const Vector2D& operator*=(const Matrix1D<T>& other);
 
-    const Vector2D& operator/=(const T& other)
+    constexpr const Vector2D& operator/=(const T& other)
     {
         // Divide only if other is not zero
         if(other > std::numeric_limits<T>::epsilon())
@@ -219,11 +213,11 @@ public:
         return *this;
     }
 
-    bool operator==(const Vector2D& other)const
+    constexpr bool operator==(const Vector2D& other)const
     {
         return (x==other.x)&&(y==other.y);
     }
-    bool operator!=(const Vector2D& other)const
+    constexpr bool operator!=(const Vector2D& other)const
     {
         return(x!=other.x)||(y!=other.y);
     }
@@ -237,14 +231,14 @@ public:
 **/
 
 template<class T>
-T operator*(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
+constexpr T operator*(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
 {
     Vector2D<T> res = vec1;
     return res.Dot(vec2);
 }
 
 template<class T>
-Vector2D<T> operator*(const Vector2D<T>& vec, T val)
+constexpr Vector2D<T> operator*(const Vector2D<T>& vec, T val)
 {
     Vector2D<T> res = vec;
     res *= val;
@@ -252,7 +246,7 @@ Vector2D<T> operator*(const Vector2D<T>& vec, T val)
 }
 
 template<class T>
-Vector2D<T> operator*(T val, const Vector2D<T>& vec)
+constexpr Vector2D<T> operator*(T val, const Vector2D<T>& vec)
 {
     Vector2D<T> res = vec;
     res *= val;
@@ -260,7 +254,7 @@ Vector2D<T> operator*(T val, const Vector2D<T>& vec)
 }
 
 template<class T>
-Vector2D<T> operator+(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
+constexpr Vector2D<T> operator+(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
 {
     Vector2D<T> res = vec1;
     res += vec2;
@@ -268,7 +262,7 @@ Vector2D<T> operator+(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
 }
 
 template<class T>
-Vector2D<T> operator-(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
+constexpr Vector2D<T> operator-(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
 {
     Vector2D<T> res = vec1;
     res -= vec2;
@@ -276,7 +270,7 @@ Vector2D<T> operator-(const Vector2D<T>& vec1, const Vector2D<T>& vec2)
 }
 
 template<class T>
-Vector2D<T> operator/(const Vector2D<T>& vec, T val)
+constexpr Vector2D<T> operator/(const Vector2D<T>& vec, T val)
 {
     Vector2D<T> res = vec;
     res /= val;
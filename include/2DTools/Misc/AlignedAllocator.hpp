@@ -0,0 +1,74 @@
+#ifndef ALIGNED_ALLOCATOR_HPP
+#define ALIGNED_ALLOCATOR_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <stdint.h>
+
+namespace Tools2D {
+
+/**
+* Allocator returning memory aligned to "Alignment" bytes (default: one cache line)
+* Used for the SoA buffers so that SIMD kernels work on aligned, cache-line sized blocks
+**/
+template<class T, std::size_t Alignment = 64>
+class AlignedAllocator
+{
+public:
+    typedef T value_type;
+
+    template<class U>
+    struct rebind
+    {
+        typedef AlignedAllocator<U, Alignment> other;
+    };
+
+    AlignedAllocator(){}
+
+    template<class U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&){}
+
+    /**
+    * Largest number of elements whose block (with the alignment slack and the stored pointer) fits in a size_t
+    **/
+    std::size_t max_size()const
+    {
+        return (std::numeric_limits<std::size_t>::max()-Alignment-sizeof(void*))/sizeof(T);
+    }
+
+    /**
+    * Allocate memory for n elements
+    * The original pointer is stored right before the aligned block
+    **/
+    T* allocate(std::size_t n)
+    {
+        if(n>max_size())
+            throw std::bad_array_new_length();
+        void* raw = std::malloc(n*sizeof(T)+Alignment+sizeof(void*));
+        if(!raw)
+            throw std::bad_alloc();
+        uintptr_t addr = (reinterpret_cast<uintptr_t>(raw)+sizeof(void*)+Alignment-1)&~(uintptr_t)(Alignment-1);
+        reinterpret_cast<void**>(addr)[-1] = raw;
+        return reinterpret_cast<T*>(addr);
+    }
+
+    void deallocate(T* p, std::size_t)
+    {
+        if(p)
+            std::free(reinterpret_cast<void**>(p)[-1]);
+    }
+
+    template<class U>
+    bool operator==(const AlignedAllocator<U, Alignment>&)const {return true;}
+    template<class U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&)const {return false;}
+};
+
+}
+
+#endif
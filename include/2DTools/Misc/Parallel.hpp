@@ -0,0 +1,131 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+/**
+* Minimal threading helpers for the parallel builds/batch entry points (std::thread, link with pthread)
+* Define TOOLS2D_NO_THREADS to run everything on the calling thread
+* The functions given to the helpers must not throw
+**/
+#include <cstddef>
+#include <vector>
+#if !defined(TOOLS2D_NO_THREADS)
+#include <thread>
+#endif
+
+namespace Tools2D {
+
+/**
+* Get the number of hardware threads
+* @return unsigned int - number of hardware threads (at least 1)
+**/
+inline unsigned int HardwareThreads()
+{
+#if !defined(TOOLS2D_NO_THREADS)
+    unsigned int n = std::thread::hardware_concurrency();
+    return n>0 ? n : 1;
+#else
+    return 1;
+#endif
+}
+
+/**
+* Resolve a requested number of threads (0 means all hardware threads)
+* @param threads - requested number of threads
+* @return unsigned int - number of threads to use (at least 1)
+**/
+inline unsigned int ResolveThreads(unsigned int threads)
+{
+#if !defined(TOOLS2D_NO_THREADS)
+    return threads==0 ? HardwareThreads() : threads;
+#else
+    (void)threads;
+    return 1;
+#endif
+}
+
+/**
+* Split [begin, end) into contiguous chunks and call func(chunkBegin, chunkEnd) for every chunk in parallel
+* @param begin - first index
+* @param end - one past the last index
+* @param func - function called with every chunk
+* @param threads - number of threads (0 means all hardware threads)
+* @param grain - minimum number of indices per chunk
+**/
+template<class Func>
+void ParallelRanges(std::size_t begin, std::size_t end, Func func, unsigned int threads = 0, std::size_t grain = 1024)
+{
+    if(end<=begin)
+        return;
+    std::size_t n = end-begin;
+    std::size_t chunks = ResolveThreads(threads);
+    if(grain==0)
+        grain = 1;
+    if(chunks>(n+grain-1)/grain)
+        chunks = (n+grain-1)/grain;
+    if(chunks<=1)
+    {
+        func(begin, end);
+        return;
+    }
+#if !defined(TOOLS2D_NO_THREADS)
+    std::vector<std::thread> workers;
+    workers.reserve(chunks-1);
+    std::size_t chunk = n/chunks, extra = n%chunks, start = begin;
+    for(std::size_t c=0;c<chunks;c++)
+    {
+        std::size_t stop = start+chunk+(c<extra ? 1 : 0);
+        if(c+1==chunks)
+            func(start, stop);
+        else
+            workers.push_back(std::thread(func, start, stop));
+        start = stop;
+    }
+    for(std::size_t c=0;c<workers.size();c++)
+        workers[c].join();
+#endif
+}
+
+/**
+* Call func(i) for every i in [begin, end) in parallel
+* @param begin - first index
+* @param end - one past the last index
+* @param func - function called with every index
+* @param threads - number of threads (0 means all hardware threads)
+* @param grain - minimum number of indices per thread
+**/
+template<class Func>
+void ParallelFor(std::size_t begin, std::size_t end, Func func, unsigned int threads = 0, std::size_t grain = 1024)
+{
+    ParallelRanges(begin, end, [&func](std::size_t b, std::size_t e) {
+        for(std::size_t i=b;i<e;i++)
+            func(i);
+    }, threads, grain);
+}
+
+/**
+* Run two functions, the first one on a new thread when parallel is true
+* @param parallel - run the functions in parallel
+* @param first - first function
+* @param second - second function (always on the calling thread)
+**/
+template<class Func1, class Func2>
+void ParallelInvoke(bool parallel, Func1 first, Func2 second)
+{
+#if !defined(TOOLS2D_NO_THREADS)
+    if(parallel)
+    {
+        std::thread worker(first);
+        second();
+        worker.join();
+        return;
+    }
+#else
+    (void)parallel;
+#endif
+    first();
+    second();
+}
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SIMD_HPP
+#define SIMD_HPP
+
+/**
+* SIMD configuration for the batch kernels
+* Kernels are selected at compile time from the target flags (e.g. -msse2, -mavx2, -march=native)
+* Define TOOLS2D_NO_SIMD to force the scalar code paths
+**/
+#if !defined(TOOLS2D_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TOOLS2D_SSE2
+#endif
+#if defined(__AVX2__)
+#define TOOLS2D_AVX2
+#endif
+#if defined(__FMA__)
+#define TOOLS2D_FMA
+#endif
+#endif
+
+#include <cstddef>
+#if defined(TOOLS2D_SSE2) || defined(TOOLS2D_AVX2)
+#include <immintrin.h>
+#endif
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* Multiply-add helpers (a*b+c) - fused when FMA is available
+**/
+#if defined(TOOLS2D_SSE2)
+inline __m128 MulAdd(__m128 a, __m128 b, __m128 c)
+{
+#if defined(TOOLS2D_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+inline __m128d MulAdd(__m128d a, __m128d b, __m128d c)
+{
+#if defined(TOOLS2D_FMA)
+    return _mm_fmadd_pd(a, b, c);
+#else
+    return _mm_add_pd(_mm_mul_pd(a, b), c);
+#endif
+}
+#endif
+
+#if defined(TOOLS2D_AVX2)
+inline __m256 MulAdd(__m256 a, __m256 b, __m256 c)
+{
+#if defined(TOOLS2D_FMA)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline __m256d MulAdd(__m256d a, __m256d b, __m256d c)
+{
+#if defined(TOOLS2D_FMA)
+    return _mm256_fmadd_pd(a, b, c);
+#else
+    return _mm256_add_pd(_mm256_mul_pd(a, b), c);
+#endif
+}
+#endif
+
+/**
+* Pack<T> - thin wrapper over the widest available SIMD register for T
+* Lets reductions/kernels be written once for float and double
+* Less returns a lane mask, Select(mask,a,b) picks a where the mask is set and b elsewhere
+* Pack<T>::Enabled is false when there is no SIMD support for T (scalar code paths are used)
+**/
+template<class T>
+struct Pack
+{
+    static const bool Enabled = false;
+};
+
+#if defined(TOOLS2D_AVX2)
+template<>
+struct Pack<float>
+{
+    static const bool Enabled = true;
+    static const std::size_t Width = 8;
+    typedef __m256 Type;
+    static Type Load(const float* p) {return _mm256_loadu_ps(p);}
+    static void Store(float* p, Type v) {_mm256_storeu_ps(p, v);}
+    static Type Set1(float v) {return _mm256_set1_ps(v);}
+    static Type Add(Type a, Type b) {return _mm256_add_ps(a, b);}
+    static Type Sub(Type a, Type b) {return _mm256_sub_ps(a, b);}
+    static Type Mul(Type a, Type b) {return _mm256_mul_ps(a, b);}
+    static Type Min(Type a, Type b) {return _mm256_min_ps(a, b);}
+    static Type Max(Type a, Type b) {return _mm256_max_ps(a, b);}
+    static Type Sqrt(Type a) {return _mm256_sqrt_ps(a);}
+    static Type Less(Type a, Type b) {return _mm256_cmp_ps(a, b, _CMP_LT_OQ);}
+    static Type Select(Type mask, Type a, Type b) {return _mm256_blendv_ps(b, a, mask);}
+    static Type Iota() {return _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);}
+};
+
+template<>
+struct Pack<double>
+{
+    static const bool Enabled = true;
+    static const std::size_t Width = 4;
+    typedef __m256d Type;
+    static Type Load(const double* p) {return _mm256_loadu_pd(p);}
+    static void Store(double* p, Type v) {_mm256_storeu_pd(p, v);}
+    static Type Set1(double v) {return _mm256_set1_pd(v);}
+    static Type Add(Type a, Type b) {return _mm256_add_pd(a, b);}
+    static Type Sub(Type a, Type b) {return _mm256_sub_pd(a, b);}
+    static Type Mul(Type a, Type b) {return _mm256_mul_pd(a, b);}
+    static Type Min(Type a, Type b) {return _mm256_min_pd(a, b);}
+    static Type Max(Type a, Type b) {return _mm256_max_pd(a, b);}
+    static Type Sqrt(Type a) {return _mm256_sqrt_pd(a);}
+    static Type Less(Type a, Type b) {return _mm256_cmp_pd(a, b, _CMP_LT_OQ);}
+    static Type Select(Type mask, Type a, Type b) {return _mm256_blendv_pd(b, a, mask);}
+    static Type Iota() {return _mm256_setr_pd(0, 1, 2, 3);}
+};
+#elif defined(TOOLS2D_SSE2)
+template<>
+struct Pack<float>
+{
+    static const bool Enabled = true;
+    static const std::size_t Width = 4;
+    typedef __m128 Type;
+    static Type Load(const float* p) {return _mm_loadu_ps(p);}
+    static void Store(float* p, Type v) {_mm_storeu_ps(p, v);}
+    static Type Set1(float v) {return _mm_set1_ps(v);}
+    static Type Add(Type a, Type b) {return _mm_add_ps(a, b);}
+    static Type Sub(Type a, Type b) {return _mm_sub_ps(a, b);}
+    static Type Mul(Type a, Type b) {return _mm_mul_ps(a, b);}
+    static Type Min(Type a, Type b) {return _mm_min_ps(a, b);}
+    static Type Max(Type a, Type b) {return _mm_max_ps(a, b);}
+    static Type Sqrt(Type a) {return _mm_sqrt_ps(a);}
+    static Type Less(Type a, Type b) {return _mm_cmplt_ps(a, b);}
+    static Type Select(Type mask, Type a, Type b) {return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));}
+    static Type Iota() {return _mm_setr_ps(0, 1, 2, 3);}
+};
+
+template<>
+struct Pack<double>
+{
+    static const bool Enabled = true;
+    static const std::size_t Width = 2;
+    typedef __m128d Type;
+    static Type Load(const double* p) {return _mm_loadu_pd(p);}
+    static void Store(double* p, Type v) {_mm_storeu_pd(p, v);}
+    static Type Set1(double v) {return _mm_set1_pd(v);}
+    static Type Add(Type a, Type b) {return _mm_add_pd(a, b);}
+    static Type Sub(Type a, Type b) {return _mm_sub_pd(a, b);}
+    static Type Mul(Type a, Type b) {return _mm_mul_pd(a, b);}
+    static Type Min(Type a, Type b) {return _mm_min_pd(a, b);}
+    static Type Max(Type a, Type b) {return _mm_max_pd(a, b);}
+    static Type Sqrt(Type a) {return _mm_sqrt_pd(a);}
+    static Type Less(Type a, Type b) {return _mm_cmplt_pd(a, b);}
+    static Type Select(Type mask, Type a, Type b) {return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b));}
+    static Type Iota() {return _mm_setr_pd(0, 1);}
+};
+#endif
+
+}
+
+}
+
+#endif
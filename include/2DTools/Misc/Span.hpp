@@ -0,0 +1,104 @@
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+namespace Tools2D {
+
+/**
+* Non-owning view of a contiguous array (a small subset of C++20 std::span)
+* Used to pass vertex/point buffers around without copying them
+**/
+template<class T>
+class Span
+{
+protected:
+    T* ptr; // first element
+    std::size_t count; // number of elements
+public:
+    typedef typename std::remove_const<T>::type value_type;
+
+    /**
+    * Default Constructor
+    * Creates an empty span
+    **/
+    Span():ptr(0),count(0){}
+
+    /**
+    * Constructor
+    * @param p - pointer to the first element
+    * @param n - number of elements
+    **/
+    Span(T* p, std::size_t n):ptr(p),count(n){}
+
+    /**
+    * Constructor - view a whole std::vector
+    * @param v - the vector
+    **/
+    template<class A>
+    Span(std::vector<value_type, A>& v):ptr(v.data()),count(v.size()){}
+
+    template<class A>
+    Span(const std::vector<value_type, A>& v):ptr(v.data()),count(v.size()){}
+
+    /**
+    * Constructor - view a whole C array
+    * @param arr - the array
+    **/
+    template<std::size_t N>
+    Span(T (&arr)[N]):ptr(arr),count(N){}
+
+    /**
+    * Conversion Constructor (e.g. Span<T> to Span<const T>)
+    * @param other - span to view
+    **/
+    template<class U>
+    Span(const Span<U>& other, typename std::enable_if<std::is_convertible<U*, T*>::value>::type* = 0):ptr(other.data()),count(other.size()){}
+
+    T* data()const {return ptr;}
+    std::size_t size()const {return count;}
+    bool empty()const {return count==0;}
+    T* begin()const {return ptr;}
+    T* end()const {return ptr+count;}
+    T& front()const {return ptr[0];}
+    T& back()const {return ptr[count-1];}
+    T& operator[](std::size_t i)const {return ptr[i];}
+
+    /**
+    * Get a part of the span
+    * @param offset - first element of the part
+    * @param n - number of elements of the part
+    * @return Span - the sub-span
+    **/
+    Span subspan(std::size_t offset, std::size_t n)const {return Span(ptr+offset, n);}
+};
+
+/**
+* Helper functions to create spans with deduced type
+**/
+template<class T, class A>
+Span<const T> MakeSpan(const std::vector<T, A>& v)
+{
+    return Span<const T>(v.data(), v.size());
+}
+
+template<class T, class A>
+Span<T> MakeSpan(std::vector<T, A>& v)
+{
+    return Span<T>(v.data(), v.size());
+}
+
+template<class T>
+Span<T> MakeSpan(T* p, std::size_t n)
+{
+    return Span<T>(p, n);
+}
+
+}
+
+#endif
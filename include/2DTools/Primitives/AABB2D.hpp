@@ -0,0 +1,177 @@
+#ifndef AABB_2D_HPP
+#define AABB_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <limits>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* AABB2D Class
+* Axis aligned bounding box given by its lower-left and upper-right corners
+* A default constructed box is empty (lower > upper) and grows with Extend
+**/
+template<class T>
+class AABB2D
+{
+protected:
+    Vector2D<T> lo; // lower-left corner
+    Vector2D<T> hi; // upper-right corner
+public:
+    /**
+    * Default Constructor
+    * Initializes an empty box
+    **/
+    AABB2D():lo(std::numeric_limits<T>::max(),std::numeric_limits<T>::max()),hi(std::numeric_limits<T>::lowest(),std::numeric_limits<T>::lowest()){}
+
+    /**
+    * Constructor
+    * @param lower - lower-left corner
+    * @param upper - upper-right corner
+    **/
+    AABB2D(const Vector2D<T>& lower, const Vector2D<T>& upper):lo(lower),hi(upper){}
+
+    /**
+    * Get lower-left corner
+    * @return Vector2D - the lower-left corner
+    **/
+    Vector2D<T> Min()const {return lo;}
+
+    /**
+    * Get upper-right corner
+    * @return Vector2D - the upper-right corner
+    **/
+    Vector2D<T> Max()const {return hi;}
+
+    /**
+    * Check if box is empty (nothing was added)
+    * @return bool - true if empty
+    **/
+    bool Empty()const {return lo.X()>hi.X()||lo.Y()>hi.Y();}
+
+    T Width()const {return hi.X()-lo.X();}
+    T Height()const {return hi.Y()-lo.Y();}
+    T Area()const {return Width()*Height();}
+
+    /**
+    * Get Center of the box
+    * @return Vector2D - the center
+    **/
+    Vector2D<T> Center()const {return Vector2D<T>((lo.X()+hi.X())/2,(lo.Y()+hi.Y())/2);}
+
+    /**
+    * Grow box to include a point
+    * @param point - point to include
+    **/
+    void Extend(const Vector2D<T>& point)
+    {
+        lo = Vector2D<T>(point.X()<lo.X()?point.X():lo.X(), point.Y()<lo.Y()?point.Y():lo.Y());
+        hi = Vector2D<T>(point.X()>hi.X()?point.X():hi.X(), point.Y()>hi.Y()?point.Y():hi.Y());
+    }
+
+    /**
+    * Grow box to include another box
+    * @param other - box to include
+    **/
+    void Extend(const AABB2D& other)
+    {
+        if(other.Empty())
+            return;
+        Extend(other.lo);
+        Extend(other.hi);
+    }
+
+    /**
+    * Grow box by r in every direction
+    * @param r - margin to add
+    **/
+    void Inflate(const T& r)
+    {
+        lo -= Vector2D<T>(r,r);
+        hi += Vector2D<T>(r,r);
+    }
+
+    /**
+    * Check if a point is inside the box (boundary included)
+    * @param point - the point
+    * @return bool - true if inside
+    **/
+    bool Contains(const Vector2D<T>& point)const
+    {
+        return point.X()>=lo.X()&&point.X()<=hi.X()&&point.Y()>=lo.Y()&&point.Y()<=hi.Y();
+    }
+
+    /**
+    * Check if another box is completely inside this box
+    * @param other - the other box
+    * @return bool - true if inside
+    **/
+    bool Contains(const AABB2D& other)const
+    {
+        return other.lo.X()>=lo.X()&&other.hi.X()<=hi.X()&&other.lo.Y()>=lo.Y()&&other.hi.Y()<=hi.Y();
+    }
+
+    /**
+    * Check if two boxes overlap (touching counts as overlap)
+    * @param other - the other box
+    * @return bool - true if they overlap
+    **/
+    bool Overlaps(const AABB2D& other)const
+    {
+        return lo.X()<=other.hi.X()&&other.lo.X()<=hi.X()&&lo.Y()<=other.hi.Y()&&other.lo.Y()<=hi.Y();
+    }
+
+    /**
+    * Squared distance from a point to the box (0 if inside)
+    * @param point - the point
+    * @return T - the squared distance
+    **/
+    T DistanceSq(const Vector2D<T>& point)const
+    {
+        T dx = point.X()<lo.X() ? lo.X()-point.X() : (point.X()>hi.X() ? point.X()-hi.X() : T(0));
+        T dy = point.Y()<lo.Y() ? lo.Y()-point.Y() : (point.Y()>hi.Y() ? point.Y()-hi.Y() : T(0));
+        return dx*dx+dy*dy;
+    }
+
+    /**
+    * Convert to an axis aligned Rectangle2D
+    * @return Rectangle2D - the rectangle
+    **/
+    Rectangle2D<T> ToRectangle()const
+    {
+        return Rectangle2D<T>(Center(), Width(), Height());
+    }
+};
+
+/**
+* Get the bounding box of the vertices of a polyline/polygon
+* @param line - the polyline
+* @return AABB2D - the bounding box (empty if there are no vertices)
+**/
+template<class T>
+AABB2D<T> BoundingBox(const PolylineView2D<T>& line)
+{
+    AABB2D<T> box;
+    Span<const Vector2D<T> > v = line.Vertices();
+    for(std::size_t i=0;i<v.size();i++)
+        box.Extend(v[i]);
+    return box;
+}
+
+template<class T>
+AABB2D<T> BoundingBox(const Polyline2D<T>& line)
+{
+    return BoundingBox(line.View());
+}
+
+typedef AABB2D<double> AABB2d;
+typedef AABB2D<float> AABB2;
+
+}
+
+#endif
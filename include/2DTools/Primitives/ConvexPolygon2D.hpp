@@ -0,0 +1,383 @@
+#ifndef CONVEX_POLYGON_2D_HPP
+#define CONVEX_POLYGON_2D_HPP
+
+/**
+* Includes
+**/
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Simd.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/SegmentArray2D.hpp>
+#include <2DTools/Distances/BatchDistances2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* Smallest cross product dx*(py-y0)-dy*(px-x0) over the edges [start, n) (the point is on the left of all the
+* edges of a counter clockwise polygon when it is >= 0)
+**/
+template<class T>
+inline T MinEdgeSide(T px, T py, const SegmentArray2D<T>& edges, std::size_t start, T best)
+{
+    const T *x0 = edges.X0(), *y0 = edges.Y0(), *dx = edges.DX(), *dy = edges.DY();
+    for(std::size_t j=start;j<edges.Size();j++)
+    {
+        T side = dx[j]*(py-y0[j])-dy[j]*(px-x0[j]);
+        best = side<best ? side : best;
+    }
+    return best;
+}
+
+template<class T>
+inline T MinEdgeSide(T px, T py, const SegmentArray2D<T>& edges, std::false_type)
+{
+    return MinEdgeSide(px, py, edges, 0, std::numeric_limits<T>::max());
+}
+
+template<class T>
+inline T MinEdgeSide(T px, T py, const SegmentArray2D<T>& edges, std::true_type)
+{
+    typedef Pack<T> P;
+    const T *x0 = edges.X0(), *y0 = edges.Y0(), *dx = edges.DX(), *dy = edges.DY();
+    std::size_t n = edges.Size(), j = 0;
+    T best = std::numeric_limits<T>::max();
+    if(n>=P::Width)
+    {
+        typename P::Type vpx = P::Set1(px), vpy = P::Set1(py), vbest = P::Set1(best);
+        for(;j+P::Width<=n;j+=P::Width)
+        {
+            typename P::Type side = P::Sub(P::Mul(P::Load(dx+j), P::Sub(vpy, P::Load(y0+j))), P::Mul(P::Load(dy+j), P::Sub(vpx, P::Load(x0+j))));
+            vbest = P::Min(vbest, side);
+        }
+        T lanes[P::Width];
+        P::Store(lanes, vbest);
+        for(std::size_t k=0;k<P::Width;k++)
+            best = lanes[k]<best ? lanes[k] : best;
+    }
+    return MinEdgeSide(px, py, edges, j, best);
+}
+
+}
+
+/**
+* ConvexPolygon2D Class
+* Convex polygon prepared once for fast point queries
+* The constructor checks convexity, makes the vertices counter clockwise and drops repeated and collinear vertices;
+* Contains and DistanceSq then search the fan of triangles around an interior point in O(log n)
+* Small polygons (up to SmallContainsSize / SmallDistanceSize vertices) use a vectorized scan over all the edges instead
+**/
+template<class T>
+class ConvexPolygon2D
+{
+public:
+    // Polygons with at most this many vertices are scanned linearly (SIMD) instead of binary searched
+    // (the containment scan is cheaper per edge than the distance scan, hence the larger size)
+    static const std::size_t SmallContainsSize = 128;
+    static const std::size_t SmallDistanceSize = 48;
+protected:
+    // Counter clockwise vertices (empty if the input was not a convex polygon)
+    std::vector<Vector2D<T> > vertices;
+    // Edge i goes from vertex i to vertex i+1 (SoA, for the vectorized scans)
+    SegmentArray2D<T> edges;
+    // Interior point (center of the fan)
+    Vector2D<T> center;
+    // Pseudo angles of the vertices around the center (increasing, vertex 0 at 0)
+    std::vector<T> angles;
+    T startAngle;
+    // Number of edges after (before) edge i whose direction is within half a turn of it
+    std::vector<std::size_t> forwardHalf, backwardHalf;
+
+    static T Cross(const Vector2D<T>& a, const Vector2D<T>& b) {return a.X()*b.Y()-a.Y()*b.X();}
+
+    std::size_t Next(std::size_t i)const {return i+1==vertices.size() ? 0 : i+1;}
+    std::size_t Prev(std::size_t i)const {return i==0 ? vertices.size()-1 : i-1;}
+    std::size_t Forward(std::size_t i, std::size_t s)const {return i+s>=vertices.size() ? i+s-vertices.size() : i+s;}
+    std::size_t Backward(std::size_t i, std::size_t s)const {return i>=s ? i-s : i+vertices.size()-s;}
+    Vector2D<T> Edge(std::size_t i)const {return vertices[Next(i)]-vertices[i];}
+
+    // angle of b (counter clockwise from a) is less than pi
+    static bool HalfTurn(const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        T c = Cross(a, b);
+        return c>0 || (c==0 && a*b>0);
+    }
+
+    // Monotone substitute for the angle of a direction, in [0, 4) (no trigonometry)
+    static T PseudoAngle(const Vector2D<T>& d)
+    {
+        T p = d.Y()/(std::abs(d.X())+std::abs(d.Y()));
+        return d.X()<0 ? 2-p : (d.Y()<0 ? 4+p : p);
+    }
+
+    // Pseudo angle of a direction from the center, counter clockwise from vertex 0
+    T RelativeAngle(const Vector2D<T>& d)const
+    {
+        T a = PseudoAngle(d)-startAngle;
+        return a<0 ? a+4 : a;
+    }
+
+    // q is strictly outside edge i (edge i is visible from q)
+    bool Visible(std::size_t i, const Vector2D<T>& q)const {return Cross(Edge(i), q-vertices[i])<0;}
+
+    /**
+    * Last s in [1, n) with pred(s) true, 0 if pred(1) is false (pred must be true on a prefix)
+    **/
+    template<class Pred>
+    std::size_t LastTrue(std::size_t n, Pred pred)const
+    {
+        std::size_t lo = 0, hi = n;
+        while(hi-lo>1)
+        {
+            std::size_t mid = lo+(hi-lo)/2;
+            if(pred(mid))
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    /**
+    * Edge hit by the ray from the center through q
+    * Binary search on the pseudo angles, then exact orientation tests fix the rounding of the pseudo angles
+    **/
+    std::size_t Locate(const Vector2D<T>& q)const
+    {
+        Vector2D<T> d = q-center;
+        if(d.X()==0 && d.Y()==0)
+            return 0;
+        std::size_t n = vertices.size();
+        std::size_t k = std::size_t(std::upper_bound(angles.begin(), angles.end(), RelativeAngle(d))-angles.begin())-1;
+        // the ray is in the wedge [vertex k, vertex k+1) (less than half a turn wide as the center is inside)
+        for(std::size_t step=0;step<n;step++)
+        {
+            if(Cross(vertices[k]-center, d)<0)
+                k = Prev(k);
+            else if(Cross(vertices[Next(k)]-center, d)>=0)
+                k = Next(k);
+            else
+                break;
+        }
+        return k;
+    }
+
+    void Clean()
+    {
+        // repeated vertices (including a closing vertex equal to the first one)
+        std::size_t m = 0;
+        for(std::size_t i=0;i<vertices.size();i++)
+            if(m==0 || vertices[i]!=vertices[m-1])
+                vertices[m++] = vertices[i];
+        while(m>1 && vertices[m-1]==vertices[0])
+            m--;
+        vertices.resize(m);
+        T area = 0;
+        for(std::size_t i=0;i<m;i++)
+            area += Cross(vertices[i], vertices[Next(i)]);
+        if(area<0)
+            std::reverse(vertices.begin(), vertices.end());
+        // collinear vertices (a vertex is dropped when its neighbours see it on a straight line)
+        bool changed = true;
+        while(changed && vertices.size()>=3)
+        {
+            changed = false;
+            for(std::size_t i=0;i<vertices.size() && vertices.size()>=3;)
+            {
+                if(Cross(vertices[i]-vertices[Prev(i)], vertices[Next(i)]-vertices[i])==0)
+                {
+                    vertices.erase(vertices.begin()+i);
+                    changed = true;
+                }
+                else
+                    i++;
+            }
+        }
+    }
+
+    bool Check()const
+    {
+        std::size_t n = vertices.size();
+        if(n<3)
+            return false;
+        // all left turns, and the vertices go around the first one only once (no polygrams)
+        for(std::size_t i=0;i<n;i++)
+            if(Cross(vertices[i]-vertices[Prev(i)], vertices[Next(i)]-vertices[i])<=0)
+                return false;
+        for(std::size_t i=1;i+1<n;i++)
+            if(Cross(vertices[i]-vertices[0], vertices[i+1]-vertices[0])<=0)
+                return false;
+        return true;
+    }
+
+    void Prepare(Span<const Vector2D<T> > v)
+    {
+        vertices.assign(v.begin(), v.end());
+        Clean();
+        if(!Check())
+            vertices.clear();
+        edges = SegmentArray2D<T>(PolylineView2D<T>(Span<const Vector2D<T> >(vertices), true));
+        center = Vector2D<T>();
+        for(std::size_t i=0;i<vertices.size();i++)
+            center += vertices[i];
+        std::size_t n = vertices.size();
+        angles.resize(n);
+        forwardHalf.resize(n);
+        backwardHalf.resize(n);
+        if(n==0)
+            return;
+        center /= T(n);
+        startAngle = PseudoAngle(vertices[0]-center);
+        angles[0] = 0;
+        for(std::size_t i=1;i<n;i++)
+            angles[i] = std::max(angles[i-1], RelativeAngle(vertices[i]-center));
+        // the window ends only move forward with the edge (two pointers, on indices unwrapped over two turns)
+        for(std::size_t k=0, j=0;k<n;k++)
+        {
+            j = std::max(j, k);
+            while(j+1<k+n && HalfTurn(Edge(k), Edge((j+1)%n)))
+                j++;
+            forwardHalf[k] = j-k;
+        }
+        for(std::size_t k=2*n-1, j=2*n-1;k>=n;k--)
+        {
+            j = std::min(j, k);
+            while(j>k+1-n && HalfTurn(Edge((j-1)%n), Edge(k%n)))
+                j--;
+            backwardHalf[k%n] = k-j;
+        }
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty (invalid) polygon
+    **/
+    ConvexPolygon2D():startAngle(0){}
+
+    /**
+    * Constructor - from the vertices of a convex polygon
+    * @param v - the vertices (either orientation, a repeated closing vertex is allowed)
+    **/
+    explicit ConvexPolygon2D(Span<const Vector2D<T> > v):startAngle(0)
+    {
+        Prepare(v);
+    }
+
+    /**
+    * Constructor - from a convex Polygon2D (or subclass)
+    * @param polygon - the polygon
+    **/
+    explicit ConvexPolygon2D(const Polygon2D<T>& polygon):startAngle(0)
+    {
+        Prepare(Span<const Vector2D<T> >(polygon.Vertices()));
+    }
+
+    /**
+    * Check if the input was a convex polygon with a non zero area
+    * Invalid polygons contain no point and are infinitely far from everything
+    * @return bool - true if valid
+    **/
+    bool Valid()const {return !vertices.empty();}
+
+    std::size_t Size()const {return vertices.size();}
+
+    /**
+    * Get the vertices (counter clockwise, without repeated or collinear vertices)
+    * @return Span - the vertices (no copy)
+    **/
+    Span<const Vector2D<T> > Vertices()const {return Span<const Vector2D<T> >(vertices);}
+
+    /**
+    * Get the edges (edge i goes from vertex i to vertex i+1)
+    * @return SegmentArray2D - the edges (SoA)
+    **/
+    const SegmentArray2D<T>& Edges()const {return edges;}
+
+    /**
+    * Check if a point is inside the polygon (boundary included)
+    * @param point - the point
+    * @return bool - true if inside
+    **/
+    bool Contains(const Vector2D<T>& point)const
+    {
+        if(vertices.empty())
+            return false;
+        if(vertices.size()<=SmallContainsSize)
+            return detail::MinEdgeSide(point.X(), point.Y(), edges, std::integral_constant<bool, detail::Pack<T>::Enabled>())>=0;
+        return !Visible(Locate(point), point);
+    }
+
+    /**
+    * Squared distance from a point to the polygon (0 inside)
+    * Note: Distance(point, Polygon2D) measures the distance to the boundary instead
+    * Outside points: the edges visible from the point form a chain whose normals span less than pi, and the distance
+    * along that chain is unimodal, so the closest edge is found with a binary search from the edge hit by the ray
+    * @param point - the point
+    * @return T - the squared distance (infinity for an invalid polygon)
+    **/
+    T DistanceSq(const Vector2D<T>& point)const
+    {
+        if(vertices.empty())
+            return std::numeric_limits<T>::infinity();
+        if(vertices.size()<=SmallDistanceSize)
+        {
+            if(Contains(point))
+                return 0;
+            return FindClosestSegment(point, edges).distanceSq;
+        }
+        std::size_t k = Locate(point);
+        if(!Visible(k, point))
+            return 0;
+        // the closest point is on the visible chain, where the distance is unimodal: walk (binary search) from edge k
+        // towards its end the point projects beyond, while the edges stay visible
+        std::size_t closest = k;
+        if((point-vertices[Next(k)])*Edge(k)>0)
+        {
+            std::size_t s = LastTrue(forwardHalf[k]+1, [&](std::size_t s) {
+                std::size_t i = Forward(k, s);
+                return Visible(i, point) && (point-vertices[Next(i)])*Edge(i)>0;
+            });
+            closest = Forward(k, s+1);
+        }
+        else if((point-vertices[k])*Edge(k)<0)
+        {
+            std::size_t s = LastTrue(backwardHalf[k]+1, [&](std::size_t s) {
+                std::size_t i = Backward(k, s);
+                return Visible(i, point) && (point-vertices[i])*Edge(i)<0;
+            });
+            closest = Backward(k, s+1);
+        }
+        // the neighbours are checked as well (robust to rounding at the chain ends)
+        T best = std::numeric_limits<T>::infinity();
+        std::size_t candidates[3] = {Prev(closest), closest, Next(closest)};
+        for(int c=0;c<3;c++)
+        {
+            std::size_t j = candidates[c];
+            T d = detail::SegmentDistanceSq(point.X(), point.Y(), edges.X0()[j], edges.Y0()[j], edges.DX()[j], edges.DY()[j], edges.InvLengthSq()[j]);
+            best = d<best ? d : best;
+        }
+        return best;
+    }
+
+    /**
+    * Distance from a point to the polygon (0 inside)
+    * @param point - the point
+    * @return T - the distance (infinity for an invalid polygon)
+    **/
+    T Distance(const Vector2D<T>& point)const {return std::sqrt(DistanceSq(point));}
+};
+
+typedef ConvexPolygon2D<double> ConvexPolygon2d;
+typedef ConvexPolygon2D<float> ConvexPolygon2;
+
+}
+
+#endif
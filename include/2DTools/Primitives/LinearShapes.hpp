@@ -4,6 +4,7 @@
 /**
 * Includes
 **/
+#include <cmath>
 #include <2DTools/Math/Vector2D.hpp>
 
 namespace Tools2D {
@@ -62,25 +63,25 @@ public:
     * Get "a" value - Implicit Form
     * @return T - the "a" value
     **/
-    T a() {return -d.Y();}
+    T a()const {return -d.Y();}
 
     /**
     * Get "b" value - Implicit Form
     * @return T - the "b" value
     **/
-    T b() {return d.X();}
+    T b()const {return d.X();}
 
     /**
     * Get "c" value - Implicit Form
     * @return T - the "c" value
     **/
-    T c() {return (p.X()*d.Y()-p.Y()*d.X());}
+    T c()const {return (p.X()*d.Y()-p.Y()*d.X());}
 
     /**
     * Get Normal of Line
     * @return Vector2D - the Normal vector
     **/
-    Vector2D<T> n() {return Vector2D<T>(a(),b());}
+    Vector2D<T> n()const {return Vector2D<T>(a(),b());}
 };
 
 /**
@@ -197,6 +198,115 @@ public:
     T LengthSq()const { return this->d.LengthSq();}
 };
 
+/**
+* PreparedLine Class
+* Line with cached unit direction/normal and signed offset (n*X+c = signed distance of X)
+* The unit normal is the perpendicular (-u.y,u.x) of the cached unit direction u
+* Built once from a Line, Ray or Segment (their supporting line), then distance queries need no sqrt/division
+* A zero direction is degenerate: u is (0,0), so SignedDistance/Project are 0 and the shape is only its point P
+**/
+template<class T>
+class PreparedLine
+{
+protected:
+    Vector2D<T> p; // point on the line
+    Vector2D<T> u; // unit direction (unit normal is u.Perp(), same orientation as LinearShape::n())
+    T offset; // signed offset: u.Perp()*X+offset is the signed distance of X
+    T lengthSq; // squared length of the original direction vector
+    T invLength; // reciprocal length of the original direction vector (0 if degenerate)
+public:
+    /**
+    * Default Constructor
+    **/
+    PreparedLine():offset(0),lengthSq(0),invLength(0){}
+
+    /**
+    * Constructor
+    * @param shape - the Line, Ray or Segment whose supporting line is prepared
+    **/
+    explicit PreparedLine(const LinearShape<T>& shape):p(shape.P())
+    {
+        Vector2D<T> d = shape.D();
+        lengthSq = d.LengthSq();
+        invLength = (lengthSq>0) ? T(1)/std::sqrt(lengthSq) : T(0);
+        u = d*invLength;
+        offset = -(u.Perp()*p);
+    }
+
+    Vector2D<T> P()const {return p;}
+    Vector2D<T> Direction()const {return u;}
+    Vector2D<T> Normal()const {return u.Perp();}
+    T Offset()const {return offset;}
+    T LengthSq()const {return lengthSq;}
+    T InvLength()const {return invLength;}
+    bool Degenerate()const {return lengthSq==0;}
+
+    /**
+    * Signed distance of a point to the line (positive on the side of the normal)
+    * @param point - the point
+    * @return T - the signed distance
+    **/
+    T SignedDistance(const Vector2D<T>& point)const {return u.X()*point.Y()-u.Y()*point.X()+offset;}
+
+    /**
+    * Parameter of the projection of a point (distance along the unit direction from P)
+    * @param point - the point
+    * @return T - the projection parameter
+    **/
+    T Project(const Vector2D<T>& point)const {return u.X()*(point.X()-p.X())+u.Y()*(point.Y()-p.Y());}
+};
+
+/**
+* PreparedRay Class
+* Ray with the cached data of PreparedLine (projection parameter must be >= 0)
+**/
+template<class T>
+class PreparedRay: public PreparedLine<T>
+{
+public:
+    PreparedRay():PreparedLine<T>(){}
+
+    /**
+    * Constructor
+    * @param ray - the Ray to prepare
+    **/
+    explicit PreparedRay(const Ray<T>& ray):PreparedLine<T>(ray){}
+};
+
+/**
+* PreparedSegment Class
+* Segment with the cached data of PreparedLine plus its length
+**/
+template<class T>
+class PreparedSegment: public PreparedLine<T>
+{
+protected:
+    Vector2D<T> p1; // ending point (stored: p+u*length is not exact)
+    T length; // length of the segment
+public:
+    PreparedSegment():PreparedLine<T>(),length(0){}
+
+    /**
+    * Constructor
+    * @param seg - the Segment to prepare
+    **/
+    explicit PreparedSegment(const Segment<T>& seg):PreparedLine<T>(seg),p1(seg.P1())
+    {
+        length = this->lengthSq*this->invLength;
+    }
+
+    Vector2D<T> P0()const {return this->p;}
+    Vector2D<T> P1()const {return p1;}
+    T Length()const {return length;}
+};
+
+typedef PreparedLine<double> PreparedLine2d;
+typedef PreparedLine<float> PreparedLine2;
+typedef PreparedRay<double> PreparedRay2d;
+typedef PreparedRay<float> PreparedRay2;
+typedef PreparedSegment<double> PreparedSegment2d;
+typedef PreparedSegment<float> PreparedSegment2;
+
 typedef LinearShape<double> LinearShape2d;
 typedef LinearShape<float> LinearShape2;
 typedef Line<double> Line2d;
@@ -0,0 +1,458 @@
+#ifndef POINT_CLOUD_2D_HPP
+#define POINT_CLOUD_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+#include <2DTools/Misc/Simd.hpp>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/AlignedAllocator.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Matrix1D.hpp>
+#include <2DTools/Math/Transforms2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* Reduction kernels over SoA coordinates (x[i], y[i]) for i in [start, n)
+* The scalar versions are also used for the remainder of the SIMD versions
+**/
+template<class T>
+void BoundsScalar(const T* x, const T* y, std::size_t start, std::size_t n, T& minX, T& minY, T& maxX, T& maxY)
+{
+    for(std::size_t i=start;i<n;i++)
+    {
+        minX = x[i]<minX ? x[i] : minX;
+        maxX = x[i]>maxX ? x[i] : maxX;
+        minY = y[i]<minY ? y[i] : minY;
+        maxY = y[i]>maxY ? y[i] : maxY;
+    }
+}
+
+template<class T>
+void SumScalar(const T* x, const T* y, std::size_t start, std::size_t n, T& sx, T& sy)
+{
+    for(std::size_t i=start;i<n;i++)
+    {
+        sx += x[i];
+        sy += y[i];
+    }
+}
+
+template<class T>
+void MomentsScalar(const T* x, const T* y, std::size_t start, std::size_t n, T cx, T cy, T& sxx, T& sxy, T& syy)
+{
+    for(std::size_t i=start;i<n;i++)
+    {
+        T dx = x[i]-cx;
+        T dy = y[i]-cy;
+        sxx += dx*dx;
+        sxy += dx*dy;
+        syy += dy*dy;
+    }
+}
+
+template<class T>
+void Bounds(const T* x, const T* y, std::size_t n, T& minX, T& minY, T& maxX, T& maxY, std::false_type)
+{
+    BoundsScalar(x, y, 0, n, minX, minY, maxX, maxY);
+}
+
+template<class T>
+void Sum(const T* x, const T* y, std::size_t n, T& sx, T& sy, std::false_type)
+{
+    SumScalar(x, y, 0, n, sx, sy);
+}
+
+template<class T>
+void Moments(const T* x, const T* y, std::size_t n, T cx, T cy, T& sxx, T& sxy, T& syy, std::false_type)
+{
+    MomentsScalar(x, y, 0, n, cx, cy, sxx, sxy, syy);
+}
+
+/**
+* SIMD versions (one accumulator per lane, lanes combined at the end)
+**/
+template<class T>
+void Bounds(const T* x, const T* y, std::size_t n, T& minX, T& minY, T& maxX, T& maxY, std::true_type)
+{
+    typedef Pack<T> P;
+    std::size_t i = 0;
+    if(n>=P::Width)
+    {
+        typename P::Type mnX = P::Set1(minX), mnY = P::Set1(minY), mxX = P::Set1(maxX), mxY = P::Set1(maxY);
+        for(;i+P::Width<=n;i+=P::Width)
+        {
+            typename P::Type vx = P::Load(x+i);
+            typename P::Type vy = P::Load(y+i);
+            mnX = P::Min(mnX, vx);
+            mxX = P::Max(mxX, vx);
+            mnY = P::Min(mnY, vy);
+            mxY = P::Max(mxY, vy);
+        }
+        T lanes[4][P::Width];
+        P::Store(lanes[0], mnX);
+        P::Store(lanes[1], mnY);
+        P::Store(lanes[2], mxX);
+        P::Store(lanes[3], mxY);
+        BoundsScalar(lanes[0], lanes[1], 0, P::Width, minX, minY, maxX, maxY);
+        BoundsScalar(lanes[2], lanes[3], 0, P::Width, minX, minY, maxX, maxY);
+    }
+    BoundsScalar(x, y, i, n, minX, minY, maxX, maxY);
+}
+
+template<class T>
+void Sum(const T* x, const T* y, std::size_t n, T& sx, T& sy, std::true_type)
+{
+    typedef Pack<T> P;
+    std::size_t i = 0;
+    if(n>=P::Width)
+    {
+        typename P::Type ax = P::Set1(0), ay = P::Set1(0);
+        for(;i+P::Width<=n;i+=P::Width)
+        {
+            ax = P::Add(ax, P::Load(x+i));
+            ay = P::Add(ay, P::Load(y+i));
+        }
+        T lanes[2][P::Width];
+        P::Store(lanes[0], ax);
+        P::Store(lanes[1], ay);
+        SumScalar(lanes[0], lanes[1], 0, P::Width, sx, sy);
+    }
+    SumScalar(x, y, i, n, sx, sy);
+}
+
+template<class T>
+void Moments(const T* x, const T* y, std::size_t n, T cx, T cy, T& sxx, T& sxy, T& syy, std::true_type)
+{
+    typedef Pack<T> P;
+    std::size_t i = 0;
+    if(n>=P::Width)
+    {
+        typename P::Type vcx = P::Set1(cx), vcy = P::Set1(cy);
+        typename P::Type axx = P::Set1(0), axy = P::Set1(0), ayy = P::Set1(0);
+        for(;i+P::Width<=n;i+=P::Width)
+        {
+            typename P::Type dx = P::Sub(P::Load(x+i), vcx);
+            typename P::Type dy = P::Sub(P::Load(y+i), vcy);
+            axx = P::Add(axx, P::Mul(dx, dx));
+            axy = P::Add(axy, P::Mul(dx, dy));
+            ayy = P::Add(ayy, P::Mul(dy, dy));
+        }
+        T lanes[3][P::Width];
+        P::Store(lanes[0], axx);
+        P::Store(lanes[1], axy);
+        P::Store(lanes[2], ayy);
+        for(std::size_t k=0;k<P::Width;k++)
+        {
+            sxx += lanes[0][k];
+            sxy += lanes[1][k];
+            syy += lanes[2][k];
+        }
+    }
+    MomentsScalar(x, y, i, n, cx, cy, sxx, sxy, syy);
+}
+
+// Sums are accumulated per block and then added together to limit round-off on large clouds
+const std::size_t ReductionBlock = 4096;
+
+}
+
+/**
+* PointCloudView2D Class
+* Non-owning view of points stored as separate x and y arrays (SoA)
+* Can view a PointCloud2D (or part of it) or any external pair of coordinate arrays
+**/
+template<class T>
+class PointCloudView2D
+{
+protected:
+    const T* xs; // x coordinates
+    const T* ys; // y coordinates
+    std::size_t count; // number of points
+public:
+    /**
+    * Default Constructor
+    * Creates an empty view
+    **/
+    PointCloudView2D():xs(0),ys(0),count(0){}
+
+    /**
+    * Constructor
+    * @param x - x coordinates (n elements)
+    * @param y - y coordinates (n elements)
+    * @param n - number of points
+    **/
+    PointCloudView2D(const T* x, const T* y, std::size_t n):xs(x),ys(y),count(n){}
+
+    const T* X()const {return xs;}
+    const T* Y()const {return ys;}
+    std::size_t Size()const {return count;}
+    bool Empty()const {return count==0;}
+
+    /**
+    * Get a point
+    * @param i - index of the point
+    * @return Vector2D - the point
+    **/
+    Vector2D<T> operator[](std::size_t i)const {return Vector2D<T>(xs[i],ys[i]);}
+
+    /**
+    * Get a view of a part of the points
+    * @param offset - first point
+    * @param n - number of points
+    * @return PointCloudView2D - the view
+    **/
+    PointCloudView2D Subview(std::size_t offset, std::size_t n)const {return PointCloudView2D(xs+offset, ys+offset, n);}
+
+    /**
+    * Copy the points to an array of Vector2D (AoS)
+    * @param out - destination (at least Size() elements)
+    **/
+    void CopyTo(Span<Vector2D<T> > out)const
+    {
+        for(std::size_t i=0;i<count;i++)
+            out[i] = Vector2D<T>(xs[i],ys[i]);
+    }
+
+    /**
+    * Get the bounding box of the points (vectorized)
+    * @return AABB2D - the bounding box (empty if there are no points)
+    **/
+    AABB2D<T> BoundingBox()const
+    {
+        AABB2D<T> box;
+        if(count==0)
+            return box;
+        T minX = xs[0], minY = ys[0], maxX = xs[0], maxY = ys[0];
+        detail::Bounds(xs, ys, count, minX, minY, maxX, maxY, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+        return AABB2D<T>(Vector2D<T>(minX,minY), Vector2D<T>(maxX,maxY));
+    }
+
+    /**
+    * Get the centroid (mean) of the points (vectorized)
+    * @return Vector2D - the centroid (zero if there are no points)
+    **/
+    Vector2D<T> Centroid()const
+    {
+        if(count==0)
+            return Vector2D<T>();
+        T sx = 0, sy = 0;
+        for(std::size_t i=0;i<count;i+=detail::ReductionBlock)
+        {
+            std::size_t n = count-i<detail::ReductionBlock ? count-i : detail::ReductionBlock;
+            T bx = 0, by = 0;
+            detail::Sum(xs+i, ys+i, n, bx, by, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+            sx += bx;
+            sy += by;
+        }
+        return Vector2D<T>(sx/count, sy/count);
+    }
+
+    /**
+    * Get the covariance matrix of the points (vectorized, two-pass for accuracy)
+    * @return Matrix1D - the 2x2 covariance (normalized by the number of points)
+    **/
+    Matrix1D<T> Covariance()const
+    {
+        Matrix1D<T> cov;
+        cov(0,0) = cov(1,1) = 0;
+        if(count==0)
+            return cov;
+        Vector2D<T> c = Centroid();
+        T sxx = 0, sxy = 0, syy = 0;
+        for(std::size_t i=0;i<count;i+=detail::ReductionBlock)
+        {
+            std::size_t n = count-i<detail::ReductionBlock ? count-i : detail::ReductionBlock;
+            T bxx = 0, bxy = 0, byy = 0;
+            detail::Moments(xs+i, ys+i, n, c.X(), c.Y(), bxx, bxy, byy, std::integral_constant<bool, detail::Pack<T>::Enabled>());
+            sxx += bxx;
+            sxy += bxy;
+            syy += byy;
+        }
+        cov(0,0) = sxx/count;
+        cov(0,1) = cov(1,0) = sxy/count;
+        cov(1,1) = syy/count;
+        return cov;
+    }
+};
+
+/**
+* PointCloud2D Class
+* Collection of points stored as separate, cache-line aligned x and y arrays (SoA)
+* Bulk operations (transforms, reductions) run vectorized over the coordinate arrays
+**/
+template<class T>
+class PointCloud2D
+{
+protected:
+    // Coordinates of the points
+    std::vector<T, AlignedAllocator<T> > xs;
+    std::vector<T, AlignedAllocator<T> > ys;
+public:
+    /**
+    * Default Constructor
+    * Creates an empty cloud
+    **/
+    PointCloud2D(){}
+
+    /**
+    * Constructor - from an array of Vector2D
+    * @param points - points to copy
+    **/
+    explicit PointCloud2D(Span<const Vector2D<T> > points)
+    {
+        Append(points);
+    }
+
+    std::size_t Size()const {return xs.size();}
+    std::size_t Capacity()const {return xs.capacity();}
+    bool Empty()const {return xs.empty();}
+
+    /**
+    * Reserve memory for n points
+    * @param n - number of points
+    **/
+    void Reserve(std::size_t n)
+    {
+        xs.reserve(n);
+        ys.reserve(n);
+    }
+
+    /**
+    * Resize the cloud (new points are zero)
+    * @param n - number of points
+    **/
+    void Resize(std::size_t n)
+    {
+        xs.resize(n);
+        ys.resize(n);
+    }
+
+    /**
+    * Remove all points (memory is kept)
+    **/
+    void Clear()
+    {
+        xs.clear();
+        ys.clear();
+    }
+
+    /**
+    * Add new point to the cloud
+    * @param point - point to be added
+    **/
+    void AddPoint(const Vector2D<T>& point)
+    {
+        xs.push_back(point.X());
+        ys.push_back(point.Y());
+    }
+
+    void AddPoint(const T& x, const T& y)
+    {
+        xs.push_back(x);
+        ys.push_back(y);
+    }
+
+    /**
+    * Append an array of Vector2D
+    * @param points - points to add
+    **/
+    void Append(Span<const Vector2D<T> > points)
+    {
+        std::size_t n = xs.size();
+        Resize(n+points.size());
+        for(std::size_t i=0;i<points.size();i++)
+        {
+            xs[n+i] = points[i].X();
+            ys[n+i] = points[i].Y();
+        }
+    }
+
+    /**
+    * Append points given as separate coordinate arrays
+    * @param x - x coordinates (count elements)
+    * @param y - y coordinates (count elements)
+    * @param count - number of points
+    **/
+    void Append(const T* x, const T* y, std::size_t count)
+    {
+        xs.insert(xs.end(), x, x+count);
+        ys.insert(ys.end(), y, y+count);
+    }
+
+    /**
+    * Get/Set a point
+    * @param i - index of the point
+    **/
+    Vector2D<T> operator[](std::size_t i)const {return Vector2D<T>(xs[i],ys[i]);}
+
+    void SetPoint(std::size_t i, const Vector2D<T>& point)
+    {
+        xs[i] = point.X();
+        ys[i] = point.Y();
+    }
+
+    /**
+    * Get the coordinate arrays
+    * @return T* - pointer to the first coordinate (aligned)
+    **/
+    T* X() {return xs.data();}
+    const T* X()const {return xs.data();}
+    T* Y() {return ys.data();}
+    const T* Y()const {return ys.data();}
+
+    /**
+    * Get a non-owning view of the cloud
+    * @return PointCloudView2D - the view (invalidated when the cloud grows)
+    **/
+    PointCloudView2D<T> View()const {return PointCloudView2D<T>(xs.data(), ys.data(), xs.size());}
+
+    PointCloudView2D<T> View(std::size_t offset, std::size_t n)const {return PointCloudView2D<T>(xs.data()+offset, ys.data()+offset, n);}
+
+    /**
+    * Copy the points to an array of Vector2D (AoS)
+    * @param out - destination (at least Size() elements)
+    **/
+    void CopyTo(Span<Vector2D<T> > out)const {View().CopyTo(out);}
+
+    /**
+    * Get the points as a vector of Vector2D (AoS copy)
+    * @return vector<Vector2D> - the points
+    **/
+    std::vector<Vector2D<T> > ToVector()const
+    {
+        std::vector<Vector2D<T> > res(xs.size());
+        CopyTo(res);
+        return res;
+    }
+
+    /**
+    * Transform all the points in place (vectorized)
+    * @param mat - the transform
+    **/
+    void Transform(const Matrix2D<T>& mat) {TransformPoints(mat, X(), Y(), Size());}
+    void Transform(const Affine2D<T>& mat) {TransformPoints(mat, X(), Y(), Size());}
+
+    /**
+    * Reductions (see PointCloudView2D)
+    **/
+    AABB2D<T> BoundingBox()const {return View().BoundingBox();}
+    Vector2D<T> Centroid()const {return View().Centroid();}
+    Matrix1D<T> Covariance()const {return View().Covariance();}
+};
+
+typedef PointCloudView2D<double> PointCloudView2d;
+typedef PointCloudView2D<float> PointCloudView2;
+typedef PointCloud2D<double> PointCloud2d;
+typedef PointCloud2D<float> PointCloud2;
+
+}
+
+#endif
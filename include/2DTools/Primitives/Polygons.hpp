@@ -4,12 +4,87 @@
 /**
 * Includes
 **/
+#include <2DTools/Misc/Span.hpp>
 #include <2DTools/Primitives/LinearShapes.hpp>
+#include <limits>
+#include <type_traits>
+#include <utility>
 #include <vector>
 using std::vector;
 
 namespace Tools2D {
 
+namespace detail {
+
+// Coordinate type of a shape with Vertices()
+template<class Shape>
+struct ShapeScalar
+{
+    typedef typename std::decay<decltype(std::declval<const Shape&>().Vertices()[0].X())>::type type;
+};
+
+}
+
+/**
+* PolylineView2D Class
+* Non-owning view of the vertices of a polyline (P0->P1->...->Pn)
+* If closed, the edge Pn->P0 is part of the polyline as well (polygons)
+**/
+template<class T>
+class PolylineView2D
+{
+protected:
+    Span<const Vector2D<T> > vertices; // the viewed vertices
+    bool closed; // true if last vertex connects back to the first one
+public:
+    /**
+    * Default Constructor
+    * Creates an empty view
+    **/
+    PolylineView2D():closed(false){}
+
+    /**
+    * Constructor
+    * @param v - the vertices
+    * @param isClosed - true if the last vertex connects back to the first one
+    **/
+    PolylineView2D(Span<const Vector2D<T> > v, bool isClosed = false):vertices(v),closed(isClosed){}
+
+    /**
+    * Get Vertices/Points
+    * @return Span - the vertices (no copy)
+    **/
+    Span<const Vector2D<T> > Vertices()const {return vertices;}
+
+    /**
+    * Check if the polyline is closed
+    * @return bool - true if closed
+    **/
+    bool Closed()const {return closed;}
+
+    /**
+    * Get number of segments/edges
+    * @return size_t - the number of segments
+    **/
+    std::size_t SegmentCount()const
+    {
+        if(vertices.size()<2)
+            return 0;
+        return closed ? vertices.size() : vertices.size()-1;
+    }
+
+    /**
+    * Get a segment/edge
+    * @param i - index of the segment (from vertex i to vertex i+1)
+    * @return Segment - the segment
+    **/
+    Segment<T> GetSegment(std::size_t i)const
+    {
+        std::size_t i_p = (i+1==vertices.size()) ? 0 : i+1;
+        return Segment<T>(vertices[i], vertices[i_p]);
+    }
+};
+
 /**
 * Polyline2D Class
 * Polyline is a collection of arbitrary segments (or points)
@@ -43,9 +118,22 @@ public:
 
     /**
     * Get Vertices/Points
-    * @return vector<Vector2D> - the collection of points/vertices
+    * @return vector<Vector2D> - the collection of points/vertices (no copy)
+    **/
+    const vector<Vector2D<T> >& Vertices()const {return vertices;}
+
+    /**
+    * Check if the last vertex connects back to the first one
+    * virtual method - polygons are closed
+    * @return bool - true if closed
     **/
-    vector<Vector2D<T> > Vertices() {return vertices;}
+    virtual bool Closed()const {return false;}
+
+    /**
+    * Get a non-owning view of the polyline
+    * @return PolylineView2D - the view (invalidated when points are added)
+    **/
+    PolylineView2D<T> View()const {return PolylineView2D<T>(Span<const Vector2D<T> >(vertices), Closed());}
 };
 
 /**
@@ -63,6 +151,12 @@ public:
     **/
     Polygon2D():Polyline2D<T>(){}
 
+    /**
+    * Polygons are closed (last vertex connects back to the first one)
+    * @return bool - always true
+    **/
+    bool Closed()const {return true;}
+
     /**
     * Get the area under the polygon
     * gives correct answer if polygon is simple/convex (=non-adjacent segments do not intersect)
@@ -120,6 +214,25 @@ public:
             return false;
         return true;
     }
+
+    /**
+    * Check if a point is inside the polygon (even-odd crossing test, O(n))
+    * points on the boundary may go either way; PreparedPolygon2D answers repeated queries on large polygons faster
+    * @param point - the point
+    * @return bool - true if inside
+    **/
+    bool Contains(const Vector2D<T>& point)const
+    {
+        bool inside = false;
+        const std::vector<Vector2D<T> >& v = this->vertices;
+        for(std::size_t i=0, j=v.size()-1;i<v.size();j=i++)
+        {
+            if((v[i].Y()>point.Y())!=(v[j].Y()>point.Y()) &&
+                point.X()<(v[j].X()-v[i].X())*(point.Y()-v[i].Y())/(v[j].Y()-v[i].Y())+v[i].X())
+                inside = !inside;
+        }
+        return inside;
+    }
 };
 
 /**
@@ -163,16 +276,19 @@ public:
     * Constructor
     * @param p0 - lower left point of rectangle
     * @param e0 - direction (with length) of horizontal edge
-    * @param e1 - direction (with length) of vertical edge
+    * @param e1 - direction (with length) of vertical edge (replaced by e0.Perp() if not perpendicular to e0)
     **/
     Rectangle2D(const Vector2D<T>& p0, const Vector2D<T>& e0, const Vector2D<T>& e1):Polygon2D<T>()
     {
-        if((e0*e1)!=0)
-            e1 = e0.Perp();
+        // computed edges are rarely exactly perpendicular, so the check is relative to their lengths
+        Vector2D<T> e = e1;
+        T dot = e0*e1;
+        if(dot*dot>64*std::numeric_limits<T>::epsilon()*std::numeric_limits<T>::epsilon()*e0.LengthSq()*e1.LengthSq())
+            e = e0.Perp();
         Polygon2D<T>::AddPoint(p0);
         Polygon2D<T>::AddPoint(p0+e0);
-        Polygon2D<T>::AddPoint(p0+e0+e1);
-        Polygon2D<T>::AddPoint(p0+e1);
+        Polygon2D<T>::AddPoint(p0+e0+e);
+        Polygon2D<T>::AddPoint(p0+e);
     }
 
     /**
@@ -204,6 +320,8 @@ public:
     }
 };
 
+typedef PolylineView2D<double> PolylineView2d;
+typedef PolylineView2D<float> PolylineView2;
 typedef Polyline2D<double> Polyline2d;
 typedef Polyline2D<float> Polyline2;
 typedef Polygon2D<double> Polygon2d;
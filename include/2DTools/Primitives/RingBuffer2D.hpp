@@ -0,0 +1,168 @@
+#ifndef RING_BUFFER_2D_HPP
+#define RING_BUFFER_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* RingBuffer2D Class
+* Flat storage of many polygon rings: the vertices of all the rings in one array and the offset of every ring
+* Outer boundaries are counter clockwise and holes are clockwise, so a set of rings describes polygons with holes
+* (multi-polygons) with the nonzero rule; ring r is Points()[Offset(r), Offset(r+1))
+**/
+template<class T>
+class RingBuffer2D
+{
+protected:
+    std::vector<Vector2D<T> > points;
+    // offsets.size() is the number of rings plus one
+    std::vector<std::size_t> offsets;
+public:
+    /**
+    * Default Constructor
+    * Creates an empty buffer
+    **/
+    RingBuffer2D():offsets(1, 0){}
+
+    /**
+    * Constructor - from polygons without holes
+    * @param polygons - the polygons (any class with Vertices(), either orientation: they are made counter clockwise)
+    **/
+    template<class Shape>
+    explicit RingBuffer2D(Span<const Shape> polygons):offsets(1, 0)
+    {
+        for(std::size_t i=0;i<polygons.size();i++)
+            AddRing(Span<const Vector2D<T> >(polygons[i].Vertices()));
+    }
+
+    void Clear()
+    {
+        points.clear();
+        offsets.assign(1, 0);
+    }
+
+    void Reserve(std::size_t rings, std::size_t vertices)
+    {
+        offsets.reserve(rings+1);
+        points.reserve(vertices);
+    }
+
+    /**
+    * Add a ring
+    * @param ring - the vertices (either orientation, a repeated closing vertex is dropped)
+    * @param hole - true to store the ring clockwise (a hole), false to store it counter clockwise
+    **/
+    void AddRing(Span<const Vector2D<T> > ring, bool hole = false)
+    {
+        std::size_t n = ring.size();
+        if(n>1 && ring[n-1]==ring[0])
+            n--;
+        std::size_t start = points.size();
+        points.insert(points.end(), ring.begin(), ring.begin()+n);
+        offsets.push_back(points.size());
+        if((SignedArea(offsets.size()-2)<0)!=hole)
+            std::reverse(points.begin()+start, points.end());
+    }
+
+    /**
+    * Add a ring vertex by vertex (the ring is kept as given): AddPoint for every vertex then CloseRing
+    **/
+    void AddPoint(const Vector2D<T>& point) {points.push_back(point);}
+    void CloseRing() {offsets.push_back(points.size());}
+
+    /**
+    * Add all the rings of another buffer
+    * @param other - the rings
+    **/
+    void Append(const RingBuffer2D& other)
+    {
+        std::size_t base = points.size();
+        points.insert(points.end(), other.points.begin(), other.points.end());
+        for(std::size_t r=1;r<other.offsets.size();r++)
+            offsets.push_back(base+other.offsets[r]);
+    }
+
+    std::size_t RingCount()const {return offsets.size()-1;}
+    std::size_t PointCount()const {return points.size();}
+    bool Empty()const {return offsets.size()==1;}
+    std::size_t Offset(std::size_t ring)const {return offsets[ring];}
+    const std::vector<Vector2D<T> >& Points()const {return points;}
+
+    /**
+    * Get the vertices of a ring
+    * @param ring - index of the ring
+    * @return Span - the vertices
+    **/
+    Span<const Vector2D<T> > Ring(std::size_t ring)const
+    {
+        return Span<const Vector2D<T> >(points.data()+offsets[ring], offsets[ring+1]-offsets[ring]);
+    }
+
+    /**
+    * Get the signed area of a ring
+    * @param ring - index of the ring
+    * @return T - the area, positive for outer boundaries (counter clockwise) and negative for holes
+    **/
+    T SignedArea(std::size_t ring)const
+    {
+        std::size_t begin = offsets[ring], end = offsets[ring+1];
+        T sum = 0;
+        for(std::size_t i=begin;i<end;i++)
+        {
+            const Vector2D<T>& a = points[i];
+            const Vector2D<T>& b = points[i+1==end ? begin : i+1];
+            sum += a.X()*b.Y()-a.Y()*b.X();
+        }
+        return sum/2;
+    }
+
+    /**
+    * Get the area covered by the rings (outer boundaries minus holes)
+    * @return T - the area
+    **/
+    T Area()const
+    {
+        T sum = 0;
+        for(std::size_t r=0;r+1<offsets.size();r++)
+            sum += SignedArea(r);
+        return sum;
+    }
+
+    /**
+    * Get a ring as a polygon
+    * @param ring - index of the ring
+    * @return Polygon2D - the ring
+    **/
+    Polygon2D<T> Polygon(std::size_t ring)const
+    {
+        Polygon2D<T> polygon;
+        for(std::size_t i=offsets[ring];i<offsets[ring+1];i++)
+            polygon.AddPoint(points[i]);
+        return polygon;
+    }
+
+    /**
+    * Get the memory used by the buffer
+    * @return std::size_t - bytes allocated (capacity of the arrays)
+    **/
+    std::size_t MemoryUsage()const
+    {
+        return sizeof(*this)+points.capacity()*sizeof(Vector2D<T>)+offsets.capacity()*sizeof(std::size_t);
+    }
+};
+
+typedef RingBuffer2D<double> RingBuffer2d;
+typedef RingBuffer2D<float> RingBuffer2;
+
+}
+
+#endif
@@ -0,0 +1,142 @@
+#ifndef SEGMENT_ARRAY_2D_HPP
+#define SEGMENT_ARRAY_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/AlignedAllocator.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/LinearShapes.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+
+namespace Tools2D {
+
+/**
+* SegmentArray2D Class
+* Collection of segments stored as separate, cache-line aligned arrays (SoA)
+* For every segment it keeps the starting point, the direction (P1-P0) and 1/|P1-P0|^2
+* so that the batch distance kernels need no division or branch per segment
+**/
+template<class T>
+class SegmentArray2D
+{
+protected:
+    typedef std::vector<T, AlignedAllocator<T> > Array;
+    // Starting points
+    Array x0s;
+    Array y0s;
+    // Directions (P1-P0)
+    Array dxs;
+    Array dys;
+    // 1/|P1-P0|^2 (zero for degenerate segments)
+    Array invLengthSqs;
+public:
+    /**
+    * Default Constructor
+    * Creates an empty array
+    **/
+    SegmentArray2D(){}
+
+    /**
+    * Constructor - from an array of segments
+    * @param segments - segments to copy
+    **/
+    explicit SegmentArray2D(Span<const Segment<T> > segments)
+    {
+        Reserve(segments.size());
+        for(std::size_t i=0;i<segments.size();i++)
+            AddSegment(segments[i]);
+    }
+
+    /**
+    * Constructor - from the edges of a polyline (including the closing edge of a polygon)
+    * Segment i goes from vertex i to vertex i+1
+    * @param line - the polyline
+    **/
+    explicit SegmentArray2D(const PolylineView2D<T>& line)
+    {
+        Reserve(line.SegmentCount());
+        for(std::size_t i=0;i<line.SegmentCount();i++)
+            AddSegment(line.GetSegment(i));
+    }
+
+    std::size_t Size()const {return x0s.size();}
+    bool Empty()const {return x0s.empty();}
+
+    /**
+    * Reserve memory for n segments
+    * @param n - number of segments
+    **/
+    void Reserve(std::size_t n)
+    {
+        x0s.reserve(n);
+        y0s.reserve(n);
+        dxs.reserve(n);
+        dys.reserve(n);
+        invLengthSqs.reserve(n);
+    }
+
+    /**
+    * Remove all segments (memory is kept)
+    **/
+    void Clear()
+    {
+        x0s.clear();
+        y0s.clear();
+        dxs.clear();
+        dys.clear();
+        invLengthSqs.clear();
+    }
+
+    /**
+    * Add new segment to the array
+    * @param P0 - starting point
+    * @param P1 - ending point
+    **/
+    void AddSegment(const Vector2D<T>& P0, const Vector2D<T>& P1)
+    {
+        T dx = P1.X()-P0.X(), dy = P1.Y()-P0.Y();
+        T lengthSq = dx*dx+dy*dy;
+        x0s.push_back(P0.X());
+        y0s.push_back(P0.Y());
+        dxs.push_back(dx);
+        dys.push_back(dy);
+        invLengthSqs.push_back(lengthSq>0 ? 1/lengthSq : 0);
+    }
+
+    void AddSegment(const Segment<T>& segment)
+    {
+        AddSegment(segment.P0(), segment.P1());
+    }
+
+    /**
+    * Get a segment
+    * @param i - index of the segment
+    * @return Segment - the segment
+    **/
+    Segment<T> GetSegment(std::size_t i)const
+    {
+        Vector2D<T> P0(x0s[i], y0s[i]);
+        return Segment<T>(P0, P0+Vector2D<T>(dxs[i], dys[i]));
+    }
+
+    /**
+    * Get the coordinate arrays
+    * @return const T* - pointer to the first element (aligned)
+    **/
+    const T* X0()const {return x0s.data();}
+    const T* Y0()const {return y0s.data();}
+    const T* DX()const {return dxs.data();}
+    const T* DY()const {return dys.data();}
+    const T* InvLengthSq()const {return invLengthSqs.data();}
+};
+
+typedef SegmentArray2D<double> SegmentArray2d;
+typedef SegmentArray2D<float> SegmentArray2;
+
+}
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef EDGE_GRID_2D_HPP
+#define EDGE_GRID_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Math/Predicates2D.hpp>
+
+namespace Tools2D {
+
+namespace detail {
+
+/**
+* EdgeGrid2D Class
+* Uniform grid over the edges of polygons, shared by the point location structures
+* Every cell keeps a copy of the edges crossing it and the polygon containing its center (its label); a point is
+* located by walking from the center of its cell to it: the polygons whose edges the segment crosses an odd
+* number of times are entered or left on the way, and only edges of the cell can be crossed
+* The crossing tests use exact orientation signs (Orient2D) and resolve the ties as if the points were moved by an
+* infinitesimal step along +x (then +y): a point on an edge or a vertex goes to the polygon just right of it, so
+* points on a shared edge go to exactly one polygon, whatever the compiler contracts into fused multiply-adds
+**/
+template<class T>
+class EdgeGrid2D
+{
+public:
+    // Label of the points in no polygon
+    static const std::uint32_t None = 0xffffffffu;
+protected:
+    // Grid (the bounding box of the edges with a margin)
+    T minX, minY, maxX, maxY;
+    T cellWidth, cellHeight, invCellWidth, invCellHeight;
+    std::size_t columns, rows;
+    // cell c holds the edge copies [starts[c], starts[c+1]), in the order the edges were added
+    std::vector<std::uint32_t> starts;
+    std::vector<T> x0s, y0s, x1s, y1s;
+    // edges added since the last build
+    std::vector<T> ex0, ey0, ex1, ey1;
+    std::size_t edgeCount;
+
+    // rounded cross product, only used with a tolerance to skip cells (never to decide a side)
+    static T Cross(T ax, T ay, T bx, T by) {return ax*by-ay*bx;}
+
+    /**
+    * Sign of s (true if positive) where s is zero, the sign of the first order term (tx, then ty)
+    **/
+    static bool Positive(T s, T tx, T ty) {return s>0 || (s==0 && (tx>0 || (tx==0 && ty>0)));}
+
+    Vector2D<T> Center(std::size_t column, std::size_t row)const
+    {
+        return Vector2D<T>(minX+(T(column)+T(0.5))*cellWidth, minY+(T(row)+T(0.5))*cellHeight);
+    }
+
+    std::size_t Column(T x)const {return std::min(columns-1, std::size_t(std::max(T(0), (x-minX)*invCellWidth)));}
+    std::size_t Row(T y)const {return std::min(rows-1, std::size_t(std::max(T(0), (y-minY)*invCellHeight)));}
+
+    /**
+    * Call f(cell) for every cell an edge may cross (a conservative superset: the bounding box of the edge grown by a
+    * small margin, minus the cells whose corners are all clearly on the same side of the edge)
+    **/
+    template<class Func>
+    void ForEachCell(T ax, T ay, T bx, T by, Func f)const
+    {
+        T marginX = cellWidth*T(1e-3), marginY = cellHeight*T(1e-3);
+        std::size_t c0 = Column(std::min(ax, bx)-marginX), c1 = Column(std::max(ax, bx)+marginX);
+        std::size_t r0 = Row(std::min(ay, by)-marginY), r1 = Row(std::max(ay, by)+marginY);
+        T dx = bx-ax, dy = by-ay;
+        T tolerance = T(1e-3)*(std::abs(dx)+std::abs(dy))*(cellWidth+cellHeight);
+        for(std::size_t r=r0;r<=r1;r++)
+        {
+            T y0 = minY+T(r)*cellHeight-ay, y1 = y0+cellHeight;
+            for(std::size_t c=c0;c<=c1;c++)
+            {
+                T x0 = minX+T(c)*cellWidth-ax, x1 = x0+cellWidth;
+                T s0 = Cross(dx, dy, x0, y0), s1 = Cross(dx, dy, x1, y0), s2 = Cross(dx, dy, x0, y1), s3 = Cross(dx, dy, x1, y1);
+                if(std::min(std::min(s0, s1), std::min(s2, s3))>tolerance || std::max(std::max(s0, s1), std::max(s2, s3))<-tolerance)
+                    continue;
+                f(r*columns+c);
+            }
+        }
+    }
+public:
+    EdgeGrid2D():minX(0),minY(0),maxX(0),maxY(0),cellWidth(1),cellHeight(1),invCellWidth(1),invCellHeight(1),columns(0),rows(0),edgeCount(0){}
+
+    /**
+    * The edge (a, b) crosses the segment (p, q), both ends moved by the infinitesimal step (e, e^2) (exact, see the
+    * class comment): a vertex of the edge is never on the segment and the segment never ends on the edge
+    * The differences only break the ties: their signs are exact even when they are rounded
+    **/
+    static bool Crosses(T ax, T ay, T bx, T by, T px, T py, T qx, T qy)
+    {
+        T dx = qx-px, dy = qy-py;
+        if(Positive(Orient2D(px, py, qx, qy, ax, ay), dy, -dx)==Positive(Orient2D(px, py, qx, qy, bx, by), dy, -dx))
+            return false;
+        T ex = bx-ax, ey = by-ay;
+        return Positive(Orient2D(ax, ay, bx, by, px, py), -ey, ex)!=Positive(Orient2D(ax, ay, bx, by, qx, qy), -ey, ex);
+    }
+
+    /**
+    * Polygon reached by moving from a point inside polygon label along a segment, given the n edges that may cross it
+    * (grouped by polygon): polygonOf(k) is the polygon of edge k and crosses(k) tells if edge k crosses the segment
+    **/
+    template<class PolygonOf, class CrossesAt>
+    static std::uint32_t Walk(std::uint32_t label, std::size_t n, PolygonOf polygonOf, CrossesAt crosses)
+    {
+        bool seenLabel = false;
+        for(std::size_t k=0;k<n;)
+        {
+            std::uint32_t polygon = polygonOf(k);
+            bool odd = false;
+            for(;k<n && polygonOf(k)==polygon;k++)
+                odd ^= crosses(k);
+            if(polygon==label)
+                seenLabel = true;
+            if(odd!=(polygon==label))
+                return polygon;
+        }
+        // no polygon is entered: the segment ends in label unless it left it
+        return seenLabel ? None : label;
+    }
+
+    /**
+    * Add an edge for the next build (zero length edges are skipped)
+    * Edges must be added polygon by polygon
+    * @return bool - true if the edge was added
+    **/
+    bool AddEdge(const Vector2D<T>& a, const Vector2D<T>& b)
+    {
+        if(a==b)
+            return false;
+        ex0.push_back(a.X());
+        ey0.push_back(a.Y());
+        ex1.push_back(b.X());
+        ey1.push_back(b.Y());
+        return true;
+    }
+
+    /**
+    * Build the grid over the added edges
+    * @param edgesPerCell - average number of edges per cell
+    * @param polygonOf - polygonOf(i) is the polygon of added edge i
+    * @param labels - the label of every cell
+    * @param copies - the added edge of every edge copy
+    * @param threads - number of threads for the labels (0 means all hardware threads)
+    **/
+    template<class PolygonOf>
+    void Build(T edgesPerCell, PolygonOf polygonOf, std::vector<std::uint32_t>& labels, std::vector<std::uint32_t>& copies, unsigned int threads)
+    {
+        edgeCount = ex0.size();
+        starts.clear();
+        labels.clear();
+        copies.clear();
+        columns = rows = 0;
+        if(edgeCount==0)
+            return;
+        // grid with about edgesPerCell edges per cell and cells close to square, over the box with a margin
+        minX = std::min(*std::min_element(ex0.begin(), ex0.end()), *std::min_element(ex1.begin(), ex1.end()));
+        minY = std::min(*std::min_element(ey0.begin(), ey0.end()), *std::min_element(ey1.begin(), ey1.end()));
+        maxX = std::max(*std::max_element(ex0.begin(), ex0.end()), *std::max_element(ex1.begin(), ex1.end()));
+        maxY = std::max(*std::max_element(ey0.begin(), ey0.end()), *std::max_element(ey1.begin(), ey1.end()));
+        T margin = T(0.01)*std::max(maxX-minX, maxY-minY);
+        minX -= margin;
+        minY -= margin;
+        maxX += margin;
+        maxY += margin;
+        T width = maxX-minX, height = maxY-minY;
+        T cells = std::max(T(1), T(edgeCount)/std::max(edgesPerCell, T(0.01)));
+        columns = std::size_t(std::min(T(65536), std::max(T(1), std::round(std::sqrt(cells*width/height)))));
+        rows = std::size_t(std::min(T(65536), std::max(T(1), std::round(cells/T(columns)))));
+        cellWidth = width/T(columns);
+        cellHeight = height/T(rows);
+        invCellWidth = 1/cellWidth;
+        invCellHeight = 1/cellHeight;
+        // counting sort of the edge copies by cell (the edge order, and so the polygon order, is kept inside a cell)
+        std::size_t cellCount = columns*rows;
+        starts.assign(cellCount+1, 0);
+        for(std::size_t e=0;e<edgeCount;e++)
+            ForEachCell(ex0[e], ey0[e], ex1[e], ey1[e], [&](std::size_t c) {starts[c+1]++;});
+        for(std::size_t c=0;c<cellCount;c++)
+            starts[c+1] += starts[c];
+        copies.resize(starts[cellCount]);
+        std::vector<std::uint32_t> fill(starts.begin(), starts.end()-1);
+        for(std::size_t e=0;e<edgeCount;e++)
+            ForEachCell(ex0[e], ey0[e], ex1[e], ey1[e], [&](std::size_t c) {copies[fill[c]++] = std::uint32_t(e);});
+        std::vector<std::uint32_t>().swap(fill);
+        x0s.resize(copies.size());
+        y0s.resize(copies.size());
+        x1s.resize(copies.size());
+        y1s.resize(copies.size());
+        for(std::size_t k=0;k<copies.size();k++)
+        {
+            x0s[k] = ex0[copies[k]];
+            y0s[k] = ey0[copies[k]];
+            x1s[k] = ex1[copies[k]];
+            y1s[k] = ey1[copies[k]];
+        }
+        // labels: every row is walked from a point left of the grid (outside all the polygons) through the cell centers;
+        // a step crosses only edges of the two cells it joins (merged, without the edges listed in both)
+        labels.resize(cellCount);
+        ParallelRanges(0, rows, [&](std::size_t begin, std::size_t end) {
+            std::vector<std::uint32_t> merged;
+            for(std::size_t r=begin;r<end;r++)
+            {
+                std::uint32_t label = None;
+                Vector2D<T> from = Center(0, r)-Vector2D<T>(cellWidth, 0);
+                for(std::size_t c=0;c<columns;c++)
+                {
+                    std::size_t cell = r*columns+c;
+                    const std::uint32_t* a = copies.data()+starts[cell];
+                    const std::uint32_t* aEnd = copies.data()+starts[cell+1];
+                    const std::uint32_t* b = c==0 ? aEnd : copies.data()+starts[cell-1];
+                    const std::uint32_t* bEnd = c==0 ? aEnd : a;
+                    merged.clear();
+                    std::set_union(a, aEnd, b, bEnd, std::back_inserter(merged));
+                    Vector2D<T> to = Center(c, r);
+                    label = Walk(label, merged.size(), [&](std::size_t k) {return std::uint32_t(polygonOf(merged[k]));}, [&](std::size_t k) {
+                        std::uint32_t e = merged[k];
+                        return Crosses(ex0[e], ey0[e], ex1[e], ey1[e], from.X(), from.Y(), to.X(), to.Y());
+                    });
+                    labels[cell] = label;
+                    from = to;
+                }
+            }
+        }, threads, 1);
+        std::vector<T>().swap(ex0);
+        std::vector<T>().swap(ey0);
+        std::vector<T>().swap(ex1);
+        std::vector<T>().swap(ey1);
+    }
+
+    std::size_t EdgeCount()const {return edgeCount;}
+    std::size_t CopyCount()const {return x0s.size();}
+    std::size_t Columns()const {return columns;}
+    std::size_t Rows()const {return rows;}
+    bool Empty()const {return starts.empty();}
+
+    /**
+    * Get the cell of a point
+    * @param point - the point
+    * @param cell - the cell (set if the point is in the grid)
+    * @return bool - false if the point is outside the grid (and so outside all the polygons)
+    **/
+    bool Cell(const Vector2D<T>& point, std::size_t& cell)const
+    {
+        T x = point.X(), y = point.Y();
+        if(!(x>=minX && x<=maxX && y>=minY && y<=maxY) || starts.empty())
+            return false;
+        cell = Row(y)*columns+Column(x);
+        return true;
+    }
+
+    bool Boundary(std::size_t cell)const {return starts[cell]!=starts[cell+1];}
+
+    /**
+    * Walk from the center of a cell to a point of the cell
+    * @param cell - the cell
+    * @param label - label of the cell
+    * @param point - the point
+    * @param polygonOf - polygonOf(k) is the polygon of edge copy k
+    * @return std::uint32_t - polygon containing the point (None if none)
+    **/
+    template<class PolygonOf>
+    std::uint32_t Walk(std::size_t cell, std::uint32_t label, const Vector2D<T>& point, PolygonOf polygonOf)const
+    {
+        Vector2D<T> center = Center(cell%columns, cell/columns);
+        std::size_t first = starts[cell];
+        return Walk(label, starts[cell+1]-first, [&](std::size_t k) {return std::uint32_t(polygonOf(first+k));}, [&](std::size_t k) {
+            return Crosses(x0s[first+k], y0s[first+k], x1s[first+k], y1s[first+k], center.X(), center.Y(), point.X(), point.Y());
+        });
+    }
+
+    /**
+    * Get the memory used by the grid
+    * @return std::size_t - bytes allocated (capacity of the arrays)
+    **/
+    std::size_t MemoryUsage()const
+    {
+        return sizeof(*this)+starts.capacity()*sizeof(std::uint32_t)+
+            (x0s.capacity()+y0s.capacity()+x1s.capacity()+y1s.capacity()+ex0.capacity()+ey0.capacity()+ex1.capacity()+ey1.capacity())*sizeof(T);
+    }
+};
+
+template<class T>
+const std::uint32_t EdgeGrid2D<T>::None;
+
+}
+
+}
+
+#endif
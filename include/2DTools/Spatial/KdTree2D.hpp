@@ -0,0 +1,348 @@
+#ifndef KD_TREE_2D_HPP
+#define KD_TREE_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Misc/AlignedAllocator.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+#include <2DTools/Spatial/Neighbor2D.hpp>
+
+namespace Tools2D {
+
+/**
+* KdTree2D Class
+* Static k-d tree over a set of points, bulk built in O(n log n) (median split along the widest axis)
+* Nodes are stored in a flat array in depth-first order (the left child of a node follows it)
+* Points are stored in leaf order in buckets of two cache lines; every bucket but the last one is full
+* and starts on a cache line boundary
+**/
+template<class T>
+class KdTree2D
+{
+public:
+    // Number of points in a leaf bucket (two cache lines)
+    static const std::size_t BucketSize = 128/sizeof(Vector2D<T>);
+
+    /**
+    * Node of the tree
+    * axis - 0 (x) or 1 (y) for internal nodes, Leaf for leaves
+    * child - internal: index of the right child - leaf: index of the first point of the bucket
+    **/
+    struct Node
+    {
+        T split;
+        std::uint32_t child;
+        std::uint32_t axis;
+    };
+    static const std::uint32_t Leaf = 2;
+protected:
+    std::vector<Node> nodes;
+    // points in leaf order
+    std::vector<Vector2D<T>, AlignedAllocator<Vector2D<T> > > points;
+    // original index of every point
+    std::vector<std::uint32_t> indices;
+
+    // Subtrees with fewer points are built on the calling thread
+    static const std::size_t ParallelGrain = 1<<15;
+
+    static std::size_t Buckets(std::size_t n) {return (n+BucketSize-1)/BucketSize;}
+
+    // Point with its original index (used during the build)
+    struct Item
+    {
+        Vector2D<T> point;
+        std::uint32_t index;
+    };
+
+    /**
+    * Build the subtree of items [begin, end) at node index (the subtree has 2*Buckets(end-begin)-1 nodes)
+    **/
+    void Build(std::vector<Item>& items, std::size_t index, std::size_t begin, std::size_t end, unsigned int threads)
+    {
+        Node& node = nodes[index];
+        if(end-begin<=BucketSize)
+        {
+            node.split = 0;
+            node.child = std::uint32_t(begin);
+            node.axis = Leaf;
+            return;
+        }
+        T minX = items[begin].point.X(), maxX = minX, minY = items[begin].point.Y(), maxY = minY;
+        for(std::size_t i=begin+1;i<end;i++)
+        {
+            minX = std::min(minX, items[i].point.X());
+            maxX = std::max(maxX, items[i].point.X());
+            minY = std::min(minY, items[i].point.Y());
+            maxY = std::max(maxY, items[i].point.Y());
+        }
+        // the left subtree gets half of the buckets (so every bucket start stays a multiple of BucketSize)
+        std::size_t leftBuckets = (Buckets(end-begin)+1)/2;
+        std::size_t mid = begin+leftBuckets*BucketSize;
+        std::uint32_t axis = (maxX-minX)>=(maxY-minY) ? 0 : 1;
+        if(axis==0)
+            std::nth_element(items.begin()+begin, items.begin()+mid, items.begin()+end, [](const Item& a, const Item& b) {return a.point.X()<b.point.X();});
+        else
+            std::nth_element(items.begin()+begin, items.begin()+mid, items.begin()+end, [](const Item& a, const Item& b) {return a.point.Y()<b.point.Y();});
+        node.axis = axis;
+        node.split = Coordinate(items[mid].point, axis);
+        std::size_t right = index+2*leftBuckets;
+        node.child = std::uint32_t(right);
+        bool parallel = threads>1 && end-begin>=ParallelGrain;
+        unsigned int leftThreads = parallel ? threads/2 : threads;
+        unsigned int rightThreads = parallel ? threads-threads/2 : threads;
+        ParallelInvoke(parallel,
+                       [&]() { Build(items, index+1, begin, mid, leftThreads); },
+                       [&]() { Build(items, right, mid, end, rightThreads); });
+    }
+
+    std::size_t LeafEnd(std::size_t start)const {return std::min(start+BucketSize, points.size());}
+
+    static T Coordinate(const Vector2D<T>& p, std::uint32_t axis) {return axis==0 ? p.X() : p.Y();}
+
+    // Offer a candidate to the max-heap of the k best neighbours in out[first...]
+    static void Offer(std::vector<Neighbor2D<T> >& out, std::size_t first, std::size_t k, T distanceSq, std::size_t index)
+    {
+        typename std::vector<Neighbor2D<T> >::iterator heap = out.begin()+first;
+        Neighbor2D<T> candidate = {distanceSq, index};
+        if(out.size()-first<k)
+        {
+            out.push_back(candidate);
+            std::push_heap(out.begin()+first, out.end(), Compare);
+        }
+        else if(distanceSq<heap->distanceSq)
+        {
+            std::pop_heap(heap, out.end(), Compare);
+            out.back() = candidate;
+            std::push_heap(heap, out.end(), Compare);
+        }
+    }
+
+    static bool Compare(const Neighbor2D<T>& a, const Neighbor2D<T>& b)
+    {
+        return a.distanceSq<b.distanceSq || (a.distanceSq==b.distanceSq && a.index<b.index);
+    }
+
+    /**
+    * k nearest search - rd is the squared distance from the query to the cell of the node,
+    * offX/offY are its components along x and y
+    **/
+    void Nearest(std::size_t index, T px, T py, T rd, T offX, T offY, std::size_t k, std::vector<Neighbor2D<T> >& out, std::size_t first)const
+    {
+        const Node& node = nodes[index];
+        if(node.axis==Leaf)
+        {
+            for(std::size_t i=node.child, end=LeafEnd(node.child);i<end;i++)
+            {
+                T dx = points[i].X()-px, dy = points[i].Y()-py;
+                Offer(out, first, k, dx*dx+dy*dy, indices[i]);
+            }
+            return;
+        }
+        T q = node.axis==0 ? px : py;
+        T diff = q-node.split;
+        std::size_t nearChild = diff<0 ? index+1 : node.child;
+        std::size_t farChild = diff<0 ? node.child : index+1;
+        Nearest(nearChild, px, py, rd, offX, offY, k, out, first);
+        T& off = node.axis==0 ? offX : offY;
+        T farRd = rd-off*off+diff*diff;
+        if(out.size()-first<k || farRd<=out[first].distanceSq)
+        {
+            T saved = off;
+            off = diff;
+            Nearest(farChild, px, py, farRd, offX, offY, k, out, first);
+            off = saved;
+        }
+    }
+
+    void Nearest(std::size_t index, T px, T py, T rd, T offX, T offY, Neighbor2D<T>& best)const
+    {
+        const Node& node = nodes[index];
+        if(node.axis==Leaf)
+        {
+            for(std::size_t i=node.child, end=LeafEnd(node.child);i<end;i++)
+            {
+                T dx = points[i].X()-px, dy = points[i].Y()-py;
+                T d = dx*dx+dy*dy;
+                if(d<best.distanceSq || (d==best.distanceSq && indices[i]<best.index))
+                {
+                    best.distanceSq = d;
+                    best.index = indices[i];
+                }
+            }
+            return;
+        }
+        T q = node.axis==0 ? px : py;
+        T diff = q-node.split;
+        std::size_t nearChild = diff<0 ? index+1 : node.child;
+        std::size_t farChild = diff<0 ? node.child : index+1;
+        Nearest(nearChild, px, py, rd, offX, offY, best);
+        T& off = node.axis==0 ? offX : offY;
+        T farRd = rd-off*off+diff*diff;
+        if(farRd<=best.distanceSq)
+        {
+            T saved = off;
+            off = diff;
+            Nearest(farChild, px, py, farRd, offX, offY, best);
+            off = saved;
+        }
+    }
+
+    void Query(std::size_t index, T px, T py, T r2, std::vector<std::size_t>& out)const
+    {
+        const Node& node = nodes[index];
+        if(node.axis==Leaf)
+        {
+            for(std::size_t i=node.child, end=LeafEnd(node.child);i<end;i++)
+            {
+                T dx = points[i].X()-px, dy = points[i].Y()-py;
+                if(dx*dx+dy*dy<=r2)
+                    out.push_back(indices[i]);
+            }
+            return;
+        }
+        T diff = (node.axis==0 ? px : py)-node.split;
+        if(diff<=0 || diff*diff<=r2)
+            Query(index+1, px, py, r2, out);
+        if(diff>=0 || diff*diff<=r2)
+            Query(node.child, px, py, r2, out);
+    }
+
+    void Query(std::size_t index, const AABB2D<T>& box, std::vector<std::size_t>& out)const
+    {
+        const Node& node = nodes[index];
+        if(node.axis==Leaf)
+        {
+            for(std::size_t i=node.child, end=LeafEnd(node.child);i<end;i++)
+                if(box.Contains(points[i]))
+                    out.push_back(indices[i]);
+            return;
+        }
+        if(Coordinate(box.Min(), node.axis)<=node.split)
+            Query(index+1, box, out);
+        if(Coordinate(box.Max(), node.axis)>=node.split)
+            Query(node.child, box, out);
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty tree
+    **/
+    KdTree2D(){}
+
+    /**
+    * Constructor - from an array of points
+    * @param pts - the points (copied)
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    explicit KdTree2D(Span<const Vector2D<T> > pts, unsigned int threads = 1)
+    {
+        Build(pts, threads);
+    }
+
+    /**
+    * Rebuild the tree
+    * @param pts - the points (copied)
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    void Build(Span<const Vector2D<T> > pts, unsigned int threads = 1)
+    {
+        nodes.clear();
+        points.resize(pts.size());
+        indices.resize(pts.size());
+        if(pts.empty())
+            return;
+        std::vector<Item> items(pts.size());
+        for(std::size_t i=0;i<pts.size();i++)
+        {
+            items[i].point = pts[i];
+            items[i].index = std::uint32_t(i);
+        }
+        nodes.resize(2*Buckets(pts.size())-1);
+        Build(items, 0, 0, pts.size(), ResolveThreads(threads));
+        for(std::size_t i=0;i<items.size();i++)
+        {
+            points[i] = items[i].point;
+            indices[i] = items[i].index;
+        }
+    }
+
+    std::size_t Size()const {return points.size();}
+    bool Empty()const {return points.empty();}
+    std::size_t NodeCount()const {return nodes.size();}
+
+    /**
+    * Get the nearest point
+    * @param point - the query point
+    * @return Neighbor2D - squared distance and index of the nearest point (lowest index on ties)
+    *         (distanceSq is infinity and index is Size() when the tree is empty)
+    **/
+    Neighbor2D<T> Nearest(const Vector2D<T>& point)const
+    {
+        Neighbor2D<T> best = {std::numeric_limits<T>::infinity(), Size()};
+        if(!nodes.empty())
+            Nearest(0, point.X(), point.Y(), 0, 0, 0, best);
+        return best;
+    }
+
+    /**
+    * Get the k nearest points
+    * @param point - the query point
+    * @param k - number of neighbours
+    * @param out - the neighbours are appended here sorted by distance (min(k, Size()) elements)
+    * @return std::size_t - number of neighbours found
+    **/
+    std::size_t Nearest(const Vector2D<T>& point, std::size_t k, std::vector<Neighbor2D<T> >& out)const
+    {
+        std::size_t first = out.size();
+        if(nodes.empty() || k==0)
+            return 0;
+        Nearest(0, point.X(), point.Y(), 0, 0, 0, k, out, first);
+        std::sort_heap(out.begin()+first, out.end(), Compare);
+        return out.size()-first;
+    }
+
+    /**
+    * Get all the points within a radius
+    * @param point - the query point
+    * @param radius - the radius (points at distance <= radius are reported)
+    * @param out - indices of the points are appended here (in no particular order)
+    * @return std::size_t - number of points found
+    **/
+    std::size_t Query(const Vector2D<T>& point, T radius, std::vector<std::size_t>& out)const
+    {
+        std::size_t found = out.size();
+        if(!nodes.empty())
+            Query(0, point.X(), point.Y(), radius*radius, out);
+        return out.size()-found;
+    }
+
+    /**
+    * Get all the points inside a box
+    * @param box - the box (points on the border are reported)
+    * @param out - indices of the points are appended here (in no particular order)
+    * @return std::size_t - number of points found
+    **/
+    std::size_t Query(const AABB2D<T>& box, std::vector<std::size_t>& out)const
+    {
+        std::size_t found = out.size();
+        if(!nodes.empty() && !box.Empty())
+            Query(0, box, out);
+        return out.size()-found;
+    }
+};
+
+typedef KdTree2D<double> KdTree2d;
+typedef KdTree2D<float> KdTree2;
+
+}
+
+#endif
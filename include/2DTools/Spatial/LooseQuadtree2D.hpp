@@ -0,0 +1,342 @@
+#ifndef LOOSE_QUADTREE_2D_HPP
+#define LOOSE_QUADTREE_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+
+namespace Tools2D {
+
+/**
+* LooseQuadtree2D Class
+* Dynamic loose quadtree (loose factor 2) over the bounding boxes of moving objects
+* The node of an object is found in O(1) from its center and size (no descent with overlap tests):
+* it is the deepest cell whose size is at least the size of the box, and the cell is the one containing the center
+* Objects are referenced by stable handles; nodes and objects come from pools (vectors with free lists)
+* Moving an object that stays in the same cell only updates its box
+* Objects whose center is outside the world box (or larger than the world) are kept at the root
+**/
+template<class T>
+class LooseQuadtree2D
+{
+public:
+    typedef std::uint32_t Handle;
+    static const Handle Invalid = 0xffffffffu;
+    // deepest level allowed (cell coordinates are 32 bits and the query stack is fixed)
+    static const std::uint32_t MaxDepth = 16;
+protected:
+    struct Node
+    {
+        // lower corner and size of the cell (the loose bounds are the cell grown by half of its size on every side)
+        T x, y, cellSize;
+        std::uint32_t children[4];
+        std::uint32_t parent;
+        // first object of the node (objects are a doubly linked list)
+        std::uint32_t first;
+        // number of objects and of children (the node is released when both are zero)
+        std::uint32_t objects;
+        std::uint32_t childCount;
+    };
+
+    struct Object
+    {
+        AABB2D<T> box;
+        std::uint32_t node;
+        std::uint32_t prev, next;
+        // level and cell of the object (used to detect moves inside the same cell)
+        std::uint32_t level, cellX, cellY;
+    };
+
+    AABB2D<T> world;
+    T size;
+    std::uint32_t maxDepth;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> freeNodes;
+    std::vector<Object> objects;
+    std::vector<Handle> freeObjects;
+    std::size_t count;
+
+    std::uint32_t NewNode(std::uint32_t parent, T minX, T minY, T cellSize)
+    {
+        Node node;
+        node.x = minX;
+        node.y = minY;
+        node.cellSize = cellSize;
+        node.children[0] = node.children[1] = node.children[2] = node.children[3] = Invalid;
+        node.parent = parent;
+        node.first = Invalid;
+        node.objects = 0;
+        node.childCount = 0;
+        if(!freeNodes.empty())
+        {
+            std::uint32_t index = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[index] = node;
+            return index;
+        }
+        nodes.push_back(node);
+        return std::uint32_t(nodes.size()-1);
+    }
+
+    /**
+    * Compute the level and cell of a box (level 0 is the root)
+    **/
+    void Locate(const AABB2D<T>& box, std::uint32_t& level, std::uint32_t& cellX, std::uint32_t& cellY)const
+    {
+        level = 0;
+        cellX = cellY = 0;
+        Vector2D<T> c = box.Center();
+        if(!(size>0) || !world.Contains(c))
+            return;
+        T extent = box.Width()>box.Height() ? box.Width() : box.Height();
+        T cellSize = size;
+        while(level<maxDepth && cellSize/2>=extent)
+        {
+            cellSize /= 2;
+            level++;
+        }
+        std::uint32_t cells = 1u<<level;
+        cellX = std::uint32_t((c.X()-world.Min().X())/cellSize);
+        cellY = std::uint32_t((c.Y()-world.Min().Y())/cellSize);
+        cellX = cellX<cells ? cellX : cells-1;
+        cellY = cellY<cells ? cellY : cells-1;
+    }
+
+    /**
+    * Get (creating it if needed) the node of a cell
+    **/
+    std::uint32_t GetNode(std::uint32_t level, std::uint32_t cellX, std::uint32_t cellY)
+    {
+        std::uint32_t index = 0;
+        T cellSize = size;
+        T minX = world.Min().X(), minY = world.Min().Y();
+        for(std::uint32_t l=1;l<=level;l++)
+        {
+            cellSize /= 2;
+            std::uint32_t bx = (cellX>>(level-l))&1u, by = (cellY>>(level-l))&1u;
+            std::uint32_t quadrant = bx+2*by;
+            minX += bx*cellSize;
+            minY += by*cellSize;
+            if(nodes[index].children[quadrant]==Invalid)
+            {
+                std::uint32_t child = NewNode(index, minX, minY, cellSize);
+                nodes[index].children[quadrant] = child;
+                nodes[index].childCount++;
+            }
+            index = nodes[index].children[quadrant];
+        }
+        return index;
+    }
+
+    void Link(Handle handle, std::uint32_t node)
+    {
+        Object& o = objects[handle];
+        o.node = node;
+        o.prev = Invalid;
+        o.next = nodes[node].first;
+        if(o.next!=Invalid)
+            objects[o.next].prev = handle;
+        nodes[node].first = handle;
+        nodes[node].objects++;
+    }
+
+    void Unlink(Handle handle)
+    {
+        Object& o = objects[handle];
+        if(o.prev!=Invalid)
+            objects[o.prev].next = o.next;
+        else
+            nodes[o.node].first = o.next;
+        if(o.next!=Invalid)
+            objects[o.next].prev = o.prev;
+        nodes[o.node].objects--;
+        // release the empty nodes on the way up (never the root)
+        std::uint32_t index = o.node;
+        while(index!=0 && nodes[index].objects==0 && nodes[index].childCount==0)
+        {
+            std::uint32_t parent = nodes[index].parent;
+            for(int k=0;k<4;k++)
+                if(nodes[parent].children[k]==index)
+                    nodes[parent].children[k] = Invalid;
+            nodes[parent].childCount--;
+            freeNodes.push_back(index);
+            index = parent;
+        }
+    }
+public:
+    /**
+    * Constructor
+    * @param worldBox - region covered by the tree (it is made square)
+    * @param depth - maximum depth of the tree (cells at the deepest level are size/2^depth wide), clamped to MaxDepth
+    **/
+    explicit LooseQuadtree2D(const AABB2D<T>& worldBox, unsigned int depth = 8):maxDepth(depth),count(0)
+    {
+        if(maxDepth>MaxDepth)
+            maxDepth = MaxDepth;
+        size = worldBox.Width()>worldBox.Height() ? worldBox.Width() : worldBox.Height();
+        world = AABB2D<T>(worldBox.Min(), worldBox.Min()+Vector2D<T>(size, size));
+        Clear();
+    }
+
+    /**
+    * Remove all the objects (memory is kept, handles are invalidated)
+    **/
+    void Clear()
+    {
+        nodes.clear();
+        freeNodes.clear();
+        objects.clear();
+        freeObjects.clear();
+        count = 0;
+        // the root is always visited (it also holds the objects outside of the world)
+        NewNode(Invalid, world.Min().X(), world.Min().Y(), size);
+    }
+
+    std::size_t Size()const {return count;}
+    bool Empty()const {return count==0;}
+    std::size_t NodeCount()const {return nodes.size()-freeNodes.size();}
+
+    /**
+    * Insert a new object
+    * @param box - bounding box of the object
+    * @return Handle - handle of the object (stays valid until it is removed)
+    **/
+    Handle Insert(const AABB2D<T>& box)
+    {
+        Handle handle;
+        if(!freeObjects.empty())
+        {
+            handle = freeObjects.back();
+            freeObjects.pop_back();
+        }
+        else
+        {
+            handle = Handle(objects.size());
+            objects.push_back(Object());
+        }
+        Object& o = objects[handle];
+        o.box = box;
+        Locate(box, o.level, o.cellX, o.cellY);
+        Link(handle, GetNode(o.level, o.cellX, o.cellY));
+        count++;
+        return handle;
+    }
+
+    Handle Insert(const Vector2D<T>& point)
+    {
+        return Insert(AABB2D<T>(point, point));
+    }
+
+    /**
+    * Remove an object
+    * @param handle - handle of the object
+    **/
+    void Remove(Handle handle)
+    {
+        Unlink(handle);
+        objects[handle].node = Invalid;
+        freeObjects.push_back(handle);
+        count--;
+    }
+
+    /**
+    * Move an object (only its box is updated when it stays in the same cell)
+    * @param handle - handle of the object
+    * @param box - new bounding box of the object
+    **/
+    void Move(Handle handle, const AABB2D<T>& box)
+    {
+        std::uint32_t level, cellX, cellY;
+        Locate(box, level, cellX, cellY);
+        Object& o = objects[handle];
+        o.box = box;
+        if(level==o.level && cellX==o.cellX && cellY==o.cellY)
+            return;
+        Unlink(handle);
+        o.level = level;
+        o.cellX = cellX;
+        o.cellY = cellY;
+        Link(handle, GetNode(level, cellX, cellY));
+    }
+
+    void Move(Handle handle, const Vector2D<T>& point)
+    {
+        Move(handle, AABB2D<T>(point, point));
+    }
+
+    /**
+    * Get the bounding box of an object
+    * @param handle - handle of the object
+    * @return AABB2D - the bounding box
+    **/
+    const AABB2D<T>& Box(Handle handle)const {return objects[handle].box;}
+
+    /**
+    * Get the objects whose box overlaps a window (touching counts as overlap)
+    * @param window - the query window
+    * @param out - handles of the objects are appended here (in no particular order)
+    * @return std::size_t - number of objects found
+    **/
+    std::size_t Query(const AABB2D<T>& window, std::vector<Handle>& out)const
+    {
+        std::size_t found = out.size();
+        if(window.Empty())
+            return 0;
+        T minX = window.Min().X(), minY = window.Min().Y(), maxX = window.Max().X(), maxY = window.Max().Y();
+        // the depth is bounded by MaxDepth, so the stack holds at most 3*MaxDepth+1 nodes
+        std::uint32_t stack[3*MaxDepth+1];
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while(top>0)
+        {
+            const Node& node = nodes[stack[--top]];
+            for(std::uint32_t i=node.first;i!=Invalid;i=objects[i].next)
+                if(objects[i].box.Overlaps(window))
+                    out.push_back(i);
+            // the loose bounds of the children follow from the parent cell (the children are only read when visited)
+            T half = node.cellSize/2;
+            for(int k=0;k<4;k++)
+            {
+                std::uint32_t c = node.children[k];
+                T cx = node.x+(k&1)*half-half/2, cy = node.y+(k>>1)*half-half/2;
+                if(c!=Invalid && cx<=maxX && minX<=cx+2*half && cy<=maxY && minY<=cy+2*half)
+                    stack[top++] = c;
+            }
+        }
+        return out.size()-found;
+    }
+
+    /**
+    * Get the objects whose box is within a radius of a point
+    * @param point - the query point
+    * @param radius - the radius
+    * @param out - handles of the objects are appended here (in no particular order)
+    * @return std::size_t - number of objects found
+    **/
+    std::size_t Query(const Vector2D<T>& point, T radius, std::vector<Handle>& out)const
+    {
+        std::size_t found = out.size();
+        AABB2D<T> window(point-Vector2D<T>(radius, radius), point+Vector2D<T>(radius, radius));
+        Query(window, out);
+        // keep only the objects within the radius (the window is a superset)
+        std::size_t kept = found;
+        for(std::size_t i=found;i<out.size();i++)
+            if(objects[out[i]].box.DistanceSq(point)<=radius*radius)
+                out[kept++] = out[i];
+        out.resize(kept);
+        return kept-found;
+    }
+};
+
+typedef LooseQuadtree2D<double> LooseQuadtree2d;
+typedef LooseQuadtree2D<float> LooseQuadtree2;
+
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef NEIGHBOR_2D_HPP
+#define NEIGHBOR_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+
+namespace Tools2D {
+
+/**
+* Result of a nearest neighbour query of the spatial indexes
+* distanceSq - squared distance to the object
+* index - index of the object in the array the index was built from
+**/
+template<class T>
+struct Neighbor2D
+{
+    T distanceSq;
+    std::size_t index;
+};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+#ifndef POINT_LOCATOR_2D_HPP
+#define POINT_LOCATOR_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/PointCloud2D.hpp>
+#include <2DTools/Spatial/EdgeGrid2D.hpp>
+
+namespace Tools2D {
+
+/**
+* PointLocator2D Class
+* Point location in a set of non overlapping polygons (a tiling, gaps allowed): which polygon contains a point
+* The polygon edges are binned in a uniform grid (a copy of an edge in every cell it crosses) and every cell stores
+* the polygon containing its center. A query only looks at the edges of its cell: the polygons crossed an odd
+* number of times by the segment from the point to the cell center are entered or left on the way
+* Queries cost O(edges in the cell): expected O(1) when the edges have similar lengths, as in most tilings
+* Points on an edge or a vertex go to the polygon just right of them: the sides are exact orientation signs
+* (Orient2D, see EdgeGrid2D), so points on a shared edge go to exactly one polygon, with or without FMA contraction
+**/
+template<class T>
+class PointLocator2D
+{
+public:
+    // Returned for points outside all the polygons
+    static const std::uint32_t None = detail::EdgeGrid2D<T>::None;
+protected:
+    detail::EdgeGrid2D<T> grid;
+    // polygon of every edge copy of the grid
+    std::vector<std::uint32_t> polygonIds;
+    // polygon containing the center of each cell
+    std::vector<std::uint32_t> labels;
+    std::size_t polygonCount;
+public:
+    /**
+    * Default Constructor
+    * Creates an empty locator
+    **/
+    PointLocator2D():polygonCount(0){}
+
+    /**
+    * Constructor - from polygons
+    * @param polygons - the polygons (any class with Vertices(), either orientation)
+    * @param edgesPerCell - average number of edges per grid cell
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    template<class Shape>
+    explicit PointLocator2D(Span<const Shape> polygons, T edgesPerCell = 2, unsigned int threads = 1):polygonCount(0)
+    {
+        Build(polygons, edgesPerCell, threads);
+    }
+
+    /**
+    * Rebuild the locator from polygons
+    * @param polygons - the polygons (any class with Vertices(), either orientation); they should not overlap
+    * @param edgesPerCell - average number of edges per grid cell
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    template<class Shape>
+    void Build(Span<const Shape> polygons, T edgesPerCell = 2, unsigned int threads = 1)
+    {
+        std::vector<std::uint32_t> ids;
+        for(std::size_t p=0;p<polygons.size();p++)
+        {
+            Span<const Vector2D<T> > v(polygons[p].Vertices());
+            for(std::size_t i=0;i<v.size();i++)
+                if(grid.AddEdge(v[i], v[i+1==v.size() ? 0 : i+1]))
+                    ids.push_back(std::uint32_t(p));
+        }
+        polygonCount = polygons.size();
+        std::vector<std::uint32_t> copies;
+        grid.Build(edgesPerCell, [&](std::uint32_t e) {return ids[e];}, labels, copies, threads);
+        polygonIds.resize(copies.size());
+        for(std::size_t k=0;k<copies.size();k++)
+            polygonIds[k] = ids[copies[k]];
+    }
+
+    std::size_t Size()const {return polygonCount;}
+    std::size_t EdgeCount()const {return grid.EdgeCount();}
+    std::size_t Columns()const {return grid.Columns();}
+    std::size_t Rows()const {return grid.Rows();}
+
+    /**
+    * Get the memory used by the locator
+    * @return std::size_t - bytes allocated (capacity of the arrays)
+    **/
+    std::size_t MemoryUsage()const
+    {
+        return sizeof(*this)-sizeof(grid)+grid.MemoryUsage()+(polygonIds.capacity()+labels.capacity())*sizeof(std::uint32_t);
+    }
+
+    /**
+    * Find the polygon containing a point
+    * @param point - the point
+    * @return std::uint32_t - index of the polygon, None if the point is in no polygon
+    **/
+    std::uint32_t Locate(const Vector2D<T>& point)const
+    {
+        std::size_t cell;
+        if(!grid.Cell(point, cell))
+            return None;
+        return grid.Walk(cell, labels[cell], point, [&](std::size_t k) {return polygonIds[k];});
+    }
+
+    /**
+    * Find the polygons containing a batch of points
+    * @param points - the points
+    * @param out - index of the polygon of each point (None if in no polygon), points.size() elements
+    * @param threads - number of threads (0 means all hardware threads)
+    **/
+    void Locate(Span<const Vector2D<T> > points, std::uint32_t* out, unsigned int threads = 0)const
+    {
+        ParallelFor(0, points.size(), [&](std::size_t i) {out[i] = Locate(points[i]);}, threads);
+    }
+
+    /**
+    * Find the polygons containing a batch of points (SoA)
+    * @param points - the points
+    * @param out - index of the polygon of each point (None if in no polygon), points.Size() elements
+    * @param threads - number of threads (0 means all hardware threads)
+    **/
+    void Locate(const PointCloudView2D<T>& points, std::uint32_t* out, unsigned int threads = 0)const
+    {
+        const T* xs = points.X();
+        const T* ys = points.Y();
+        ParallelFor(0, points.Size(), [&](std::size_t i) {out[i] = Locate(Vector2D<T>(xs[i], ys[i]));}, threads);
+    }
+};
+
+template<class T>
+const std::uint32_t PointLocator2D<T>::None;
+
+typedef PointLocator2D<double> PointLocator2d;
+typedef PointLocator2D<float> PointLocator2;
+
+}
+
+#endif
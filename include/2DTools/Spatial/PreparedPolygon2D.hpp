@@ -0,0 +1,157 @@
+#ifndef PREPARED_POLYGON_2D_HPP
+#define PREPARED_POLYGON_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/PointCloud2D.hpp>
+#include <2DTools/Spatial/EdgeGrid2D.hpp>
+
+namespace Tools2D {
+
+/**
+* PreparedPolygon2D Class
+* Polygon (possibly with holes, even-odd rule) prepared for fast containment queries on very large polygons
+* The edges are bucketed once in a uniform grid; cells crossed by no edge cache whether they are inside, so points
+* there are answered in O(1), and points of boundary cells only test the few edges of their cell
+* Points on the boundary are inside when the polygon is just right of them (see EdgeGrid2D)
+**/
+template<class T>
+class PreparedPolygon2D
+{
+protected:
+    // Cell states
+    enum {Outside = 0, Inside = 1, Boundary = 2};
+
+    detail::EdgeGrid2D<T> grid;
+    // state of each cell, with the Inside bit giving the side of its center for boundary cells
+    std::vector<std::uint8_t> states;
+
+    void Finish(T edgesPerCell, unsigned int threads)
+    {
+        std::vector<std::uint32_t> labels, copies;
+        // all the rings belong to the same polygon: the walks count the crossings of every ring (even-odd rule)
+        grid.Build(edgesPerCell, [](std::uint32_t) {return 0u;}, labels, copies, threads);
+        states.resize(labels.size());
+        for(std::size_t c=0;c<labels.size();c++)
+            states[c] = std::uint8_t((labels[c]==0 ? Inside : Outside)|(grid.Boundary(c) ? Boundary : Outside));
+    }
+
+    void AddRing(Span<const Vector2D<T> > v)
+    {
+        for(std::size_t i=0;i<v.size();i++)
+            grid.AddEdge(v[i], v[i+1==v.size() ? 0 : i+1]);
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty polygon (contains no point)
+    **/
+    PreparedPolygon2D(){}
+
+    /**
+    * Constructor - from a polygon
+    * @param polygon - the polygon (either orientation)
+    * @param edgesPerCell - average number of edges per grid cell
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    explicit PreparedPolygon2D(const Polygon2D<T>& polygon, T edgesPerCell = 2, unsigned int threads = 1)
+    {
+        AddRing(polygon.Vertices());
+        Finish(edgesPerCell, threads);
+    }
+
+    /**
+    * Constructor - from the rings of a polygon with holes
+    * @param rings - the outer boundary and the holes (any class with Vertices(), any orientation, even-odd rule)
+    * @param edgesPerCell - average number of edges per grid cell
+    * @param threads - number of threads used for the build (0 means all hardware threads)
+    **/
+    template<class Shape>
+    explicit PreparedPolygon2D(Span<const Shape> rings, T edgesPerCell = 2, unsigned int threads = 1)
+    {
+        for(std::size_t r=0;r<rings.size();r++)
+            AddRing(rings[r].Vertices());
+        Finish(edgesPerCell, threads);
+    }
+
+    std::size_t EdgeCount()const {return grid.EdgeCount();}
+    std::size_t Columns()const {return grid.Columns();}
+    std::size_t Rows()const {return grid.Rows();}
+
+    /**
+    * Get the number of cells crossed by edges (the cells where queries test edges)
+    * @return std::size_t - number of boundary cells
+    **/
+    std::size_t BoundaryCells()const
+    {
+        std::size_t n = 0;
+        for(std::size_t c=0;c<states.size();c++)
+            n += (states[c]&Boundary)!=0;
+        return n;
+    }
+
+    /**
+    * Get the memory used by the polygon
+    * @return std::size_t - bytes allocated (capacity of the arrays)
+    **/
+    std::size_t MemoryUsage()const
+    {
+        return sizeof(*this)-sizeof(grid)+grid.MemoryUsage()+states.capacity();
+    }
+
+    /**
+    * Check if a point is inside the polygon
+    * @param point - the point
+    * @return bool - true if inside
+    **/
+    bool Contains(const Vector2D<T>& point)const
+    {
+        std::size_t cell;
+        if(!grid.Cell(point, cell))
+            return false;
+        std::uint8_t state = states[cell];
+        if(!(state&Boundary))
+            return state==Inside;
+        std::uint32_t label = (state&Inside) ? 0 : detail::EdgeGrid2D<T>::None;
+        return grid.Walk(cell, label, point, [](std::size_t) {return 0u;})==0;
+    }
+
+    /**
+    * Check if a batch of points are inside the polygon
+    * @param points - the points
+    * @param out - true for the points inside, points.size() elements
+    * @param threads - number of threads (0 means all hardware threads)
+    **/
+    void Contains(Span<const Vector2D<T> > points, bool* out, unsigned int threads = 0)const
+    {
+        ParallelFor(0, points.size(), [&](std::size_t i) {out[i] = Contains(points[i]);}, threads);
+    }
+
+    /**
+    * Check if a batch of points are inside the polygon (SoA)
+    * @param points - the points
+    * @param out - true for the points inside, points.Size() elements
+    * @param threads - number of threads (0 means all hardware threads)
+    **/
+    void Contains(const PointCloudView2D<T>& points, bool* out, unsigned int threads = 0)const
+    {
+        const T* xs = points.X();
+        const T* ys = points.Y();
+        ParallelFor(0, points.Size(), [&](std::size_t i) {out[i] = Contains(Vector2D<T>(xs[i], ys[i]));}, threads);
+    }
+};
+
+typedef PreparedPolygon2D<double> PreparedPolygon2d;
+typedef PreparedPolygon2D<float> PreparedPolygon2;
+
+}
+
+#endif
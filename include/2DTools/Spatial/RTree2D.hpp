@@ -0,0 +1,297 @@
+#ifndef R_TREE_2D_HPP
+#define R_TREE_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <vector>
+#include <algorithm>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+#include <2DTools/Distances/Distances2D.hpp>
+#include <2DTools/Spatial/Neighbor2D.hpp>
+
+namespace Tools2D {
+
+/**
+* RTree2D Class
+* Static packed R-tree over bounding boxes, bulk loaded with Sort-Tile-Recursive (STR)
+* Every level is packed separately and all the entries are kept in flat arrays, level by level
+* (the boxes of the level 0 entries are the boxes of the objects, the top level is the root)
+* Every node has up to NodeSize children, stored next to each other in the level below
+**/
+template<class T>
+class RTree2D
+{
+public:
+    // Maximum number of children of a node
+    static const std::size_t NodeSize = 8;
+protected:
+    // Boxes of all the entries (SoA, level by level)
+    std::vector<T> minXs, minYs, maxXs, maxYs;
+    // level 0: index of the object - level>0: first child (in the level below) and number of children
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint32_t> counts;
+    // first entry of every level
+    std::vector<std::size_t> levels;
+
+    // Entry of the nearest shape search (level -1 marks an exact distance)
+    struct Candidate
+    {
+        T distanceSq;
+        int level;
+        std::size_t entry;
+        bool operator<(const Candidate& other)const {return distanceSq>other.distanceSq;}
+    };
+
+    static T Center(const std::vector<T>& lo, const std::vector<T>& hi, std::size_t i) {return lo[i]+hi[i];}
+
+    /**
+    * STR ordering of the entries [begin, end): sort by x center, cut into vertical slices of
+    * ceil(sqrt(nodes)) nodes each and sort every slice by y center
+    **/
+    void Order(std::size_t begin, std::size_t end, std::vector<std::size_t>& order)const
+    {
+        std::size_t n = end-begin;
+        order.resize(n);
+        for(std::size_t i=0;i<n;i++)
+            order[i] = begin+i;
+        std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+            return Center(minXs, maxXs, a)<Center(minXs, maxXs, b);
+        });
+        std::size_t nodes = (n+NodeSize-1)/NodeSize;
+        std::size_t slices = std::size_t(std::ceil(std::sqrt(double(nodes))));
+        std::size_t sliceSize = ((nodes+slices-1)/slices)*NodeSize;
+        for(std::size_t s=0;s<n;s+=sliceSize)
+        {
+            std::size_t e = std::min(n, s+sliceSize);
+            std::sort(order.begin()+s, order.begin()+e, [this](std::size_t a, std::size_t b) {
+                return Center(minYs, maxYs, a)<Center(minYs, maxYs, b);
+            });
+        }
+    }
+
+    // Reorder the entries [begin, begin+order.size()) by order
+    template<class V>
+    static void Permute(V& values, std::size_t begin, const std::vector<std::size_t>& order)
+    {
+        V tmp(order.size());
+        for(std::size_t i=0;i<order.size();i++)
+            tmp[i] = values[order[i]];
+        std::copy(tmp.begin(), tmp.end(), values.begin()+begin);
+    }
+
+    bool Overlaps(std::size_t i, T minX, T minY, T maxX, T maxY)const
+    {
+        return minXs[i]<=maxX && minX<=maxXs[i] && minYs[i]<=maxY && minY<=maxYs[i];
+    }
+
+    T DistanceSq(std::size_t i, T px, T py)const
+    {
+        T dx = std::max(std::max(minXs[i]-px, px-maxXs[i]), T(0));
+        T dy = std::max(std::max(minYs[i]-py, py-maxYs[i]), T(0));
+        return dx*dx+dy*dy;
+    }
+
+    void Query(std::size_t level, std::size_t entry, T minX, T minY, T maxX, T maxY, std::vector<std::size_t>& out)const
+    {
+        std::size_t first = levels[level-1]+starts[entry];
+        std::size_t last = first+counts[entry];
+        for(std::size_t i=first;i<last;i++)
+        {
+            if(!Overlaps(i, minX, minY, maxX, maxY))
+                continue;
+            if(level==1)
+                out.push_back(starts[i]);
+            else
+                Query(level-1, i, minX, minY, maxX, maxY, out);
+        }
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty tree
+    **/
+    RTree2D(){}
+
+    /**
+    * Constructor - from the bounding boxes of the objects
+    * @param boxes - the boxes (object i has box i)
+    **/
+    explicit RTree2D(Span<const AABB2D<T> > boxes)
+    {
+        Build(boxes);
+    }
+
+    /**
+    * Rebuild the tree from the bounding boxes of the objects
+    * @param boxes - the boxes (object i has box i)
+    **/
+    void Build(Span<const AABB2D<T> > boxes)
+    {
+        std::size_t n = boxes.size();
+        minXs.clear();
+        minYs.clear();
+        maxXs.clear();
+        maxYs.clear();
+        starts.clear();
+        counts.clear();
+        levels.clear();
+        if(n==0)
+            return;
+        for(std::size_t i=0;i<n;i++)
+        {
+            minXs.push_back(boxes[i].Min().X());
+            minYs.push_back(boxes[i].Min().Y());
+            maxXs.push_back(boxes[i].Max().X());
+            maxYs.push_back(boxes[i].Max().Y());
+            starts.push_back(std::uint32_t(i));
+            counts.push_back(0);
+        }
+        levels.push_back(0);
+        std::vector<std::size_t> order;
+        std::size_t begin = 0, end = n;
+        while(true)
+        {
+            // pack the level [begin, end) and create its parents
+            Order(begin, end, order);
+            Permute(minXs, begin, order);
+            Permute(minYs, begin, order);
+            Permute(maxXs, begin, order);
+            Permute(maxYs, begin, order);
+            Permute(starts, begin, order);
+            Permute(counts, begin, order);
+            if(end-begin==1)
+                break;
+            for(std::size_t s=begin;s<end;s+=NodeSize)
+            {
+                std::size_t e = std::min(end, s+NodeSize);
+                T minX = minXs[s], minY = minYs[s], maxX = maxXs[s], maxY = maxYs[s];
+                for(std::size_t i=s+1;i<e;i++)
+                {
+                    minX = std::min(minX, minXs[i]);
+                    minY = std::min(minY, minYs[i]);
+                    maxX = std::max(maxX, maxXs[i]);
+                    maxY = std::max(maxY, maxYs[i]);
+                }
+                minXs.push_back(minX);
+                minYs.push_back(minY);
+                maxXs.push_back(maxX);
+                maxYs.push_back(maxY);
+                starts.push_back(std::uint32_t(s-begin));
+                counts.push_back(std::uint32_t(e-s));
+            }
+            begin = end;
+            end = minXs.size();
+            levels.push_back(begin);
+        }
+    }
+
+    /**
+    * Rebuild the tree from the bounding boxes of polylines/polygons
+    * @param shapes - the shapes (any class with a BoundingBox overload, e.g. Polyline2D, Polygon2D)
+    **/
+    template<class Shape>
+    void BuildFromShapes(Span<const Shape> shapes)
+    {
+        std::vector<AABB2D<T> > boxes(shapes.size());
+        for(std::size_t i=0;i<shapes.size();i++)
+            boxes[i] = BoundingBox(shapes[i]);
+        Build(boxes);
+    }
+
+    std::size_t Size()const {return levels.empty() ? 0 : levels.size()>1 ? levels[1] : 1;}
+    bool Empty()const {return levels.empty();}
+    std::size_t Height()const {return levels.size();}
+
+    /**
+    * Get the objects whose box overlaps a window (touching counts as overlap)
+    * @param window - the query window
+    * @param out - indices of the objects are appended here (in no particular order)
+    * @return std::size_t - number of objects found
+    **/
+    std::size_t Query(const AABB2D<T>& window, std::vector<std::size_t>& out)const
+    {
+        std::size_t found = out.size();
+        if(levels.empty() || window.Empty())
+            return 0;
+        T minX = window.Min().X(), minY = window.Min().Y(), maxX = window.Max().X(), maxY = window.Max().Y();
+        std::size_t root = minXs.size()-1;
+        if(!Overlaps(root, minX, minY, maxX, maxY))
+            return 0;
+        if(levels.size()==1)
+            out.push_back(starts[root]);
+        else
+            Query(levels.size()-1, root, minX, minY, maxX, maxY, out);
+        return out.size()-found;
+    }
+
+    /**
+    * Get the objects whose box contains a point (candidates for point containment)
+    * @param point - the query point
+    * @param out - indices of the objects are appended here (in no particular order)
+    * @return std::size_t - number of objects found
+    **/
+    std::size_t Query(const Vector2D<T>& point, std::vector<std::size_t>& out)const
+    {
+        return Query(AABB2D<T>(point, point), out);
+    }
+
+    /**
+    * Get the shape nearest to a point
+    * Boxes are visited best-first and candidates are refined with the exact DistanceSq(point, shape)
+    * @param point - the query point
+    * @param shapes - the shapes the tree was built from
+    * @return Neighbor2D - squared distance and index of the nearest shape
+    *         (distanceSq is infinity and index is shapes.size() when the tree is empty)
+    **/
+    template<class Shape>
+    Neighbor2D<T> Nearest(const Vector2D<T>& point, Span<const Shape> shapes)const
+    {
+        Neighbor2D<T> best = {std::numeric_limits<T>::infinity(), shapes.size()};
+        if(levels.empty())
+            return best;
+        T px = point.X(), py = point.Y();
+        std::priority_queue<Candidate> queue;
+        std::size_t root = minXs.size()-1;
+        Candidate c = {DistanceSq(root, px, py), int(levels.size())-1, root};
+        queue.push(c);
+        while(!queue.empty())
+        {
+            Candidate top = queue.top();
+            queue.pop();
+            if(top.level<0)
+            {
+                best.distanceSq = top.distanceSq;
+                best.index = top.entry;
+                break;
+            }
+            if(top.level==0)
+            {
+                Candidate exact = {T(Tools2D::DistanceSq(point, shapes[starts[top.entry]])), -1, starts[top.entry]};
+                queue.push(exact);
+                continue;
+            }
+            std::size_t first = levels[top.level-1]+starts[top.entry];
+            for(std::size_t i=first;i<first+counts[top.entry];i++)
+            {
+                Candidate child = {DistanceSq(i, px, py), top.level-1, i};
+                queue.push(child);
+            }
+        }
+        return best;
+    }
+};
+
+typedef RTree2D<double> RTree2d;
+typedef RTree2D<float> RTree2;
+
+}
+
+#endif
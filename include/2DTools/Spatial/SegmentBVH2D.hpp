@@ -0,0 +1,288 @@
+#ifndef SEGMENT_BVH_2D_HPP
+#define SEGMENT_BVH_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+#include <2DTools/Distances/BatchDistances2D.hpp>
+
+namespace Tools2D {
+
+/**
+* SegmentBVH2D Class
+* Bounding volume hierarchy over the segments of a polyline/polygon
+* Built once (top-down median split, O(n log n)) and stored as a flat array of nodes in depth-first order
+* (the left child of a node follows it, the right child is referenced by index)
+* The segments are kept in leaf order, so the segments of a leaf are next to each other in memory
+**/
+template<class T>
+class SegmentBVH2D
+{
+public:
+    // Maximum number of segments in a leaf
+    static const std::size_t LeafSize = 4;
+
+    struct Node
+    {
+        T minX, minY, maxX, maxY;
+        // leaf: first segment and number of segments - internal node: right child and 0
+        std::uint32_t start;
+        std::uint32_t count;
+    };
+protected:
+    std::vector<Node> nodes;
+    // Segment stored as P0, P1-P0 and 1/|P1-P0|^2 (see SegmentArray2D)
+    struct SegmentData
+    {
+        T x0, y0, dx, dy, invLengthSq;
+    };
+    // segments in leaf order
+    std::vector<SegmentData> segments;
+    // original index of every segment (as in PolylineView2D::GetSegment)
+    std::vector<std::size_t> indices;
+
+    // Maximum depth of the traversal stack (the median split keeps the depth at log2(n/LeafSize)+1)
+    static const std::size_t StackSize = 64;
+
+    /**
+    * Build the subtree of items [begin, end) and return the index of its root
+    **/
+    std::uint32_t Build(std::vector<std::uint32_t>& items, std::size_t begin, std::size_t end,
+                        const std::vector<AABB2D<T> >& boxes, const std::vector<Vector2D<T> >& centers)
+    {
+        std::uint32_t index = std::uint32_t(nodes.size());
+        nodes.push_back(Node());
+        AABB2D<T> box, centerBox;
+        for(std::size_t i=begin;i<end;i++)
+        {
+            box.Extend(boxes[items[i]]);
+            centerBox.Extend(centers[items[i]]);
+        }
+        Node node;
+        node.minX = box.Min().X();
+        node.minY = box.Min().Y();
+        node.maxX = box.Max().X();
+        node.maxY = box.Max().Y();
+        if(end-begin<=LeafSize)
+        {
+            node.start = std::uint32_t(begin);
+            node.count = std::uint32_t(end-begin);
+            nodes[index] = node;
+            return index;
+        }
+        // split at the median center along the longest axis of the centers
+        bool splitX = centerBox.Width()>=centerBox.Height();
+        std::size_t mid = begin+(end-begin)/2;
+        std::nth_element(items.begin()+begin, items.begin()+mid, items.begin()+end,
+                         [&](std::uint32_t a, std::uint32_t b) {
+                             return splitX ? centers[a].X()<centers[b].X() : centers[a].Y()<centers[b].Y();
+                         });
+        Build(items, begin, mid, boxes, centers);
+        node.start = Build(items, mid, end, boxes, centers);
+        node.count = 0;
+        nodes[index] = node;
+        return index;
+    }
+
+    static T BoxDistanceSq(const Node& node, T px, T py)
+    {
+        T dx = node.minX-px > px-node.maxX ? node.minX-px : px-node.maxX;
+        T dy = node.minY-py > py-node.maxY ? node.minY-py : py-node.maxY;
+        dx = dx>0 ? dx : 0;
+        dy = dy>0 ? dy : 0;
+        return dx*dx+dy*dy;
+    }
+
+    T SegmentDistanceSq(std::size_t j, T px, T py)const
+    {
+        const SegmentData& s = segments[j];
+        return detail::SegmentDistanceSq(px, py, s.x0, s.y0, s.dx, s.dy, s.invLengthSq);
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty hierarchy
+    **/
+    SegmentBVH2D(){}
+
+    /**
+    * Constructor - from the segments of a polyline (including the closing edge of a polygon)
+    * @param line - the polyline (the vertices are copied)
+    **/
+    explicit SegmentBVH2D(const PolylineView2D<T>& line)
+    {
+        Build(line);
+    }
+
+    explicit SegmentBVH2D(const Polyline2D<T>& line)
+    {
+        Build(line.View());
+    }
+
+    /**
+    * Rebuild the hierarchy from the segments of a polyline
+    * @param line - the polyline (the vertices are copied)
+    **/
+    void Build(const PolylineView2D<T>& line)
+    {
+        std::size_t n = line.SegmentCount();
+        nodes.clear();
+        segments.clear();
+        indices.clear();
+        if(n==0)
+            return;
+        std::vector<AABB2D<T> > boxes(n);
+        std::vector<Vector2D<T> > centers(n);
+        std::vector<std::uint32_t> items(n);
+        for(std::size_t i=0;i<n;i++)
+        {
+            Segment<T> s = line.GetSegment(i);
+            boxes[i].Extend(s.P0());
+            boxes[i].Extend(s.P1());
+            centers[i] = boxes[i].Center();
+            items[i] = std::uint32_t(i);
+        }
+        nodes.reserve(2*(n/LeafSize+1));
+        Build(items, 0, n, boxes, centers);
+        segments.resize(n);
+        indices.resize(n);
+        for(std::size_t i=0;i<n;i++)
+        {
+            Segment<T> s = line.GetSegment(items[i]);
+            T lengthSq = s.LengthSq();
+            SegmentData d = {s.P0().X(), s.P0().Y(), s.D().X(), s.D().Y(), lengthSq>0 ? 1/lengthSq : T(0)};
+            segments[i] = d;
+            indices[i] = items[i];
+        }
+    }
+
+    std::size_t Size()const {return indices.size();}
+    bool Empty()const {return indices.empty();}
+    std::size_t NodeCount()const {return nodes.size();}
+
+    /**
+    * Get the bounding box of all the segments
+    * @return AABB2D - the bounding box (empty if there are no segments)
+    **/
+    AABB2D<T> BoundingBox()const
+    {
+        if(nodes.empty())
+            return AABB2D<T>();
+        return AABB2D<T>(Vector2D<T>(nodes[0].minX, nodes[0].minY), Vector2D<T>(nodes[0].maxX, nodes[0].maxY));
+    }
+
+    /**
+    * Get the segment closest to a point (exact)
+    * @param point - the point
+    * @return ClosestSegment2D - squared distance, index (lowest one on ties) and parameter of the closest point
+    *         (distanceSq is infinity and index is Size() when there are no segments)
+    **/
+    ClosestSegment2D<T> Closest(const Vector2D<T>& point)const
+    {
+        ClosestSegment2D<T> result;
+        result.distanceSq = std::numeric_limits<T>::infinity();
+        result.index = Size();
+        result.t = 0;
+        if(nodes.empty())
+            return result;
+        T px = point.X(), py = point.Y();
+        std::size_t bestSlot = 0;
+        std::uint32_t stack[StackSize];
+        T stackDistance[StackSize];
+        std::size_t top = 0;
+        stack[top] = 0;
+        stackDistance[top++] = BoxDistanceSq(nodes[0], px, py);
+        while(top>0)
+        {
+            top--;
+            if(stackDistance[top]>result.distanceSq)
+                continue;
+            const Node* node = &nodes[stack[top]];
+            // descend to the nearest leaf, pushing the farther children
+            while(node->count==0)
+            {
+                std::uint32_t left = std::uint32_t(node-&nodes[0])+1, right = node->start;
+                T dl = BoxDistanceSq(nodes[left], px, py), dr = BoxDistanceSq(nodes[right], px, py);
+                std::uint32_t near = left, far = right;
+                if(dr<dl)
+                {
+                    std::swap(near, far);
+                    std::swap(dl, dr);
+                }
+                if(dl>result.distanceSq)
+                    break;
+                if(dr<=result.distanceSq)
+                {
+                    stack[top] = far;
+                    stackDistance[top++] = dr;
+                }
+                node = &nodes[near];
+            }
+            if(node->count==0)
+                continue;
+            for(std::size_t j=node->start;j<node->start+node->count;j++)
+            {
+                T d = SegmentDistanceSq(j, px, py);
+                if(d<result.distanceSq || (d==result.distanceSq && indices[j]<result.index))
+                {
+                    result.distanceSq = d;
+                    result.index = indices[j];
+                    bestSlot = j;
+                }
+            }
+        }
+        const SegmentData& s = segments[bestSlot];
+        result.t = detail::ClampedSegmentT(px-s.x0, py-s.y0, s.dx, s.dy, s.invLengthSq);
+        return result;
+    }
+
+    /**
+    * Get all the segments within a radius of a point
+    * @param point - the point
+    * @param radius - the radius (segments at distance <= radius are reported)
+    * @param out - indices of the segments are appended here (in no particular order)
+    * @return std::size_t - number of segments found
+    **/
+    std::size_t Query(const Vector2D<T>& point, T radius, std::vector<std::size_t>& out)const
+    {
+        if(nodes.empty())
+            return 0;
+        std::size_t found = out.size();
+        T px = point.X(), py = point.Y(), r2 = radius*radius;
+        std::uint32_t stack[StackSize];
+        std::size_t top = 0;
+        stack[top++] = 0;
+        while(top>0)
+        {
+            std::uint32_t index = stack[--top];
+            const Node& node = nodes[index];
+            if(BoxDistanceSq(node, px, py)>r2)
+                continue;
+            if(node.count==0)
+            {
+                stack[top++] = node.start;
+                stack[top++] = index+1;
+                continue;
+            }
+            for(std::size_t j=node.start;j<node.start+node.count;j++)
+                if(SegmentDistanceSq(j, px, py)<=r2)
+                    out.push_back(indices[j]);
+        }
+        return out.size()-found;
+    }
+};
+
+typedef SegmentBVH2D<double> SegmentBVH2d;
+typedef SegmentBVH2D<float> SegmentBVH2;
+
+}
+
+#endif
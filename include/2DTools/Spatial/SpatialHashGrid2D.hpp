@@ -0,0 +1,282 @@
+#ifndef SPATIAL_HASH_GRID_2D_HPP
+#define SPATIAL_HASH_GRID_2D_HPP
+
+/**
+* Includes
+**/
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Misc/Parallel.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+
+namespace Tools2D {
+
+/**
+* SpatialHashGrid2D Class
+* Uniform grid hashed into a table of buckets, rebuilt from scratch every frame in linear time (counting sort)
+* Objects (points or boxes) are binned by their center; the cell size is the search radius plus the largest
+* box size, so all the objects within the radius of an object are in its cell or in the 8 cells around it
+* All the arrays are kept between builds (no allocations once they have grown to the working size)
+**/
+template<class T>
+class SpatialHashGrid2D
+{
+public:
+    typedef std::pair<std::uint32_t, std::uint32_t> Pair;
+protected:
+    T radius;
+    T cellSize;
+    T invCellSize;
+    T maxExtent;
+    std::size_t count;
+    std::uint32_t mask;
+    // bucket b holds the objects [starts[b], starts[b+1]) of the sorted arrays
+    std::vector<std::uint32_t> starts;
+    std::vector<std::uint32_t> keys;
+    // objects in bucket order: original index, cell and box
+    std::vector<std::uint32_t> items;
+    std::vector<std::int32_t> cellXs, cellYs;
+    std::vector<T> minXs, minYs, maxXs, maxYs;
+    // per-thread pair buffers of FindPairs
+    std::vector<std::vector<Pair> > threadPairs;
+
+    /**
+    * Cell of a coordinate, clamped so that its neighbours (c-1, c+1) fit in 32 bits too (NaN goes to the lowest cell)
+    * Clamping keeps the order, so objects in adjacent cells are still in adjacent (or the same) cells
+    **/
+    std::int32_t Cell(T v)const
+    {
+        T c = std::floor(v*invCellSize);
+        const std::int32_t low = -2147483647, high = 2147483646;
+        return c>T(low) ? (c<T(high) ? std::int32_t(c) : high) : low;
+    }
+
+    std::uint32_t Bucket(std::int32_t cx, std::int32_t cy)const
+    {
+        return ((std::uint32_t(cx)*73856093u)^(std::uint32_t(cy)*19349663u))&mask;
+    }
+
+    bool Close(std::size_t a, std::size_t b, T r2)const
+    {
+        T dx = std::max(std::max(minXs[a]-maxXs[b], minXs[b]-maxXs[a]), T(0));
+        T dy = std::max(std::max(minYs[a]-maxYs[b], minYs[b]-maxYs[a]), T(0));
+        return dx*dx+dy*dy<=r2;
+    }
+
+    /**
+    * Counting sort of the boxes stored in the unsorted arrays (index i of the input in slot i)
+    **/
+    void Sort(const std::vector<T>& bx0, const std::vector<T>& by0, const std::vector<T>& bx1, const std::vector<T>& by1)
+    {
+        std::size_t tableSize = 1;
+        while(tableSize<2*count)
+            tableSize *= 2;
+        mask = std::uint32_t(tableSize-1);
+        starts.assign(tableSize+1, 0);
+        keys.resize(count);
+        for(std::size_t i=0;i<count;i++)
+        {
+            keys[i] = Bucket(Cell((bx0[i]+bx1[i])/2), Cell((by0[i]+by1[i])/2));
+            starts[keys[i]+1]++;
+        }
+        for(std::size_t b=0;b<tableSize;b++)
+            starts[b+1] += starts[b];
+        items.resize(count);
+        cellXs.resize(count);
+        cellYs.resize(count);
+        minXs.resize(count);
+        minYs.resize(count);
+        maxXs.resize(count);
+        maxYs.resize(count);
+        for(std::size_t i=0;i<count;i++)
+        {
+            std::uint32_t slot = starts[keys[i]]++;
+            items[slot] = std::uint32_t(i);
+            cellXs[slot] = Cell((bx0[i]+bx1[i])/2);
+            cellYs[slot] = Cell((by0[i]+by1[i])/2);
+            minXs[slot] = bx0[i];
+            minYs[slot] = by0[i];
+            maxXs[slot] = bx1[i];
+            maxYs[slot] = by1[i];
+        }
+        // the scatter moved every start to the end of its bucket
+        for(std::size_t b=tableSize;b>0;b--)
+            starts[b] = starts[b-1];
+        starts[0] = 0;
+    }
+
+    // Input boxes of the current build (kept to reuse their memory)
+    std::vector<T> inMinX, inMinY, inMaxX, inMaxY;
+
+    void Setup(T r)
+    {
+        radius = r;
+        cellSize = r+maxExtent;
+        if(!(cellSize>0))
+            cellSize = 1;
+        invCellSize = 1/cellSize;
+        Sort(inMinX, inMinY, inMaxX, inMaxY);
+    }
+
+    /**
+    * Pairs of the sorted objects [begin, end) with the objects of their cell (after them) and of the
+    * 4 forward neighbour cells (every pair is found exactly once)
+    **/
+    void FindPairs(std::size_t begin, std::size_t end, std::vector<Pair>& out)const
+    {
+        static const std::int32_t offsets[4][2] = {{1, -1}, {1, 0}, {1, 1}, {0, 1}};
+        T r2 = radius*radius;
+        for(std::size_t a=begin;a<end;a++)
+        {
+            std::int32_t cx = cellXs[a], cy = cellYs[a];
+            std::uint32_t bucket = Bucket(cx, cy);
+            for(std::size_t b=a+1;b<starts[bucket+1];b++)
+                if(cellXs[b]==cx && cellYs[b]==cy && Close(a, b, r2))
+                    out.push_back(Pair(items[a], items[b]));
+            for(int k=0;k<4;k++)
+            {
+                std::int32_t nx = cx+offsets[k][0], ny = cy+offsets[k][1];
+                std::uint32_t neighbour = Bucket(nx, ny);
+                for(std::size_t b=starts[neighbour];b<starts[neighbour+1];b++)
+                    if(cellXs[b]==nx && cellYs[b]==ny && Close(a, b, r2))
+                        out.push_back(Pair(items[a], items[b]));
+            }
+        }
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty grid
+    **/
+    SpatialHashGrid2D():radius(0),cellSize(1),invCellSize(1),maxExtent(0),count(0),mask(0){}
+
+    /**
+    * Rebuild the grid from points
+    * @param points - the points
+    * @param r - search radius of the queries
+    **/
+    void Build(Span<const Vector2D<T> > points, T r)
+    {
+        count = points.size();
+        inMinX.resize(count);
+        inMinY.resize(count);
+        for(std::size_t i=0;i<count;i++)
+        {
+            inMinX[i] = points[i].X();
+            inMinY[i] = points[i].Y();
+        }
+        inMaxX.assign(inMinX.begin(), inMinX.end());
+        inMaxY.assign(inMinY.begin(), inMinY.end());
+        maxExtent = 0;
+        Setup(r);
+    }
+
+    /**
+    * Rebuild the grid from boxes (e.g. shape bounding boxes)
+    * @param boxes - the boxes
+    * @param r - search radius of the queries (gap between the boxes)
+    **/
+    void Build(Span<const AABB2D<T> > boxes, T r)
+    {
+        count = boxes.size();
+        inMinX.resize(count);
+        inMinY.resize(count);
+        inMaxX.resize(count);
+        inMaxY.resize(count);
+        maxExtent = 0;
+        for(std::size_t i=0;i<count;i++)
+        {
+            inMinX[i] = boxes[i].Min().X();
+            inMinY[i] = boxes[i].Min().Y();
+            inMaxX[i] = boxes[i].Max().X();
+            inMaxY[i] = boxes[i].Max().Y();
+            maxExtent = std::max(maxExtent, std::max(boxes[i].Width(), boxes[i].Height()));
+        }
+        Setup(r);
+    }
+
+    std::size_t Size()const {return count;}
+    T Radius()const {return radius;}
+    T CellSize()const {return cellSize;}
+
+    /**
+    * Find all the pairs of objects within the radius of each other
+    * Each thread enumerates the pairs of a range of buckets into its own buffer (no locks)
+    * @param out - the pairs (i, j) of object indices (cleared first, order depends on the grid)
+    * @param threads - number of threads (0 means all hardware threads)
+    * @return std::size_t - number of pairs
+    **/
+    std::size_t FindPairs(std::vector<Pair>& out, unsigned int threads = 1)
+    {
+        out.clear();
+        std::size_t chunks = ResolveThreads(threads);
+        if(chunks==1)
+        {
+            FindPairs(0, count, out);
+            return out.size();
+        }
+        // more chunks than threads to even out dense regions
+        chunks *= 4;
+        if(threadPairs.size()<chunks)
+            threadPairs.resize(chunks);
+        std::size_t chunk = (count+chunks-1)/chunks;
+        ParallelFor(0, chunks, [&](std::size_t c) {
+            threadPairs[c].clear();
+            std::size_t b = std::min(count, c*chunk);
+            FindPairs(b, std::min(count, b+chunk), threadPairs[c]);
+        }, threads, 1);
+        std::size_t total = 0;
+        for(std::size_t c=0;c<chunks;c++)
+            total += threadPairs[c].size();
+        out.reserve(total);
+        for(std::size_t c=0;c<chunks;c++)
+            out.insert(out.end(), threadPairs[c].begin(), threadPairs[c].end());
+        return out.size();
+    }
+
+    /**
+    * Get the objects within a distance of a point
+    * @param point - the query point
+    * @param r - the distance (at most the radius of the build)
+    * @param out - indices of the objects are appended here (in no particular order)
+    * @return std::size_t - number of objects found
+    **/
+    std::size_t Query(const Vector2D<T>& point, T r, std::vector<std::size_t>& out)const
+    {
+        std::size_t found = out.size();
+        if(count==0)
+            return 0;
+        std::int32_t cx = Cell(point.X()), cy = Cell(point.Y());
+        T r2 = r*r;
+        for(std::int32_t ny=cy-1;ny<=cy+1;ny++)
+        {
+            for(std::int32_t nx=cx-1;nx<=cx+1;nx++)
+            {
+                std::uint32_t bucket = Bucket(nx, ny);
+                for(std::size_t b=starts[bucket];b<starts[bucket+1];b++)
+                {
+                    if(cellXs[b]!=nx || cellYs[b]!=ny)
+                        continue;
+                    T dx = std::max(std::max(minXs[b]-point.X(), point.X()-maxXs[b]), T(0));
+                    T dy = std::max(std::max(minYs[b]-point.Y(), point.Y()-maxYs[b]), T(0));
+                    if(dx*dx+dy*dy<=r2)
+                        out.push_back(items[b]);
+                }
+            }
+        }
+        return out.size()-found;
+    }
+};
+
+typedef SpatialHashGrid2D<double> SpatialHashGrid2d;
+typedef SpatialHashGrid2D<float> SpatialHashGrid2;
+
+}
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef SWEEP_AND_PRUNE_2D_HPP
+#define SWEEP_AND_PRUNE_2D_HPP
+
+/**
+* Includes
+**/
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+#include <2DTools/Misc/Span.hpp>
+#include <2DTools/Math/Vector2D.hpp>
+#include <2DTools/Primitives/AABB2D.hpp>
+
+namespace Tools2D {
+
+/**
+* SweepAndPrune2D Class
+* Incremental sweep-and-prune broadphase over the bounding boxes of moving bodies
+* The min/max endpoints of every body are kept sorted on both axes between frames; after the boxes are moved,
+* Update restores the order with insertion sort (nearly linear when the motion is small) and every swap of a
+* min and a max endpoint adds or removes a pair, so only the pair changes are reported (touching counts as overlap)
+* Boxes must be finite; the number of swaps of the last update is kept to spot degenerate frames
+* (e.g. many bodies aligned on one axis)
+**/
+template<class T>
+class SweepAndPrune2D
+{
+public:
+    typedef std::uint32_t Handle;
+    typedef std::pair<Handle, Handle> Pair;
+    static const Handle Invalid = 0xffffffffu;
+protected:
+    struct Endpoint
+    {
+        T value;
+        // body<<1 | 1 for a max endpoint
+        std::uint32_t data;
+    };
+
+    struct Body
+    {
+        T lo[2], hi[2];
+        // position of the min/max endpoints on both axes
+        std::uint32_t minIndex[2], maxIndex[2];
+        bool alive;
+    };
+
+    std::vector<Endpoint> axes[2];
+    std::vector<Body> bodies;
+    std::vector<Handle> freeBodies;
+    // bodies removed since the last update (their endpoints are moved to the end of the axes)
+    std::vector<Handle> removed;
+    std::unordered_set<std::uint64_t> pairs;
+    // pairs added or removed during the update (a pair toggled twice did not change)
+    std::vector<std::uint64_t> toggled;
+    std::size_t swaps[2];
+    std::size_t count;
+
+    static bool Less(const Endpoint& a, const Endpoint& b)
+    {
+        // a min sorts before a max of the same value so touching boxes overlap
+        return a.value<b.value || (a.value==b.value && (a.data&1u)<(b.data&1u));
+    }
+
+    static std::uint64_t Key(Handle a, Handle b)
+    {
+        return a<b ? (std::uint64_t(a)<<32)|b : (std::uint64_t(b)<<32)|a;
+    }
+
+    bool Overlaps(Handle a, Handle b)const
+    {
+        const Body& p = bodies[a];
+        const Body& q = bodies[b];
+        return p.alive && q.alive && p.lo[0]<=q.hi[0] && q.lo[0]<=p.hi[0] && p.lo[1]<=q.hi[1] && q.lo[1]<=p.hi[1];
+    }
+
+    void SetIndex(int axis, const Endpoint& e, std::uint32_t index)
+    {
+        Body& body = bodies[e.data>>1];
+        if(e.data&1u)
+            body.maxIndex[axis] = index;
+        else
+            body.minIndex[axis] = index;
+    }
+
+    void Toggle(std::uint64_t key, bool add)
+    {
+        if(add ? pairs.insert(key).second : pairs.erase(key)>0)
+            toggled.push_back(key);
+    }
+
+    /**
+    * Insertion sort of an axis, updating the pairs on every min/max swap
+    **/
+    void Sort(int axis)
+    {
+        std::vector<Endpoint>& e = axes[axis];
+        std::size_t n = 0;
+        for(std::size_t i=1;i<e.size();i++)
+        {
+            Endpoint moving = e[i];
+            std::size_t j = i;
+            while(j>0 && Less(moving, e[j-1]))
+            {
+                const Endpoint& other = e[j-1];
+                Handle a = moving.data>>1, b = other.data>>1;
+                bool movingMax = (moving.data&1u)!=0, otherMax = (other.data&1u)!=0;
+                if(a!=b && movingMax!=otherMax)
+                {
+                    // a min passing a max may start an overlap (checked on both axes with the new boxes),
+                    // a max passing a min ends it
+                    if(!movingMax)
+                    {
+                        if(Overlaps(a, b))
+                            Toggle(Key(a, b), true);
+                    }
+                    else
+                        Toggle(Key(a, b), false);
+                }
+                e[j] = other;
+                SetIndex(axis, other, std::uint32_t(j));
+                j--;
+                n++;
+            }
+            if(j!=i)
+            {
+                e[j] = moving;
+                SetIndex(axis, moving, std::uint32_t(j));
+            }
+        }
+        swaps[axis] = n;
+    }
+
+    /**
+    * Remove the pairs between two removed bodies (their endpoints are all equal, so they never swap)
+    **/
+    void RemoveDeadPairs()
+    {
+        if(removed.size()*removed.size()<=pairs.size())
+        {
+            for(std::size_t i=0;i<removed.size();i++)
+                for(std::size_t j=i+1;j<removed.size();j++)
+                    Toggle(Key(removed[i], removed[j]), false);
+            return;
+        }
+        for(typename std::unordered_set<std::uint64_t>::iterator it=pairs.begin();it!=pairs.end();)
+        {
+            if(!bodies[*it>>32].alive && !bodies[*it&0xffffffffu].alive)
+            {
+                toggled.push_back(*it);
+                it = pairs.erase(it);
+            }
+            else
+                ++it;
+        }
+    }
+
+    void WriteBox(Handle handle, const AABB2D<T>& box)
+    {
+        Body& body = bodies[handle];
+        body.lo[0] = box.Min().X();
+        body.lo[1] = box.Min().Y();
+        body.hi[0] = box.Max().X();
+        body.hi[1] = box.Max().Y();
+        for(int axis=0;axis<2;axis++)
+        {
+            axes[axis][body.minIndex[axis]].value = body.lo[axis];
+            axes[axis][body.maxIndex[axis]].value = body.hi[axis];
+        }
+    }
+
+    Handle NewBody()
+    {
+        Handle handle;
+        if(!freeBodies.empty())
+        {
+            handle = freeBodies.back();
+            freeBodies.pop_back();
+        }
+        else
+        {
+            handle = Handle(bodies.size());
+            bodies.push_back(Body());
+        }
+        bodies[handle].alive = true;
+        count++;
+        return handle;
+    }
+public:
+    /**
+    * Default Constructor
+    * Creates an empty broadphase
+    **/
+    SweepAndPrune2D():count(0)
+    {
+        swaps[0] = swaps[1] = 0;
+    }
+
+    /**
+    * Rebuild from scratch (full sort and sweep, use it for the first frame instead of many Insert calls)
+    * Body i gets handle i; the overlapping pairs are available with Pairs (no events are reported)
+    * @param boxes - the bounding boxes of the bodies
+    **/
+    void Build(Span<const AABB2D<T> > boxes)
+    {
+        Clear();
+        std::size_t n = boxes.size();
+        bodies.resize(n);
+        for(int axis=0;axis<2;axis++)
+            axes[axis].resize(2*n);
+        for(std::size_t i=0;i<n;i++)
+        {
+            bodies[i].alive = true;
+            bodies[i].lo[0] = boxes[i].Min().X();
+            bodies[i].lo[1] = boxes[i].Min().Y();
+            bodies[i].hi[0] = boxes[i].Max().X();
+            bodies[i].hi[1] = boxes[i].Max().Y();
+            for(int axis=0;axis<2;axis++)
+            {
+                Endpoint lo = {bodies[i].lo[axis], std::uint32_t(i<<1)};
+                Endpoint hi = {bodies[i].hi[axis], std::uint32_t((i<<1)|1u)};
+                axes[axis][2*i] = lo;
+                axes[axis][2*i+1] = hi;
+            }
+        }
+        count = n;
+        for(int axis=0;axis<2;axis++)
+        {
+            std::sort(axes[axis].begin(), axes[axis].end(), Less);
+            for(std::size_t j=0;j<2*n;j++)
+                SetIndex(axis, axes[axis][j], std::uint32_t(j));
+        }
+        // sweep on x: every body overlaps the open bodies whose y range meets its own
+        std::vector<Handle> open;
+        std::vector<std::uint32_t> slot(n);
+        for(std::size_t j=0;j<2*n;j++)
+        {
+            const Endpoint& e = axes[0][j];
+            Handle a = e.data>>1;
+            if(e.data&1u)
+            {
+                // swap-remove from the open list
+                open[slot[a]] = open.back();
+                slot[open.back()] = slot[a];
+                open.pop_back();
+                continue;
+            }
+            for(std::size_t k=0;k<open.size();k++)
+                if(bodies[a].lo[1]<=bodies[open[k]].hi[1] && bodies[open[k]].lo[1]<=bodies[a].hi[1])
+                    pairs.insert(Key(a, open[k]));
+            slot[a] = std::uint32_t(open.size());
+            open.push_back(a);
+        }
+    }
+
+    /**
+    * Rebuild from the bounding boxes of polylines/polygons
+    * @param shapes - the shapes (any class with a BoundingBox overload, e.g. Polygon2D, Rectangle2D)
+    **/
+    template<class Shape>
+    void BuildFromShapes(Span<const Shape> shapes)
+    {
+        std::vector<AABB2D<T> > boxes(shapes.size());
+        for(std::size_t i=0;i<shapes.size();i++)
+            boxes[i] = BoundingBox(shapes[i]);
+        Build(boxes);
+    }
+
+    /**
+    * Remove all the bodies (memory is kept, handles are invalidated)
+    **/
+    void Clear()
+    {
+        axes[0].clear();
+        axes[1].clear();
+        bodies.clear();
+        freeBodies.clear();
+        removed.clear();
+        pairs.clear();
+        toggled.clear();
+        swaps[0] = swaps[1] = 0;
+        count = 0;
+    }
+
+    std::size_t Size()const {return count;}
+    bool Empty()const {return count==0;}
+    std::size_t PairCount()const {return pairs.size();}
+
+    /**
+    * Insert a new body (its pairs are reported by the next Update)
+    * @param box - bounding box of the body
+    * @return Handle - handle of the body (stays valid until it is removed)
+    **/
+    Handle Insert(const AABB2D<T>& box)
+    {
+        Handle handle = NewBody();
+        Body& body = bodies[handle];
+        for(int axis=0;axis<2;axis++)
+        {
+            // appended at the end (right of everything), Update moves the endpoints into place
+            Endpoint lo = {T(0), handle<<1};
+            Endpoint hi = {T(0), (handle<<1)|1u};
+            body.minIndex[axis] = std::uint32_t(axes[axis].size());
+            axes[axis].push_back(lo);
+            body.maxIndex[axis] = std::uint32_t(axes[axis].size());
+            axes[axis].push_back(hi);
+        }
+        WriteBox(handle, box);
+        return handle;
+    }
+
+    /**
+    * Remove a body (its pairs are reported as removed by the next Update, the handle is reused after it)
+    * @param handle - handle of the body
+    **/
+    void Remove(Handle handle)
+    {
+        // the endpoints move past all the others to the end of the axes during the update
+        T far = std::numeric_limits<T>::max();
+        WriteBox(handle, AABB2D<T>(Vector2D<T>(far, far), Vector2D<T>(far, far)));
+        bodies[handle].alive = false;
+        removed.push_back(handle);
+        count--;
+    }
+
+    /**
+    * Set the bounding box of a body (the pairs are updated by the next Update)
+    * @param handle - handle of the body
+    * @param box - new bounding box of the body
+    **/
+    void Move(Handle handle, const AABB2D<T>& box)
+    {
+        WriteBox(handle, box);
+    }
+
+    /**
+    * Get the bounding box of a body
+    * @param handle - handle of the body
+    * @return AABB2D - the bounding box
+    **/
+    AABB2D<T> Box(Handle handle)const
+    {
+        const Body& body = bodies[handle];
+        return AABB2D<T>(Vector2D<T>(body.lo[0], body.lo[1]), Vector2D<T>(body.hi[0], body.hi[1]));
+    }
+
+    /**
+    * Re-sort the endpoints after the moves/inserts/removes and report the pair changes
+    * @param added - pairs that started to overlap since the last update (cleared first)
+    * @param removedPairs - pairs that stopped overlapping (or lost a body) since the last update (cleared first)
+    * @return std::size_t - number of endpoint swaps on both axes (about the number of endpoints passing each other)
+    **/
+    std::size_t Update(std::vector<Pair>& added, std::vector<Pair>& removedPairs)
+    {
+        added.clear();
+        removedPairs.clear();
+        toggled.clear();
+        RemoveDeadPairs();
+        Sort(0);
+        Sort(1);
+        // a pair toggled an even number of times is back in its previous state
+        std::sort(toggled.begin(), toggled.end());
+        for(std::size_t i=0;i<toggled.size();)
+        {
+            std::size_t j = i+1;
+            while(j<toggled.size() && toggled[j]==toggled[i])
+                j++;
+            if((j-i)&1u)
+            {
+                Pair pair(Handle(toggled[i]>>32), Handle(toggled[i]&0xffffffffu));
+                if(pairs.count(toggled[i]))
+                    added.push_back(pair);
+                else
+                    removedPairs.push_back(pair);
+            }
+            i = j;
+        }
+        // the endpoints of the removed bodies are now the last ones
+        if(!removed.empty())
+        {
+            for(int axis=0;axis<2;axis++)
+                axes[axis].resize(axes[axis].size()-2*removed.size());
+            freeBodies.insert(freeBodies.end(), removed.begin(), removed.end());
+            removed.clear();
+        }
+        return swaps[0]+swaps[1];
+    }
+
+    /**
+    * Get the number of endpoint swaps of the last update on one axis
+    * @param axis - 0 for x, 1 for y
+    * @return std::size_t - number of swaps
+    **/
+    std::size_t Swaps(int axis)const {return swaps[axis];}
+
+    /**
+    * Get all the overlapping pairs (as of the last Build/Update)
+    * @param out - the pairs (lower handle first, in no particular order, cleared first)
+    * @return std::size_t - number of pairs
+    **/
+    std::size_t Pairs(std::vector<Pair>& out)const
+    {
+        out.clear();
+        out.reserve(pairs.size());
+        for(typename std::unordered_set<std::uint64_t>::const_iterator it=pairs.begin();it!=pairs.end();++it)
+            out.push_back(Pair(Handle(*it>>32), Handle(*it&0xffffffffu)));
+        return out.size();
+    }
+};
+
+typedef SweepAndPrune2D<double> SweepAndPrune2d;
+typedef SweepAndPrune2D<float> SweepAndPrune2;
+
+}
+
+#endif
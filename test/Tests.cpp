@@ -2,10 +2,86 @@
 #include <2DTools/Math/Vector2D.hpp>
 #include <2DTools/Math/Matrix2D.hpp>
 #include <2DTools/Math/Matrix1D.hpp>
+#include <2DTools/Math/Affine2D.hpp>
+#include <2DTools/Math/Transforms2D.hpp>
 #include <2DTools/Primitives/Polygons.hpp>
+#include <2DTools/Primitives/PointCloud2D.hpp>
+#include <2DTools/Primitives/ConvexPolygon2D.hpp>
 #include <2DTools/Distances/Distances2D.hpp>
+#include <2DTools/Distances/BatchDistances2D.hpp>
+#include <2DTools/Intersections/GJK2D.hpp>
+#include <2DTools/Algorithms/RotatingCalipers2D.hpp>
+#include <2DTools/Algorithms/ConvexHull2D.hpp>
+#include <2DTools/Algorithms/Triangulation2D.hpp>
+#include <2DTools/Algorithms/PolygonBoolean2D.hpp>
+#include <2DTools/Algorithms/Clipping2D.hpp>
+#include <2DTools/Algorithms/Simplification2D.hpp>
+#include <2DTools/Spatial/SegmentBVH2D.hpp>
+#include <2DTools/Spatial/KdTree2D.hpp>
+#include <2DTools/Spatial/RTree2D.hpp>
+#include <2DTools/Spatial/LooseQuadtree2D.hpp>
+#include <2DTools/Spatial/SpatialHashGrid2D.hpp>
+#include <2DTools/Spatial/SweepAndPrune2D.hpp>
+#include <2DTools/Spatial/PointLocator2D.hpp>
+#include <2DTools/Spatial/PreparedPolygon2D.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <set>
+#include <type_traits>
 using namespace Tools2D;
 
+/**
+* Global allocation counter (used to check that code paths do not touch the heap)
+* Atomic because the parallel code paths allocate from worker threads
+**/
+static std::atomic<unsigned long> allocations(0);
+
+/**
+* The replacements stay out of line: inlined, GCC pairs malloc/free with operator new/delete (-Wmismatched-new-delete)
+**/
+#if defined(__GNUC__)
+#define TEST_NOINLINE __attribute__((noinline))
+#else
+#define TEST_NOINLINE
+#endif
+
+TEST_NOINLINE void* operator new(std::size_t size)
+{
+    allocations++;
+    void* p = std::malloc(size ? size : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+TEST_NOINLINE void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+TEST_NOINLINE void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+TEST_NOINLINE void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST_NOINLINE void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+TEST_NOINLINE void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
 TEST(Vector2DTest, DefaultConstructor) {
     Vector2D<double> d;
     EXPECT_EQ(d.X(), 0.0);
@@ -57,9 +133,56 @@ TEST(Vector2DTest, Perp2) {
     EXPECT_EQ(d.Dot(x), 0.0);
 }
 
+TEST(Vector2DTest, Constexpr) {
+    constexpr Vector2d a(3.0, 4.0);
+    constexpr Vector2d b = a.Perp()+2.0*a-Vector2d(1.0, 1.0)/2.0;
+    static_assert(b.X()==1.5 && b.Y()==10.5, "constexpr arithmetic");
+    static_assert(a.Dot(a.Perp())==0.0, "constexpr Dot/Perp");
+    static_assert(a.LengthSq()==25.0, "constexpr LengthSq");
+    constexpr Vector2d c = Vector2d(1.0, 2.0)*Matrix2d(1, 0, 0, 0, 1, 0, 5, 6, 1);
+    static_assert(c==Vector2d(6.0, 8.0), "constexpr transform");
+    EXPECT_EQ(b.X(), 1.5);
+}
+
+// rotation by 90 degrees and translation (evaluated at compile time below)
+constexpr Matrix2d MountFrame()
+{
+    Matrix2d m;
+    m.RotateCS(0.0, 1.0);
+    m.Translate(2.0, 3.0);
+    return m;
+}
+
+TEST(Matrix2DTest, Constexpr) {
+    constexpr Matrix2d frame = MountFrame();
+    static_assert(frame(0,1)==1.0 && frame(1,0)==-1.0 && frame(2,0)==2.0, "constexpr Rotate/Translate");
+    static_assert(frame.Det()==1.0, "constexpr Det");
+    constexpr Matrix2d inv = frame.Inverse();
+    constexpr Matrix2d id = frame*inv;
+    static_assert(id(0,0)==1.0 && id(1,1)==1.0 && id(2,0)==0.0 && id(2,1)==0.0, "constexpr Inverse");
+    static_assert(frame.Transpose()(1,0)==frame(0,1), "constexpr Transpose");
+    constexpr Matrix1D<double> m(2.0, 1.0, 1.0, 1.0);
+    static_assert((m*m.Inverse())(0,0)==1.0 && (m*m.Inverse())(0,1)==0.0, "constexpr Matrix1D Inverse");
+    static_assert(m.Transpose().Det()==1.0, "constexpr Matrix1D Det/Transpose");
+    EXPECT_EQ(id(2,2), 1.0);
+}
+
+TEST(Matrix2DTest, Inverse) {
+    Matrix2d mat;
+    mat.Rotate(0.4);
+    mat.Scale(2.0, 0.5);
+    mat.Translate(-1.0, 3.0);
+    mat(0,2) = 0.1;
+    Matrix2d id = mat*mat.Inverse();
+    for(int i=0;i<3;i++) {
+        for(int j=0;j<3;j++)
+            EXPECT_NEAR(id(i,j), i==j ? 1.0 : 0.0, 1e-12);
+    }
+}
+
 TEST(Matrix2DTest, DefaultConstructor) {
     Matrix2D<double> tmp;
-    double** d = tmp.getData();
+    const Matrix2d::DataType& d = tmp.getData();
     for(int i=0;i<3;i++) {
         for(int j=0;j<3;j++) {
             if(i==j)
@@ -74,9 +197,9 @@ TEST(Matrix2DTest, Identity) {
     Matrix2D<double> tmp;
     Matrix2D<double> tr = tmp.Transpose();
     Matrix2D<double> inv = tmp.Inverse();
-    double** d1 = tmp.getData();
-    double** d2 = tmp.getData();
-    double** d3 = tmp.getData();
+    const Matrix2d::DataType& d1 = tmp.getData();
+    const Matrix2d::DataType& d2 = tr.getData();
+    const Matrix2d::DataType& d3 = inv.getData();
     for(int i=0;i<3;i++) {
         for(int j=0;j<3;j++) {
             EXPECT_EQ(d1[i][j], d2[i][j]);
@@ -104,9 +227,28 @@ TEST(Matrix2DTest, Multiplication) {
     EXPECT_EQ(t(2,2), 1);
 }
 
+TEST(Matrix2DTest, NoAllocations) {
+    EXPECT_TRUE(std::is_trivially_copyable<Matrix2d>::value);
+    unsigned long before = allocations;
+    Matrix2d mat;
+    mat.Translate(2.0, 3.0);
+    mat.Scale(2.0, 0.5);
+    mat.Rotate(0.3);
+    Matrix2d copy = mat;
+    Matrix2d moved = std::move(copy);
+    Matrix2d res = moved*mat.Transpose()+mat.Inverse()-mat;
+    res *= 2.0;
+    const Matrix2d::DataType& d = res.getData();
+    Vector2d v(1.0, 2.0);
+    v *= mat;
+    unsigned long after = allocations;
+    EXPECT_EQ(after, before);
+    EXPECT_EQ(d[0][0], res(0,0));
+}
+
 TEST(Matrix1DTest, DefaultConstructor) {
     Matrix1D<double> tmp;
-    double** d = tmp.getData();
+    const Matrix1D<double>::DataType& d = tmp.getData();
     for(int i=0;i<2;i++) {
         for(int j=0;j<2;j++) {
             if(i==j)
@@ -121,9 +263,9 @@ TEST(Matrix1DTest, Identity) {
     Matrix1D<double> tmp;
     Matrix1D<double> tr = tmp.Transpose();
     Matrix1D<double> inv = tmp.Inverse();
-    double** d1 = tmp.getData();
-    double** d2 = tmp.getData();
-    double** d3 = tmp.getData();
+    const Matrix1D<double>::DataType& d1 = tmp.getData();
+    const Matrix1D<double>::DataType& d2 = tr.getData();
+    const Matrix1D<double>::DataType& d3 = inv.getData();
     for(int i=0;i<2;i++) {
         for(int j=0;j<2;j++) {
             EXPECT_EQ(d1[i][j], d2[i][j]);
@@ -161,6 +303,142 @@ TEST(Matrix1DTest, Eigenvalues) {
     EXPECT_EQ(tmp2(1,1), tmp(1,1));
 }
 
+TEST(Matrix1DTest, EigenSymmetric) {
+    Matrix1D<double> tmp;
+    tmp(0,0) = 4;
+    tmp(0,1) = tmp(1,0) = 1;
+    tmp(1,1) = 2;
+    unsigned long before = allocations;
+    Eigen2D<double> eig = tmp.EigenSymmetric();
+    std::array<double,2> vals = tmp.Eigenvalues();
+    Matrix1D<double> eigD;
+    Matrix1D<double> eigP;
+    tmp.EigenDiagonalize(eigD, eigP);
+    unsigned long after = allocations;
+    EXPECT_EQ(after, before);
+    EXPECT_NEAR(eig.values[0], 3.0-sqrt(2.0), 1e-12);
+    EXPECT_NEAR(eig.values[1], 3.0+sqrt(2.0), 1e-12);
+    EXPECT_NEAR(eig.values[0], vals[1], 1e-12);
+    EXPECT_NEAR(eig.values[1], vals[0], 1e-12);
+    for(int i=0;i<2;i++) {
+        Vector2D<double> v = eig.vectors[i];
+        Vector2D<double> Av = v*tmp;
+        EXPECT_NEAR(v.Length(), 1.0, 1e-12);
+        EXPECT_NEAR(Av.X(), eig.values[i]*v.X(), 1e-12);
+        EXPECT_NEAR(Av.Y(), eig.values[i]*v.Y(), 1e-12);
+    }
+}
+
+TEST(Matrix1DTest, EigenSymmetricBatch) {
+    const int n = 37;
+    std::vector<float> xx(n), xy(n), yy(n), l0(n), l1(n), vx(n), vy(n);
+    for(int k=0;k<n;k++) {
+        xx[k] = 1.0f+0.25f*k;
+        xy[k] = (k%5)-2.0f;
+        yy[k] = 3.0f-0.1f*k;
+    }
+    xx[0] = yy[0] = 2.0f; xy[0] = 0.0f; // isotropic
+    EigenSymmetricBatch(&xx[0], &xy[0], &yy[0], n, &l0[0], &l1[0], &vx[0], &vy[0]);
+    for(int k=0;k<n;k++) {
+        Matrix1D<float> m;
+        m(0,0) = xx[k];
+        m(0,1) = m(1,0) = xy[k];
+        m(1,1) = yy[k];
+        Eigen2D<float> eig = m.EigenSymmetric();
+        EXPECT_FLOAT_EQ(l0[k], eig.values[0]);
+        EXPECT_FLOAT_EQ(l1[k], eig.values[1]);
+        EXPECT_FLOAT_EQ(vx[k], eig.vectors[1].X());
+        EXPECT_FLOAT_EQ(vy[k], eig.vectors[1].Y());
+        EXPECT_LE(l0[k], l1[k]);
+    }
+}
+
+TEST(Affine2DTest, MatchesMatrix2D) {
+    Matrix2d mat;
+    Affine2d aff;
+    mat.Translate(1.0, -2.0);
+    aff.Translate(1.0, -2.0);
+    mat.Rotate(0.7);
+    aff.Rotate(0.7);
+    mat.Scale(2.0, 3.0);
+    aff.Scale(2.0, 3.0);
+    mat.Rotate(Vector2d(0.6, 0.8), Vector2d(-0.8, 0.6));
+    aff.Rotate(Vector2d(0.6, 0.8), Vector2d(-0.8, 0.6));
+    for(int i=0;i<3;i++) {
+        for(int j=0;j<2;j++)
+            EXPECT_NEAR(aff(i,j), mat(i,j), 1e-12);
+    }
+    Vector2d p(3.0, 4.0);
+    Vector2d q1 = p*mat;
+    Vector2d q2 = p*aff;
+    EXPECT_NEAR(q1.X(), q2.X(), 1e-12);
+    EXPECT_NEAR(q1.Y(), q2.Y(), 1e-12);
+
+    Affine2d composed = Affine2d(mat)*aff;
+    Matrix2d matComposed = mat*mat;
+    for(int i=0;i<3;i++) {
+        for(int j=0;j<3;j++)
+            EXPECT_NEAR(composed.ToMatrix2D()(i,j), matComposed(i,j), 1e-9);
+    }
+    EXPECT_TRUE(Affine2d(aff.ToMatrix2D())==aff);
+}
+
+TEST(Affine2DTest, Inverse) {
+    Affine2d rigid;
+    rigid.Rotate(1.1);
+    rigid.Translate(5.0, -3.0);
+    rigid.Rotate(-0.4);
+    Affine2d general = rigid;
+    general.Scale(2.0, 0.5);
+    Vector2d p(-1.5, 2.5);
+    Vector2d r1 = (p*rigid)*rigid.RigidInverse();
+    Vector2d r2 = (p*general)*general.Inverse();
+    EXPECT_NEAR(r1.X(), p.X(), 1e-12);
+    EXPECT_NEAR(r1.Y(), p.Y(), 1e-12);
+    EXPECT_NEAR(r2.X(), p.X(), 1e-12);
+    EXPECT_NEAR(r2.Y(), p.Y(), 1e-12);
+}
+
+template<class T>
+void CheckTransformPoints(T tol)
+{
+    Matrix2D<T> mat;
+    mat.Rotate(T(0.3));
+    mat.Scale(T(2), T(-1));
+    mat.Translate(T(1.5), T(-0.5));
+    for(int n=0;n<=19;n++) {
+        std::vector<Vector2D<T> > in(n), out(n), inPlace(n);
+        std::vector<T> x(n), y(n), outX(n), outY(n);
+        for(int i=0;i<n;i++) {
+            in[i] = Vector2D<T>(T(i)-T(3), T(2)*T(i)+T(1));
+            x[i] = in[i].X();
+            y[i] = in[i].Y();
+        }
+        inPlace = in;
+        TransformPoints(mat, in.data(), out.data(), n);
+        TransformPoints(mat, inPlace.data(), n);
+        TransformPoints(mat, x.data(), y.data(), outX.data(), outY.data(), n);
+        TransformPoints(Affine2D<T>(mat), x.data(), y.data(), n);
+        for(int i=0;i<n;i++) {
+            Vector2D<T> p = in[i];
+            p *= mat;
+            EXPECT_NEAR(out[i].X(), p.X(), tol);
+            EXPECT_NEAR(out[i].Y(), p.Y(), tol);
+            EXPECT_NEAR(inPlace[i].X(), p.X(), tol);
+            EXPECT_NEAR(inPlace[i].Y(), p.Y(), tol);
+            EXPECT_NEAR(outX[i], p.X(), tol);
+            EXPECT_NEAR(outY[i], p.Y(), tol);
+            EXPECT_NEAR(x[i], p.X(), tol);
+            EXPECT_NEAR(y[i], p.Y(), tol);
+        }
+    }
+}
+
+TEST(TransformsTest, TransformPoints) {
+    CheckTransformPoints<float>(1e-4f);
+    CheckTransformPoints<double>(1e-12);
+}
+
 TEST(PolygonsTest, Polyline) {
     Polyline2D<double> poly;
     poly.AddPoint(Vector2D<double>(2.0,3.0));
@@ -192,6 +470,69 @@ TEST(PolygonsTest, Triangle) {
     EXPECT_EQ(tr.Area(), 0.5);
 }
 
+template<class T>
+void CheckPointCloud(T tol)
+{
+    std::vector<Vector2D<T> > points;
+    for(int i=0;i<1003;i++)
+        points.push_back(Vector2D<T>(T(i%17)-T(4), T(0.5)*T(i%29)+T(i%3)));
+    PointCloud2D<T> cloud(points);
+    cloud.AddPoint(Vector2D<T>(T(-10), T(30)));
+    points.push_back(Vector2D<T>(T(-10), T(30)));
+    EXPECT_EQ(cloud.Size(), points.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(cloud.X())%64, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(cloud.Y())%64, 0u);
+
+    Vector2D<T> lo = points[0], hi = points[0];
+    T sx = 0, sy = 0;
+    for(unsigned int i=0;i<points.size();i++) {
+        lo = Vector2D<T>(std::min(lo.X(), points[i].X()), std::min(lo.Y(), points[i].Y()));
+        hi = Vector2D<T>(std::max(hi.X(), points[i].X()), std::max(hi.Y(), points[i].Y()));
+        sx += points[i].X();
+        sy += points[i].Y();
+    }
+    T cx = sx/points.size(), cy = sy/points.size();
+    T sxx = 0, sxy = 0, syy = 0;
+    for(unsigned int i=0;i<points.size();i++) {
+        sxx += (points[i].X()-cx)*(points[i].X()-cx);
+        sxy += (points[i].X()-cx)*(points[i].Y()-cy);
+        syy += (points[i].Y()-cy)*(points[i].Y()-cy);
+    }
+    AABB2D<T> box = cloud.BoundingBox();
+    EXPECT_TRUE(box.Min()==lo);
+    EXPECT_TRUE(box.Max()==hi);
+    Vector2D<T> c = cloud.Centroid();
+    EXPECT_NEAR(c.X(), cx, tol);
+    EXPECT_NEAR(c.Y(), cy, tol);
+    Matrix1D<T> cov = cloud.Covariance();
+    EXPECT_NEAR(cov(0,0), sxx/points.size(), tol);
+    EXPECT_NEAR(cov(0,1), sxy/points.size(), tol);
+    EXPECT_NEAR(cov(1,1), syy/points.size(), tol);
+
+    PointCloudView2D<T> view = cloud.View(5, 3);
+    EXPECT_EQ(view.Size(), 3u);
+    EXPECT_TRUE(view[0]==points[5]);
+    std::vector<Vector2D<T> > back = cloud.ToVector();
+    EXPECT_TRUE(back==points);
+}
+
+TEST(PointCloudTest, Reductions) {
+    CheckPointCloud<float>(1e-3f);
+    CheckPointCloud<double>(1e-9);
+}
+
+TEST(PointCloudTest, AlignedAllocator) {
+    AlignedAllocator<double> allocator;
+    double* p = allocator.allocate(5);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p)%64, 0u);
+    allocator.deallocate(p, 5);
+    // the byte count would wrap around: refused instead of a short block
+    EXPECT_THROW(allocator.allocate(allocator.max_size()+1), std::bad_array_new_length);
+    EXPECT_THROW(allocator.allocate(std::numeric_limits<std::size_t>::max()/4), std::bad_array_new_length);
+    std::vector<double, AlignedAllocator<double> > values;
+    EXPECT_THROW(values.reserve(std::numeric_limits<std::size_t>::max()/4), std::length_error);
+}
+
 TEST(DistancesTest, PointLine) {
     Line<double> l(2.0, 3.0, 1.0);
     Vector2D<double> p(0.0, 0.0);
@@ -206,6 +547,1553 @@ TEST(DistancesTest, PointLineTypedef) {
     EXPECT_EQ(Distance(p, l), 1/sqrt(13.0));
 }
 
+TEST(DistancesTest, PointPolyline) {
+    Polyline2D<double> poly;
+    for(int i=0;i<50;i++)
+        poly.AddPoint(Vector2D<double>(i, (i%2) ? 1.0 : -1.0));
+    Vector2D<double> p(10.3, 4.0);
+    double brute = DistanceSq(p, Segment<double>(poly.Vertices()[0], poly.Vertices()[1]));
+    for(unsigned int i=1;i+1<poly.Vertices().size();i++)
+        brute = std::min(brute, DistanceSq(p, Segment<double>(poly.Vertices()[i], poly.Vertices()[i+1])));
+    unsigned long before = allocations;
+    double d = DistanceSq(p, poly);
+    double d2 = Distance(poly.View(), p);
+    unsigned long after = allocations;
+    EXPECT_EQ(after, before);
+    EXPECT_NEAR(d, brute, 1e-12);
+    EXPECT_NEAR(d2*d2, brute, 1e-12);
+}
+
+TEST(DistancesTest, PointPolygonClosingEdge) {
+    Polygon2D<double> square;
+    square.AddPoint(Vector2D<double>(0.0, 0.0));
+    square.AddPoint(Vector2D<double>(4.0, 0.0));
+    square.AddPoint(Vector2D<double>(4.0, 4.0));
+    square.AddPoint(Vector2D<double>(0.0, 4.0));
+    // closest to the edge (0,4)->(0,0)
+    EXPECT_NEAR(Distance(Vector2D<double>(-1.0, 2.0), square), 1.0, 1e-12);
+    Polyline2D<double>& asLine = square;
+    EXPECT_NEAR(Distance(Vector2D<double>(-1.0, 2.0), asLine), 1.0, 1e-12);
+    EXPECT_NEAR(Distance(Vector2D<double>(-1.0, 2.0), PolylineView2D<double>(square.Vertices())), sqrt(5.0), 1e-12);
+}
+
+TEST(DistancesTest, PreparedShapes) {
+    Line<double> line(Vector2D<double>(1.0, 2.0), Vector2D<double>(3.0, -1.0));
+    Ray<double> ray(Vector2D<double>(1.0, 2.0), Vector2D<double>(3.0, -1.0));
+    Segment<double> seg(Vector2D<double>(1.0, 2.0), Vector2D<double>(4.0, 1.0));
+    PreparedLine<double> pLine(line);
+    PreparedRay<double> pRay(ray);
+    PreparedSegment<double> pSeg(seg);
+    EXPECT_NEAR(pSeg.Length(), seg.Length(), 1e-12);
+    EXPECT_NEAR(pSeg.LengthSq(), seg.LengthSq(), 1e-12);
+    EXPECT_NEAR(pSeg.InvLength(), 1.0/seg.Length(), 1e-12);
+    for(int i=-5;i<=10;i++) {
+        for(int j=-5;j<=8;j++) {
+            Vector2D<double> p(0.5*i, 0.5*j);
+            EXPECT_NEAR(Distance(p, pLine), Distance(p, line), 1e-12);
+            EXPECT_NEAR(DistanceSq(p, pLine), DistanceSq(p, line), 1e-12);
+            EXPECT_NEAR(Distance(p, pRay), Distance(p, ray), 1e-12);
+            EXPECT_NEAR(DistanceSq(p, pRay), DistanceSq(p, ray), 1e-12);
+            EXPECT_NEAR(Distance(p, pSeg), Distance(p, seg), 1e-12);
+            EXPECT_NEAR(DistanceSq(pSeg, p), DistanceSq(seg, p), 1e-12);
+        }
+    }
+    EXPECT_EQ(pSeg.P1(), seg.P1());
+
+    // degenerate segment/ray: the distance to their point
+    Segment<double> dot(Vector2D<double>(1.0, 1.0), Vector2D<double>(1.0, 1.0));
+    Ray<double> stopped(Vector2D<double>(1.0, 1.0), Vector2D<double>(0.0, 0.0));
+    PreparedSegment<double> pDot(dot);
+    PreparedRay<double> pStopped(stopped);
+    EXPECT_TRUE(pDot.Degenerate());
+    EXPECT_TRUE(pStopped.Degenerate());
+    EXPECT_FALSE(pSeg.Degenerate());
+    EXPECT_EQ(pDot.P1(), dot.P1());
+    EXPECT_DOUBLE_EQ(Distance(Vector2D<double>(4.0, 5.0), pDot), 5.0);
+    EXPECT_DOUBLE_EQ(Distance(Vector2D<double>(4.0, 5.0), pStopped), 5.0);
+    for(int i=-3;i<=3;i++) {
+        Vector2D<double> p(1.5*i, 2.0-i);
+        EXPECT_NEAR(Distance(p, pDot), Distance(p, dot), 1e-12);
+        EXPECT_NEAR(DistanceSq(pDot, p), DistanceSq(dot, p), 1e-12);
+        EXPECT_NEAR(Distance(pStopped, p), Distance(p, stopped), 1e-12);
+        EXPECT_NEAR(DistanceSq(p, pStopped), DistanceSq(p, stopped), 1e-12);
+    }
+}
+
+template<class T>
+void CheckBatchDistances(T eps) {
+    PointCloud2D<T> points;
+    SegmentArray2D<T> segments;
+    for(int i=0;i<37;i++)
+        points.AddPoint(T(std::cos(0.7*i)*(i%5)), T(std::sin(1.3*i)*(i%7)));
+    for(int j=0;j<23;j++)
+        segments.AddSegment(Vector2D<T>(T(j%4)-2, T(j%3)), Vector2D<T>(T(j%5)-1, T(j%6)-3));
+    segments.AddSegment(Vector2D<T>(1, 1), Vector2D<T>(1, 1));
+    std::vector<T> row(points.Size()), matrix(points.Size()*segments.Size());
+    DistanceSqMatrix(points.View(), segments, matrix.data());
+    for(std::size_t j=0;j<segments.Size();j++) {
+        BatchDistanceSq(points.View(), segments.GetSegment(j), row.data());
+        for(std::size_t i=0;i<points.Size();i++) {
+            T expected = T(DistanceSq(points[i], segments.GetSegment(j)));
+            EXPECT_NEAR(row[i], expected, eps);
+            EXPECT_NEAR(matrix[i*segments.Size()+j], expected, eps);
+        }
+    }
+    for(std::size_t i=0;i<points.Size();i++) {
+        BatchDistanceSq(points[i], segments, row.data());
+        std::size_t best = std::min_element(row.begin(), row.begin()+segments.Size())-row.begin();
+        ClosestSegment2D<T> closest = FindClosestSegment(points[i], segments);
+        EXPECT_EQ(closest.index, best);
+        EXPECT_EQ(closest.distanceSq, row[best]);
+        Segment<T> seg = segments.GetSegment(closest.index);
+        EXPECT_NEAR(points[i].DistanceSq(seg.P0()+seg.D()*closest.t), closest.distanceSq, eps);
+    }
+    ClosestSegment2D<T> none = FindClosestSegment(Vector2D<T>(0, 0), SegmentArray2D<T>());
+    EXPECT_EQ(none.index, 0u);
+    EXPECT_EQ(none.distanceSq, std::numeric_limits<T>::infinity());
+}
+
+TEST(DistancesTest, BatchDistances) {
+    CheckBatchDistances<double>(1e-9);
+    CheckBatchDistances<float>(1e-3f);
+}
+
+TEST(SpatialTest, SegmentBVH) {
+    Polyline2D<double> line;
+    Polygon2D<double> polygon;
+    double x = 0.0, y = 0.0;
+    std::srand(7);
+    for(int i=0;i<2000;i++) {
+        x += double(std::rand())/RAND_MAX-0.5;
+        y += double(std::rand())/RAND_MAX-0.5;
+        line.AddPoint(Vector2D<double>(x, y));
+        polygon.AddPoint(Vector2D<double>(std::cos(0.00314*i)*(10+i%3), std::sin(0.00314*i)*(10+i%3)));
+    }
+    SegmentBVH2D<double> bvh(line), polygonBvh(polygon);
+    SegmentArray2D<double> segments(line.View());
+    EXPECT_EQ(bvh.Size(), 1999u);
+    EXPECT_EQ(polygonBvh.Size(), 2000u);
+    AABB2D<double> box = bvh.BoundingBox();
+    for(int i=0;i<300;i++) {
+        Vector2D<double> p(box.Min().X()+box.Width()*std::rand()/RAND_MAX, box.Min().Y()+box.Height()*std::rand()/RAND_MAX);
+        ClosestSegment2D<double> closest = bvh.Closest(p);
+        ClosestSegment2D<double> expected = FindClosestSegment(p, segments);
+        // adjacent segments tie at shared vertices, so compare the distances and the reported closest point
+        EXPECT_NEAR(closest.distanceSq, expected.distanceSq, 1e-12);
+        EXPECT_NEAR(closest.distanceSq, DistanceSq(p, line), 1e-12);
+        Segment<double> seg = segments.GetSegment(closest.index);
+        EXPECT_NEAR(p.DistanceSq(seg.P0()+seg.D()*closest.t), closest.distanceSq, 1e-12);
+        EXPECT_NEAR(polygonBvh.Closest(p).distanceSq, DistanceSq(p, polygon), 1e-12);
+
+        std::vector<std::size_t> found, brute;
+        std::size_t count = bvh.Query(p, 0.5, found);
+        EXPECT_EQ(count, found.size());
+        for(std::size_t j=0;j<segments.Size();j++)
+            if(DistanceSq(p, segments.GetSegment(j))<=0.25)
+                brute.push_back(j);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, brute);
+    }
+    EXPECT_EQ(SegmentBVH2D<double>().Closest(Vector2D<double>()).index, 0u);
+}
+
+TEST(SpatialTest, KdTree) {
+    std::srand(11);
+    std::vector<Vector2D<double> > points;
+    for(int i=0;i<5000;i++)
+        points.push_back(Vector2D<double>(double(std::rand())/RAND_MAX, 0.5*std::rand()/RAND_MAX));
+    KdTree2D<double> tree(points), parallelTree(points, 4);
+    EXPECT_EQ(tree.Size(), points.size());
+    EXPECT_EQ(tree.NodeCount(), parallelTree.NodeCount());
+    std::vector<Neighbor2D<double> > knn;
+    std::vector<std::size_t> found, brute;
+    for(int q=0;q<200;q++) {
+        Vector2D<double> p(1.2*std::rand()/RAND_MAX-0.1, 0.6*std::rand()/RAND_MAX-0.05);
+        std::vector<std::pair<double, std::size_t> > sorted;
+        for(std::size_t i=0;i<points.size();i++)
+            sorted.push_back(std::make_pair(p.DistanceSq(points[i]), i));
+        std::sort(sorted.begin(), sorted.end());
+
+        Neighbor2D<double> nearest = parallelTree.Nearest(p);
+        EXPECT_EQ(nearest.index, sorted[0].second);
+        EXPECT_EQ(nearest.distanceSq, sorted[0].first);
+        knn.clear();
+        EXPECT_EQ(tree.Nearest(p, 7, knn), 7u);
+        for(std::size_t k=0;k<7;k++)
+            EXPECT_EQ(knn[k].index, sorted[k].second);
+
+        found.clear();
+        brute.clear();
+        tree.Query(p, 0.05, found);
+        for(std::size_t i=0;i<sorted.size() && sorted[i].first<=0.05*0.05;i++)
+            brute.push_back(sorted[i].second);
+        std::sort(found.begin(), found.end());
+        std::sort(brute.begin(), brute.end());
+        EXPECT_EQ(found, brute);
+
+        AABB2D<double> box(p, p+Vector2D<double>(0.1, 0.05));
+        found.clear();
+        brute.clear();
+        parallelTree.Query(box, found);
+        for(std::size_t i=0;i<points.size();i++)
+            if(box.Contains(points[i]))
+                brute.push_back(i);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, brute);
+    }
+
+    // large enough for the parallel build (subtrees of ParallelGrain = 1<<15 points and more are split between threads)
+    std::vector<Vector2D<double> > many;
+    for(int i=0;i<(1<<17);i++)
+        many.push_back(Vector2D<double>(double(std::rand())/RAND_MAX, double(std::rand())/RAND_MAX));
+    KdTree2D<double> serialMany(many), parallelMany(many, 4);
+    EXPECT_EQ(parallelMany.Size(), many.size());
+    EXPECT_EQ(parallelMany.NodeCount(), serialMany.NodeCount());
+    std::vector<Neighbor2D<double> > serialKnn;
+    for(int q=0;q<100;q++) {
+        Vector2D<double> p(double(std::rand())/RAND_MAX, double(std::rand())/RAND_MAX);
+        std::size_t best = 0;
+        for(std::size_t i=1;i<many.size();i++)
+            if(p.DistanceSq(many[i])<p.DistanceSq(many[best]))
+                best = i;
+        EXPECT_EQ(parallelMany.Nearest(p).index, best);
+        knn.clear();
+        serialKnn.clear();
+        parallelMany.Nearest(p, 5, knn);
+        serialMany.Nearest(p, 5, serialKnn);
+        for(std::size_t k=0;k<5;k++)
+            EXPECT_EQ(knn[k].index, serialKnn[k].index);
+        found.clear();
+        brute.clear();
+        parallelMany.Query(p, 0.01, found);
+        serialMany.Query(p, 0.01, brute);
+        std::sort(found.begin(), found.end());
+        std::sort(brute.begin(), brute.end());
+        EXPECT_EQ(found, brute);
+    }
+
+    std::vector<Neighbor2D<float> > few;
+    EXPECT_EQ(KdTree2D<float>().Nearest(Vector2D<float>(), 3, few), 0u);
+    EXPECT_EQ(KdTree2D<float>(std::vector<Vector2D<float> >(3, Vector2D<float>(1, 1))).Nearest(Vector2D<float>(), 5, few), 3u);
+}
+
+TEST(SpatialTest, RTree) {
+    std::srand(13);
+    std::vector<Polygon2D<double> > shapes;
+    std::vector<AABB2D<double> > boxes;
+    for(int i=0;i<3000;i++) {
+        Vector2D<double> c(100.0*std::rand()/RAND_MAX, 100.0*std::rand()/RAND_MAX);
+        Polygon2D<double> polygon;
+        for(int k=0;k<5;k++)
+            polygon.AddPoint(c+Vector2D<double>(std::cos(1.2*k), std::sin(1.2*k))*(0.2+0.01*(i%50)));
+        shapes.push_back(polygon);
+        boxes.push_back(BoundingBox(polygon));
+    }
+    RTree2D<double> tree;
+    tree.BuildFromShapes(Span<const Polygon2D<double> >(shapes));
+    EXPECT_EQ(tree.Size(), shapes.size());
+    EXPECT_EQ(tree.Height(), 5u);
+    std::vector<std::size_t> found, brute;
+    for(int q=0;q<200;q++) {
+        Vector2D<double> p(110.0*std::rand()/RAND_MAX-5, 110.0*std::rand()/RAND_MAX-5);
+        AABB2D<double> window(p, p+Vector2D<double>(3.0, 2.0));
+        found.clear();
+        brute.clear();
+        tree.Query(window, found);
+        for(std::size_t i=0;i<boxes.size();i++)
+            if(boxes[i].Overlaps(window))
+                brute.push_back(i);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, brute);
+
+        found.clear();
+        brute.clear();
+        tree.Query(p, found);
+        for(std::size_t i=0;i<boxes.size();i++)
+            if(boxes[i].Contains(p))
+                brute.push_back(i);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, brute);
+
+        double best = std::numeric_limits<double>::infinity();
+        for(std::size_t i=0;i<shapes.size();i++)
+            best = std::min(best, DistanceSq(p, shapes[i]));
+        Neighbor2D<double> nearest = tree.Nearest(p, Span<const Polygon2D<double> >(shapes));
+        EXPECT_EQ(nearest.distanceSq, best);
+        EXPECT_EQ(DistanceSq(p, shapes[nearest.index]), best);
+    }
+    RTree2D<double> single(Span<const AABB2D<double> >(boxes.data(), 1));
+    found.clear();
+    EXPECT_EQ(single.Query(boxes[0], found), 1u);
+    EXPECT_EQ(RTree2D<double>().Nearest(Vector2D<double>(), Span<const Polygon2D<double> >(shapes)).index, shapes.size());
+}
+
+TEST(SpatialTest, LooseQuadtree) {
+    std::srand(17);
+    LooseQuadtree2D<double> tree(AABB2D<double>(Vector2D<double>(0, 0), Vector2D<double>(100, 100)), 6);
+    std::vector<LooseQuadtree2D<double>::Handle> handles;
+    std::vector<bool> alive;
+    for(int i=0;i<2000;i++) {
+        Vector2D<double> c(110.0*std::rand()/RAND_MAX-5, 110.0*std::rand()/RAND_MAX-5);
+        double r = (i%10==0) ? 8.0 : 0.3;
+        handles.push_back(tree.Insert(AABB2D<double>(c-Vector2D<double>(r, r), c+Vector2D<double>(r, r))));
+        alive.push_back(true);
+    }
+    std::vector<LooseQuadtree2D<double>::Handle> found, brute;
+    for(int frame=0;frame<20;frame++) {
+        for(std::size_t i=0;i<handles.size();i++) {
+            if(!alive[i])
+                continue;
+            if(std::rand()%50==0) {
+                tree.Remove(handles[i]);
+                alive[i] = false;
+                continue;
+            }
+            AABB2D<double> box = tree.Box(handles[i]);
+            Vector2D<double> step(2.0*std::rand()/RAND_MAX-1, 2.0*std::rand()/RAND_MAX-1);
+            tree.Move(handles[i], AABB2D<double>(box.Min()+step, box.Max()+step));
+        }
+        handles.push_back(tree.Insert(Vector2D<double>(50, 50)));
+        alive.push_back(true);
+        for(int q=0;q<10;q++) {
+            Vector2D<double> p(100.0*std::rand()/RAND_MAX, 100.0*std::rand()/RAND_MAX);
+            found.clear();
+            brute.clear();
+            tree.Query(p, 4.0, found);
+            for(std::size_t i=0;i<handles.size();i++)
+                if(alive[i] && tree.Box(handles[i]).DistanceSq(p)<=16.0)
+                    brute.push_back(handles[i]);
+            std::sort(found.begin(), found.end());
+            std::sort(brute.begin(), brute.end());
+            EXPECT_EQ(found, brute);
+        }
+    }
+    EXPECT_EQ(tree.Size(), std::size_t(std::count(alive.begin(), alive.end(), true)));
+    for(std::size_t i=0;i<handles.size();i++)
+        if(alive[i])
+            tree.Remove(handles[i]);
+    EXPECT_EQ(tree.Size(), 0u);
+    EXPECT_EQ(tree.NodeCount(), 1u);
+
+    // the depth is clamped to MaxDepth: tiny boxes stop at level 16
+    LooseQuadtree2D<double> deep(AABB2D<double>(Vector2D<double>(0, 0), Vector2D<double>(1, 1)), 40);
+    LooseQuadtree2D<double>::Handle tiny = deep.Insert(Vector2D<double>(0.7, 0.3));
+    EXPECT_EQ(deep.NodeCount(), std::size_t(LooseQuadtree2D<double>::MaxDepth+1));
+    found.clear();
+    deep.Query(Vector2D<double>(0.7, 0.3), 1e-9, found);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], tiny);
+}
+
+TEST(SpatialTest, SpatialHashGrid) {
+    std::srand(19);
+    std::vector<Vector2D<double> > points;
+    std::vector<AABB2D<double> > boxes;
+    for(int i=0;i<1500;i++) {
+        Vector2D<double> p(40.0*std::rand()/RAND_MAX-20, 40.0*std::rand()/RAND_MAX-20);
+        points.push_back(p);
+        boxes.push_back(AABB2D<double>(p, p+Vector2D<double>(0.5*std::rand()/RAND_MAX, 0.5*std::rand()/RAND_MAX)));
+    }
+    SpatialHashGrid2D<double> grid;
+    std::vector<SpatialHashGrid2D<double>::Pair> pairs, parallelPairs, brute;
+    for(int frame=0;frame<2;frame++) {
+        double r = 0.8+frame*0.5;
+        grid.Build(points, r);
+        grid.FindPairs(pairs);
+        grid.FindPairs(parallelPairs, 3);
+        brute.clear();
+        for(std::uint32_t i=0;i<points.size();i++)
+            for(std::uint32_t j=i+1;j<points.size();j++)
+                if(points[i].DistanceSq(points[j])<=r*r)
+                    brute.push_back(SpatialHashGrid2D<double>::Pair(i, j));
+        for(std::size_t k=0;k<pairs.size();k++)
+            if(pairs[k].first>pairs[k].second)
+                std::swap(pairs[k].first, pairs[k].second);
+        for(std::size_t k=0;k<parallelPairs.size();k++)
+            if(parallelPairs[k].first>parallelPairs[k].second)
+                std::swap(parallelPairs[k].first, parallelPairs[k].second);
+        std::sort(pairs.begin(), pairs.end());
+        std::sort(parallelPairs.begin(), parallelPairs.end());
+        EXPECT_EQ(pairs, brute);
+        EXPECT_EQ(parallelPairs, brute);
+
+        std::vector<std::size_t> found, near;
+        grid.Query(points[7], r, found);
+        for(std::size_t i=0;i<points.size();i++)
+            if(points[i].DistanceSq(points[7])<=r*r)
+                near.push_back(i);
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(found, near);
+    }
+    grid.Build(boxes, 0.3);
+    grid.FindPairs(pairs, 2);
+    std::size_t expected = 0;
+    for(std::size_t i=0;i<boxes.size();i++) {
+        for(std::size_t j=i+1;j<boxes.size();j++) {
+            double dx = std::max(std::max(boxes[i].Min().X()-boxes[j].Max().X(), boxes[j].Min().X()-boxes[i].Max().X()), 0.0);
+            double dy = std::max(std::max(boxes[i].Min().Y()-boxes[j].Max().Y(), boxes[j].Min().Y()-boxes[i].Max().Y()), 0.0);
+            expected += (dx*dx+dy*dy<=0.09);
+        }
+    }
+    EXPECT_EQ(pairs.size(), expected);
+
+    // cells beyond the 32 bit range are clamped: far objects share the border cells, close pairs are still found
+    std::vector<Vector2D<float> > far;
+    far.push_back(Vector2D<float>(1e12f, 0));
+    far.push_back(Vector2D<float>(1e12f, 0.5f));
+    far.push_back(Vector2D<float>(3e12f, 0.25f));
+    far.push_back(Vector2D<float>(-1e12f, -1e12f));
+    far.push_back(Vector2D<float>(0, 0));
+    SpatialHashGrid2D<float> farGrid;
+    std::vector<SpatialHashGrid2D<float>::Pair> farPairs;
+    farGrid.Build(far, 1.0f);
+    farGrid.FindPairs(farPairs);
+    ASSERT_EQ(farPairs.size(), 1u);
+    EXPECT_EQ(std::min(farPairs[0].first, farPairs[0].second), 0u);
+    EXPECT_EQ(std::max(farPairs[0].first, farPairs[0].second), 1u);
+    std::vector<std::size_t> farFound;
+    farGrid.Query(Vector2D<float>(-1e12f, -1e12f), 1.0f, farFound);
+    EXPECT_EQ(farFound, std::vector<std::size_t>(1, 3));
+}
+
+TEST(SpatialTest, SweepAndPrune) {
+    typedef SweepAndPrune2D<double>::Pair Pair;
+    std::srand(23);
+    std::vector<AABB2D<double> > boxes;
+    for(int i=0;i<400;i++) {
+        Vector2D<double> p(30.0*std::rand()/RAND_MAX, 30.0*std::rand()/RAND_MAX);
+        boxes.push_back(AABB2D<double>(p, p+Vector2D<double>(1.0+std::rand()%3, 1.0+std::rand()%3)));
+    }
+    std::vector<bool> alive(boxes.size(), true);
+    SweepAndPrune2D<double> sap;
+    sap.Build(boxes);
+    std::vector<Pair> current, added, removed, brute;
+    sap.Pairs(current);
+    std::set<Pair> tracked(current.begin(), current.end());
+    for(int frame=0;frame<20;frame++) {
+        for(std::size_t i=0;i<boxes.size();i++) {
+            if(!alive[i])
+                continue;
+            // integer steps make many endpoints equal (touching boxes)
+            Vector2D<double> step(double(std::rand()%3-1), double(std::rand()%3-1));
+            boxes[i] = AABB2D<double>(boxes[i].Min()+step, boxes[i].Max()+step);
+            sap.Move(SweepAndPrune2D<double>::Handle(i), boxes[i]);
+        }
+        if(frame==5) {
+            for(std::size_t i=0;i<boxes.size();i+=7) {
+                sap.Remove(SweepAndPrune2D<double>::Handle(i));
+                alive[i] = false;
+            }
+        }
+        if(frame==9) {
+            // freed handles are reused (last freed first)
+            for(std::size_t i=(boxes.size()-1)/7*7;i<boxes.size();i-=7) {
+                EXPECT_EQ(sap.Insert(boxes[i]), i);
+                alive[i] = true;
+            }
+        }
+        sap.Update(added, removed);
+        for(std::size_t k=0;k<removed.size();k++)
+            EXPECT_EQ(tracked.erase(removed[k]), 1u);
+        for(std::size_t k=0;k<added.size();k++)
+            EXPECT_TRUE(tracked.insert(added[k]).second);
+        brute.clear();
+        for(std::uint32_t i=0;i<boxes.size();i++)
+            for(std::uint32_t j=i+1;j<boxes.size();j++)
+                if(alive[i] && alive[j] && boxes[i].Overlaps(boxes[j]))
+                    brute.push_back(Pair(i, j));
+        EXPECT_EQ(std::vector<Pair>(tracked.begin(), tracked.end()), brute);
+        EXPECT_EQ(sap.PairCount(), brute.size()) << frame;
+    }
+    EXPECT_EQ(sap.Size(), boxes.size());
+    EXPECT_EQ(sap.Update(added, removed), 0u);
+    EXPECT_TRUE(added.empty() && removed.empty());
+}
+
+TEST(SpatialTest, PointLocator) {
+    std::srand(41);
+    // jittered lattice tiling with holes, mixed orientations and extra collinear vertices on some edges
+    const int size = 30;
+    std::vector<Vector2D<double> > lattice;
+    for(int j=0;j<=size;j++)
+        for(int i=0;i<=size;i++)
+            lattice.push_back(Vector2D<double>(i+0.6*std::rand()/RAND_MAX-0.3, j+0.6*std::rand()/RAND_MAX-0.3));
+    std::vector<Polygon2D<double> > polygons;
+    std::vector<bool> present(size*size, false);
+    for(int j=0;j<size;j++)
+        for(int i=0;i<size;i++) {
+            if(std::rand()%10==0)
+                continue;
+            present[j*size+i] = true;
+            Vector2D<double> v[4] = {lattice[j*(size+1)+i], lattice[j*(size+1)+i+1], lattice[(j+1)*(size+1)+i+1], lattice[(j+1)*(size+1)+i]};
+            bool clockwise = std::rand()%2==0;
+            Polygon2D<double> polygon;
+            for(int k=0;k<4;k++) {
+                const Vector2D<double>& a = v[clockwise ? 3-k : k];
+                const Vector2D<double>& b = v[clockwise ? (6-k)%4 : (k+1)%4];
+                polygon.AddPoint(a);
+                if(std::rand()%4==0)
+                    polygon.AddPoint((a+b)/2.0);
+            }
+            polygons.push_back(polygon);
+        }
+    PointLocator2D<double> locator(Span<const Polygon2D<double> >(polygons), 2.0, 3);
+    EXPECT_EQ(locator.Size(), polygons.size());
+    EXPECT_GT(locator.MemoryUsage(), 0u);
+
+    std::vector<Vector2D<double> > points;
+    for(int k=0;k<20000;k++)
+        points.push_back(Vector2D<double>(34.0*std::rand()/RAND_MAX-2, 34.0*std::rand()/RAND_MAX-2));
+    std::vector<std::uint32_t> found(points.size()), cloudFound(points.size());
+    locator.Locate(Span<const Vector2D<double> >(points), found.data(), 3);
+    PointCloud2D<double> cloud((Span<const Vector2D<double> >(points)));
+    locator.Locate(cloud.View(), cloudFound.data(), 2);
+    for(std::size_t k=0;k<points.size();k++) {
+        std::uint32_t expected = PointLocator2D<double>::None;
+        for(std::size_t p=0;p<polygons.size();p++)
+            if(polygons[p].Contains(points[k]))
+                expected = std::uint32_t(p);
+        EXPECT_EQ(locator.Locate(points[k]), expected);
+        EXPECT_EQ(found[k], expected);
+        EXPECT_EQ(cloudFound[k], expected);
+    }
+
+    // lattice vertices: where every polygon around is present, one of them is reported
+    for(int j=1;j<size;j++)
+        for(int i=1;i<size;i++) {
+            std::uint32_t p = locator.Locate(lattice[j*(size+1)+i]);
+            if(present[j*size+i] && present[j*size+i-1] && present[(j-1)*size+i] && present[(j-1)*size+i-1]) {
+                EXPECT_NE(p, PointLocator2D<double>::None);
+            }
+            if(p!=PointLocator2D<double>::None) {
+                EXPECT_LT(Distance(lattice[j*(size+1)+i], polygons[p]), 1e-12);
+            }
+        }
+
+    // a single concave polygon, grid coarser than the polygon
+    Polygon2D<double> notch;
+    notch.AddPoint(Vector2D<double>(0, 0));
+    notch.AddPoint(Vector2D<double>(4, 0));
+    notch.AddPoint(Vector2D<double>(4, 4));
+    notch.AddPoint(Vector2D<double>(2, 1));
+    notch.AddPoint(Vector2D<double>(0, 4));
+    std::vector<Polygon2D<double> > single(1, notch);
+    PointLocator2D<double> one(Span<const Polygon2D<double> >(single), 100.0);
+    EXPECT_EQ(one.Locate(Vector2D<double>(1, 0.5)), 0u);
+    EXPECT_EQ(one.Locate(Vector2D<double>(2, 3)), PointLocator2D<double>::None);
+    EXPECT_EQ(one.Locate(Vector2D<double>(3.5, 3)), 0u);
+    EXPECT_EQ(one.Locate(Vector2D<double>(-1, 1)), PointLocator2D<double>::None);
+    std::vector<PolylineView2D<double> > notchView(1, PolylineView2D<double>(notch.Vertices()));
+    PointLocator2D<double> oneView(Span<const PolylineView2D<double> >(notchView), 100.0);
+    EXPECT_EQ(oneView.Locate(Vector2D<double>(1, 0.5)), 0u);
+    EXPECT_EQ(oneView.Locate(Vector2D<double>(2, 3)), PointLocator2D<double>::None);
+    EXPECT_EQ(PointLocator2D<double>().Locate(Vector2D<double>(1, 1)), PointLocator2D<double>::None);
+}
+
+TEST(SpatialTest, PreparedPolygon) {
+    std::srand(43);
+    // star shaped "coastline" with a hole
+    const int n = 20000;
+    Polygon2D<double> coast, lake;
+    for(int i=0;i<n;i++) {
+        double angle = 6.283185307179586*i/n;
+        double radius = 10.0+std::sin(37*angle)+0.5*std::sin(301*angle)+0.3*std::rand()/RAND_MAX;
+        coast.AddPoint(Vector2D<double>(radius*std::cos(angle), radius*std::sin(angle)));
+    }
+    for(int i=0;i<50;i++) {
+        double angle = -6.283185307179586*i/50;
+        lake.AddPoint(Vector2D<double>(2+3*std::cos(angle), 1+2*std::sin(angle)));
+    }
+    EXPECT_TRUE(coast.Contains(Vector2D<double>(0, 0)));
+    EXPECT_FALSE(coast.Contains(Vector2D<double>(12, 0)));
+    PreparedPolygon2D<double> prepared(coast);
+    std::vector<Polygon2D<double> > rings;
+    rings.push_back(coast);
+    rings.push_back(lake);
+    PreparedPolygon2D<double> withLake(Span<const Polygon2D<double> >(rings), 4.0, 3);
+    EXPECT_EQ(prepared.EdgeCount(), std::size_t(n));
+    EXPECT_LT(prepared.BoundaryCells(), prepared.Columns()*prepared.Rows());
+    EXPECT_GT(prepared.MemoryUsage(), 0u);
+
+    PointCloud2D<double> cloud;
+    for(int k=0;k<20000;k++)
+        cloud.AddPoint(26.0*std::rand()/RAND_MAX-13, 26.0*std::rand()/RAND_MAX-13);
+    std::vector<Vector2D<double> > points(cloud.Size());
+    cloud.CopyTo(Span<Vector2D<double> >(points));
+    bool* inside = new bool[cloud.Size()];
+    bool* insideLake = new bool[cloud.Size()];
+    prepared.Contains(Span<const Vector2D<double> >(points), inside, 3);
+    withLake.Contains(cloud.View(), insideLake, 2);
+    for(std::size_t k=0;k<cloud.Size();k++) {
+        bool expected = coast.Contains(points[k]);
+        EXPECT_EQ(prepared.Contains(points[k]), expected);
+        EXPECT_EQ(inside[k], expected);
+        EXPECT_EQ(insideLake[k], expected && !lake.Contains(points[k]));
+    }
+    delete[] inside;
+    delete[] insideLake;
+
+    // rings given as views (Vertices() returns a Span)
+    std::vector<PolylineView2D<double> > views;
+    views.push_back(PolylineView2D<double>(coast.Vertices()));
+    views.push_back(PolylineView2D<double>(lake.Vertices()));
+    PreparedPolygon2D<double> viewed(Span<const PolylineView2D<double> >(views), 4.0, 3);
+    for(std::size_t k=0;k<cloud.Size();k+=7)
+        EXPECT_EQ(viewed.Contains(points[k]), withLake.Contains(points[k]));
+
+    // float polygon, queries outside the grid and an empty polygon
+    Rectangle2D<float> box(Vector2D<float>(1, 2), 4.0f, 2.0f);
+    PreparedPolygon2D<float> preparedBox(box);
+    EXPECT_TRUE(preparedBox.Contains(Vector2D<float>(1.5f, 2.5f)));
+    EXPECT_FALSE(preparedBox.Contains(Vector2D<float>(3.5f, 2.5f)));
+    EXPECT_FALSE(preparedBox.Contains(Vector2D<float>(100, 2)));
+    EXPECT_FALSE(PreparedPolygon2D<float>().Contains(Vector2D<float>(1, 2)));
+}
+
+/**
+* Random convex polygon (counter clockwise points on a circle)
+**/
+Polygon2D<double> RandomConvexPolygon(const Vector2D<double>& center, double radius, int n)
+{
+    std::vector<double> angles;
+    for(int i=0;i<n;i++)
+        angles.push_back(6.283185307179586*std::rand()/RAND_MAX);
+    std::sort(angles.begin(), angles.end());
+    Polygon2D<double> polygon;
+    for(int i=0;i<n;i++)
+        polygon.AddPoint(center+radius*Vector2D<double>(std::cos(angles[i]), std::sin(angles[i])));
+    return polygon;
+}
+
+/**
+* Smallest overlap of the projections of two convex polygons on the edge normals (negative if separated)
+**/
+double SeparatingAxisOverlap(const Polygon2D<double>& a, const Polygon2D<double>& b)
+{
+    double best = std::numeric_limits<double>::max();
+    const Polygon2D<double>* shapes[2] = {&a, &b};
+    for(int s=0;s<2;s++) {
+        const std::vector<Vector2D<double> >& v = shapes[s]->Vertices();
+        for(std::size_t i=0;i<v.size();i++) {
+            Vector2D<double> n = (v[(i+1)%v.size()]-v[i]).Perp2();
+            n.Normalize();
+            double minA = 1e300, maxA = -1e300, minB = 1e300, maxB = -1e300;
+            for(std::size_t k=0;k<a.Vertices().size();k++) {
+                minA = std::min(minA, n*a.Vertices()[k]);
+                maxA = std::max(maxA, n*a.Vertices()[k]);
+            }
+            for(std::size_t k=0;k<b.Vertices().size();k++) {
+                minB = std::min(minB, n*b.Vertices()[k]);
+                maxB = std::max(maxB, n*b.Vertices()[k]);
+            }
+            best = std::min(best, std::min(maxA-minB, maxB-minA));
+        }
+    }
+    return best;
+}
+
+TEST(IntersectionsTest, GJK) {
+    std::srand(29);
+    int separated = 0, overlapping = 0;
+    for(int trial=0;trial<300;trial++) {
+        Polygon2D<double> a = RandomConvexPolygon(Vector2D<double>(0, 0), 1.0+std::rand()%3, 3+std::rand()%12);
+        Polygon2D<double> b = RandomConvexPolygon(Vector2D<double>(8.0*std::rand()/RAND_MAX-4, 8.0*std::rand()/RAND_MAX-4), 1.0+std::rand()%2, 3+std::rand()%12);
+        double overlap = SeparatingAxisOverlap(a, b);
+        GJKResult2D<double> result = GJKDistance(a, b);
+        Penetration2D<double> penetration = EPAPenetration(a, b);
+        EXPECT_EQ(GJKIntersect(a, b), overlap>=0);
+        EXPECT_EQ(penetration.intersecting, overlap>=0);
+        if(overlap<0) {
+            separated++;
+            // exact distance of disjoint polygons: closest vertex/edge pair
+            double brute = std::min(Distance(a.Vertices()[0], b), Distance(b.Vertices()[0], a));
+            for(std::size_t i=0;i<a.Vertices().size();i++)
+                brute = std::min(brute, Distance(a.Vertices()[i], b));
+            for(std::size_t i=0;i<b.Vertices().size();i++)
+                brute = std::min(brute, Distance(b.Vertices()[i], a));
+            EXPECT_NEAR(result.distance, brute, 1e-9);
+            EXPECT_NEAR(result.pointA.Distance(result.pointB), brute, 1e-9);
+            EXPECT_NEAR(Distance(result.pointA, a), 0.0, 1e-9);
+            EXPECT_NEAR(Distance(result.pointB, b), 0.0, 1e-9);
+            EXPECT_EQ(penetration.depth, 0.0);
+        }
+        else {
+            overlapping++;
+            EXPECT_EQ(result.distance, 0.0);
+            EXPECT_NEAR(penetration.depth, overlap, 1e-9);
+            EXPECT_NEAR(penetration.normal.Length(), 1.0, 1e-12);
+            // moving b by the penetration vector leaves the polygons touching
+            Polygon2D<double> moved;
+            for(std::size_t i=0;i<b.Vertices().size();i++)
+                moved.AddPoint(b.Vertices()[i]+(penetration.depth+1e-9)*penetration.normal);
+            EXPECT_FALSE(GJKIntersect(a, moved));
+        }
+    }
+    EXPECT_GT(separated, 50);
+    EXPECT_GT(overlapping, 50);
+
+    // warm start: a small move from the cached simplex needs fewer iterations
+    Triangle2D<double> tri(Vector2D<double>(0, 0), Vector2D<double>(2, 0), Vector2D<double>(1, 2));
+    Polygon2D<double> circle = RandomConvexPolygon(Vector2D<double>(5, 1), 1.0, 40);
+    SimplexCache2D cache;
+    GJKResult2D<double> cold = GJKDistance(tri, circle, &cache);
+    Polygon2D<double> shifted;
+    for(std::size_t i=0;i<circle.Vertices().size();i++)
+        shifted.AddPoint(circle.Vertices()[i]+Vector2D<double>(0.01, 0.0));
+    GJKResult2D<double> warm = GJKDistance(tri, shifted, &cache);
+    EXPECT_NEAR(warm.distance, GJKDistance(tri, shifted).distance, 1e-12);
+    EXPECT_LE(warm.iterations, 1u);
+    EXPECT_LT(warm.iterations, cold.iterations);
+
+    // rectangles: touching counts as intersection, penetration along the shortest axis
+    Rectangle2D<float> r1(Vector2D<float>(0, 0), 2.0f, 2.0f);
+    Rectangle2D<float> r2(Vector2D<float>(2, 0.5f), 2.0f, 2.0f);
+    Rectangle2D<float> r3(Vector2D<float>(1.5f, 0.2f), 2.0f, 2.0f);
+    EXPECT_TRUE(GJKIntersect(r1, r2));
+    EXPECT_FLOAT_EQ(EPAPenetration(r1, r3).depth, 0.5f);
+    EXPECT_NEAR(EPAPenetration(r1, r3).normal.X(), 1.0f, 1e-6f);
+    EXPECT_FLOAT_EQ(GJKDistance(r1, Rectangle2D<float>(Vector2D<float>(5, 0), 2.0f, 2.0f)).distance, 3.0f);
+}
+
+TEST(AlgorithmsTest, RotatingCalipers) {
+    std::srand(31);
+    std::vector<Polygon2D<double> > polygons, others;
+    for(int trial=0;trial<200;trial++) {
+        Polygon2D<double> a = RandomConvexPolygon(Vector2D<double>(0, 0), 1.0+std::rand()%3, 3+std::rand()%30);
+        Polygon2D<double> b = RandomConvexPolygon(Vector2D<double>(10.0*std::rand()/RAND_MAX-5, 10.0*std::rand()/RAND_MAX-5), 1.0, 3+std::rand()%30);
+        polygons.push_back(a);
+        others.push_back(b);
+        const std::vector<Vector2D<double> >& v = a.Vertices();
+        std::size_t n = v.size();
+
+        double diameter = 0, width = 1e300, area = 1e300;
+        for(std::size_t i=0;i<n;i++) {
+            Vector2D<double> u = v[(i+1)%n]-v[i];
+            u.Normalize();
+            double sMin = 1e300, sMax = -1e300, height = 0;
+            for(std::size_t j=0;j<n;j++) {
+                diameter = std::max(diameter, v[i].Distance(v[j]));
+                sMin = std::min(sMin, u*(v[j]-v[i]));
+                sMax = std::max(sMax, u*(v[j]-v[i]));
+                height = std::max(height, u.X()*(v[j].Y()-v[i].Y())-u.Y()*(v[j].X()-v[i].X()));
+            }
+            width = std::min(width, height);
+            area = std::min(area, (sMax-sMin)*height);
+        }
+        CaliperPair2D<double> d = ConvexDiameter(a);
+        EXPECT_NEAR(d.distance, diameter, 1e-12);
+        EXPECT_NEAR(d.first.Distance(d.second), diameter, 1e-12);
+        CaliperPair2D<double> w = ConvexWidth(a);
+        EXPECT_NEAR(w.distance, width, 1e-12);
+        EXPECT_NEAR(w.first.Distance(w.second), width, 1e-12);
+
+        Rectangle2D<double> rect = MinAreaRectangle(a);
+        const std::vector<Vector2D<double> >& r = rect.Vertices();
+        ASSERT_EQ(r.size(), 4u);
+        EXPECT_NEAR(rect.Area(), area, 1e-9);
+        EXPECT_FALSE(rect.ClockwiseOrdered());
+        for(std::size_t j=0;j<n;j++)
+            for(int k=0;k<4;k++)
+                EXPECT_GE((r[(k+1)%4].X()-r[k].X())*(v[j].Y()-r[k].Y())-(r[(k+1)%4].Y()-r[k].Y())*(v[j].X()-r[k].X()), -1e-9);
+
+        // clockwise input with the closing vertex repeated
+        Polygon2D<double> reversed;
+        for(std::size_t i=0;i<=n;i++)
+            reversed.AddPoint(v[(n-i)%n]);
+        EXPECT_NEAR(ConvexDiameter(reversed).distance, diameter, 1e-12);
+        EXPECT_NEAR(ConvexWidth(reversed).distance, width, 1e-12);
+        EXPECT_NEAR(MinAreaRectangle(reversed).Area(), area, 1e-9);
+
+        CaliperPair2D<double> between = ConvexDistance(reversed, b);
+        if(SeparatingAxisOverlap(a, b)<0) {
+            double expected = GJKDistance(a, b).distance;
+            EXPECT_NEAR(between.distance, expected, 1e-9);
+            EXPECT_NEAR(between.first.Distance(between.second), expected, 1e-9);
+            EXPECT_NEAR(Distance(between.first, a), 0.0, 1e-9);
+            EXPECT_NEAR(Distance(between.second, b), 0.0, 1e-9);
+        }
+        else
+            EXPECT_EQ(between.distance, 0.0);
+    }
+
+    std::vector<double> diameters(polygons.size()), widths(polygons.size()), distances(polygons.size());
+    std::vector<Rectangle2D<double> > rects;
+    ConvexDiameters(Span<const Polygon2D<double> >(polygons), diameters.data(), 3);
+    ConvexWidths(Span<const Polygon2D<double> >(polygons), widths.data(), 3);
+    MinAreaRectangles(Span<const Polygon2D<double> >(polygons), rects, 3);
+    ConvexDistances(Span<const Polygon2D<double> >(polygons), Span<const Polygon2D<double> >(others), distances.data(), 3);
+    ASSERT_EQ(rects.size(), polygons.size());
+    for(std::size_t i=0;i<polygons.size();i++) {
+        EXPECT_EQ(diameters[i], ConvexDiameter(polygons[i]).distance);
+        EXPECT_EQ(widths[i], ConvexWidth(polygons[i]).distance);
+        EXPECT_EQ(rects[i].Vertices(), MinAreaRectangle(polygons[i]).Vertices());
+        EXPECT_EQ(distances[i], ConvexDistance(polygons[i], others[i]).distance);
+    }
+
+    // degenerate input and the axis aligned rectangle
+    std::vector<Vector2D<float> > segment(2, Vector2D<float>(1, 1));
+    segment[1] = Vector2D<float>(4, 5);
+    EXPECT_FLOAT_EQ(ConvexDiameter(Span<const Vector2D<float> >(segment)).distance, 5.0f);
+    EXPECT_FLOAT_EQ(ConvexWidth(Span<const Vector2D<float> >(segment)).distance, 0.0f);
+    Rectangle2D<float> box(Vector2D<float>(1, 2), 4.0f, 2.0f);
+    EXPECT_FLOAT_EQ(MinAreaRectangle(box).Area(), 8.0f);
+    EXPECT_FLOAT_EQ(ConvexWidth(box).distance, 2.0f);
+
+    // segments and points: crossing, touching and collinear overlaps are at distance 0
+    std::vector<Vector2D<float> > cross(2, Vector2D<float>(1, 5));
+    cross[1] = Vector2D<float>(4, 1);
+    std::vector<Vector2D<float> > far(2, Vector2D<float>(10, 0));
+    far[1] = Vector2D<float>(10, 6);
+    std::vector<Vector2D<float> > on(1, Vector2D<float>(2.5f, 3));
+    std::vector<Vector2D<float> > along(2, Vector2D<float>(3.25f, 4));
+    along[1] = Vector2D<float>(7, 9);
+    Span<const Vector2D<float> > s(segment);
+    EXPECT_EQ(ConvexDistance(s, Span<const Vector2D<float> >(cross)).distance, 0.0f);
+    EXPECT_EQ(ConvexDistance(Span<const Vector2D<float> >(on), s).distance, 0.0f);
+    EXPECT_EQ(ConvexDistance(s, Span<const Vector2D<float> >(along)).distance, 0.0f);
+    EXPECT_EQ(ConvexDistance(s, s).distance, 0.0f);
+    EXPECT_FLOAT_EQ(ConvexDistance(s, Span<const Vector2D<float> >(far)).distance, 6.0f);
+    EXPECT_FLOAT_EQ(ConvexDistance(Span<const Vector2D<float> >(on), Span<const Vector2D<float> >(far)).distance, 7.5f);
+}
+
+TEST(PrimitivesTest, ConvexPolygon) {
+    std::srand(37);
+    for(int trial=0;trial<200;trial++) {
+        // both the linear scan (small) and the binary search (large) paths
+        int n = trial%2 ? 3+std::rand()%20 : 40+std::rand()%400;
+        Polygon2D<double> polygon = RandomConvexPolygon(Vector2D<double>(1, -2), 1.0+std::rand()%3, n);
+        const std::vector<Vector2D<double> >& v = polygon.Vertices();
+        std::vector<Vector2D<double> > reversed(v.rbegin(), v.rend());
+        reversed.push_back(reversed.front());
+        ConvexPolygon2D<double> convex(polygon), clockwise((Span<const Vector2D<double> >(reversed)));
+        ASSERT_TRUE(convex.Valid());
+        ASSERT_TRUE(clockwise.Valid());
+        EXPECT_EQ(convex.Size(), clockwise.Size());
+        for(int k=0;k<200;k++) {
+            Vector2D<double> q(1+10.0*std::rand()/RAND_MAX-5, -2+10.0*std::rand()/RAND_MAX-5);
+            bool inside = true;
+            for(std::size_t i=0;i<v.size();i++) {
+                const Vector2D<double>& a = v[i];
+                const Vector2D<double>& b = v[(i+1)%v.size()];
+                inside = inside && (b.X()-a.X())*(q.Y()-a.Y())-(b.Y()-a.Y())*(q.X()-a.X())>=0;
+            }
+            double expected = inside ? 0.0 : Distance(q, polygon);
+            EXPECT_EQ(convex.Contains(q), inside);
+            EXPECT_EQ(clockwise.Contains(q), inside);
+            EXPECT_NEAR(convex.Distance(q), expected, 1e-12);
+            EXPECT_NEAR(clockwise.Distance(q), expected, 1e-12);
+        }
+        for(std::size_t i=0;i<v.size();i++) {
+            EXPECT_NEAR(convex.Distance(v[i]), 0.0, 1e-12);
+            EXPECT_NEAR(convex.Distance((v[i]+v[(i+1)%v.size()])/2.0), 0.0, 1e-12);
+        }
+    }
+
+    // collinear and repeated vertices are dropped
+    std::vector<Vector2D<float> > square;
+    square.push_back(Vector2D<float>(0, 0));
+    square.push_back(Vector2D<float>(1, 0));
+    square.push_back(Vector2D<float>(2, 0));
+    square.push_back(Vector2D<float>(2, 0));
+    square.push_back(Vector2D<float>(2, 2));
+    square.push_back(Vector2D<float>(0, 2));
+    square.push_back(Vector2D<float>(0, 1));
+    ConvexPolygon2D<float> box((Span<const Vector2D<float> >(square)));
+    ASSERT_TRUE(box.Valid());
+    EXPECT_EQ(box.Size(), 4u);
+    EXPECT_TRUE(box.Contains(Vector2D<float>(2, 1)));
+    EXPECT_FALSE(box.Contains(Vector2D<float>(2.5f, 1)));
+    EXPECT_FLOAT_EQ(box.Distance(Vector2D<float>(5, 6)), 5.0f);
+    EXPECT_FLOAT_EQ(box.Distance(Vector2D<float>(1, 1)), 0.0f);
+
+    // non convex and degenerate input
+    square.push_back(Vector2D<float>(1, 1.5f));
+    ConvexPolygon2D<float> notConvex((Span<const Vector2D<float> >(square)));
+    EXPECT_FALSE(notConvex.Valid());
+    EXPECT_FALSE(notConvex.Contains(Vector2D<float>(1, 1)));
+    EXPECT_EQ(notConvex.DistanceSq(Vector2D<float>(1, 1)), std::numeric_limits<float>::infinity());
+    std::vector<Vector2D<double> > star;
+    for(int i=0;i<5;i++)
+        star.push_back(Vector2D<double>(std::cos(i*4*3.141592653589793/5), std::sin(i*4*3.141592653589793/5)));
+    EXPECT_FALSE(ConvexPolygon2D<double>(Span<const Vector2D<double> >(star)).Valid());
+    EXPECT_FALSE(ConvexPolygon2D<double>(Span<const Vector2D<double> >(std::vector<Vector2D<double> >(2, Vector2D<double>(1, 1)))).Valid());
+    EXPECT_FALSE(ConvexPolygon2D<double>().Valid());
+}
+
+TEST(AlgorithmsTest, ConvexHull) {
+    std::srand(47);
+    for(int trial=0;trial<60;trial++) {
+        // random clouds, lattice points (many collinear and repeated points) and large parallel inputs
+        std::size_t n = trial<20 ? 1+std::rand()%200 : trial<40 ? 500 : 200000;
+        std::vector<Vector2D<double> > points(n);
+        for(std::size_t i=0;i<n;i++) {
+            if(trial>=20 && trial<40)
+                points[i] = Vector2D<double>(std::rand()%12, std::rand()%9);
+            else
+                points[i] = Vector2D<double>(10.0*std::rand()/RAND_MAX, 10.0*std::rand()/RAND_MAX-5);
+        }
+        Polygon2D<double> hull = ConvexHull(Span<const Vector2D<double> >(points), trial%2 ? 4 : 1);
+        const std::vector<Vector2D<double> >& h = hull.Vertices();
+        ASSERT_FALSE(h.empty());
+        std::size_t m = h.size();
+        for(std::size_t i=0;i<m && m>=3;i++)
+            EXPECT_GT(detail::Orient(h[i], h[(i+1)%m], h[(i+2)%m]), 0.0);
+        for(std::size_t i=0;i<n;i+=(n>1000 ? 97 : 1)) {
+            for(std::size_t k=0;k<m && m>=3;k++)
+                EXPECT_GE(detail::Orient(h[k], h[(k+1)%m], points[i]), 0.0);
+        }
+        for(std::size_t k=0;k<m;k++)
+            EXPECT_NE(std::find(points.begin(), points.end(), h[k]), points.end());
+
+        IncrementalHull2D<double> incremental;
+        incremental.Insert(Span<const Vector2D<double> >(points));
+        std::vector<Vector2D<double> > streamed;
+        incremental.Vertices(streamed);
+        EXPECT_EQ(streamed, h);
+        EXPECT_EQ(ConvexHull(PointCloud2D<double>(Span<const Vector2D<double> >(points)).View(), 2).Vertices(), h);
+    }
+
+    // streaming: the hull is right after every insertion
+    IncrementalHull2D<float> stream;
+    std::vector<Vector2D<float> > seen;
+    for(int i=0;i<300;i++) {
+        Vector2D<float> p(float(std::rand()%50), float(std::rand()%50));
+        seen.push_back(p);
+        stream.Insert(p);
+        if(i%10==0) {
+            EXPECT_EQ(stream.Hull().Vertices(), ConvexHull(Span<const Vector2D<float> >(seen)).Vertices());
+        }
+    }
+    EXPECT_FALSE(stream.Insert(Vector2D<float>(25, 25)));
+
+    // degenerate inputs
+    std::vector<Vector2D<double> > line;
+    for(int i=0;i<10;i++)
+        line.push_back(Vector2D<double>(i%5, 2*(i%5)));
+    EXPECT_EQ(ConvexHull(Span<const Vector2D<double> >(line)).Vertices().size(), 2u);
+    EXPECT_EQ(ConvexHull(Span<const Vector2D<double> >(std::vector<Vector2D<double> >(3, Vector2D<double>(1, 1)))).Vertices().size(), 1u);
+    EXPECT_TRUE(ConvexHull(Span<const Vector2D<double> >()).Vertices().empty());
+    IncrementalHull2D<double> single;
+    single.Insert(Vector2D<double>(1, 2));
+    EXPECT_EQ(single.Hull().Vertices().size(), 1u);
+    Rectangle2D<double> box(Vector2D<double>(1, 2), 4.0, 2.0);
+    EXPECT_DOUBLE_EQ(ConvexHull(box).Area(), 8.0);
+}
+
+// Check a triangulation: counter clockwise triangles covering the area, with centroids inside, every ring edge used once
+static void CheckTriangulation(const std::vector<Polygon2D<double> >& rings, const std::vector<std::uint32_t>& triangles)
+{
+    std::vector<Vector2D<double> > v;
+    std::map<std::pair<std::uint32_t, std::uint32_t>, int> edges;
+    double area = 0.0;
+    for(std::size_t r=0;r<rings.size();r++)
+    {
+        Polygon2D<double> ring = rings[r];
+        area += (r==0 ? 1 : -1)*std::fabs(ring.Area());
+        v.insert(v.end(), rings[r].Vertices().begin(), rings[r].Vertices().end());
+    }
+    std::size_t holes = rings.size()-1;
+    ASSERT_EQ(triangles.size(), 3*(v.size()-2+2*holes));
+    double sum = 0.0;
+    for(std::size_t t=0;t<triangles.size();t+=3)
+    {
+        const Vector2D<double>& a = v[triangles[t]];
+        const Vector2D<double>& b = v[triangles[t+1]];
+        const Vector2D<double>& c = v[triangles[t+2]];
+        double twice = (b.X()-a.X())*(c.Y()-a.Y())-(b.Y()-a.Y())*(c.X()-a.X());
+        EXPECT_GT(twice, 0.0);
+        sum += 0.5*twice;
+        Vector2D<double> centroid((a.X()+b.X()+c.X())/3, (a.Y()+b.Y()+c.Y())/3);
+        bool inside = rings[0].Contains(centroid);
+        for(std::size_t r=1;r<rings.size();r++)
+            inside = inside && !rings[r].Contains(centroid);
+        EXPECT_TRUE(inside);
+        for(int k=0;k<3;k++)
+            edges[std::make_pair(triangles[t+k], triangles[t+(k+1)%3])]++;
+    }
+    EXPECT_NEAR(sum, area, 1e-9*std::fabs(area));
+    // every ring edge is used by exactly one triangle, in one direction or the other
+    for(std::size_t r=0, base=0;r<rings.size();base+=rings[r].Vertices().size(), r++)
+    {
+        std::uint32_t m = std::uint32_t(rings[r].Vertices().size());
+        for(std::uint32_t i=0;i<m;i++)
+        {
+            std::uint32_t a = std::uint32_t(base)+i, b = std::uint32_t(base)+(i+1)%m;
+            EXPECT_EQ(edges[std::make_pair(a, b)]+edges[std::make_pair(b, a)], 1);
+        }
+    }
+}
+
+TEST(AlgorithmsTest, Triangulation) {
+    std::srand(53);
+    std::vector<std::uint32_t> triangles;
+    // square, both orientations
+    Rectangle2D<double> square(Vector2D<double>(0, 0), 2.0, 2.0);
+    ASSERT_TRUE(Triangulate(square, triangles));
+    CheckTriangulation(std::vector<Polygon2D<double> >(1, square), triangles);
+
+    // random star shaped polygons (many split and merge vertices), either orientation
+    for(int trial=0;trial<40;trial++)
+    {
+        int n = 3+std::rand()%300;
+        Polygon2D<double> star;
+        for(int k=0;k<n;k++)
+        {
+            double angle = (trial%2 ? 1 : -1)*6.283185307179586*k/n, radius = 1.0+9.0*std::rand()/RAND_MAX;
+            star.AddPoint(Vector2D<double>(radius*std::cos(angle), radius*std::sin(angle)));
+        }
+        ASSERT_TRUE(Triangulate(star, triangles));
+        CheckTriangulation(std::vector<Polygon2D<double> >(1, star), triangles);
+        // with a star shaped hole in the kernel
+        std::vector<Polygon2D<double> > withHole(1, star);
+        withHole.push_back(Polygon2D<double>());
+        for(int k=0;k<n;k++)
+        {
+            double angle = 6.283185307179586*k/n, radius = 0.2+0.7*std::rand()/RAND_MAX;
+            withHole[1].AddPoint(Vector2D<double>(radius*std::cos(angle), radius*std::sin(angle)));
+        }
+        ASSERT_TRUE(Triangulate(Span<const Polygon2D<double> >(withHole), triangles));
+        CheckTriangulation(withHole, triangles);
+    }
+
+    // comb on a grid: horizontal edges and vertices at the same height
+    Polygon2D<double> comb;
+    comb.AddPoint(Vector2D<double>(0, 0));
+    for(int i=0;i<10;i++)
+    {
+        comb.AddPoint(Vector2D<double>(2*i+2, 0));
+        comb.AddPoint(Vector2D<double>(2*i+2, i%2 ? 3 : 1));
+    }
+    for(int i=9;i>=0;i--)
+    {
+        comb.AddPoint(Vector2D<double>(2*i+2, 5));
+        comb.AddPoint(Vector2D<double>(2*i+1, 5));
+        comb.AddPoint(Vector2D<double>(2*i+1, 4));
+        comb.AddPoint(Vector2D<double>(2*i, 4));
+    }
+    ASSERT_TRUE(Triangulate(comb, triangles));
+    CheckTriangulation(std::vector<Polygon2D<double> >(1, comb), triangles);
+
+    // polygon with holes (a square hole, a star hole and a diamond hole at the height of the square)
+    std::vector<Polygon2D<double> > rings;
+    rings.push_back(Rectangle2D<double>(Vector2D<double>(10, 5), 20.0, 10.0));
+    rings.push_back(Rectangle2D<double>(Vector2D<double>(3.5, 3.5), 3.0, 3.0));
+    Polygon2D<double> hole;
+    for(int k=0;k<40;k++)
+    {
+        double angle = 6.283185307179586*k/40, radius = 1.0+0.8*(k%2);
+        hole.AddPoint(Vector2D<double>(12+radius*std::cos(angle), 5+radius*std::sin(angle)));
+    }
+    rings.push_back(hole);
+    Polygon2D<double> diamond;
+    diamond.AddPoint(Vector2D<double>(7, 2));
+    diamond.AddPoint(Vector2D<double>(8, 3.5));
+    diamond.AddPoint(Vector2D<double>(7, 5));
+    diamond.AddPoint(Vector2D<double>(6, 3.5));
+    rings.push_back(diamond);
+    ASSERT_TRUE(Triangulate(Span<const Polygon2D<double> >(rings), triangles));
+    CheckTriangulation(rings, triangles);
+
+    // nearly straight chains over one bottom vertex: every triangle is counter clockwise under exact orientation
+    std::srand(59);
+    std::size_t clockwise = 0;
+    for(int trial=0;trial<2000;trial++)
+    {
+        Polygon2D<double> chain;
+        int n = 5+std::rand()%20;
+        double slope = 0.1+double(std::rand())/RAND_MAX;
+        chain.AddPoint(Vector2D<double>(0.5*n, -1.0));
+        for(int k=n-1;k>=0;k--)
+            chain.AddPoint(Vector2D<double>(k*0.7071, 1.0+slope*k*0.7071+1e-15*(std::rand()%3)));
+        ASSERT_TRUE(Triangulate(chain, triangles));
+        const std::vector<Vector2D<double> >& v = chain.Vertices();
+        for(std::size_t t=0;t<triangles.size();t+=3)
+            clockwise += Orient2D(v[triangles[t]], v[triangles[t+1]], v[triangles[t+2]])<=0;
+    }
+    EXPECT_EQ(clockwise, 0u);
+
+    // repeated vertices and the closing vertex are skipped
+    Polygon2D<double> repeated;
+    repeated.AddPoint(Vector2D<double>(0, 0));
+    repeated.AddPoint(Vector2D<double>(1, 0));
+    repeated.AddPoint(Vector2D<double>(1, 0));
+    repeated.AddPoint(Vector2D<double>(1, 1));
+    repeated.AddPoint(Vector2D<double>(0, 0));
+    ASSERT_TRUE(Triangulate(repeated, triangles));
+    ASSERT_EQ(triangles.size(), 3u);
+    std::sort(triangles.begin(), triangles.end());
+    EXPECT_EQ(triangles, std::vector<std::uint32_t>({0, 1, 3}));
+
+    // batch: same triangles as one by one
+    std::vector<Polygon2D<double> > polygons;
+    for(int p=0;p<500;p++)
+    {
+        Polygon2D<double> polygon;
+        int n = 3+p%17;
+        for(int k=0;k<n;k++)
+        {
+            double angle = 6.283185307179586*k/n, radius = 1.0+std::rand()%5;
+            polygon.AddPoint(Vector2D<double>(p+radius*std::cos(angle), radius*std::sin(angle)));
+        }
+        polygons.push_back(polygon);
+    }
+    std::vector<std::uint32_t> all;
+    std::vector<std::size_t> offsets;
+    EXPECT_EQ(TriangulatePolygons(Span<const Polygon2D<double> >(polygons), all, offsets, 4), 0u);
+    ASSERT_EQ(offsets.size(), polygons.size()+1);
+    for(std::size_t p=0;p<polygons.size();p++)
+    {
+        ASSERT_TRUE(Triangulate(polygons[p], triangles));
+        EXPECT_EQ(std::vector<std::uint32_t>(all.begin()+offsets[p], all.begin()+offsets[p+1]), triangles);
+    }
+    Triangulator2D<float> reused;
+    reused.AddRing(Span<const Vector2D<float> >(std::vector<Vector2D<float> >(3, Vector2D<float>(1, 1))));
+    EXPECT_TRUE(reused.Triangulate(triangles));
+
+    // a degenerate outer boundary is dropped: the next ring is not taken for it, the holes make the input invalid
+    reused.Clear();
+    std::vector<Vector2D<float> > flat, cell;
+    for(int k=0;k<4;k++)
+        flat.push_back(Vector2D<float>(float(k), float(2*k)));
+    cell.push_back(Vector2D<float>(0, 0));
+    cell.push_back(Vector2D<float>(1, 0));
+    cell.push_back(Vector2D<float>(1, 1));
+    cell.push_back(Vector2D<float>(0, 1));
+    reused.AddRing(Span<const Vector2D<float> >(flat));
+    EXPECT_TRUE(reused.Triangulate(triangles));
+    reused.AddRing(Span<const Vector2D<float> >(cell));
+    triangles.clear();
+    EXPECT_FALSE(reused.Triangulate(triangles));
+    EXPECT_TRUE(triangles.empty());
+    reused.Clear();
+    reused.AddRing(Span<const Vector2D<float> >(cell));
+    EXPECT_TRUE(reused.Triangulate(triangles));
+    EXPECT_EQ(triangles.size(), 6u);
+}
+
+// Point in a set of non overlapping rings (even-odd)
+static bool InsideRings(const RingBuffer2D<double>& rings, const Vector2D<double>& point)
+{
+    bool inside = false;
+    for(std::size_t r=0;r<rings.RingCount();r++)
+        inside = inside!=rings.Polygon(r).Contains(point);
+    return inside;
+}
+
+TEST(AlgorithmsTest, PolygonBoolean) {
+    std::vector<Polygon2D<double> > squares;
+    squares.push_back(Rectangle2D<double>(Vector2D<double>(1, 1), 2.0, 2.0));
+    squares.push_back(Rectangle2D<double>(Vector2D<double>(2, 2), 2.0, 2.0));
+    RingBuffer2D<double> a(Span<const Polygon2D<double> >(&squares[0], 1)), b(Span<const Polygon2D<double> >(&squares[1], 1)), out;
+    PolygonBoolean2D<double> engine;
+    const double areas[4] = {7.0, 1.0, 3.0, 6.0};
+    const std::size_t points[4] = {8, 4, 6, 12};
+    for(int op=0;op<4;op++)
+    {
+        EXPECT_TRUE(engine.Compute(a, b, BooleanOperation(op), out));
+        EXPECT_DOUBLE_EQ(out.Area(), areas[op]);
+        EXPECT_EQ(out.PointCount(), points[op]);
+        for(std::size_t r=0;r<out.RingCount();r++)
+            EXPECT_GT(out.SignedArea(r), 0.0);
+        EXPECT_EQ(engine.Stats().inputEdges, 8u);
+        EXPECT_EQ(engine.Stats().outputRings, out.RingCount());
+        EXPECT_GT(engine.Stats().memoryUsage, 0u);
+    }
+
+    // float orientation: 1e-20f-1e20f is not exact in double, the rounded determinant would be 0
+    EXPECT_LT(Orient2D(1e-20f, 0.0f, 0.0f, 0.0f, 1e20f, 1e20f), 0.0f);
+    EXPECT_GT(Orient2D(0.0f, 0.0f, 1e-20f, 0.0f, 1e20f, 1e20f), 0.0f);
+    EXPECT_EQ(Orient2D(1e-20f, 1e-20f, 2e-20f, 2e-20f, 1e20f, 1e20f), 0.0f);
+
+    // shared edges: the union is one ring without the collinear vertices, the intersection is empty
+    RingBuffer2D<double> left, right;
+    left.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(0, 0), 2.0, 2.0).Vertices()));
+    right.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(2, 0.5), 2.0, 1.0).Vertices()));
+    EXPECT_TRUE(BooleanOp(left, right, BooleanUnion, out).closed);
+    ASSERT_EQ(out.RingCount(), 1u);
+    EXPECT_EQ(out.PointCount(), 6u);
+    EXPECT_DOUBLE_EQ(out.Area(), 6.0);
+    BooleanOp(left, right, BooleanIntersection, out);
+    EXPECT_TRUE(out.Empty());
+    BooleanOp(left, left, BooleanUnion, out);
+    EXPECT_EQ(out.PointCount(), 4u);
+
+    // holes: a frame minus a bar through it gives two pieces, the frame hole is kept as a clockwise ring
+    RingBuffer2D<double> frame, bar;
+    frame.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(0, 0), 10.0, 10.0).Vertices()));
+    frame.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(0, 0), 4.0, 4.0).Vertices()), true);
+    bar.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(0, 0), 20.0, 2.0).Vertices()));
+    BooleanOp(frame, bar, BooleanDifference, out);
+    EXPECT_EQ(out.RingCount(), 2u);
+    EXPECT_DOUBLE_EQ(out.Area(), 100.0-16.0-2*(10.0-4.0));
+    BooleanOp(frame, RingBuffer2D<double>(), BooleanUnion, out);
+    ASSERT_EQ(out.RingCount(), 2u);
+    EXPECT_LT(std::min(out.SignedArea(0), out.SignedArea(1)), 0.0);
+
+    // random star shaped polygons (many crossings): areas and sampled points agree with the definitions
+    std::srand(61);
+    for(int trial=0;trial<30;trial++)
+    {
+        RingBuffer2D<double> sets[2];
+        std::vector<Polygon2D<double> > stars(2);
+        for(int s=0;s<2;s++)
+        {
+            int n = 3+std::rand()%40;
+            for(int k=0;k<n;k++)
+            {
+                double angle = (s ? -1 : 1)*6.283185307179586*k/n, radius = 1.0+4.0*std::rand()/RAND_MAX;
+                stars[s].AddPoint(Vector2D<double>(s+radius*std::cos(angle), radius*std::sin(angle)));
+            }
+            sets[s].AddRing(Span<const Vector2D<double> >(stars[s].Vertices()));
+        }
+        RingBuffer2D<double> results[4];
+        for(int op=0;op<4;op++)
+            EXPECT_TRUE(engine.Compute(sets[0], sets[1], BooleanOperation(op), results[op]));
+        double areaA = sets[0].Area(), areaB = sets[1].Area();
+        EXPECT_NEAR(results[BooleanUnion].Area(), areaA+areaB-results[BooleanIntersection].Area(), 1e-9);
+        EXPECT_NEAR(results[BooleanDifference].Area(), areaA-results[BooleanIntersection].Area(), 1e-9);
+        EXPECT_NEAR(results[BooleanXor].Area(), results[BooleanUnion].Area()-results[BooleanIntersection].Area(), 1e-9);
+        for(int i=0;i<200;i++)
+        {
+            Vector2D<double> p(12.0*std::rand()/RAND_MAX-5.5, 12.0*std::rand()/RAND_MAX-6);
+            bool inA = stars[0].Contains(p), inB = stars[1].Contains(p);
+            EXPECT_EQ(InsideRings(results[BooleanUnion], p), inA || inB);
+            EXPECT_EQ(InsideRings(results[BooleanIntersection], p), inA && inB);
+            EXPECT_EQ(InsideRings(results[BooleanDifference], p), inA && !inB);
+            EXPECT_EQ(InsideRings(results[BooleanXor], p), inA!=inB);
+        }
+    }
+
+    // a crossing point rounded beside an axis aligned edge must still split it
+    RingBuffer2D<double> hexagon, square;
+    std::vector<Vector2D<double> > corners = {Vector2D<double>(1.66118, 6.54313), Vector2D<double>(1.01096, 7.62467), Vector2D<double>(-0.250792, 7.60233),
+        Vector2D<double>(-0.862322, 6.49845), Vector2D<double>(-0.2121, 5.41691), Vector2D<double>(1.04965, 5.43925)};
+    hexagon.AddRing(Span<const Vector2D<double> >(corners));
+    square.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(5.0, 5.0), 10.0, 10.0).Vertices()));
+    RingBuffer2D<double> clippedResults[4];
+    for(int op=0;op<4;op++)
+        EXPECT_TRUE(engine.Compute(hexagon, square, BooleanOperation(op), clippedResults[op]));
+    EXPECT_NEAR(clippedResults[BooleanIntersection].Area(), 2.9419344605, 1e-9);
+    EXPECT_NEAR(clippedResults[BooleanDifference].Area(), hexagon.Area()-clippedResults[BooleanIntersection].Area(), 1e-9);
+    EXPECT_NEAR(clippedResults[BooleanUnion].Area(), 100.0+clippedResults[BooleanDifference].Area(), 1e-9);
+    EXPECT_NEAR(clippedResults[BooleanXor].Area(), clippedResults[BooleanUnion].Area()-clippedResults[BooleanIntersection].Area(), 1e-9);
+
+    // a self-intersecting ring: the rounded crossing points cut a near vertical edge out of order
+    RingBuffer2D<double> triangle, bowtie, joined;
+    std::vector<Vector2D<double> > triangleCorners = {Vector2D<double>(1.2489356447864646, 2.6345092864330306),
+        Vector2D<double>(-0.47432222736654139, 3.3071200072887006), Vector2D<double>(1.2115829655109958, -0.3794164025604736)};
+    std::vector<Vector2D<double> > bowtieCorners = {Vector2D<double>(2.9035129396500254, 3.3347436505856338),
+        Vector2D<double>(0.66547010352252789, 5.6299096296271571), Vector2D<double>(0.66547010352252767, 2.7590396367844372),
+        Vector2D<double>(-0.70358208774809994, 3.3347436505856338)};
+    triangle.AddRing(Span<const Vector2D<double> >(triangleCorners));
+    bowtie.AddRing(Span<const Vector2D<double> >(bowtieCorners));
+    EXPECT_TRUE(engine.Compute(triangle, bowtie, BooleanUnion, joined));
+    EXPECT_TRUE(engine.Stats().closed);
+    EXPECT_NEAR(joined.Area(), 5.4752, 1e-4);
+
+    // random self-intersecting rings with vertices one ulp apart and shared coordinates: the results are closed
+    // and agree with the nonzero rule of the inputs
+    auto winding = [](const RingBuffer2D<double>& rings, const Vector2D<double>& p) {
+        int w = 0;
+        for(std::size_t r=0;r<rings.RingCount();r++)
+        {
+            Span<const Vector2D<double> > v = rings.Ring(r);
+            for(std::size_t i=0;i<v.size();i++)
+            {
+                const Vector2D<double>& s = v[i];
+                const Vector2D<double>& t = v[(i+1)%v.size()];
+                double side = (t.X()-s.X())*(p.Y()-s.Y())-(t.Y()-s.Y())*(p.X()-s.X());
+                if(s.Y()<=p.Y() && t.Y()>p.Y() && side>0)
+                    w++;
+                else if(s.Y()>p.Y() && t.Y()<=p.Y() && side<0)
+                    w--;
+            }
+        }
+        return w;
+    };
+    for(int trial=0;trial<200;trial++)
+    {
+        RingBuffer2D<double> sets[2];
+        for(int s=0;s<2;s++)
+            for(int r=0;r<1+s;r++)
+            {
+                std::vector<Vector2D<double> > v;
+                int n = 3+std::rand()%6;
+                for(int i=0;i<n;i++)
+                {
+                    double x = 6.0*std::rand()/RAND_MAX-3.0, y = 6.0*std::rand()/RAND_MAX-3.0;
+                    if(i>0 && std::rand()%3==0)
+                        x = std::nextafter(v[std::rand()%i].X(), std::rand()%2 ? 10.0 : -10.0);
+                    if(i>0 && std::rand()%3==0)
+                        y = v[std::rand()%i].Y();
+                    v.push_back(Vector2D<double>(x, y));
+                }
+                for(std::size_t i=0;i<v.size();i++)
+                    sets[s].AddPoint(v[i]);
+                sets[s].CloseRing();
+            }
+        for(int op=0;op<4;op++)
+        {
+            RingBuffer2D<double> result;
+            EXPECT_TRUE(engine.Compute(sets[0], sets[1], BooleanOperation(op), result));
+            for(int i=0;i<50;i++)
+            {
+                Vector2D<double> p(6.0*std::rand()/RAND_MAX-3.0, 6.0*std::rand()/RAND_MAX-3.0);
+                bool inA = winding(sets[0], p)!=0, inB = winding(sets[1], p)!=0;
+                bool expected = op==BooleanUnion ? inA || inB : op==BooleanIntersection ? inA && inB : op==BooleanDifference ? inA && !inB : inA!=inB;
+                EXPECT_EQ(winding(result, p)!=0, expected);
+            }
+        }
+    }
+
+    // cascaded union of overlapping integer rectangles: the area is the number of covered unit cells
+    std::vector<Polygon2D<double> > boxes;
+    std::vector<char> covered(40*40, 0);
+    for(int i=0;i<300;i++)
+    {
+        int x = std::rand()%36, y = std::rand()%36, w = 1+std::rand()%4, h = 1+std::rand()%4;
+        boxes.push_back(Rectangle2D<double>(Vector2D<double>(x+0.5*w, y+0.5*h), double(w), double(h)));
+        for(int cy=y;cy<y+h;cy++)
+            for(int cx=x;cx<x+w;cx++)
+                covered[cy*40+cx] = 1;
+    }
+    double cells = 0.0;
+    for(std::size_t c=0;c<covered.size();c++)
+        cells += covered[c];
+    RingBuffer2D<double> merged, parallel;
+    BooleanStats2D stats = CascadedUnion(Span<const Polygon2D<double> >(boxes), merged, 1);
+    EXPECT_DOUBLE_EQ(merged.Area(), cells);
+    EXPECT_EQ(stats.outputPoints, merged.PointCount());
+    EXPECT_TRUE(stats.closed);
+    // an open sub-operation makes the whole cascade open
+    BooleanStats2D open;
+    open.closed = false;
+    stats.Add(open);
+    EXPECT_FALSE(stats.closed);
+    // small strips: the boxes are cut in four strips, swept in parallel and merged two by two with MergeUnion
+    BooleanStats2D cascade = CascadedUnion(Span<const Polygon2D<double> >(boxes), parallel, 4, 16);
+    EXPECT_TRUE(cascade.closed);
+    EXPECT_GT(cascade.inputEdges, stats.inputEdges);
+    EXPECT_DOUBLE_EQ(parallel.Area(), cells);
+    for(int cy=0;cy<40;cy++)
+        for(int cx=0;cx<40;cx++)
+            EXPECT_EQ(InsideRings(parallel, Vector2D<double>(cx+0.5, cy+0.5)), covered[cy*40+cx]!=0);
+    for(int cy=0;cy<40;cy++)
+        for(int cx=0;cx<40;cx++)
+            EXPECT_EQ(InsideRings(merged, Vector2D<double>(cx+0.5, cy+0.5)), covered[cy*40+cx]!=0);
+
+    // merge of two unions: only the edges near their shared range of x are swept
+    RingBuffer2D<double> west, east, both;
+    for(std::size_t i=0;i<boxes.size();i++)
+        (boxes[i].Vertices()[0].X()<12.0 ? west : east).AddRing(Span<const Vector2D<double> >(boxes[i].Vertices()));
+    engine.Compute(RingBuffer2D<double>(west), RingBuffer2D<double>(), BooleanUnion, west);
+    engine.Compute(RingBuffer2D<double>(east), RingBuffer2D<double>(), BooleanUnion, east);
+    EXPECT_TRUE(engine.MergeUnion(west, east, both));
+    EXPECT_LT(engine.Stats().sweepEdges, engine.Stats().inputEdges);
+    EXPECT_DOUBLE_EQ(both.Area(), cells);
+    for(int cy=0;cy<40;cy++)
+        for(int cx=0;cx<40;cx++)
+            EXPECT_EQ(InsideRings(both, Vector2D<double>(cx+0.5, cy+0.5)), covered[cy*40+cx]!=0);
+}
+
+TEST(AlgorithmsTest, Clipping) {
+    RectangleClipper2D<double> clipper(Rectangle2D<double>(Vector2D<double>(5.0, 5.0), 10.0, 10.0));
+    EXPECT_EQ(clipper.Window().Min(), Vector2D<double>(0.0, 0.0));
+    EXPECT_EQ(clipper.Window().Max(), Vector2D<double>(10.0, 10.0));
+
+    // Liang-Barsky
+    Segment<double> part;
+    ASSERT_TRUE(clipper.Clip(Segment<double>(Vector2D<double>(-5.0, 5.0), Vector2D<double>(15.0, 5.0)), part));
+    EXPECT_EQ(part.P0(), Vector2D<double>(0.0, 5.0));
+    EXPECT_EQ(part.P1(), Vector2D<double>(10.0, 5.0));
+    ASSERT_TRUE(clipper.Clip(Segment<double>(Vector2D<double>(-2.0, -2.0), Vector2D<double>(4.0, 4.0)), part));
+    EXPECT_EQ(part.P0(), Vector2D<double>(0.0, 0.0));
+    EXPECT_EQ(part.P1(), Vector2D<double>(4.0, 4.0));
+    EXPECT_FALSE(clipper.Clip(Segment<double>(Vector2D<double>(-1.0, 0.0), Vector2D<double>(-1.0, 10.0)), part));
+    EXPECT_FALSE(clipper.Clip(Segment<double>(Vector2D<double>(-3.0, 8.0), Vector2D<double>(1.0, 12.0)), part));
+
+    // Sutherland-Hodgman: a convex polygon clipped to the window covers their intersection
+    std::vector<Vector2D<double> > ring;
+    auto area = [](const std::vector<Vector2D<double> >& v) {
+        double sum = 0.0;
+        for(std::size_t i=0;i<v.size();i++)
+            sum += v[i].X()*v[(i+1)%v.size()].Y()-v[i].Y()*v[(i+1)%v.size()].X();
+        return sum/2;
+    };
+    RingBuffer2D<double> window;
+    window.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(5.0, 5.0), 10.0, 10.0).Vertices()));
+    for(int k=0;k<50;k++)
+    {
+        Polygon2D<double> hexagon;
+        Vector2D<double> center(-4.0+18.0*std::rand()/RAND_MAX, -4.0+18.0*std::rand()/RAND_MAX);
+        double radius = 0.5+5.0*std::rand()/RAND_MAX;
+        for(int i=0;i<6;i++)
+            hexagon.AddPoint(center+Vector2D<double>(radius*std::cos(1.0471975511965976*i+k), radius*std::sin(1.0471975511965976*i+k)));
+        RingBuffer2D<double> shape, common;
+        shape.AddRing(Span<const Vector2D<double> >(hexagon.Vertices()));
+        BooleanOp(shape, window, BooleanIntersection, common);
+        if(clipper.Clip(Span<const Vector2D<double> >(hexagon.Vertices()), ring))
+        {
+            EXPECT_NEAR(area(ring), common.Area(), 1e-9);
+            for(std::size_t i=0;i<ring.size();i++)
+                EXPECT_TRUE(clipper.Window().Contains(ring[i]));
+        }
+        else
+            EXPECT_NEAR(common.Area(), 0.0, 1e-9);
+    }
+    // a concave ring stays one ring joined along the window side
+    std::vector<Vector2D<double> > comb = {Vector2D<double>(2.0, 8.0), Vector2D<double>(2.0, 12.0), Vector2D<double>(4.0, 12.0), Vector2D<double>(4.0, 9.0),
+        Vector2D<double>(6.0, 9.0), Vector2D<double>(6.0, 12.0), Vector2D<double>(8.0, 12.0), Vector2D<double>(8.0, 8.0)};
+    std::reverse(comb.begin(), comb.end());
+    ASSERT_TRUE(clipper.Clip(Span<const Vector2D<double> >(comb), ring));
+    EXPECT_DOUBLE_EQ(area(ring), 10.0);
+
+    // batches: inside rings are copied, outside ones skipped, the others clipped
+    RingBuffer2D<double> rings, clipped;
+    rings.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(5.0, 5.0), 2.0, 2.0).Vertices()));
+    rings.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(20.0, 5.0), 2.0, 2.0).Vertices()));
+    rings.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(10.0, 10.0), 2.0, 2.0).Vertices()));
+    rings.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(10.5, 5.0), 2.0, 2.0).Vertices()), true);
+    // touching the window only
+    rings.AddRing(Span<const Vector2D<double> >(Rectangle2D<double>(Vector2D<double>(5.0, -1.0), 2.0, 2.0).Vertices()));
+    std::vector<std::uint32_t> sources;
+    EXPECT_EQ(clipper.ClipRings(rings, clipped, sources), 3u);
+    EXPECT_EQ(clipper.Accepted(), 1u);
+    EXPECT_EQ(clipper.Rejected(), 2u);
+    EXPECT_EQ(clipper.Clipped(), 2u);
+    EXPECT_EQ(sources, (std::vector<std::uint32_t>{0, 2, 3}));
+    EXPECT_DOUBLE_EQ(clipped.SignedArea(0), 4.0);
+    EXPECT_DOUBLE_EQ(clipped.SignedArea(1), 1.0);
+    EXPECT_DOUBLE_EQ(clipped.SignedArea(2), -1.0);
+    // the output buffers are reused
+    const Vector2D<double>* storage = clipped.Points().data();
+    clipper.ClipRings(rings, clipped, sources);
+    EXPECT_EQ(clipped.Points().data(), storage);
+    EXPECT_EQ(clipped.RingCount(), 3u);
+
+    SegmentArray2D<double> segments, inside;
+    std::vector<Segment<double> > input;
+    for(int i=0;i<500;i++)
+    {
+        Vector2D<double> a(-5.0+20.0*std::rand()/RAND_MAX, -5.0+20.0*std::rand()/RAND_MAX), b(-5.0+20.0*std::rand()/RAND_MAX, -5.0+20.0*std::rand()/RAND_MAX);
+        input.push_back(Segment<double>(a, b));
+        segments.AddSegment(a, b);
+    }
+    std::size_t count = clipper.ClipSegments(segments, inside, sources);
+    EXPECT_EQ(count, inside.Size());
+    EXPECT_EQ(clipper.Accepted()+clipper.Rejected()+clipper.Clipped(), input.size());
+    std::size_t k = 0;
+    for(std::size_t i=0;i<input.size();i++)
+    {
+        bool hit = clipper.Clip(input[i], part);
+        ASSERT_EQ(k<count && sources[k]==i, hit);
+        if(!hit)
+            continue;
+        Segment<double> s = inside.GetSegment(k++);
+        EXPECT_NEAR((s.P0()-part.P0()).Length(), 0.0, 1e-12);
+        EXPECT_NEAR((s.P1()-part.P1()).Length(), 0.0, 1e-12);
+        EXPECT_TRUE(clipper.Window().Contains(s.P0()) && clipper.Window().Contains(s.P1()));
+        // the clipped segment lies on the input segment
+        Vector2D<double> d = input[i].P1()-input[i].P0(), m = (s.P0()+s.P1())*0.5-input[i].P0();
+        EXPECT_NEAR((d.X()*m.Y()-d.Y()*m.X())/d.Length(), 0.0, 1e-9);
+    }
+}
+
+// Largest distance from a vertex of line to the segment between the kept vertices around it
+static double SimplificationError(const Polyline2D<double>& line, const std::vector<std::uint32_t>& kept)
+{
+    double error = 0.0;
+    for(std::size_t k=0;k+1<kept.size();k++)
+    {
+        Segment<double> segment(line.Vertices()[kept[k]], line.Vertices()[kept[k+1]]);
+        for(std::uint32_t i=kept[k]+1;i<kept[k+1];i++)
+            error = std::max(error, std::sqrt(DistanceSq(line.Vertices()[i], segment)));
+    }
+    return error;
+}
+
+TEST(AlgorithmsTest, Simplification) {
+    // a collinear run and a spike
+    Polyline2D<double> line;
+    line.AddPoint(Vector2D<double>(0.0, 0.0));
+    line.AddPoint(Vector2D<double>(1.0, 0.0));
+    line.AddPoint(Vector2D<double>(2.0, 0.0));
+    line.AddPoint(Vector2D<double>(3.0, 1.0));
+    line.AddPoint(Vector2D<double>(4.0, 0.0));
+    line.AddPoint(Vector2D<double>(5.0, 0.05));
+    line.AddPoint(Vector2D<double>(6.0, 0.0));
+    std::vector<std::uint32_t> kept;
+    DouglasPeucker(line, 0.1, kept);
+    EXPECT_EQ(kept, (std::vector<std::uint32_t>{0, 2, 3, 4, 6}));
+    DouglasPeucker(line, 2.0, kept);
+    EXPECT_EQ(kept, (std::vector<std::uint32_t>{0, 6}));
+    Visvalingam(line, 0.1, kept);
+    EXPECT_EQ(kept, (std::vector<std::uint32_t>{0, 2, 3, 4, 6}));
+    Visvalingam(line, 4.0, kept);
+    EXPECT_EQ(kept, (std::vector<std::uint32_t>{0, 6}));
+
+    // random walk: the error stays below the tolerance, and nothing recurses (an arc keeps every vertex)
+    Polyline2D<double> walk, arc;
+    Vector2D<double> position(0.0, 0.0);
+    for(int i=0;i<20000;i++)
+    {
+        position += Vector2D<double>(1.0, 2.0*std::rand()/RAND_MAX-1.0);
+        walk.AddPoint(position);
+    }
+    for(int i=0;i<200000;i++)
+        arc.AddPoint(Vector2D<double>(std::cos(3.0*i/200000), std::sin(3.0*i/200000)));
+    DouglasPeucker(walk, 2.0, kept);
+    EXPECT_LE(SimplificationError(walk, kept), 2.0);
+    EXPECT_LT(kept.size(), walk.Vertices().size()/4);
+    std::vector<std::uint32_t> coarse;
+    Visvalingam(walk, 5.0, kept);
+    Visvalingam(walk, 50.0, coarse);
+    EXPECT_LT(coarse.size(), kept.size());
+    EXPECT_TRUE(std::includes(kept.begin(), kept.end(), coarse.begin(), coarse.end()));
+    DouglasPeucker(arc, 0.0, kept);
+    EXPECT_EQ(kept.size(), arc.Vertices().size());
+
+    // streaming: the same bound with a bounded window, and plain Douglas-Peucker with a window covering everything
+    StreamingPolyline2D<double> stream(2.0, 256), whole(2.0, 1<<20);
+    for(std::size_t i=0;i<walk.Vertices().size();i++)
+    {
+        stream.AddPoint(walk.Vertices()[i]);
+        whole.AddPoint(walk.Vertices()[i]);
+    }
+    EXPECT_GT(stream.Indices().size(), 1u);
+    stream.Flush();
+    whole.Flush();
+    EXPECT_EQ(stream.Indices().front(), 0u);
+    EXPECT_EQ(stream.Indices().back(), walk.Vertices().size()-1);
+    EXPECT_LE(SimplificationError(stream, stream.Indices()), 2.0);
+    EXPECT_LT(stream.Indices().size(), walk.Vertices().size()/4);
+    DouglasPeucker(walk, 2.0, kept);
+    EXPECT_EQ(whole.Indices(), kept);
+
+    // batches match the single polylines
+    std::vector<Polyline2D<double> > lines(40);
+    for(std::size_t l=0;l<lines.size();l++)
+        for(std::size_t i=0;i<l*l*12;i++)
+            lines[l].AddPoint(walk.Vertices()[i]);
+    std::vector<std::uint32_t> all;
+    std::vector<std::size_t> offsets;
+    for(unsigned int threads=1;threads<=4;threads+=3)
+        for(int method=0;method<2;method++)
+        {
+            SimplifyPolylines(Span<const Polyline2D<double> >(lines), 1.0, SimplifyMethod(method), all, offsets, threads);
+            ASSERT_EQ(offsets.size(), lines.size()+1);
+            EXPECT_EQ(offsets.back(), all.size());
+            for(std::size_t l=0;l<lines.size();l++)
+            {
+                if(method==0)
+                    DouglasPeucker(lines[l], 1.0, kept);
+                else
+                    Visvalingam(lines[l], 1.0, kept);
+                EXPECT_EQ(std::vector<std::uint32_t>(all.begin()+offsets[l], all.begin()+offsets[l+1]), kept);
+            }
+        }
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();